@@ -14,6 +14,41 @@ function(internal_paraview_install_plugin name)
   endif()
 endfunction()
 
+# Function to write the manifest for a plugin, "${name}.pvmanifest", next to
+# the plugin library. The manifest carries the plugin's server-manager xmls so
+# that vtkPVPluginLoader can register the plugin without loading the library
+# until one of its proxies is instantiated. Expects the PLUGIN_REQUIRED_*
+# variables set up by ADD_PARAVIEW_PLUGIN.
+# This is a function internal to ParaView and should not be directly used by
+# external applications. This may change in future without notice.
+function(internal_paraview_write_plugin_manifest name version xmls)
+  set(manifest "<PluginManifest name=\"${name}\" version=\"${version}\"\n")
+  set(manifest "${manifest}  verification=\"paraviewplugin|${CMAKE_CXX_COMPILER_ID}|${PARAVIEW_VERSION}\"\n")
+  set(manifest "${manifest}  required_on_server=\"${PLUGIN_REQUIRED_ON_SERVER}\"")
+  set(manifest "${manifest} required_on_client=\"${PLUGIN_REQUIRED_ON_CLIENT}\"")
+  set(manifest "${manifest} required_plugins=\"${PLUGIN_REQUIRED_PLUGINS}\">\n")
+  foreach(xml IN LISTS xmls)
+    get_filename_component(xml "${xml}" ABSOLUTE)
+    file(READ "${xml}" contents)
+    string(REGEX REPLACE "<\\?xml[^>]*\\?>" "" contents "${contents}")
+    set(manifest "${manifest}${contents}\n")
+    # regenerate the manifest when the xml changes.
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${xml}")
+  endforeach()
+  set(manifest "${manifest}</PluginManifest>\n")
+
+  set(manifest_file "${CMAKE_CURRENT_BINARY_DIR}/${name}.pvmanifest")
+  file(WRITE "${manifest_file}.tmp" "${manifest}")
+  configure_file("${manifest_file}.tmp" "${manifest_file}" COPYONLY)
+  add_custom_command(TARGET ${name} POST_BUILD
+    COMMAND ${CMAKE_COMMAND} -E copy_if_different
+            "${manifest_file}" "$<TARGET_FILE_DIR:${name}>/${name}.pvmanifest")
+  if(PARAVIEW_INSTALL_PLUGINS_DIR)
+    install(FILES "${manifest_file}"
+      DESTINATION ${PARAVIEW_INSTALL_PLUGINS_DIR}/${name} COMPONENT Runtime)
+  endif()
+endfunction()
+
 # helper PV_PLUGIN_LIST_CONTAINS macro
 MACRO(PV_PLUGIN_LIST_CONTAINS var value)
   SET(${var})
@@ -965,6 +1000,14 @@ FUNCTION(ADD_PARAVIEW_PLUGIN NAME VERSION)
     # source are installed.
     internal_paraview_install_plugin(${NAME})
 
+    # Plugins that only provide server-manager xmls and wrapped classes can be
+    # loaded on first use. Those with GUI components or Python modules are
+    # always loaded eagerly.
+    IF(PARAVIEW_GENERATE_PLUGIN_MANIFESTS AND PARAVIEW_BUILD_SHARED_LIBS AND
+       ARG_SERVER_MANAGER_XML AND NOT GUI_SRCS AND NOT ARG_PYTHON_MODULES)
+      internal_paraview_write_plugin_manifest(${NAME} ${VERSION} "${ARG_SERVER_MANAGER_XML}")
+    ENDIF()
+
     IF(ARG_AUTOLOAD)
       message(WARNING "AUTOLOAD option is obsolete. Plugins built within"
         " ParaView source should use pv_plugin(..) macro with AUTOLOAD argument.")
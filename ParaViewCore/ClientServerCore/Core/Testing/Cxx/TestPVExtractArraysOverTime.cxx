@@ -0,0 +1,304 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVExtractArraysOverTime.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the output of vtkPVExtractArraysOverTime in time-parallel mode
+// with the output of the regular mode, and checks that each group executes
+// its own time steps only, with the controller of the group passed upstream.
+
+#include <mpi.h>
+
+#include "vtkCompositeDataIterator.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMPIController.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPVExtractArraysOverTime.h"
+#include "vtkPVInformationKeys.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataAlgorithm.h"
+#include "vtkSelectionNode.h"
+#include "vtkSelectionSource.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTable.h"
+
+#include <cmath>
+
+namespace
+{
+const int NUMBER_OF_TIME_STEPS = 5;
+const int NUMBER_OF_POINTS = 8;
+
+// Produces NUMBER_OF_POINTS points split among the requested pieces, with a
+// point array that depends on the global id and the requested time.
+class vtkTimeGroupsTestSource : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkTimeGroupsTestSource* New();
+  vtkTypeMacro(vtkTimeGroupsTestSource, vtkPolyDataAlgorithm);
+
+  int NumberOfExecutions;
+
+  // Number of processes of the controller passed with the update request, 0
+  // when none was passed. -1 if it changed between executions.
+  int UpdateControllerSize;
+
+protected:
+  vtkTimeGroupsTestSource()
+    : NumberOfExecutions(0)
+    , UpdateControllerSize(0)
+  {
+    this->SetNumberOfInputPorts(0);
+  }
+
+  int RequestInformation(vtkInformation*, vtkInformationVector**,
+    vtkInformationVector* outputVector) VTK_OVERRIDE
+  {
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    double times[NUMBER_OF_TIME_STEPS];
+    for (int cc = 0; cc < NUMBER_OF_TIME_STEPS; ++cc)
+    {
+      times[cc] = cc;
+    }
+    double range[2] = { times[0], times[NUMBER_OF_TIME_STEPS - 1] };
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_STEPS(), times, NUMBER_OF_TIME_STEPS);
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::TIME_RANGE(), range, 2);
+    outInfo->Set(vtkAlgorithm::CAN_HANDLE_PIECE_REQUEST(), 1);
+    return 1;
+  }
+
+  int RequestData(vtkInformation*, vtkInformationVector**,
+    vtkInformationVector* outputVector) VTK_OVERRIDE
+  {
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+    vtkPolyData* output = vtkPolyData::GetData(outInfo);
+    int piece = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER());
+    int numPieces = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES());
+    double time = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
+
+    vtkIdType begin = (piece * NUMBER_OF_POINTS) / numPieces;
+    vtkIdType end = ((piece + 1) * NUMBER_OF_POINTS) / numPieces;
+
+    vtkNew<vtkPoints> points;
+    vtkNew<vtkIdTypeArray> ids;
+    ids->SetName("GlobalIds");
+    vtkNew<vtkDoubleArray> values;
+    values->SetName("value");
+    for (vtkIdType gid = begin; gid < end; ++gid)
+    {
+      points->InsertNextPoint(gid, 0, 0);
+      ids->InsertNextValue(gid);
+      values->InsertNextValue(100 * time + gid);
+    }
+    output->SetPoints(points.GetPointer());
+    output->GetPointData()->SetGlobalIds(ids.GetPointer());
+    output->GetPointData()->AddArray(values.GetPointer());
+    output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), time);
+
+    vtkMultiProcessController* updateController = vtkMultiProcessController::SafeDownCast(
+      outInfo->Get(vtkPVInformationKeys::UPDATE_CONTROLLER()));
+    int size = updateController ? updateController->GetNumberOfProcesses() : 0;
+    if (this->NumberOfExecutions > 0 && size != this->UpdateControllerSize)
+    {
+      size = -1;
+    }
+    this->UpdateControllerSize = size;
+    this->NumberOfExecutions++;
+    return 1;
+  }
+
+private:
+  vtkTimeGroupsTestSource(const vtkTimeGroupsTestSource&) = delete;
+  void operator=(const vtkTimeGroupsTestSource&) = delete;
+};
+vtkStandardNewMacro(vtkTimeGroupsTestSource);
+
+// Shallow copies its input, to check that the controller is passed further
+// upstream than the input of the extraction.
+class vtkTimeGroupsTestPassThrough : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkTimeGroupsTestPassThrough* New();
+  vtkTypeMacro(vtkTimeGroupsTestPassThrough, vtkPolyDataAlgorithm);
+
+protected:
+  vtkTimeGroupsTestPassThrough() {}
+
+  int RequestData(vtkInformation*, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE
+  {
+    vtkPolyData::GetData(outputVector, 0)->ShallowCopy(vtkPolyData::GetData(inputVector[0], 0));
+    return 1;
+  }
+
+private:
+  vtkTimeGroupsTestPassThrough(const vtkTimeGroupsTestPassThrough&) = delete;
+  void operator=(const vtkTimeGroupsTestPassThrough&) = delete;
+};
+vtkStandardNewMacro(vtkTimeGroupsTestPassThrough);
+
+// Runs the extraction with the given number of time groups. Returns the
+// number of times the source executed on this rank, and the size of the
+// controller it was passed.
+int Extract(vtkMultiProcessController* controller, int numGroups, vtkMultiBlockDataSet* result,
+  int& updateControllerSize)
+{
+  vtkNew<vtkTimeGroupsTestSource> source;
+  vtkNew<vtkTimeGroupsTestPassThrough> passThrough;
+  passThrough->SetInputConnection(source->GetOutputPort());
+
+  vtkNew<vtkSelectionSource> selection;
+  selection->SetContentType(vtkSelectionNode::GLOBALIDS);
+  selection->SetFieldType(vtkSelectionNode::POINT);
+  selection->AddID(-1, 1);
+  selection->AddID(-1, NUMBER_OF_POINTS - 2);
+
+  vtkNew<vtkPVExtractArraysOverTime> extract;
+  extract->SetController(controller);
+  extract->SetNumberOfTimeGroups(numGroups);
+  extract->SetInputConnection(0, passThrough->GetOutputPort());
+  extract->SetInputConnection(1, selection->GetOutputPort());
+  extract->UpdatePiece(
+    controller->GetLocalProcessId(), controller->GetNumberOfProcesses(), 0);
+
+  result->ShallowCopy(extract->GetOutputDataObject(0));
+  updateControllerSize = source->UpdateControllerSize;
+  return source->NumberOfExecutions;
+}
+
+bool CompareTables(vtkTable* expected, vtkTable* actual)
+{
+  if (!expected || !actual || expected->GetNumberOfRows() != actual->GetNumberOfRows())
+  {
+    cerr << "ERROR: tables differ in number of rows." << endl;
+    return false;
+  }
+  for (vtkIdType col = 0; col < expected->GetNumberOfColumns(); ++col)
+  {
+    vtkDataArray* expectedArray = vtkDataArray::SafeDownCast(expected->GetColumn(col));
+    if (!expectedArray || !expectedArray->GetName())
+    {
+      continue;
+    }
+    vtkDataArray* actualArray =
+      vtkDataArray::SafeDownCast(actual->GetColumnByName(expectedArray->GetName()));
+    if (!actualArray ||
+      actualArray->GetNumberOfComponents() != expectedArray->GetNumberOfComponents())
+    {
+      cerr << "ERROR: missing column '" << expectedArray->GetName() << "'." << endl;
+      return false;
+    }
+    for (vtkIdType row = 0; row < expected->GetNumberOfRows(); ++row)
+    {
+      for (int comp = 0; comp < expectedArray->GetNumberOfComponents(); ++comp)
+      {
+        double a = expectedArray->GetComponent(row, comp);
+        double b = actualArray->GetComponent(row, comp);
+        if (a != b && !(std::isnan(a) && std::isnan(b)))
+        {
+          cerr << "ERROR: '" << expectedArray->GetName() << "' differs at row " << row << ": "
+               << a << " != " << b << endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestPVExtractArraysOverTime(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 1);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  int numProcs = controller->GetNumberOfProcesses();
+  int rank = controller->GetLocalProcessId();
+  int numGroups = numProcs < NUMBER_OF_TIME_STEPS ? numProcs : NUMBER_OF_TIME_STEPS;
+
+  vtkNew<vtkMultiBlockDataSet> expected;
+  vtkNew<vtkMultiBlockDataSet> actual;
+  int serialControllerSize, groupControllerSize;
+  int serialExecutions =
+    Extract(controller.GetPointer(), 1, expected.GetPointer(), serialControllerSize);
+  int groupExecutions =
+    Extract(controller.GetPointer(), numGroups, actual.GetPointer(), groupControllerSize);
+
+  int success = 1;
+  if (serialExecutions != NUMBER_OF_TIME_STEPS)
+  {
+    cerr << "ERROR: source executed " << serialExecutions << " times instead of "
+         << NUMBER_OF_TIME_STEPS << endl;
+    success = 0;
+  }
+
+  // Contiguous groups: rank r belongs to group (r * numGroups) / numProcs and
+  // owns the time steps groupId, groupId + numGroups, ...
+  int groupId = (rank * numGroups) / numProcs;
+  int ownSteps = (NUMBER_OF_TIME_STEPS - groupId + numGroups - 1) / numGroups;
+  if (groupExecutions != ownSteps)
+  {
+    cerr << "ERROR: source executed " << groupExecutions << " times on rank " << rank
+         << " instead of " << ownSteps << endl;
+    success = 0;
+  }
+
+  // The controller of the group is only passed upstream in time-parallel mode.
+  int groupStart = (groupId * numProcs + numGroups - 1) / numGroups;
+  int groupEnd = ((groupId + 1) * numProcs + numGroups - 1) / numGroups;
+  int expectedControllerSize = numGroups > 1 ? groupEnd - groupStart : 0;
+  if (serialControllerSize != 0 || groupControllerSize != expectedControllerSize)
+  {
+    cerr << "ERROR: source was passed controllers of " << serialControllerSize << " and "
+         << groupControllerSize << " processes on rank " << rank << " instead of 0 and "
+         << expectedControllerSize << endl;
+    success = 0;
+  }
+
+  if (rank == 0)
+  {
+    vtkCompositeDataIterator* iter = expected->NewIterator();
+    int numBlocks = 0;
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      numBlocks++;
+      if (!CompareTables(vtkTable::SafeDownCast(iter->GetCurrentDataObject()),
+            vtkTable::SafeDownCast(actual->GetDataSet(iter))))
+      {
+        success = 0;
+      }
+    }
+    iter->Delete();
+    if (numBlocks == 0)
+    {
+      cerr << "ERROR: nothing was extracted." << endl;
+      success = 0;
+    }
+  }
+
+  int allSuccess = 0;
+  controller->AllReduce(&success, &allSuccess, 1, vtkCommunicator::MIN_OP);
+
+  controller->Finalize();
+  return allSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVProgressHandler.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Tests the progress reported by vtkPVProgressHandler across ranks: the root
+// reports the progress of the slowest rank, repeated progress events are
+// dropped, and the progress of the ranks is forgotten once another algorithm
+// starts reporting progress.
+
+#include "vtkAlgorithm.h"
+#include "vtkCommand.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPVProgressHandler.h"
+#include "vtkPVServerInformation.h"
+#include "vtkPVSession.h"
+
+#include <vtksys/SystemTools.hxx>
+
+#include <mpi.h>
+
+namespace
+{
+// Session without any client or server connection.
+class vtkProgressTestSession : public vtkPVSession
+{
+public:
+  static vtkProgressTestSession* New();
+  vtkTypeMacro(vtkProgressTestSession, vtkPVSession);
+
+  bool GetIsAlive() VTK_OVERRIDE { return true; }
+  vtkPVServerInformation* GetServerInformation() VTK_OVERRIDE
+  {
+    return this->ServerInformation.GetPointer();
+  }
+
+private:
+  vtkProgressTestSession() {}
+  vtkNew<vtkPVServerInformation> ServerInformation;
+};
+vtkStandardNewMacro(vtkProgressTestSession);
+
+// Records the progress events fired by the handler.
+class vtkProgressObserver : public vtkCommand
+{
+public:
+  static vtkProgressObserver* New() { return new vtkProgressObserver(); }
+
+  void Execute(vtkObject* caller, unsigned long, void*) VTK_OVERRIDE
+  {
+    vtkPVProgressHandler* handler = static_cast<vtkPVProgressHandler*>(caller);
+    this->Progress = handler->GetLastProgress();
+    this->SlowestRank = handler->GetLastProgressSlowestRank();
+    this->Count++;
+  }
+
+  int Progress;
+  int SlowestRank;
+  int Count;
+
+private:
+  vtkProgressObserver()
+    : Progress(-1)
+    , SlowestRank(-1)
+    , Count(0)
+  {
+  }
+};
+
+// Reports progress after the progress interval of the handler has elapsed.
+void ReportProgress(vtkAlgorithm* algorithm, double progress)
+{
+  vtksys::SystemTools::Delay(20);
+  algorithm->UpdateProgress(progress);
+}
+}
+
+int TestPVProgressHandler(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 1);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int rank = controller->GetLocalProcessId();
+
+  int success = 1;
+  {
+    vtkNew<vtkProgressTestSession> session;
+    vtkPVProgressHandler* handler = session->GetProgressHandler();
+    handler->SetProgressInterval(0.01);
+
+    vtkNew<vtkAlgorithm> first;
+    vtkNew<vtkAlgorithm> second;
+    handler->RegisterProgressEvent(first.GetPointer(), 1);
+    handler->RegisterProgressEvent(second.GetPointer(), 2);
+
+    vtkNew<vtkProgressObserver> observer;
+    handler->AddObserver(vtkCommand::ProgressEvent, observer.GetPointer());
+
+    session->PrepareProgress();
+
+    // Satellites are slower than the root on the first algorithm.
+    if (rank > 0)
+    {
+      ReportProgress(first.GetPointer(), 0.1);
+    }
+    controller->Barrier();
+
+    if (rank == 0)
+    {
+      ReportProgress(first.GetPointer(), 0.5);
+      if (observer->Count != 1)
+      {
+        cerr << "ERROR: the progress of the first algorithm was not reported." << endl;
+        success = 0;
+      }
+
+      // Repeated progress events are dropped.
+      const int count = observer->Count;
+      ReportProgress(first.GetPointer(), 0.501);
+      if (observer->Count != count)
+      {
+        cerr << "ERROR: a progress event that did not change the percentage was reported."
+             << endl;
+        success = 0;
+      }
+
+      // Wait for the progress of the satellites to be received.
+      for (int cc = 0; cc < 250 && numProcs > 1 && observer->SlowestRank == 0; ++cc)
+      {
+        ReportProgress(first.GetPointer(), cc % 2 ? 0.5 : 0.6);
+      }
+      if (numProcs > 1 && (observer->SlowestRank == 0 || observer->Progress != 10))
+      {
+        cerr << "ERROR: the progress of the satellites was not reported: " << observer->Progress
+             << "% on rank " << observer->SlowestRank << endl;
+        success = 0;
+      }
+
+      // The progress satellites reported for the first algorithm no longer
+      // applies to the second one.
+      ReportProgress(second.GetPointer(), 0.3);
+      if (observer->Progress != 30 || observer->SlowestRank != 0)
+      {
+        cerr << "ERROR: expected 30% on rank 0 for the second algorithm, got "
+             << observer->Progress << "% on rank " << observer->SlowestRank << endl;
+        success = 0;
+      }
+    }
+
+    controller->Barrier();
+    session->CleanupPendingProgress();
+  }
+
+  int allSuccess = 0;
+  controller->AllReduce(&success, &allSuccess, 1, vtkCommunicator::MIN_OP);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return allSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestSharedMemoryConnection.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Connects two vtkTCPNetworkAccessManager instances of this process, with
+// every combination of tcp:// and shm:// URLs on each side, and checks that
+// shared memory is used only when both sides ask for it, and that messages
+// go through either way.
+
+#include "vtkMultiProcessController.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkServerSocket.h"
+#include "vtkSharedMemorySocketCommunicator.h"
+#include "vtkSocketCommunicator.h"
+#include "vtkTCPNetworkAccessManager.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+const char* HANDSHAKE = "paraview-5.4.renderingbackend.opengl2";
+
+// Above the shared memory threshold, and below the size of a 1 MiB ring.
+const vtkIdType NUMBER_OF_VALUES = 64 * 1024;
+const int TAG = 1234;
+
+struct ListenerData
+{
+  std::string URL;
+  vtkMultiProcessController* Controller;
+};
+
+VTK_THREAD_RETURN_TYPE Listen(void* arg)
+{
+  ListenerData* data =
+    static_cast<ListenerData*>(static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  vtkNew<vtkTCPNetworkAccessManager> nam;
+  data->Controller = nam->NewConnection(data->URL.c_str());
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+struct ReceiverData
+{
+  vtkMultiProcessController* Controller;
+  std::vector<double> Values;
+  int Status;
+};
+
+VTK_THREAD_RETURN_TYPE Receive(void* arg)
+{
+  ReceiverData* data =
+    static_cast<ReceiverData*>(static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  data->Values.resize(NUMBER_OF_VALUES);
+  data->Status = data->Controller->Receive(&data->Values[0], NUMBER_OF_VALUES, 1, TAG);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+int GetFreePort()
+{
+  vtkNew<vtkServerSocket> socket;
+  if (socket->CreateServer(0) != 0)
+  {
+    return -1;
+  }
+  int port = socket->GetServerPort();
+  socket->CloseSocket();
+  return port;
+}
+
+bool UsesSharedMemory(vtkMultiProcessController* controller)
+{
+  vtkSharedMemorySocketCommunicator* comm =
+    vtkSharedMemorySocketCommunicator::SafeDownCast(controller->GetCommunicator());
+  return comm && comm->GetSharedMemoryEnabled();
+}
+
+// Sends values from one end and receives them on the other, from another
+// thread since large messages going over the socket may block.
+bool Exchange(vtkMultiProcessController* sender, vtkMultiProcessController* receiver)
+{
+  std::vector<double> values(NUMBER_OF_VALUES);
+  for (vtkIdType cc = 0; cc < NUMBER_OF_VALUES; ++cc)
+  {
+    values[cc] = 0.5 * cc;
+  }
+
+  ReceiverData data;
+  data.Controller = receiver;
+  data.Status = 0;
+  vtkNew<vtkMultiThreader> threader;
+  int id = threader->SpawnThread(Receive, &data);
+  int status = sender->Send(&values[0], NUMBER_OF_VALUES, 1, TAG);
+  threader->TerminateThread(id);
+  if (!status || !data.Status || data.Values != values)
+  {
+    cerr << "ERROR: values were not exchanged." << endl;
+    return false;
+  }
+  return true;
+}
+
+bool TestConnection(bool server_shm, bool client_shm)
+{
+  int port = GetFreePort();
+  if (port <= 0)
+  {
+    cerr << "ERROR: no port available." << endl;
+    return false;
+  }
+
+  ListenerData listener;
+  std::ostringstream server_url;
+  server_url << (server_shm ? "shm" : "tcp") << "://localhost:" << port
+             << "?listen=true&handshake=" << HANDSHAKE;
+  listener.URL = server_url.str();
+  listener.Controller = NULL;
+  vtkNew<vtkMultiThreader> threader;
+  int id = threader->SpawnThread(Listen, &listener);
+
+  std::ostringstream client_url;
+  client_url << (client_shm ? "shm" : "tcp") << "://localhost:" << port
+             << "?handshake=" << HANDSHAKE << "&timeout=10&shmsize=1";
+  vtkNew<vtkTCPNetworkAccessManager> nam;
+  vtkMultiProcessController* client = nam->NewConnection(client_url.str().c_str());
+  threader->TerminateThread(id);
+  vtkMultiProcessController* server = listener.Controller;
+
+  bool success = true;
+  if (!client || !server)
+  {
+    cerr << "ERROR: connection failed." << endl;
+    success = false;
+  }
+  else
+  {
+    // The communicator supporting shared memory is only used when asked for.
+    if ((vtkSharedMemorySocketCommunicator::SafeDownCast(client->GetCommunicator()) != NULL) !=
+        client_shm ||
+      (vtkSharedMemorySocketCommunicator::SafeDownCast(server->GetCommunicator()) != NULL) !=
+        server_shm)
+    {
+      cerr << "ERROR: unexpected communicators." << endl;
+      success = false;
+    }
+#ifndef _WIN32
+    const bool expected = server_shm && client_shm;
+#else
+    const bool expected = false;
+#endif
+    if (UsesSharedMemory(client) != expected || UsesSharedMemory(server) != expected)
+    {
+      cerr << "ERROR: shared memory " << (expected ? "not " : "") << "in use." << endl;
+      success = false;
+    }
+    success = Exchange(client, server) && Exchange(server, client) && success;
+  }
+  if (!success)
+  {
+    cerr << "ERROR: with server " << listener.URL << " and client " << client_url.str() << endl;
+  }
+
+  if (client)
+  {
+    client->Delete();
+  }
+  if (server)
+  {
+    server->Delete();
+  }
+  return success;
+}
+}
+
+int TestSharedMemoryConnection(int, char* [])
+{
+  bool success = true;
+  for (int server_shm = 0; server_shm < 2; ++server_shm)
+  {
+    for (int client_shm = 0; client_shm < 2; ++client_shm)
+    {
+      success = TestConnection(server_shm != 0, client_shm != 0) && success;
+    }
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,11 +14,192 @@
 =========================================================================*/
 #include "vtkPVDataSizeInformation.h"
 
+#include "vtkAbstractArray.h"
 #include "vtkAlgorithm.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
 #include "vtkClientServerStream.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
+#include "vtkDataArray.h"
 #include "vtkDataObject.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
 #include "vtkObjectFactory.h"
-#include "vtkPVDataInformation.h"
+#include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTable.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+namespace
+{
+// Walks data objects collecting the arrays they hold so that arrays shallow
+// copied among blocks or output ports are counted only once. An array is
+// considered shared when it (or the vtkPoints/vtkCellArray holding it) has more
+// references than the ones encountered during the walk.
+class vtkMemoryAccumulator
+{
+public:
+  vtkMemoryAccumulator()
+    : Unaccounted(0)
+  {
+  }
+
+  void AddDataObject(vtkDataObject* dobj)
+  {
+    if (!dobj || !this->DataObjects.insert(dobj).second)
+    {
+      return;
+    }
+
+    if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(dobj))
+    {
+      this->AddFieldData(cd->GetFieldData());
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(cd->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+        this->AddDataObject(iter->GetCurrentDataObject());
+      }
+      return;
+    }
+
+    if (vtkTable* table = vtkTable::SafeDownCast(dobj))
+    {
+      this->AddFieldData(table->GetFieldData());
+      this->AddFieldData(table->GetRowData());
+      return;
+    }
+
+    vtkDataSet* ds = vtkDataSet::SafeDownCast(dobj);
+    if (!ds || !(vtkImageData::SafeDownCast(ds) || vtkRectilinearGrid::SafeDownCast(ds) ||
+                 vtkStructuredGrid::SafeDownCast(ds) || vtkPolyData::SafeDownCast(ds) ||
+                 vtkUnstructuredGrid::SafeDownCast(ds)))
+    {
+      // Data types whose internals we don't know about are counted as a whole.
+      this->Unaccounted += dobj->GetActualMemorySize();
+      return;
+    }
+
+    this->AddFieldData(ds->GetFieldData());
+    this->AddFieldData(ds->GetPointData());
+    this->AddFieldData(ds->GetCellData());
+    if (vtkPointSet* ps = vtkPointSet::SafeDownCast(ds))
+    {
+      vtkPoints* points = ps->GetPoints();
+      this->AddArray(points ? points->GetData() : NULL, points);
+    }
+    if (vtkRectilinearGrid* rg = vtkRectilinearGrid::SafeDownCast(ds))
+    {
+      this->AddArray(rg->GetXCoordinates());
+      this->AddArray(rg->GetYCoordinates());
+      this->AddArray(rg->GetZCoordinates());
+    }
+    else if (vtkPolyData* pd = vtkPolyData::SafeDownCast(ds))
+    {
+      this->AddCellArray(pd->GetVerts());
+      this->AddCellArray(pd->GetLines());
+      this->AddCellArray(pd->GetPolys());
+      this->AddCellArray(pd->GetStrips());
+    }
+    else if (vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(ds))
+    {
+      this->AddCellArray(ug->GetCells());
+      this->AddArray(ug->GetCellTypesArray());
+      this->AddArray(ug->GetCellLocationsArray());
+      this->AddArray(ug->GetFaces());
+      this->AddArray(ug->GetFaceLocations());
+    }
+  }
+
+  // Returns the total and shared memory in KBs.
+  void GetMemorySize(vtkTypeInt64& total, vtkTypeInt64& shared) const
+  {
+    total = this->Unaccounted;
+    shared = 0;
+    for (ArraysType::const_iterator iter = this->Arrays.begin(); iter != this->Arrays.end();
+         ++iter)
+    {
+      const ArrayInfo& info = iter->second;
+      total += info.Size;
+      if (iter->first->GetReferenceCount() > info.References ||
+        (info.Holder &&
+            info.Holder->GetReferenceCount() > this->Holders.find(info.Holder)->second))
+      {
+        shared += info.Size;
+      }
+    }
+  }
+
+private:
+  void AddFieldData(vtkFieldData* fd)
+  {
+    int numArrays = fd ? fd->GetNumberOfArrays() : 0;
+    for (int cc = 0; cc < numArrays; cc++)
+    {
+      this->AddArray(fd->GetAbstractArray(cc));
+    }
+  }
+
+  void AddCellArray(vtkCellArray* ca)
+  {
+    if (ca)
+    {
+      this->AddArray(ca->GetData(), ca);
+    }
+  }
+
+  void AddArray(vtkAbstractArray* array, vtkObjectBase* holder = NULL)
+  {
+    if (holder)
+    {
+      this->Holders[holder]++;
+    }
+    if (!array)
+    {
+      return;
+    }
+    ArrayInfo& info = this->Arrays[array];
+    if (info.References++ == 0)
+    {
+      info.Size = array->GetActualMemorySize();
+      info.Holder = holder;
+    }
+    else if (holder && !info.Holder)
+    {
+      info.Holder = holder;
+    }
+  }
+
+  struct ArrayInfo
+  {
+    ArrayInfo()
+      : Size(0)
+      , References(0)
+      , Holder(NULL)
+    {
+    }
+    vtkTypeInt64 Size;
+    int References;
+    vtkObjectBase* Holder;
+  };
+  typedef std::map<vtkAbstractArray*, ArrayInfo> ArraysType;
+  ArraysType Arrays;
+  std::map<vtkObjectBase*, int> Holders;
+  std::set<vtkDataObject*> DataObjects;
+  vtkTypeInt64 Unaccounted;
+};
+}
 
 vtkStandardNewMacro(vtkPVDataSizeInformation);
 //----------------------------------------------------------------------------
@@ -35,19 +216,26 @@ vtkPVDataSizeInformation::~vtkPVDataSizeInformation()
 //----------------------------------------------------------------------------
 void vtkPVDataSizeInformation::CopyFromObject(vtkObject* object)
 {
-  vtkPVDataInformation* dinfo = vtkPVDataInformation::New();
+  this->Initialize();
 
-  vtkAlgorithm* alg = vtkAlgorithm::SafeDownCast(object);
-  if (alg)
+  vtkMemoryAccumulator accumulator;
+  if (vtkAlgorithm* alg = vtkAlgorithm::SafeDownCast(object))
   {
-    dinfo->CopyFromObject(alg->GetOutputDataObject(0));
+    for (int port = 0; port < alg->GetNumberOfOutputPorts(); port++)
+    {
+      accumulator.AddDataObject(alg->GetOutputDataObject(port));
+    }
   }
   else
   {
-    dinfo->CopyFromObject(object);
+    accumulator.AddDataObject(vtkDataObject::SafeDownCast(object));
   }
-  this->MemorySize = dinfo->GetMemorySize();
-  dinfo->Delete();
+
+  vtkTypeInt64 total, shared;
+  accumulator.GetMemorySize(total, shared);
+  this->MemorySize = static_cast<int>(std::min<vtkTypeInt64>(total, VTK_INT_MAX));
+  this->SharedMemorySize = static_cast<int>(std::min<vtkTypeInt64>(shared, VTK_INT_MAX));
+  this->MaximumMemorySize = this->MemorySize;
   this->Modified();
 }
 
@@ -61,6 +249,8 @@ void vtkPVDataSizeInformation::AddInformation(vtkPVInformation* info)
     return;
   }
   this->MemorySize += dsinfo->MemorySize;
+  this->SharedMemorySize += dsinfo->SharedMemorySize;
+  this->MaximumMemorySize = std::max(this->MaximumMemorySize, dsinfo->MaximumMemorySize);
 }
 
 //----------------------------------------------------------------------------
@@ -69,6 +259,8 @@ void vtkPVDataSizeInformation::CopyToStream(vtkClientServerStream* css)
   css->Reset();
   *css << vtkClientServerStream::Reply;
   *css << this->MemorySize;
+  *css << this->SharedMemorySize;
+  *css << this->MaximumMemorySize;
   *css << vtkClientServerStream::End;
 }
 
@@ -79,6 +271,14 @@ void vtkPVDataSizeInformation::CopyFromStream(const vtkClientServerStream* css)
   {
     vtkErrorMacro("Error parsing memory size.");
   }
+  else if (!css->GetArgument(0, 1, &this->SharedMemorySize))
+  {
+    vtkErrorMacro("Error parsing shared memory size.");
+  }
+  else if (!css->GetArgument(0, 2, &this->MaximumMemorySize))
+  {
+    vtkErrorMacro("Error parsing maximum memory size.");
+  }
   else
   {
     this->Modified();
@@ -88,6 +288,8 @@ void vtkPVDataSizeInformation::CopyFromStream(const vtkClientServerStream* css)
 void vtkPVDataSizeInformation::Initialize()
 {
   this->MemorySize = 0;
+  this->SharedMemorySize = 0;
+  this->MaximumMemorySize = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -95,4 +297,6 @@ void vtkPVDataSizeInformation::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "MemorySize: " << this->MemorySize << endl;
+  os << indent << "SharedMemorySize: " << this->SharedMemorySize << endl;
+  os << indent << "MaximumMemorySize: " << this->MaximumMemorySize << endl;
 }
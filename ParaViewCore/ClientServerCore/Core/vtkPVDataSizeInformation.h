@@ -19,8 +19,14 @@
  *
  * vtkPVDataSizeInformation is an information object for getting information
  * about data size. This is a light weight sibling of vtkPVDataInformation which
- * only returns the data size and nothing more. The data size can also be
- * obtained from vtkPVDataInformation.
+ * only returns the data size and nothing more.
+ *
+ * When gathered from an algorithm, the outputs on all of its output ports are
+ * accounted for. Arrays are counted only once, even when shallow copied among
+ * several blocks or output ports, so MemorySize is the memory the proxy's
+ * outputs actually hold. Of that, SharedMemorySize is the memory in arrays that
+ * are also referenced elsewhere e.g. by the input or by a representation
+ * cache; it would not be freed by releasing these outputs alone.
 */
 
 #ifndef vtkPVDataSizeInformation_h
@@ -61,16 +67,24 @@ public:
 
   //@{
   /**
-   * Access to memory size information.
+   * Access to memory size information (in KBs).
    */
   vtkGetMacro(MemorySize, int);
+  vtkGetMacro(SharedMemorySize, int);
   //@}
 
+  /**
+   * Returns the largest MemorySize among the processes gathered from (in KBs).
+   */
+  vtkGetMacro(MaximumMemorySize, int);
+
 protected:
   vtkPVDataSizeInformation();
   ~vtkPVDataSizeInformation() override;
 
   int MemorySize;
+  int SharedMemorySize;
+  int MaximumMemorySize;
 
 private:
   vtkPVDataSizeInformation(const vtkPVDataSizeInformation&) = delete;
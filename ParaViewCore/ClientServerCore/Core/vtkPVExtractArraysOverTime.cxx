@@ -14,14 +14,42 @@
 =========================================================================*/
 #include "vtkPVExtractArraysOverTime.h"
 
+#include "vtkExecutive.h"
+#include "vtkInformation.h"
+#include "vtkInformationObjectBaseKey.h"
+#include "vtkInformationVector.h"
+#include "vtkMultiProcessController.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVExtractSelection.h"
+#include "vtkPVInformationKeys.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+
+class vtkPVExtractArraysOverTime::vtkTimeGroups
+{
+public:
+  // Controller spanning the ranks of this rank's group, along with the
+  // controller and number of groups it was partitioned for.
+  vtkSmartPointer<vtkMultiProcessController> GroupController;
+  vtkWeakPointer<vtkMultiProcessController> PartitionedController;
+  int NumberOfGroups;
+
+  vtkTimeGroups()
+    : NumberOfGroups(0)
+  {
+  }
+};
 
 vtkStandardNewMacro(vtkPVExtractArraysOverTime);
 
 //----------------------------------------------------------------------------
 vtkPVExtractArraysOverTime::vtkPVExtractArraysOverTime()
+  : NumberOfTimeGroups(1)
+  , TimeGroups(new vtkTimeGroups())
 {
   vtkNew<vtkPVExtractSelection> se;
   this->SetSelectionExtractor(se.GetPointer());
@@ -30,10 +58,139 @@ vtkPVExtractArraysOverTime::vtkPVExtractArraysOverTime()
 //----------------------------------------------------------------------------
 vtkPVExtractArraysOverTime::~vtkPVExtractArraysOverTime()
 {
+  delete this->TimeGroups;
+  this->TimeGroups = NULL;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVExtractArraysOverTime::GetTimeGroupInformation(
+  int& groupId, int& groupRank, int& groupSize)
+{
+  int numProcs = this->Controller ? this->Controller->GetNumberOfProcesses() : 1;
+  int rank = this->Controller ? this->Controller->GetLocalProcessId() : 0;
+
+  int numGroups = std::min(this->NumberOfTimeGroups, numProcs);
+  numGroups = std::min(numGroups, std::max(this->NumberOfTimeSteps, 1));
+  if (numGroups <= 1)
+  {
+    groupId = 0;
+    groupRank = rank;
+    groupSize = numProcs;
+    return 1;
+  }
+
+  // Ranks are split into contiguous groups whose sizes differ by at most 1.
+  groupId = static_cast<int>((static_cast<vtkIdType>(rank) * numGroups) / numProcs);
+  int groupStart = static_cast<int>(
+    (static_cast<vtkIdType>(groupId) * numProcs + numGroups - 1) / numGroups);
+  int groupEnd = static_cast<int>(
+    (static_cast<vtkIdType>(groupId + 1) * numProcs + numGroups - 1) / numGroups);
+  groupRank = rank - groupStart;
+  groupSize = groupEnd - groupStart;
+  return numGroups;
+}
+
+//----------------------------------------------------------------------------
+vtkMultiProcessController* vtkPVExtractArraysOverTime::GetGroupController(
+  int groupId, int groupRank, int numGroups)
+{
+  vtkTimeGroups* internals = this->TimeGroups;
+  if (internals->NumberOfGroups != numGroups ||
+    internals->PartitionedController != this->Controller || !internals->GroupController)
+  {
+    // All ranks reach this point with the same number of groups and
+    // controller, so the collective partition is matched on every rank.
+    internals->GroupController.TakeReference(
+      this->Controller->PartitionController(groupId, groupRank));
+    internals->PartitionedController = this->Controller;
+    internals->NumberOfGroups = numGroups;
+    if (!internals->GroupController)
+    {
+      vtkErrorMacro("Failed to partition the controller into time groups.");
+    }
+  }
+  return internals->GroupController;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVExtractArraysOverTime::FinishTimeLoop(
+  vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  // Mirrors what the superclass does after the last time step, without
+  // executing the time steps owned by the other groups.
+  request->Remove(vtkStreamingDemandDrivenPipeline::CONTINUE_EXECUTING());
+  this->IsExecuting = false;
+  this->CurrentTimeIndex = 0;
+  this->PostExecute(request, inputVector, outputVector);
+}
+
+//----------------------------------------------------------------------------
+int vtkPVExtractArraysOverTime::RequestUpdateExtent(
+  vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  int groupId, groupRank, groupSize;
+  int numGroups = this->GetTimeGroupInformation(groupId, groupRank, groupSize);
+  vtkMultiProcessController* groupController = NULL;
+  if (numGroups > 1)
+  {
+    if (!this->IsExecuting)
+    {
+      // Each group starts the loop at its own time step.
+      this->CurrentTimeIndex = groupId;
+    }
+    groupController = this->GetGroupController(groupId, groupRank, numGroups);
+  }
+
+  if (!this->Superclass::RequestUpdateExtent(request, inputVector, outputVector))
+  {
+    return 0;
+  }
+
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  if (numGroups > 1)
+  {
+    // Request the data partitioned among the ranks of this group only, and
+    // let the upstream algorithms know which ranks take part.
+    inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER(), groupRank);
+    inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES(), groupSize);
+    inInfo->Set(vtkPVInformationKeys::UPDATE_CONTROLLER(), groupController);
+    request->AppendUnique(vtkExecutive::KEYS_TO_COPY(), vtkPVInformationKeys::UPDATE_CONTROLLER());
+  }
+  else
+  {
+    inInfo->Remove(vtkPVInformationKeys::UPDATE_CONTROLLER());
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVExtractArraysOverTime::RequestData(
+  vtkInformation* request, vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  int groupId, groupRank, groupSize;
+  int numGroups = this->GetTimeGroupInformation(groupId, groupRank, groupSize);
+  if (!this->Superclass::RequestData(request, inputVector, outputVector))
+  {
+    return 0;
+  }
+
+  if (numGroups > 1 && this->IsExecuting)
+  {
+    // The superclass advanced to the next time step; skip the steps owned by
+    // the other groups. Past the last step of this group, end the loop here
+    // instead of letting the superclass run until the last time step.
+    this->CurrentTimeIndex += numGroups - 1;
+    if (this->CurrentTimeIndex >= this->NumberOfTimeSteps)
+    {
+      this->FinishTimeLoop(request, inputVector, outputVector);
+    }
+  }
+  return 1;
 }
 
 //----------------------------------------------------------------------------
 void vtkPVExtractArraysOverTime::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfTimeGroups: " << this->NumberOfTimeGroups << endl;
 }
@@ -20,6 +20,18 @@
  * that overrides the default SelectionExtractor with a vtkPVExtractSelection
  * instance.
  * This enables query selections to be extracted at each time step.
+ *
+ * vtkPVExtractArraysOverTime also supports a time-parallel mode. When
+ * NumberOfTimeGroups is greater than 1, the ranks of the controller are split
+ * into that many contiguous groups and each group iterates over its own
+ * subset of the time steps (round-robin), requesting the data partitioned
+ * among the ranks of the group only. The partial tables are merged by the
+ * reduction in vtkPExtractArraysOverTime, which combines rows using the
+ * validity mask. The controller spanning the ranks of the group is passed
+ * upstream with the update request, using
+ * vtkPVInformationKeys::UPDATE_CONTROLLER(). Upstream algorithms that
+ * communicate across ranks must use that controller, when set, instead of
+ * their own; time groups should not be used with those that do not.
  * @sa
  * vtkExtractArraysOverTime
  * vtkPExtractArraysOverTime
@@ -38,13 +50,52 @@ public:
   vtkTypeMacro(vtkPVExtractArraysOverTime, vtkPExtractArraysOverTime);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Get/Set the number of groups of ranks among which the time steps are
+   * distributed. 1 (default) disables time-parallel execution and every rank
+   * iterates over all time steps. The number of groups actually used is
+   * clamped to the number of processes and the number of time steps.
+   */
+  vtkSetClampMacro(NumberOfTimeGroups, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfTimeGroups, int);
+  //@}
+
 protected:
   vtkPVExtractArraysOverTime();
-  ~vtkPVExtractArraysOverTime() override;
+  ~vtkPVExtractArraysOverTime() VTK_OVERRIDE;
+
+  int RequestUpdateExtent(vtkInformation*, vtkInformationVector**,
+    vtkInformationVector*) VTK_OVERRIDE;
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
+
+  /**
+   * Computes the group this rank belongs to, its index within that group and
+   * the size of the group. Returns the number of groups in use; 1 indicates
+   * that time-parallel execution is disabled.
+   */
+  int GetTimeGroupInformation(int& groupId, int& groupRank, int& groupSize);
+
+  /**
+   * Returns the controller spanning the ranks of this rank's group, creating
+   * it if needed. Collective on Controller.
+   */
+  vtkMultiProcessController* GetGroupController(int groupId, int groupRank, int numGroups);
+
+  /**
+   * Ends the time loop early, once this rank's group has executed its last
+   * time step.
+   */
+  void FinishTimeLoop(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
+
+  int NumberOfTimeGroups;
 
 private:
   vtkPVExtractArraysOverTime(const vtkPVExtractArraysOverTime&) = delete;
   void operator=(const vtkPVExtractArraysOverTime&) = delete;
+
+  class vtkTimeGroups;
+  vtkTimeGroups* TimeGroups;
 };
 
 #endif // vtkPVExtractArraysOverTime_h
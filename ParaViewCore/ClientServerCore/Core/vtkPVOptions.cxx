@@ -55,6 +55,7 @@ vtkPVOptions::vtkPVOptions()
   this->ServerMode = 0;
   this->MultiClientMode = 0;
   this->DisableFurtherConnections = 0;
+  this->SharedMemory = 0;
   this->MultiClientModeWithErrorMacro = 0;
   this->MultiServerMode = 0;
   this->RenderServerMode = 0;
@@ -160,6 +161,11 @@ void vtkPVOptions::Initialize()
     "Does nothing without --multi-clients enabled.",
     vtkPVOptions::PVDATA_SERVER | vtkPVOptions::PVSERVER);
 
+  this->AddBooleanArgument("--shared-memory", 0, &this->SharedMemory,
+    "Exchange large messages through shared memory with clients that"
+    " ask for it and run on the same host.",
+    vtkPVOptions::PVDATA_SERVER | vtkPVOptions::PVRENDER_SERVER | vtkPVOptions::PVSERVER);
+
   this->AddBooleanArgument("--multi-servers", 0, &this->MultiServerMode,
     "Allow client to connect to several pvserver", vtkPVOptions::PVCLIENT);
 
@@ -476,6 +482,11 @@ void vtkPVOptions::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << "Disable further connections after the first client connects to a server..\n";
   }
 
+  if (this->SharedMemory)
+  {
+    os << indent << "Accept shared memory from clients on the same host.\n";
+  }
+
   if (this->MultiServerMode)
   {
     os << indent << "Allow a client to connect to multiple servers at the same time.\n";
@@ -142,6 +142,14 @@ public:
   vtkGetMacro(DisableFurtherConnections, int);
   //@}
 
+  //@{
+  /**
+   * Returns if this server accepts to exchange large messages through shared
+   * memory with clients that ask for it and run on the same host.
+   */
+  vtkGetMacro(SharedMemory, int);
+  //@}
+
   //@{
   /**
    * Is this client allow multiple server connection in parallel
@@ -321,6 +329,7 @@ protected:
   int RenderServerMode;
   int MultiClientMode;
   int DisableFurtherConnections;
+  int SharedMemory;
   int MultiClientModeWithErrorMacro;
   int MultiServerMode;
   int SymmetricMPIMode;
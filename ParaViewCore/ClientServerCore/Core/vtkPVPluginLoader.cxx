@@ -24,11 +24,15 @@
 #include "vtkPVPluginTracker.h"
 #include "vtkPVPythonPluginInterface.h"
 #include "vtkPVServerManagerPluginInterface.h"
+#include "vtkPVXMLElement.h"
 #include "vtkPVXMLParser.h"
 #include "vtkProcessModule.h"
 
+#include <map>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 #include <cstdlib>
@@ -134,6 +138,151 @@ public:
   }
 };
 
+// This is an helper class used for plugins registered from a manifest. It
+// stands in for the plugin library, providing the server-manager XMLs from the
+// manifest, until vtkPVPluginLoader::LoadDeferredPlugin() loads the library.
+class vtkPVManifestPlugin : public vtkPVPlugin, public vtkPVServerManagerPluginInterface
+{
+  std::string PluginName;
+  std::string PluginVersion;
+  std::string RequiredPlugins;
+  bool RequiredOnServer;
+  bool RequiredOnClient;
+  std::vector<std::string> XMLs;
+  vtkPVManifestPlugin()
+    : RequiredOnServer(true)
+    , RequiredOnClient(true)
+    , LibraryRequested(false)
+  {
+  }
+  vtkPVManifestPlugin(const vtkPVManifestPlugin& other);
+  void operator=(const vtkPVManifestPlugin& other);
+
+public:
+  // The plugin library this manifest describes.
+  std::string LibraryFileName;
+
+  // (group, name) of every proxy or extension defined in the XMLs.
+  std::vector<std::pair<std::string, std::string> > Proxies;
+
+  // Set once the library has been requested, so it is loaded only once.
+  bool LibraryRequested;
+
+  // Description:
+  // Returns the name of the manifest expected next to a plugin library i.e.
+  // "<dir>/<plugin name>.pvmanifest".
+  static std::string GetManifestFileName(const char* libraryfile)
+  {
+    std::string name = vtksys::SystemTools::GetFilenameWithoutExtension(libraryfile);
+    if (name.size() > 3 && name.compare(0, 3, "lib") == 0)
+    {
+      name.erase(0, 3);
+    }
+    return vtksys::SystemTools::GetFilenamePath(libraryfile) + "/" + name + ".pvmanifest";
+  }
+
+  // Description:
+  // Returns a new instance if a valid manifest, written for this version of
+  // ParaView, is present next to the plugin library. Returns NULL otherwise.
+  static vtkPVManifestPlugin* Create(const char* libraryfile)
+  {
+    std::string manifest = vtkPVManifestPlugin::GetManifestFileName(libraryfile);
+    if (!vtksys::SystemTools::FileExists(manifest.c_str(), true))
+    {
+      return NULL;
+    }
+
+    vtkNew<vtkPVXMLParser> parser;
+    parser->SetFileName(manifest.c_str());
+    parser->SuppressErrorMessagesOn();
+    vtkPVXMLElement* root = parser->Parse() ? parser->GetRootElement() : NULL;
+    if (!root || !root->GetName() || strcmp(root->GetName(), "PluginManifest") != 0 ||
+      !root->GetAttribute("name") ||
+      strcmp(root->GetAttributeOrEmpty("verification"), _PV_PLUGIN_VERIFICATION_STRING) != 0)
+    {
+      return NULL;
+    }
+
+    vtkPVManifestPlugin* instance = new vtkPVManifestPlugin();
+    instance->LibraryFileName = libraryfile;
+    instance->PluginName = root->GetAttribute("name");
+    instance->PluginVersion = root->GetAttributeOrDefault("version", "1.0");
+    instance->RequiredPlugins = root->GetAttributeOrEmpty("required_plugins");
+    int flag = 1;
+    if (root->GetScalarAttribute("required_on_server", &flag))
+    {
+      instance->RequiredOnServer = (flag != 0);
+    }
+    flag = 1;
+    if (root->GetScalarAttribute("required_on_client", &flag))
+    {
+      instance->RequiredOnClient = (flag != 0);
+    }
+
+    for (unsigned int cc = 0; cc < root->GetNumberOfNestedElements(); ++cc)
+    {
+      vtkPVXMLElement* configuration = root->GetNestedElement(cc);
+      if (!configuration->GetName() ||
+        strcmp(configuration->GetName(), "ServerManagerConfiguration") != 0)
+      {
+        continue;
+      }
+      std::ostringstream xml;
+      configuration->PrintXML(xml, vtkIndent());
+      instance->XMLs.push_back(xml.str());
+
+      for (unsigned int i = 0; i < configuration->GetNumberOfNestedElements(); ++i)
+      {
+        vtkPVXMLElement* group = configuration->GetNestedElement(i);
+        for (unsigned int j = 0; j < group->GetNumberOfNestedElements(); ++j)
+        {
+          const char* name = group->GetNestedElement(j)->GetAttribute("name");
+          if (name)
+          {
+            instance->Proxies.push_back(std::make_pair(group->GetAttributeOrEmpty("name"), name));
+          }
+        }
+      }
+    }
+    return instance;
+  }
+
+  // Description:
+  // Returns the name for this plugin.
+  const char* GetPluginName() override { return this->PluginName.c_str(); }
+
+  // Description:
+  // Returns the version for this plugin.
+  const char* GetPluginVersionString() override { return this->PluginVersion.c_str(); }
+
+  // Description:
+  // Returns true if this plugin is required on the server.
+  bool GetRequiredOnServer() override { return this->RequiredOnServer; }
+
+  // Description:
+  // Returns true if this plugin is required on the client.
+  bool GetRequiredOnClient() override { return this->RequiredOnClient; }
+
+  // Description:
+  // Returns a ';' separated list of plugin names required by this plugin.
+  const char* GetRequiredPlugins() override { return this->RequiredPlugins.c_str(); }
+
+  // Description:
+  // Obtain the server-manager configuration xmls, if any.
+  void GetXMLs(std::vector<std::string>& xmls) override
+  {
+    xmls.insert(xmls.end(), this->XMLs.begin(), this->XMLs.end());
+  }
+
+  // Description:
+  // The interpreter is initialized once the library itself is loaded.
+  vtkClientServerInterpreterInitializer::InterpreterInitializationCallback
+  GetInitializeInterpreterCallback() override
+  {
+    return NULL;
+  }
+};
+
 // Cleans successfully opened libs when the application quits.
 // BUG # 10293
 class vtkPVPluginLoaderCleaner
@@ -141,10 +290,56 @@ class vtkPVPluginLoaderCleaner
   typedef std::map<std::string, vtkLibHandle> HandlesType;
   HandlesType Handles;
   std::vector<vtkPVXMLOnlyPlugin*> XMLPlugins;
+  std::vector<vtkPVManifestPlugin*> ManifestPlugins;
+  typedef std::map<std::pair<std::string, std::string>, vtkPVManifestPlugin*> ProxiesType;
+  ProxiesType ManifestProxies;
 
 public:
   void Register(const char* pname, vtkLibHandle& handle) { this->Handles[pname] = handle; }
   void Register(vtkPVXMLOnlyPlugin* plugin) { this->XMLPlugins.push_back(plugin); }
+  void Register(vtkPVManifestPlugin* plugin)
+  {
+    this->ManifestPlugins.push_back(plugin);
+    for (size_t cc = 0; cc < plugin->Proxies.size(); ++cc)
+    {
+      this->ManifestProxies[plugin->Proxies[cc]] = plugin;
+    }
+  }
+
+  vtkPVManifestPlugin* FindManifestPlugin(const char* group, const char* name)
+  {
+    if (this->ManifestProxies.empty())
+    {
+      return NULL;
+    }
+    ProxiesType::const_iterator iter =
+      this->ManifestProxies.find(std::make_pair(std::string(group), std::string(name)));
+    return iter != this->ManifestProxies.end() ? iter->second : NULL;
+  }
+
+  vtkPVManifestPlugin* FindManifestPluginByName(const std::string& pname)
+  {
+    for (size_t cc = 0; cc < this->ManifestPlugins.size(); ++cc)
+    {
+      if (pname == this->ManifestPlugins[cc]->GetPluginName())
+      {
+        return this->ManifestPlugins[cc];
+      }
+    }
+    return NULL;
+  }
+
+  bool HasManifestPluginForLibrary(const char* filename)
+  {
+    for (size_t cc = 0; cc < this->ManifestPlugins.size(); ++cc)
+    {
+      if (this->ManifestPlugins[cc]->LibraryFileName == filename)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
 
   ~vtkPVPluginLoaderCleaner()
   {
@@ -158,6 +353,11 @@ public:
     {
       delete *iter;
     }
+    for (std::vector<vtkPVManifestPlugin*>::iterator iter = this->ManifestPlugins.begin();
+         iter != this->ManifestPlugins.end(); ++iter)
+    {
+      delete *iter;
+    }
   }
   static vtkPVPluginLoaderCleaner* GetInstance()
   {
@@ -383,6 +583,22 @@ bool vtkPVPluginLoader::LoadPluginInternal(const char* file, bool no_errors)
                               "cannot load dynamic plugins  in static builds.");
   return false;
 #else // ifndef BUILD_SHARED_LIBS
+  // If a manifest was installed next to the library, register the plugin from
+  // it and defer loading the library until one of its proxies is instantiated
+  // (see LoadDeferredPlugin). A library that was already registered that way
+  // is loaded for real.
+  if (!vtkPVPluginLoaderCleaner::GetInstance()->HasManifestPluginForLibrary(file))
+  {
+    vtkPVManifestPlugin* manifestPlugin = vtkPVManifestPlugin::Create(file);
+    if (manifestPlugin)
+    {
+      vtkPVPluginLoaderDebugMacro("Found plugin manifest. Deferring loading of the library."
+        << endl);
+      vtkPVPluginLoaderCleaner::GetInstance()->Register(manifestPlugin);
+      return this->LoadPlugin(file, manifestPlugin);
+    }
+  }
+
   vtkLibHandle lib = vtkDynamicLoader::OpenLibrary(file);
   if (!lib)
   {
@@ -617,6 +833,47 @@ void vtkPVPluginLoader::SetStaticPluginLoadFunction(vtkPluginLoadFunction functi
   }
 }
 
+//-----------------------------------------------------------------------------
+namespace
+{
+bool vtkLoadManifestPluginLibrary(vtkPVManifestPlugin* plugin)
+{
+  if (plugin->LibraryRequested)
+  {
+    return false;
+  }
+  plugin->LibraryRequested = true;
+
+  // Plugins this one depends on may have been deferred too.
+  std::vector<std::string> required;
+  vtksys::SystemTools::Split(plugin->GetRequiredPlugins(), required, ';');
+  for (size_t cc = 0; cc < required.size(); ++cc)
+  {
+    vtkPVManifestPlugin* other =
+      vtkPVPluginLoaderCleaner::GetInstance()->FindManifestPluginByName(required[cc]);
+    if (other)
+    {
+      vtkLoadManifestPluginLibrary(other);
+    }
+  }
+
+  vtkNew<vtkPVPluginLoader> loader;
+  return loader->LoadPlugin(plugin->LibraryFileName.c_str());
+}
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPVPluginLoader::LoadDeferredPlugin(const char* group, const char* name)
+{
+  if (!group || !name)
+  {
+    return false;
+  }
+  vtkPVManifestPlugin* plugin =
+    vtkPVPluginLoaderCleaner::GetInstance()->FindManifestPlugin(group, name);
+  return plugin ? vtkLoadManifestPluginLibrary(plugin) : false;
+}
+
 //-----------------------------------------------------------------------------
 void vtkPVPluginLoader::PluginLibraryUnloaded(const char* pluginname)
 {
@@ -22,6 +22,24 @@
  * This class only needed when loading plugins from shared libraries
  * dynamically. For statically importing plugins, one directly uses
  * PV_PLUGIN_IMPORT() macro defined in vtkPVPlugin.h.
+ *
+ * If a manifest named "<plugin name>.pvmanifest" is found next to a plugin
+ * library (see PARAVIEW_GENERATE_PLUGIN_MANIFESTS), the plugin is registered
+ * using the server-manager configuration it carries and the library itself is
+ * only loaded when one of its proxies is instantiated, see
+ * LoadDeferredPlugin(). The manifest is of the form:
+ *
+ * \code{.xml}
+ * <PluginManifest name="MyPlugin" version="1.0" verification="..."
+ *                 required_on_server="1" required_on_client="0" required_plugins="">
+ *   <ServerManagerConfiguration>
+ *   ...
+ *   </ServerManagerConfiguration>
+ * </PluginManifest>
+ * \endcode
+ *
+ * where verification must match the signature of plugins built for this
+ * version of ParaView, otherwise the manifest is ignored.
 */
 
 #ifndef vtkPVPluginLoader_h
@@ -144,6 +162,17 @@ public:
    */
   static void PluginLibraryUnloaded(const char* pluginname);
 
+  /**
+   * Loads the library for the plugin defining the proxy (group, name), if that
+   * plugin was registered from its manifest and the library was not loaded
+   * yet. Returns true if a library was loaded. vtkPVSessionCore calls this
+   * before creating the SI object for a proxy, since the plugin may provide
+   * the SI class as well as the VTK classes. vtkSMSessionProxyManager calls it
+   * when the proxy class itself cannot be instantiated, so that plugins
+   * providing their own vtkSMProxy subclasses are loaded on the client too.
+   */
+  static bool LoadDeferredPlugin(const char* group, const char* name);
+
 protected:
   vtkPVPluginLoader();
   ~vtkPVPluginLoader() override;
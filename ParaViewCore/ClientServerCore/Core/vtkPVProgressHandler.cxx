@@ -22,13 +22,21 @@
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkOutputWindow.h"
+#include "vtkPVConfig.h"
 #include "vtkPVOptions.h"
 #include "vtkPVSession.h"
 #include "vtkProcessModule.h"
 #include "vtkTimerLog.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
+
+#ifdef PARAVIEW_USE_MPI
+#include "vtkMPICommunicator.h"
+#include "vtkMPIController.h"
+#endif
 
 // define this variable to disable progress all together. This may be useful to
 // doing really large runs.
@@ -66,17 +74,52 @@ public:
   bool EnableProgress;
 
   vtkNew<vtkTimerLog> ProgressTimer;
+
+  // Object and percentage of the last progress event, used to drop events
+  // that do not change the percentage without looking at the clock.
+  vtkObject* LastCaller;
+  int LastPercent;
+
+  // Progress of each rank, or -1 if it has not reported any. Only the entry
+  // for the local rank is used on satellites.
+  std::vector<double> RankProgress;
+
+  // Statistics for the progress being reported.
+  double Maximum;
+  double Mean;
+  int SlowestRank;
+
+#ifdef PARAVIEW_USE_MPI
+  // Set when running in parallel.
+  vtkMPIController* MPIController;
+  // On satellites, the progress message in flight to the root, if any.
+  double SendBuffer;
+  vtkMPICommunicator::Request Request;
+  bool RequestPending;
+  int MessagesSent;
+  // On the root, number of messages received from each rank.
+  std::vector<int> MessagesReceived;
+#endif
+
   vtkInternals()
   {
     this->EnableProgress = false;
     this->DisableProgressHandling = false;
+    this->LastCaller = NULL;
+    this->LastPercent = -1;
+    this->Maximum = this->Mean = 0.0;
+    this->SlowestRank = 0;
+#ifdef PARAVIEW_USE_MPI
+    this->MPIController = NULL;
+    this->SendBuffer = 0.0;
+    this->RequestPending = false;
+    this->MessagesSent = 0;
+#endif
 
 #ifdef PV_DISABLE_PROGRESS_HANDLING
     this->DisableProgressHandling = true;
 #else
-    // In symmetric mode, we disable progress although that's not really
-    // necessary anymore. Since the progress is no longer collected from anyone
-    // but the root node, it really doesn't matter if progress is enabled.
+    // In symmetric mode, there is no client to report progress to.
     if (vtkProcessModule* pm = vtkProcessModule::GetProcessModule())
     {
       this->DisableProgressHandling = pm->GetSymmetricMPIMode();
@@ -84,6 +127,138 @@ public:
 #endif
   }
 
+  int GetLocalProcessId() const
+  {
+#ifdef PARAVIEW_USE_MPI
+    return this->MPIController ? this->MPIController->GetLocalProcessId() : 0;
+#else
+    return 0;
+#endif
+  }
+
+  void InitializeRanks()
+  {
+    int numProcs = 1;
+#ifdef PARAVIEW_USE_MPI
+    this->MPIController =
+      vtkMPIController::SafeDownCast(vtkMultiProcessController::GetGlobalController());
+    if (this->MPIController && this->MPIController->GetNumberOfProcesses() > 1)
+    {
+      numProcs = this->MPIController->GetNumberOfProcesses();
+      this->MessagesReceived.assign(numProcs, 0);
+      this->MessagesSent = 0;
+    }
+    else
+    {
+      this->MPIController = NULL;
+    }
+#endif
+    this->RankProgress.assign(numProcs, -1.0);
+    this->LastCaller = NULL;
+    this->LastPercent = -1;
+  }
+
+  // Forgets the progress reported by the ranks, e.g. when another object
+  // starts reporting progress.
+  void ResetRanks() { std::fill(this->RankProgress.begin(), this->RankProgress.end(), -1.0); }
+
+  // Updates the progress of a rank and the statistics. Returns the minimum
+  // progress across ranks that have reported any.
+  double UpdateRank(int rank, double progress)
+  {
+    this->RankProgress[rank] = progress;
+    double minimum = progress;
+    double sum = 0.0;
+    int count = 0;
+    this->Maximum = progress;
+    this->SlowestRank = rank;
+    for (size_t cc = 0; cc < this->RankProgress.size(); ++cc)
+    {
+      const double value = this->RankProgress[cc];
+      if (value < 0)
+      {
+        continue;
+      }
+      if (value < minimum)
+      {
+        minimum = value;
+        this->SlowestRank = static_cast<int>(cc);
+      }
+      this->Maximum = std::max(this->Maximum, value);
+      sum += value;
+      count++;
+    }
+    this->Mean = sum / count;
+    return minimum;
+  }
+
+#ifdef PARAVIEW_USE_MPI
+  // Called on satellites. Progress is dropped while the previous message is
+  // still in flight.
+  void SendRankProgress(double progress)
+  {
+    if (this->RequestPending && !this->Request.Test())
+    {
+      return;
+    }
+    this->SendBuffer = progress;
+    this->MPIController->NoBlockSend(
+      &this->SendBuffer, 1, 0, vtkPVProgressHandler::RANK_PROGRESS_TAG, this->Request);
+    this->RequestPending = true;
+    this->MessagesSent++;
+  }
+
+  // Called on the root to receive whatever progress satellites have sent.
+  void ReceiveRankProgress()
+  {
+    vtkMPICommunicator* comm =
+      vtkMPICommunicator::SafeDownCast(this->MPIController->GetCommunicator());
+    int flag = 0;
+    int source = -1;
+    while (comm->Iprobe(vtkMultiProcessController::ANY_SOURCE,
+             vtkPVProgressHandler::RANK_PROGRESS_TAG, &flag, &source) &&
+      flag)
+    {
+      double value = 0.0;
+      this->MPIController->Receive(&value, 1, source, vtkPVProgressHandler::RANK_PROGRESS_TAG);
+      this->RankProgress[source] = value;
+      this->MessagesReceived[source]++;
+    }
+  }
+
+  // Collective. Consumes all the progress messages sent by satellites so none
+  // of them is left behind for the next time progress is reported.
+  void FinishRankProgress()
+  {
+    if (!this->MPIController)
+    {
+      return;
+    }
+    const int myId = this->MPIController->GetLocalProcessId();
+    if (myId > 0 && this->RequestPending)
+    {
+      this->Request.Wait();
+    }
+    this->RequestPending = false;
+
+    std::vector<int> counts(this->MPIController->GetNumberOfProcesses(), 0);
+    this->MPIController->Gather(&this->MessagesSent, &counts[0], 1, 0);
+    if (myId == 0)
+    {
+      for (size_t cc = 1; cc < counts.size(); ++cc)
+      {
+        for (; this->MessagesReceived[cc] < counts[cc]; this->MessagesReceived[cc]++)
+        {
+          double value;
+          this->MPIController->Receive(
+            &value, 1, static_cast<int>(cc), vtkPVProgressHandler::RANK_PROGRESS_TAG);
+        }
+      }
+    }
+    this->MPIController = NULL;
+  }
+#endif
+
   int GetIDFromObject(vtkObject* obj)
   {
     if (this->RegisteredObjects.find(obj) != this->RegisteredObjects.end())
@@ -102,6 +277,9 @@ vtkPVProgressHandler::vtkPVProgressHandler()
   this->Internals = new vtkInternals();
   this->LastProgress = 0;
   this->LastProgressText = NULL;
+  this->LastProgressMaximum = 0.0;
+  this->LastProgressMean = 0.0;
+  this->LastProgressSlowestRank = 0;
   this->LastMessage = NULL;
 
   // use higher frequency for client while lower for server (or batch).
@@ -179,6 +357,7 @@ void vtkPVProgressHandler::PrepareProgress()
 
   SKIP_IF_DISABLED();
 
+  this->Internals->InitializeRanks();
   this->InvokeEvent(vtkCommand::StartEvent, this);
   this->Internals->EnableProgress = true;
 }
@@ -198,6 +377,10 @@ void vtkPVProgressHandler::CleanupPendingProgress()
     return;
   }
 
+#ifdef PARAVIEW_USE_MPI
+  this->Internals->FinishRankProgress();
+#endif
+
   vtkMultiProcessController* mpiController = vtkMultiProcessController::GetGlobalController();
   if (mpiController && mpiController->GetNumberOfProcesses() > 1)
   {
@@ -245,6 +428,33 @@ void vtkPVProgressHandler::OnProgressEvent(vtkObject* caller, unsigned long even
     return;
   }
 
+  double progress = *reinterpret_cast<double*>(calldata);
+  if (progress < 0 || progress > 1.0)
+  {
+#ifndef NDEBUG
+    // warn only in debug builds.
+    vtkWarningMacro(<< caller->GetClassName() << " reported invalid progress (" << progress
+                    << "). Value must be between [0, 1]. Clamping to this range.");
+#endif
+    progress = (progress < 0) ? 0 : progress;
+    progress = (progress > 1.0) ? 1.0 : progress;
+  }
+
+  // Filters may report progress from tight loops. Skip events that do not
+  // change the percentage before doing anything more expensive.
+  const int percent = static_cast<int>(progress * 100.0);
+  if (caller == this->Internals->LastCaller && percent == this->Internals->LastPercent)
+  {
+    return;
+  }
+  if (caller != this->Internals->LastCaller)
+  {
+    // What the ranks reported for the previous object no longer applies.
+    this->Internals->ResetRanks();
+  }
+  this->Internals->LastCaller = caller;
+  this->Internals->LastPercent = percent;
+
   // Try to clamp frequent progress events.
   this->Internals->ProgressTimer->StopTimer();
   // cout <<"Elapsed: " << this->Internals->ProgressTimer->GetElapsedTime() <<
@@ -256,17 +466,22 @@ void vtkPVProgressHandler::OnProgressEvent(vtkObject* caller, unsigned long even
 
   this->Internals->ProgressTimer->StartTimer();
 
-  double progress = *reinterpret_cast<double*>(calldata);
-  if (progress < 0 || progress > 1.0)
+  const int myId = this->Internals->GetLocalProcessId();
+#ifdef PARAVIEW_USE_MPI
+  if (this->Internals->MPIController)
   {
-#ifndef NDEBUG
-    // warn only in debug builds.
-    vtkWarningMacro(<< caller->GetClassName() << " reported invalid progress (" << progress
-                    << "). Value must be between [0, 1]. Clamping to this range.");
-#endif
-    progress = (progress < 0) ? 0 : progress;
-    progress = (progress > 1.0) ? 1.0 : progress;
+    if (myId > 0)
+    {
+      this->Internals->SendRankProgress(progress);
+    }
+    else
+    {
+      this->Internals->ReceiveRankProgress();
+    }
   }
+#endif
+  // The root reports the slowest rank's progress.
+  progress = this->Internals->UpdateRank(myId, progress);
 
   std::string text = ::vtkGetProgressText(caller);
   this->RefreshProgress(text.c_str(), progress);
@@ -280,23 +495,34 @@ void vtkPVProgressHandler::RefreshProgress(const char* progress_text, double pro
   if (client_controller)
   {
     // only true of server-nodes.
+    // The message is the progress, the text and the statistics across ranks
+    // (maximum, mean and slowest rank), all in little-endian form.
     int progress_text_len = static_cast<int>(strlen(progress_text));
-    int message_size = progress_text_len + sizeof(double) + sizeof(char);
+    int message_size = progress_text_len + 4 * sizeof(double) + sizeof(char);
     unsigned char* buffer = new unsigned char[message_size];
 
     double le_progress = progress;
-    vtkByteSwap::SwapLE(&progress);
+    vtkByteSwap::SwapLE(&le_progress);
     memcpy(buffer, &le_progress, sizeof(double));
 
     memcpy(buffer + sizeof(double), progress_text, progress_text_len);
     buffer[progress_text_len + sizeof(double)] = 0;
 
+    double le_statistics[3] = { this->Internals->Maximum, this->Internals->Mean,
+      static_cast<double>(this->Internals->SlowestRank) };
+    vtkByteSwap::SwapLERange(le_statistics, 3);
+    memcpy(buffer + progress_text_len + sizeof(double) + sizeof(char), le_statistics,
+      sizeof(le_statistics));
+
     client_controller->Send(buffer, message_size, 1, vtkPVProgressHandler::PROGRESS_EVENT_TAG);
     delete[] buffer;
   }
 
   this->SetLastProgressText(progress_text);
   this->LastProgress = static_cast<int>(progress * 100.0);
+  this->LastProgressMaximum = this->Internals->Maximum;
+  this->LastProgressMean = this->Internals->Mean;
+  this->LastProgressSlowestRank = this->Internals->SlowestRank;
   // cout << "Progress: " << progress_text << " " << progress * 100 << endl;
   this->InvokeEvent(vtkCommand::ProgressEvent, this);
   this->SetLastProgressText(NULL);
@@ -307,6 +533,7 @@ void vtkPVProgressHandler::RefreshProgress(const char* progress_text, double pro
 void vtkPVProgressHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "ProgressInterval: " << this->ProgressInterval << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -349,6 +576,18 @@ bool vtkPVProgressHandler::OnWrongTagEvent(vtkObject*, unsigned long eventid, vo
     vtkByteSwap::SwapLE(&progress);
 #endif
 
+    // Statistics follow the text.
+    double statistics[3] = { progress, progress, 0.0 };
+    size_t text_len = strlen(ptr);
+    if (len >= static_cast<int>(sizeof(double) + text_len + 1 + sizeof(statistics)))
+    {
+      memcpy(statistics, ptr + text_len + 1, sizeof(statistics));
+      vtkByteSwap::SwapLERange(statistics, 3);
+    }
+    this->Internals->Maximum = statistics[0];
+    this->Internals->Mean = statistics[1];
+    this->Internals->SlowestRank = static_cast<int>(statistics[2]);
+
     this->RefreshProgress(ptr, progress);
     return true;
   }
@@ -17,12 +17,16 @@
  * @brief   progress handler.
  *
  * vtkPVProgressHandler handles the progress messages. It handles progress in
- * all configurations single process, client-server. It must be noted that when
- * running in parallel, progress updates are fetched from the root node. Due to
- * performance reasons, we no longer collect progress events (or messages) from
- * satellites, only root-node events are reported back to the client. While this
- * may not faithfully report the progress, this avoid nasty MPI issues that can
- * be painful to debug and diagnose.
+ * all configurations single process, client-server.
+ *
+ * When running in parallel, satellites forward their progress to the root node
+ * at most once per ProgressInterval, using non-blocking messages. The root
+ * reports the minimum progress across all ranks that have reported any, which
+ * is what the progress bar shows, along with the maximum, the mean and the
+ * slowest rank. The progress of the ranks is forgotten whenever another
+ * object starts reporting progress. Progress events that do not change the
+ * integer percentage reported by an object are dropped before anything else
+ * is done, so filters can report progress from inner loops.
  *
  * Progress events are currently not supported in multi-clients mode.
  *
@@ -97,6 +101,16 @@ public:
   vtkGetMacro(LastProgress, int);
   //@}
 
+  //@{
+  /**
+   * Statistics of progress across ranks. LastProgress is the minimum. These
+   * are only valid in handler for the vtkCommand::ProgressEvent.
+   */
+  vtkGetMacro(LastProgressMaximum, double);
+  vtkGetMacro(LastProgressMean, double);
+  vtkGetMacro(LastProgressSlowestRank, int);
+  //@}
+
   //@{
   /**
    * Temporary storage for most recent message text.
@@ -112,7 +126,8 @@ protected:
   {
     CLEANUP_TAG = 188969,
     PROGRESS_EVENT_TAG = 188970,
-    MESSAGE_EVENT_TAG = 188971
+    MESSAGE_EVENT_TAG = 188971,
+    RANK_PROGRESS_TAG = 188972
   };
 
   //@{
@@ -149,6 +164,9 @@ private:
   vtkSetStringMacro(LastProgressText);
   int LastProgress;
   char* LastProgressText;
+  double LastProgressMaximum;
+  double LastProgressMean;
+  int LastProgressSlowestRank;
 
   vtkSetStringMacro(LastMessage);
   char* LastMessage;
@@ -17,12 +17,158 @@
 #include "vtkByteSwap.h"
 #include "vtkClientServerStream.h"
 #include "vtkDataObject.h"
+#include "vtkDoubleArray.h"
+#include "vtkIntArray.h"
 #include "vtkMultiProcessStream.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkQuadricClustering.h"
+#include "vtkStringArray.h"
+#include "vtkTable.h"
 #include "vtkTimerLog.h"
+#include "vtkTypeInt64Array.h"
 
+#include <vtksys/FStream.hxx>
+
+#include <cstdlib>
 #include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Categorizes timer log events based on the names used throughout ParaView.
+const char* vtkGetEventCategory(const std::string& name)
+{
+  if (name.compare(0, 8, "Execute ") == 0)
+  {
+    return "Filter";
+  }
+  const char* delivery[] = { "Data Migration", "Dataserver", "Deliver", "Redistributing",
+    "Kd-Tree", "Zlib", NULL };
+  for (int cc = 0; delivery[cc] != NULL; ++cc)
+  {
+    if (name.find(delivery[cc]) != std::string::npos)
+    {
+      return "Delivery";
+    }
+  }
+  if (name.find("Render") != std::string::npos || name.find("Composit") != std::string::npos ||
+    name.find("IceT") != std::string::npos)
+  {
+    return "Rendering";
+  }
+  return "Other";
+}
+
+// Escapes a string to be used in JSON.
+std::string vtkJSONEscape(const std::string& str)
+{
+  std::ostringstream escaped;
+  for (size_t cc = 0; cc < str.size(); ++cc)
+  {
+    const char ch = str[cc];
+    if (ch == '"' || ch == '\\')
+    {
+      escaped << '\\' << ch;
+    }
+    else if (static_cast<unsigned char>(ch) < 0x20)
+    {
+      escaped << ' ';
+    }
+    else
+    {
+      escaped << ch;
+    }
+  }
+  return escaped.str();
+}
+
+const char* vtkOutputMemoryPrefix = "Output memory: ";
+}
+
+//----------------------------------------------------------------------------
+class vtkPVTimerInformation::vtkInternals
+{
+public:
+  struct Event
+  {
+    int Process;
+    std::string Name;
+    std::string Category;
+    double Start;
+    double Duration;
+    int Depth;
+    vtkTypeInt64 Memory;
+  };
+  std::vector<Event> Events;
+
+  // Builds events from the start and end events in the timer log.
+  void CopyFromTimerLog(double threshold)
+  {
+    this->Events.clear();
+    std::vector<size_t> open;
+    const int numEvents = vtkTimerLog::GetNumberOfEvents();
+    for (int cc = 0; cc < numEvents; ++cc)
+    {
+      switch (vtkTimerLog::GetEventType(cc))
+      {
+        case vtkTimerLog::START:
+        {
+          Event event;
+          event.Process = 0;
+          event.Name = vtkTimerLog::GetEventString(cc);
+          event.Category = vtkGetEventCategory(event.Name);
+          event.Start = vtkTimerLog::GetEventWallTime(cc);
+          event.Duration = -1;
+          event.Depth = static_cast<int>(open.size());
+          event.Memory = -1;
+          open.push_back(this->Events.size());
+          this->Events.push_back(event);
+        }
+        break;
+
+        case vtkTimerLog::END:
+          // the matching start event may have been dropped from the log.
+          if (!open.empty())
+          {
+            Event& event = this->Events[open.back()];
+            event.Duration = vtkTimerLog::GetEventWallTime(cc) - event.Start;
+            open.pop_back();
+          }
+          break;
+
+        case vtkTimerLog::STANDALONE:
+        {
+          // vtkSISourceProxy records the output memory within the execution
+          // event.
+          const char* str = vtkTimerLog::GetEventString(cc);
+          const size_t len = strlen(vtkOutputMemoryPrefix);
+          if (!open.empty() && str && strncmp(str, vtkOutputMemoryPrefix, len) == 0)
+          {
+            this->Events[open.back()].Memory = atol(str + len);
+          }
+        }
+        break;
+
+        default:
+          break;
+      }
+    }
+
+    // Drop events that have not ended yet or are below the threshold.
+    std::vector<Event> events;
+    events.reserve(this->Events.size());
+    for (size_t cc = 0; cc < this->Events.size(); ++cc)
+    {
+      if (this->Events[cc].Duration >= 0 && this->Events[cc].Duration >= threshold)
+      {
+        events.push_back(this->Events[cc]);
+      }
+    }
+    this->Events.swap(events);
+  }
+};
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkPVTimerInformation);
@@ -33,6 +179,7 @@ vtkPVTimerInformation::vtkPVTimerInformation()
   this->NumberOfLogs = 0;
   this->Logs = NULL;
   this->LogThreshold = 0;
+  this->Internals = new vtkInternals();
 }
 
 //----------------------------------------------------------------------------
@@ -55,6 +202,7 @@ vtkPVTimerInformation::~vtkPVTimerInformation()
     this->Logs = NULL;
   }
   this->NumberOfLogs = 0;
+  delete this->Internals;
 }
 
 //----------------------------------------------------------------------------
@@ -147,6 +295,7 @@ void vtkPVTimerInformation::CopyFromObject(vtkObject*)
     fptr << ends;
     this->InsertLog(0, fptr.str().c_str());
   }
+  this->Internals->CopyFromTimerLog(this->LogThreshold);
 }
 
 //----------------------------------------------------------------------------
@@ -214,6 +363,14 @@ void vtkPVTimerInformation::AddInformation(vtkPVInformation* info)
       copyLog = NULL;
     }
   }
+
+  // Events are numbered by process the same way logs are.
+  const std::vector<vtkInternals::Event>& events = pdInfo->Internals->Events;
+  for (size_t cc = 0; cc < events.size(); ++cc)
+  {
+    this->Internals->Events.push_back(events[cc]);
+    this->Internals->Events.back().Process += oldNum;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -226,6 +383,14 @@ void vtkPVTimerInformation::CopyToStream(vtkClientServerStream* css)
   {
     *css << (const char*)this->Logs[idx];
   }
+  const std::vector<vtkInternals::Event>& events = this->Internals->Events;
+  *css << static_cast<vtkTypeInt64>(events.size());
+  for (size_t cc = 0; cc < events.size(); ++cc)
+  {
+    const vtkInternals::Event& event = events[cc];
+    *css << event.Process << event.Name.c_str() << event.Category.c_str() << event.Start
+         << event.Duration << event.Depth << event.Memory;
+  }
   *css << vtkClientServerStream::End;
 }
 
@@ -255,6 +420,36 @@ void vtkPVTimerInformation::CopyFromStream(const vtkClientServerStream* css)
     }
     this->Logs[idx] = strcpy(new char[strlen(log) + 1], log);
   }
+
+  std::vector<vtkInternals::Event>& events = this->Internals->Events;
+  events.clear();
+  int argument = 1 + this->NumberOfLogs;
+  vtkTypeInt64 numEvents = 0;
+  if (!css->GetArgument(0, argument++, &numEvents))
+  {
+    vtkErrorMacro("Error parsing number of events from message.");
+    return;
+  }
+  events.resize(static_cast<size_t>(numEvents));
+  for (size_t cc = 0; cc < events.size(); ++cc)
+  {
+    vtkInternals::Event& event = events[cc];
+    const char* name = NULL;
+    const char* category = NULL;
+    if (!css->GetArgument(0, argument++, &event.Process) ||
+      !css->GetArgument(0, argument++, &name) || !css->GetArgument(0, argument++, &category) ||
+      !css->GetArgument(0, argument++, &event.Start) ||
+      !css->GetArgument(0, argument++, &event.Duration) ||
+      !css->GetArgument(0, argument++, &event.Depth) ||
+      !css->GetArgument(0, argument++, &event.Memory))
+    {
+      vtkErrorMacro("Error parsing events from message.");
+      events.clear();
+      return;
+    }
+    event.Name = name ? name : "";
+    event.Category = category ? category : "";
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -263,6 +458,98 @@ int vtkPVTimerInformation::GetNumberOfLogs()
   return this->NumberOfLogs;
 }
 
+//----------------------------------------------------------------------------
+vtkIdType vtkPVTimerInformation::GetNumberOfEvents()
+{
+  return static_cast<vtkIdType>(this->Internals->Events.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkPVTimerInformation::CopyEventsToTable(vtkTable* table)
+{
+  if (!table)
+  {
+    return;
+  }
+
+  const std::vector<vtkInternals::Event>& events = this->Internals->Events;
+  const vtkIdType numEvents = static_cast<vtkIdType>(events.size());
+
+  vtkNew<vtkIntArray> process;
+  process->SetName("Process");
+  process->SetNumberOfTuples(numEvents);
+  vtkNew<vtkStringArray> name;
+  name->SetName("Name");
+  name->SetNumberOfTuples(numEvents);
+  vtkNew<vtkStringArray> category;
+  category->SetName("Category");
+  category->SetNumberOfTuples(numEvents);
+  vtkNew<vtkDoubleArray> start;
+  start->SetName("Start");
+  start->SetNumberOfTuples(numEvents);
+  vtkNew<vtkDoubleArray> duration;
+  duration->SetName("Duration");
+  duration->SetNumberOfTuples(numEvents);
+  vtkNew<vtkIntArray> depth;
+  depth->SetName("Depth");
+  depth->SetNumberOfTuples(numEvents);
+  vtkNew<vtkTypeInt64Array> memory;
+  memory->SetName("Memory");
+  memory->SetNumberOfTuples(numEvents);
+
+  for (vtkIdType cc = 0; cc < numEvents; ++cc)
+  {
+    const vtkInternals::Event& event = events[cc];
+    process->SetValue(cc, event.Process);
+    name->SetValue(cc, event.Name);
+    category->SetValue(cc, event.Category);
+    start->SetValue(cc, event.Start);
+    duration->SetValue(cc, event.Duration);
+    depth->SetValue(cc, event.Depth);
+    memory->SetValue(cc, event.Memory);
+  }
+
+  table->Initialize();
+  table->AddColumn(process.GetPointer());
+  table->AddColumn(name.GetPointer());
+  table->AddColumn(category.GetPointer());
+  table->AddColumn(start.GetPointer());
+  table->AddColumn(duration.GetPointer());
+  table->AddColumn(depth.GetPointer());
+  table->AddColumn(memory.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVTimerInformation::WriteChromeTrace(const char* filename)
+{
+  vtksys::ofstream file(filename ? filename : "");
+  if (!file)
+  {
+    vtkErrorMacro("Failed to open file '" << (filename ? filename : "(null)") << "'.");
+    return false;
+  }
+
+  // "Complete" events, with times in microseconds. Each process is shown as a
+  // thread of a single process, so that they are laid out one above another.
+  const std::vector<vtkInternals::Event>& events = this->Internals->Events;
+  file << "{\"traceEvents\":[";
+  for (size_t cc = 0; cc < events.size(); ++cc)
+  {
+    const vtkInternals::Event& event = events[cc];
+    file << (cc > 0 ? ",\n" : "\n") << "{\"name\":\"" << vtkJSONEscape(event.Name)
+         << "\",\"cat\":\"" << event.Category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+         << event.Process << ",\"ts\":" << static_cast<vtkTypeInt64>(event.Start * 1e6)
+         << ",\"dur\":" << static_cast<vtkTypeInt64>(event.Duration * 1e6);
+    if (event.Memory >= 0)
+    {
+      file << ",\"args\":{\"memory_kib\":" << event.Memory << "}";
+    }
+    file << "}";
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return !file.fail();
+}
+
 //----------------------------------------------------------------------------
 char* vtkPVTimerInformation::GetLog(int idx)
 {
@@ -279,6 +566,7 @@ void vtkPVTimerInformation::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 
   os << indent << "NumberOfLogs: " << this->NumberOfLogs << endl;
+  os << indent << "NumberOfEvents: " << this->GetNumberOfEvents() << endl;
   int idx;
   for (idx = 0; idx < this->NumberOfLogs; ++idx)
   {
@@ -17,6 +17,17 @@
  * @brief   Holds timer log for all processes.
  *
  * I am using this information object to gather timer logs from all processes.
+ *
+ * Besides the text logs, the timer log events are also gathered as structured
+ * records: one for each pair of start and end events, with the process it was
+ * recorded on, its name, start time, duration, nesting depth and a category
+ * (filter execution, data delivery, rendering or other). For filter
+ * executions, the memory used by the outputs is recorded as well. These can be
+ * obtained as a table using CopyEventsToTable() or saved in the Chrome trace
+ * event format (viewable in chrome://tracing) using WriteChromeTrace().
+ *
+ * Start times are relative to the first event logged on each process, so
+ * they are only approximately aligned across processes.
 */
 
 #ifndef vtkPVTimerInformation_h
@@ -25,6 +36,8 @@
 #include "vtkPVClientServerCoreCoreModule.h" //needed for exports
 #include "vtkPVInformation.h"
 
+class vtkTable;
+
 class VTKPVCLIENTSERVERCORECORE_EXPORT vtkPVTimerInformation : public vtkPVInformation
 {
 public:
@@ -49,6 +62,24 @@ public:
   char* GetLog(int proc);
   //@}
 
+  /**
+   * Returns the number of structured events gathered from all processes.
+   */
+  vtkIdType GetNumberOfEvents();
+
+  /**
+   * Fills the table with one row per event, with columns "Process", "Name",
+   * "Category", "Start" and "Duration" (in seconds), "Depth" and
+   * "Memory" (output memory in KiB, or -1 when not applicable).
+   */
+  void CopyEventsToTable(vtkTable* table);
+
+  /**
+   * Writes the events in the Chrome trace event format, with one thread per
+   * process. Returns false if the file could not be written.
+   */
+  bool WriteChromeTrace(const char* filename);
+
   //@{
   /**
    * Transfer information about a single object into
@@ -94,6 +125,10 @@ protected:
 
   vtkPVTimerInformation(const vtkPVTimerInformation&) = delete;
   void operator=(const vtkPVTimerInformation&) = delete;
+
+private:
+  class vtkInternals;
+  vtkInternals* Internals;
 };
 
 #endif
@@ -0,0 +1,442 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkSharedMemorySocketCommunicator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSharedMemorySocketCommunicator.h"
+
+#include "vtkDataArray.h"
+#include "vtkObjectFactory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+
+#if !defined(_WIN32)
+#define VTK_PV_SHARED_MEMORY_SUPPORTED 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+const vtkTypeUInt64 vtkSharedMemoryMagic = 0x7076736d72696e67ull; // "pvsmring"
+
+// Segment layout: a vtkSharedMemoryHeader, two vtkSharedMemoryRing, followed
+// by the data of both rings. Ring 0 is written by the process that created the
+// segment, ring 1 by the one that attached to it. The structures are padded to
+// keep the two tails on separate cache lines.
+struct vtkSharedMemoryHeader
+{
+  vtkTypeUInt64 Magic;
+  vtkTypeUInt64 Key;
+  vtkTypeUInt64 RingSize;
+  char Padding[40];
+};
+
+struct vtkSharedMemoryRing
+{
+  // Absolute position up to which the consumer is done with the data. The
+  // producer may reuse everything before it.
+  std::atomic<vtkTypeUInt64> Tail;
+  char Padding[64 - sizeof(std::atomic<vtkTypeUInt64>)];
+};
+
+size_t vtkSharedMemoryLength(vtkTypeUInt64 ringSize)
+{
+  return static_cast<size_t>(
+    sizeof(vtkSharedMemoryHeader) + 2 * sizeof(vtkSharedMemoryRing) + 2 * ringSize);
+}
+}
+
+class vtkSharedMemorySocketCommunicator::vtkInternals
+{
+public:
+  void* Segment;
+  size_t Length;
+  std::string Name;
+  bool Linked;
+  vtkTypeUInt64 Key;
+  vtkTypeUInt64 RingSize;
+
+  vtkSharedMemoryRing* Outgoing;
+  unsigned char* OutgoingData;
+  vtkTypeUInt64 Head;
+
+  vtkSharedMemoryRing* Incoming;
+  unsigned char* IncomingData;
+  vtkTypeUInt64 ConsumedTail;
+  // Regions received out of order, i.e. while an earlier one is still buffered
+  // by the vtkSocketCommunicator. Maps start position to end position.
+  std::map<vtkTypeUInt64, vtkTypeUInt64> Released;
+
+  vtkInternals()
+    : Segment(NULL)
+    , Length(0)
+    , Linked(false)
+    , Key(0)
+    , RingSize(0)
+    , Outgoing(NULL)
+    , OutgoingData(NULL)
+    , Head(0)
+    , Incoming(NULL)
+    , IncomingData(NULL)
+    , ConsumedTail(0)
+  {
+  }
+
+  ~vtkInternals() { this->Release(); }
+
+  void Map(void* segment, size_t length, bool creator)
+  {
+    this->Segment = segment;
+    this->Length = length;
+
+    unsigned char* base = static_cast<unsigned char*>(segment);
+    vtkSharedMemoryRing* rings =
+      reinterpret_cast<vtkSharedMemoryRing*>(base + sizeof(vtkSharedMemoryHeader));
+    unsigned char* data = reinterpret_cast<unsigned char*>(rings + 2);
+
+    const int out = creator ? 0 : 1;
+    this->Outgoing = rings + out;
+    this->OutgoingData = data + out * this->RingSize;
+    this->Incoming = rings + (1 - out);
+    this->IncomingData = data + (1 - out) * this->RingSize;
+    this->Head = 0;
+    this->ConsumedTail = 0;
+    this->Released.clear();
+  }
+
+  void Unlink()
+  {
+#if VTK_PV_SHARED_MEMORY_SUPPORTED
+    if (this->Linked)
+    {
+      shm_unlink(this->Name.c_str());
+      this->Linked = false;
+    }
+#endif
+  }
+
+  void Release()
+  {
+    this->Unlink();
+#if VTK_PV_SHARED_MEMORY_SUPPORTED
+    if (this->Segment)
+    {
+      munmap(this->Segment, this->Length);
+    }
+#endif
+    this->Segment = NULL;
+    this->Length = 0;
+    this->Outgoing = this->Incoming = NULL;
+    this->OutgoingData = this->IncomingData = NULL;
+    this->Released.clear();
+  }
+
+  // Copies data into the outgoing ring, if there is room for it. On success,
+  // returns the absolute position the data was written at.
+  bool Write(const void* data, vtkTypeUInt64 nbytes, vtkTypeUInt64& position)
+  {
+    const vtkTypeUInt64 tail = this->Outgoing->Tail.load(std::memory_order_acquire);
+    if (nbytes > this->RingSize - (this->Head - tail))
+    {
+      return false;
+    }
+    position = this->Head;
+    const vtkTypeUInt64 start = position % this->RingSize;
+    const vtkTypeUInt64 first = std::min(nbytes, this->RingSize - start);
+    memcpy(this->OutgoingData + start, data, static_cast<size_t>(first));
+    memcpy(this->OutgoingData, static_cast<const unsigned char*>(data) + first,
+      static_cast<size_t>(nbytes - first));
+    // The descriptor announcing this data is sent after the copy is complete.
+    std::atomic_thread_fence(std::memory_order_release);
+    this->Head += nbytes;
+    return true;
+  }
+
+  // Copies data written at the given absolute position out of the incoming
+  // ring and hands the region back to the producer.
+  bool Read(void* data, vtkTypeUInt64 position, vtkTypeUInt64 nbytes)
+  {
+    if (position < this->ConsumedTail || position + nbytes - this->ConsumedTail > this->RingSize)
+    {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const vtkTypeUInt64 start = position % this->RingSize;
+    const vtkTypeUInt64 first = std::min(nbytes, this->RingSize - start);
+    memcpy(data, this->IncomingData + start, static_cast<size_t>(first));
+    memcpy(static_cast<unsigned char*>(data) + first, this->IncomingData,
+      static_cast<size_t>(nbytes - first));
+
+    this->Released[position] = position + nbytes;
+    std::map<vtkTypeUInt64, vtkTypeUInt64>::iterator iter;
+    while ((iter = this->Released.find(this->ConsumedTail)) != this->Released.end())
+    {
+      this->ConsumedTail = iter->second;
+      this->Released.erase(iter);
+    }
+    this->Incoming->Tail.store(this->ConsumedTail, std::memory_order_release);
+    return true;
+  }
+};
+
+vtkStandardNewMacro(vtkSharedMemorySocketCommunicator);
+//----------------------------------------------------------------------------
+vtkSharedMemorySocketCommunicator::vtkSharedMemorySocketCommunicator()
+{
+  this->Internals = new vtkInternals();
+  this->SharedMemoryThreshold = 64 * 1024;
+}
+
+//----------------------------------------------------------------------------
+vtkSharedMemorySocketCommunicator::~vtkSharedMemorySocketCommunicator()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSharedMemorySocketCommunicator::CreateSharedMemory(vtkIdType ringSize)
+{
+  this->ReleaseSharedMemory();
+#if VTK_PV_SHARED_MEMORY_SUPPORTED
+  if (ringSize <= 0)
+  {
+    return false;
+  }
+
+  // Connections may be set up from several threads.
+  static std::atomic<int> counter(0);
+  std::ostringstream name;
+  name << "/paraview-" << getpid() << "-" << counter++;
+
+  int fd = shm_open(name.str().c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1)
+  {
+    vtkWarningMacro("Failed to create shared memory segment '" << name.str() << "'.");
+    return false;
+  }
+
+  const vtkTypeUInt64 rsize = static_cast<vtkTypeUInt64>(ringSize);
+  const size_t length = vtkSharedMemoryLength(rsize);
+  bool success = (ftruncate(fd, static_cast<off_t>(length)) == 0);
+#if defined(__linux__)
+  // Reserve the pages now. A segment larger than what /dev/shm can hold would
+  // otherwise raise SIGBUS on first write instead of failing here.
+  success = success && (posix_fallocate(fd, 0, static_cast<off_t>(length)) == 0);
+#endif
+  void* segment =
+    success ? mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close(fd);
+  if (segment == MAP_FAILED)
+  {
+    shm_unlink(name.str().c_str());
+    vtkWarningMacro("Failed to allocate " << length << " bytes of shared memory.");
+    return false;
+  }
+
+  std::random_device rd;
+  vtkSharedMemoryHeader* header = new (segment) vtkSharedMemoryHeader();
+  header->Magic = vtkSharedMemoryMagic;
+  header->Key = (static_cast<vtkTypeUInt64>(rd()) << 32) ^ rd();
+  header->RingSize = rsize;
+  vtkSharedMemoryRing* rings = reinterpret_cast<vtkSharedMemoryRing*>(header + 1);
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    new (&rings[cc].Tail) std::atomic<vtkTypeUInt64>(0);
+  }
+
+  vtkInternals& internals = *this->Internals;
+  internals.Name = name.str();
+  internals.Linked = true;
+  internals.Key = header->Key;
+  internals.RingSize = rsize;
+  internals.Map(segment, length, true);
+  return true;
+#else
+  (void)ringSize;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool vtkSharedMemorySocketCommunicator::AttachSharedMemory(const char* name, vtkTypeUInt64 key)
+{
+  this->ReleaseSharedMemory();
+#if VTK_PV_SHARED_MEMORY_SUPPORTED
+  if (!name || !*name)
+  {
+    return false;
+  }
+
+  int fd = shm_open(name, O_RDWR, 0600);
+  if (fd == -1)
+  {
+    return false;
+  }
+  struct stat info;
+  void* segment = MAP_FAILED;
+  size_t length = 0;
+  if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(vtkSharedMemoryLength(0)))
+  {
+    length = static_cast<size_t>(info.st_size);
+    segment = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (segment == MAP_FAILED)
+  {
+    return false;
+  }
+
+  // A segment of the same name on some other host, or one left behind by an
+  // unrelated process, will not have the key we were given.
+  const vtkSharedMemoryHeader* header = static_cast<const vtkSharedMemoryHeader*>(segment);
+  if (header->Magic != vtkSharedMemoryMagic || header->Key != key ||
+    vtkSharedMemoryLength(header->RingSize) != length)
+  {
+    munmap(segment, length);
+    return false;
+  }
+
+  vtkInternals& internals = *this->Internals;
+  internals.Name = name;
+  internals.Linked = false;
+  internals.Key = key;
+  internals.RingSize = header->RingSize;
+  internals.Map(segment, length, false);
+  return true;
+#else
+  (void)name;
+  (void)key;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void vtkSharedMemorySocketCommunicator::UnlinkSharedMemory()
+{
+  this->Internals->Unlink();
+}
+
+//----------------------------------------------------------------------------
+void vtkSharedMemorySocketCommunicator::ReleaseSharedMemory()
+{
+  this->Internals->Release();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSharedMemorySocketCommunicator::GetSharedMemoryEnabled() const
+{
+  return this->Internals->Segment != NULL;
+}
+
+//----------------------------------------------------------------------------
+const char* vtkSharedMemorySocketCommunicator::GetSharedMemoryName() const
+{
+  return this->Internals->Name.c_str();
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkSharedMemorySocketCommunicator::GetSharedMemoryKey() const
+{
+  return this->Internals->Key;
+}
+
+//----------------------------------------------------------------------------
+void vtkSharedMemorySocketCommunicator::CloseConnection()
+{
+  this->ReleaseSharedMemory();
+  this->Superclass::CloseConnection();
+}
+
+//----------------------------------------------------------------------------
+int vtkSharedMemorySocketCommunicator::SendVoidArray(
+  const void* data, vtkIdType length, int type, int remoteHandle, int tag)
+{
+  const vtkIdType nbytes = length * vtkDataArray::GetDataTypeSize(type);
+  if (!this->GetSharedMemoryEnabled() || nbytes <= 0 || nbytes < this->SharedMemoryThreshold)
+  {
+    return this->Superclass::SendVoidArray(data, length, type, remoteHandle, tag);
+  }
+
+  // descriptor: position in the ring, or -1 when the data follows on the
+  // socket, and the number of bytes.
+  vtkTypeInt64 descriptor[2] = { -1, nbytes };
+  vtkTypeUInt64 position;
+  if (this->Internals->Write(data, static_cast<vtkTypeUInt64>(nbytes), position))
+  {
+    descriptor[0] = static_cast<vtkTypeInt64>(position);
+  }
+  if (!this->Superclass::SendVoidArray(descriptor, 2, VTK_TYPE_INT64, remoteHandle, tag))
+  {
+    return 0;
+  }
+  return descriptor[0] >= 0
+    ? 1
+    : this->Superclass::SendVoidArray(data, length, type, remoteHandle, tag);
+}
+
+//----------------------------------------------------------------------------
+int vtkSharedMemorySocketCommunicator::ReceiveVoidArray(
+  void* data, vtkIdType maxlength, int type, int remoteHandle, int tag)
+{
+  const vtkIdType nbytes = maxlength * vtkDataArray::GetDataTypeSize(type);
+  if (!this->GetSharedMemoryEnabled() || nbytes <= 0 || nbytes < this->SharedMemoryThreshold)
+  {
+    return this->Superclass::ReceiveVoidArray(data, maxlength, type, remoteHandle, tag);
+  }
+
+  vtkTypeInt64 descriptor[2];
+  if (!this->Superclass::ReceiveVoidArray(descriptor, 2, VTK_TYPE_INT64, remoteHandle, tag))
+  {
+    return 0;
+  }
+  if (descriptor[1] != nbytes)
+  {
+    vtkErrorMacro("Message size mismatch: expected " << nbytes << " bytes, got "
+                                                      << descriptor[1] << ".");
+    return 0;
+  }
+  if (descriptor[0] < 0)
+  {
+    return this->Superclass::ReceiveVoidArray(data, maxlength, type, remoteHandle, tag);
+  }
+  if (!this->Internals->Read(
+        data, static_cast<vtkTypeUInt64>(descriptor[0]), static_cast<vtkTypeUInt64>(nbytes)))
+  {
+    vtkErrorMacro("Invalid shared memory descriptor.");
+    return 0;
+  }
+  this->Count = maxlength;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkSharedMemorySocketCommunicator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SharedMemoryThreshold: " << this->SharedMemoryThreshold << endl;
+  os << indent << "SharedMemoryEnabled: " << this->GetSharedMemoryEnabled() << endl;
+  if (this->GetSharedMemoryEnabled())
+  {
+    os << indent << "SharedMemoryName: " << this->Internals->Name << endl;
+    os << indent << "RingSize: " << this->Internals->RingSize << endl;
+  }
+}
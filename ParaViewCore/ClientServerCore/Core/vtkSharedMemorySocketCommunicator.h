@@ -0,0 +1,131 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkSharedMemorySocketCommunicator.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkSharedMemorySocketCommunicator
+ * @brief   socket communicator that hands large buffers over shared memory.
+ *
+ * vtkSharedMemorySocketCommunicator is a vtkSocketCommunicator that can
+ * optionally be paired with a shared memory segment when both ends of the
+ * connection run on the same host. The segment holds two single-producer,
+ * single-consumer ring buffers, one per direction. Arrays whose size is at
+ * least SharedMemoryThreshold bytes are copied into the outgoing ring and only
+ * a small descriptor is sent over the socket; the receiver copies the payload
+ * straight from the mapped ring into the destination buffer. Smaller messages,
+ * and large ones for which the ring has no free space, go over the socket as
+ * before. The socket thus remains the only thing one has to select() on.
+ *
+ * Since the receiver has to know the exact size of every message it receives,
+ * both ends agree on which messages travel through the ring without any
+ * additional exchange.
+ *
+ * The segment is created by one end using CreateSharedMemory(), and the other
+ * end attaches to it using AttachSharedMemory(). vtkTCPNetworkAccessManager
+ * negotiates this for \c shm:// connections. Shared memory is only supported on
+ * POSIX platforms; elsewhere CreateSharedMemory() and AttachSharedMemory()
+ * simply fail and the communicator behaves as a vtkSocketCommunicator.
+*/
+
+#ifndef vtkSharedMemorySocketCommunicator_h
+#define vtkSharedMemorySocketCommunicator_h
+
+#include "vtkPVClientServerCoreCoreModule.h" //needed for exports
+#include "vtkSocketCommunicator.h"
+
+class VTKPVCLIENTSERVERCORECORE_EXPORT vtkSharedMemorySocketCommunicator
+  : public vtkSocketCommunicator
+{
+public:
+  static vtkSharedMemorySocketCommunicator* New();
+  vtkTypeMacro(vtkSharedMemorySocketCommunicator, vtkSocketCommunicator);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Messages of at least these many bytes are sent through the shared memory
+   * ring, when available. Both ends of the connection must use the same
+   * value. Default is 64 KiB.
+   */
+  vtkSetMacro(SharedMemoryThreshold, vtkIdType);
+  vtkGetMacro(SharedMemoryThreshold, vtkIdType);
+  //@}
+
+  /**
+   * Creates a new shared memory segment with rings of \c ringSize bytes in
+   * each direction. Returns false if the segment could not be created. On
+   * success, GetSharedMemoryName() and GetSharedMemoryKey() must be passed to
+   * the other end, which calls AttachSharedMemory().
+   */
+  bool CreateSharedMemory(vtkIdType ringSize);
+
+  /**
+   * Attaches to a segment created by CreateSharedMemory() on the other end of
+   * this connection. \c key must match the one the segment was created with.
+   */
+  bool AttachSharedMemory(const char* name, vtkTypeUInt64 key);
+
+  /**
+   * Removes the name of the segment from the system, once the other end has
+   * attached to it (or has failed to). The mapping remains valid.
+   */
+  void UnlinkSharedMemory();
+
+  /**
+   * Unmaps the segment. Subsequent messages go over the socket.
+   */
+  void ReleaseSharedMemory();
+
+  /**
+   * Returns true if messages may be sent through shared memory.
+   */
+  bool GetSharedMemoryEnabled() const;
+
+  //@{
+  /**
+   * Name and key of the segment created by CreateSharedMemory().
+   */
+  const char* GetSharedMemoryName() const;
+  vtkTypeUInt64 GetSharedMemoryKey() const;
+  //@}
+
+  /**
+   * Overridden to release the shared memory segment as well.
+   */
+  void CloseConnection() VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Overridden to route large arrays through the shared memory rings.
+   */
+  int SendVoidArray(
+    const void* data, vtkIdType length, int type, int remoteHandle, int tag) VTK_OVERRIDE;
+  int ReceiveVoidArray(
+    void* data, vtkIdType maxlength, int type, int remoteHandle, int tag) VTK_OVERRIDE;
+  //@}
+
+protected:
+  vtkSharedMemorySocketCommunicator();
+  ~vtkSharedMemorySocketCommunicator() VTK_OVERRIDE;
+
+  vtkIdType SharedMemoryThreshold;
+
+private:
+  vtkSharedMemorySocketCommunicator(const vtkSharedMemorySocketCommunicator&) = delete;
+  void operator=(const vtkSharedMemorySocketCommunicator&) = delete;
+
+  class vtkInternals;
+  vtkInternals* Internals;
+};
+
+#endif
@@ -18,7 +18,7 @@
 #include "vtkCommand.h"
 #include "vtkObjectFactory.h"
 #include "vtkServerSocket.h"
-#include "vtkSmartPointer.h"
+#include "vtkSharedMemorySocketCommunicator.h"
 #include "vtkSmartPointer.h"
 #include "vtkSocketCommunicator.h"
 #include "vtkSocketController.h"
@@ -29,18 +29,24 @@
 #include <vtksys/SystemInformation.hxx>
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#if defined(__linux__)
+#define VTK_PV_USE_EPOLL 1
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 // set this to 1 if you want to generate a log file with all the raw socket
 // communication.
 #define GENERATE_DEBUG_LOG 0
 
-#define MAX_SOCKETS 256
-
 class vtkTCPNetworkAccessManager::vtkInternals
 {
 public:
@@ -48,8 +54,142 @@ public:
   VectorOfControllers Controllers;
   typedef std::map<int, vtkSmartPointer<vtkServerSocket> > MapToServerSockets;
   MapToServerSockets ServerSockets;
+
+  // Socket descriptors being waited on, and the controller or server socket
+  // each one belongs to.
+  typedef std::map<int, vtkWeakPointer<vtkObject> > MapOfDescriptors;
+  MapOfDescriptors Descriptors;
+
+#if VTK_PV_USE_EPOLL
+  // The epoll instance keeps its interest list across calls, so only sockets
+  // that come and go need to be (un)registered.
+  int EPollFD;
+
+  vtkInternals() { this->EPollFD = epoll_create1(EPOLL_CLOEXEC); }
+  ~vtkInternals()
+  {
+    if (this->EPollFD != -1)
+    {
+      close(this->EPollFD);
+    }
+  }
+#endif
+
+  void UpdateDescriptors(const MapOfDescriptors& current)
+  {
+#if VTK_PV_USE_EPOLL
+    // A descriptor number may have been reused by another socket, in which
+    // case it's registered again.
+    for (MapOfDescriptors::iterator iter = this->Descriptors.begin();
+         iter != this->Descriptors.end();)
+    {
+      MapOfDescriptors::const_iterator citer = current.find(iter->first);
+      if (citer == current.end() || citer->second.GetPointer() != iter->second.GetPointer())
+      {
+        // this fails harmlessly if the socket has already been closed.
+        epoll_ctl(this->EPollFD, EPOLL_CTL_DEL, iter->first, NULL);
+        this->Descriptors.erase(iter++);
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+    for (MapOfDescriptors::const_iterator citer = current.begin(); citer != current.end();
+         ++citer)
+    {
+      if (this->Descriptors.find(citer->first) == this->Descriptors.end())
+      {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = citer->first;
+        if (epoll_ctl(this->EPollFD, EPOLL_CTL_ADD, citer->first, &event) == 0 || errno == EEXIST)
+        {
+          this->Descriptors[citer->first] = citer->second;
+        }
+      }
+    }
+#else
+    this->Descriptors = current;
+#endif
+  }
+
+  // Waits for activity on the descriptors. Returns -1 on error, 0 on timeout,
+  // otherwise the number of descriptors added to `ready`. A timeout of 0 waits
+  // indefinitely.
+  int Wait(unsigned long timeout_msecs, std::vector<int>& ready)
+  {
+#if VTK_PV_USE_EPOLL
+    if (this->EPollFD == -1)
+    {
+      return -1;
+    }
+    std::vector<epoll_event> events(std::max<size_t>(this->Descriptors.size(), 1));
+    int timeout = timeout_msecs > 0
+      ? static_cast<int>(std::min<unsigned long>(timeout_msecs, VTK_INT_MAX))
+      : -1;
+    int result =
+      epoll_wait(this->EPollFD, &events[0], static_cast<int>(events.size()), timeout);
+    if (result < 0)
+    {
+      // a signal is not an error, simply report no activity.
+      return errno == EINTR ? 0 : -1;
+    }
+    for (int cc = 0; cc < result; ++cc)
+    {
+      ready.push_back(events[cc].data.fd);
+    }
+    return result;
+#else
+    std::vector<int> sockets;
+    for (MapOfDescriptors::const_iterator iter = this->Descriptors.begin();
+         iter != this->Descriptors.end(); ++iter)
+    {
+      sockets.push_back(iter->first);
+    }
+    int selected_index = -1;
+    int result = vtkSocket::SelectSockets(&sockets[0], static_cast<int>(sockets.size()),
+      timeout_msecs, &selected_index);
+    if (result > 0)
+    {
+      ready.push_back(sockets[selected_index]);
+    }
+    return result;
+#endif
+  }
 };
 
+namespace
+{
+// Appended to the handshake by connecting sides that ask for shared memory.
+const char vtkSharedMemoryHandshakeSuffix[] = ".sharedmemory";
+
+// Strings are sent as a size, including the terminating null character,
+// followed by the characters, as done for the handshake.
+bool vtkSendString(vtkSocketCommunicator* comm, const std::string& str, int tag)
+{
+  int size = static_cast<int>(str.size() + 1);
+  return comm->Send(&size, 1, 1, tag) && comm->Send(str.c_str(), size, 1, tag);
+}
+
+bool vtkReceiveString(vtkSocketCommunicator* comm, std::string& str, int tag)
+{
+  int size = 0;
+  if (!comm->Receive(&size, 1, 1, tag) || size <= 0)
+  {
+    return false;
+  }
+  std::vector<char> buffer(size);
+  if (!comm->Receive(&buffer[0], size, 1, tag))
+  {
+    return false;
+  }
+  buffer[size - 1] = 0;
+  str = &buffer[0];
+  return true;
+}
+}
+
 vtkStandardNewMacro(vtkTCPNetworkAccessManager);
 //----------------------------------------------------------------------------
 vtkTCPNetworkAccessManager::vtkTCPNetworkAccessManager()
@@ -74,19 +214,21 @@ vtkTCPNetworkAccessManager::~vtkTCPNetworkAccessManager()
 //----------------------------------------------------------------------------
 vtkMultiProcessController* vtkTCPNetworkAccessManager::NewConnection(const char* url)
 {
-  vtksys::RegularExpression re_connect("^tcp://([^:]+)?:([0-9]+)\\?\?((&?[a-zA-Z0-9%]+=[^&]+)*)");
+  vtksys::RegularExpression re_connect(
+    "^(tcp|shm)://([^:]+)?:([0-9]+)\\?\?((&?[a-zA-Z0-9%]+=[^&]+)*)");
   vtksys::RegularExpression key_val("([a-zA-Z0-9%]+)=([^&]+)");
 
   std::map<std::string, std::string> parameters;
   if (re_connect.find(url))
   {
-    std::string hostname = re_connect.match(1);
-    int port = atoi(re_connect.match(2).c_str());
+    bool use_shm = (re_connect.match(1) == "shm");
+    std::string hostname = re_connect.match(2);
+    int port = atoi(re_connect.match(3).c_str());
 
     // there some issue with RegularExpression that I cannot extract parameters.
     // hence we do this:
     std::vector<vtksys::String> param_vals =
-      vtksys::SystemTools::SplitString(re_connect.match(3).c_str(), '&');
+      vtksys::SystemTools::SplitString(re_connect.match(4).c_str(), '&');
     for (size_t cc = 0; cc < param_vals.size(); cc++)
     {
       if (key_val.find(param_vals[cc]))
@@ -112,19 +254,29 @@ vtkMultiProcessController* vtkTCPNetworkAccessManager::NewConnection(const char*
       }
     }
 
+    // size of each of the shared memory rings, in MiB.
+    int shm_size = use_shm ? 32 : 0;
+    if (use_shm && parameters.find("shmsize") != parameters.end())
+    {
+      shm_size = std::max(atoi(parameters["shmsize"].c_str()), 0);
+    }
+
     this->WrongConnectID = false;
 
     if (parameters["listen"] == "true" && parameters["multiple"] == "true")
     {
-      return this->WaitForConnection(port, false, handshake, parameters["nonblocking"] == "true");
+      return this->WaitForConnection(
+        port, false, handshake, parameters["nonblocking"] == "true", use_shm);
     }
     else if (parameters["listen"] == "true")
     {
-      return this->WaitForConnection(port, true, handshake, parameters["nonblocking"] == "true");
+      return this->WaitForConnection(
+        port, true, handshake, parameters["nonblocking"] == "true", use_shm);
     }
     else
     {
-      return this->ConnectToRemote(hostname.c_str(), port, handshake, timeout_in_seconds);
+      return this->ConnectToRemote(
+        hostname.c_str(), port, handshake, timeout_in_seconds, shm_size);
     }
   }
   else
@@ -196,11 +348,9 @@ int vtkTCPNetworkAccessManager::ProcessEvents(unsigned long timeout_msecs)
 int vtkTCPNetworkAccessManager::ProcessEventsInternal(
   unsigned long timeout_msecs, bool do_processing)
 {
-  int sockets_to_select[MAX_SOCKETS];
-  vtkObject* controller_or_server_socket[MAX_SOCKETS];
-
-  vtkSocketController* ctrlWithBufferToEmpty = NULL;
-  int size = 0;
+  vtkInternals::MapOfDescriptors descriptors;
+  std::vector<vtkSmartPointer<vtkSocketController> > ctrlsWithBufferToEmpty;
+  int num_controllers = 0;
   vtkInternals::VectorOfControllers::iterator iter1;
   for (iter1 = this->Internals->Controllers.begin(); iter1 != this->Internals->Controllers.end();
        ++iter1)
@@ -216,24 +366,23 @@ int vtkTCPNetworkAccessManager::ProcessEventsInternal(
     vtkSocket* socket = comm->GetSocket();
     if (socket && socket->GetConnected())
     {
-      sockets_to_select[size] = socket->GetSocketDescriptor();
-      controller_or_server_socket[size] = controller;
+      descriptors[socket->GetSocketDescriptor()] = controller;
       if (comm->HasBufferredMessages())
       {
-        ctrlWithBufferToEmpty = controller;
         if (!do_processing)
         {
           // we do have events to process, but we were told not to process them,
           // so just return and say we have something to process here.
           return 1;
         }
+        ctrlsWithBufferToEmpty.push_back(controller);
       }
-      size++;
+      num_controllers++;
     }
   }
 
   // Only one client connected, so if it fails, just quit...
-  bool can_quit_if_error = (size == 1);
+  bool can_quit_if_error = (num_controllers == 1);
 
   // Now add server sockets.
   vtkInternals::MapToServerSockets::iterator iter2;
@@ -242,58 +391,79 @@ int vtkTCPNetworkAccessManager::ProcessEventsInternal(
   {
     if (iter2->second.GetPointer() && iter2->second.GetPointer()->GetConnected())
     {
-      sockets_to_select[size] = iter2->second.GetPointer()->GetSocketDescriptor();
-      controller_or_server_socket[size] = iter2->second.GetPointer();
-      size++;
+      descriptors[iter2->second.GetPointer()->GetSocketDescriptor()] = iter2->second.GetPointer();
     }
   }
 
-  if (size == 0 || this->AbortPendingConnectionFlag)
+  if (descriptors.empty() || this->AbortPendingConnectionFlag)
   {
     // Connection failed / aborted.
     return -1;
   }
 
-  // Try to empty RMI buffered messages if any
-  if (ctrlWithBufferToEmpty &&
-    (ctrlWithBufferToEmpty->ProcessRMIs(0, 1) == vtkMultiProcessController::RMI_NO_ERROR))
+  // Try to empty RMI buffered messages if any. These are not seen by the
+  // poller since they have already been read from the socket.
+  bool processed_buffered = false;
+  for (size_t cc = 0; cc < ctrlsWithBufferToEmpty.size(); ++cc)
+  {
+    if (ctrlsWithBufferToEmpty[cc]->ProcessRMIs(0, 1) == vtkMultiProcessController::RMI_NO_ERROR)
+    {
+      processed_buffered = true;
+    }
+  }
+  if (processed_buffered)
   {
     return 1;
   }
 
-  int selected_index = -1;
-  int result = vtkSocket::SelectSockets(sockets_to_select, size, timeout_msecs, &selected_index);
+  this->Internals->UpdateDescriptors(descriptors);
+
+  std::vector<int> ready;
+  int result = this->Internals->Wait(timeout_msecs, ready);
   if (result <= 0)
   {
     return result;
   }
-  if (result > 0 && !do_processing)
+  if (!do_processing)
   {
     // we were told not to do any processing, so just let the caller know that
     // we have events to process.
     return 1;
   }
 
-  if (controller_or_server_socket[selected_index]->IsA("vtkServerSocket"))
-  {
-    vtkServerSocket* ss =
-      static_cast<vtkServerSocket*>(controller_or_server_socket[selected_index]);
-    int port = ss->GetServerPort();
-    this->InvokeEvent(vtkCommand::ConnectionCreatedEvent, &port);
-    return 1;
-  }
-  else
+  // Handle every socket with activity. Handling one may release others, so
+  // the owners are looked up through weak pointers as we go.
+  for (size_t cc = 0; cc < ready.size(); ++cc)
   {
+    vtkInternals::MapOfDescriptors::iterator iter = this->Internals->Descriptors.find(ready[cc]);
+    if (iter == this->Internals->Descriptors.end() || iter->second.GetPointer() == NULL)
+    {
+      continue;
+    }
+
+    if (vtkServerSocket* ss = vtkServerSocket::SafeDownCast(iter->second.GetPointer()))
+    {
+      int port = ss->GetServerPort();
+      this->InvokeEvent(vtkCommand::ConnectionCreatedEvent, &port);
+      continue;
+    }
+
     // We use smart pointer here to make sure the controller will live
     // during the whole ProcessRMIs call. As that call can release
     // the controller while executing.
     vtkSmartPointer<vtkMultiProcessController> controller =
-      vtkMultiProcessController::SafeDownCast(controller_or_server_socket[selected_index]);
-    result = controller->ProcessRMIs(0, 1);
-    if (result == vtkMultiProcessController::RMI_NO_ERROR)
+      vtkMultiProcessController::SafeDownCast(iter->second.GetPointer());
+    vtkSocketCommunicator* comm =
+      vtkSocketCommunicator::SafeDownCast(controller->GetCommunicator());
+    if (!comm->GetSocket() || !comm->GetSocket()->GetConnected())
+    {
+      // closed while handling another socket.
+      continue;
+    }
+    if (controller->ProcessRMIs(0, 1) == vtkMultiProcessController::RMI_NO_ERROR)
     {
       // all's well.
-      return 1;
+      continue;
     }
 
     if (can_quit_if_error)
@@ -302,15 +472,17 @@ int vtkTCPNetworkAccessManager::ProcessEventsInternal(
     }
 
     // Close cleanly the socket in error
-    vtkSocketCommunicator* comm =
-      vtkSocketCommunicator::SafeDownCast(controller->GetCommunicator());
     comm->CloseConnection();
 
     // Fire an event letting the world know that the connection was closed.
     this->InvokeEvent(vtkCommand::ConnectionClosedEvent, controller);
 
-    return can_quit_if_error ? -1 /* Quit */ : 1 /* Pretend it's OK */;
+    if (can_quit_if_error)
+    {
+      return -1; // Quit
+    }
   }
+  return 1;
 }
 
 //----------------------------------------------------------------------------
@@ -372,7 +544,7 @@ void vtkTCPNetworkAccessManager::PrintHandshakeError(int errorcode, bool server_
 
 //----------------------------------------------------------------------------
 vtkMultiProcessController* vtkTCPNetworkAccessManager::ConnectToRemote(
-  const char* hostname, int port, const char* handshake, int timeout_in_seconds)
+  const char* hostname, int port, const char* handshake, int timeout_in_seconds, int shm_size)
 {
 
   // Create client socket.
@@ -399,8 +571,14 @@ vtkMultiProcessController* vtkTCPNetworkAccessManager::ConnectToRemote(
     vtksys::SystemTools::Delay(1000);
   }
 
+  // Only connections asking for shared memory use the communicator supporting
+  // it, and go through the negotiation.
+  bool shm = (shm_size > 0);
   vtkSocketController* controller = vtkSocketController::New();
-  vtkSocketCommunicator* comm = vtkSocketCommunicator::SafeDownCast(controller->GetCommunicator());
+  vtkSocketCommunicator* comm =
+    shm ? vtkSharedMemorySocketCommunicator::New() : vtkSocketCommunicator::New();
+  controller->SetCommunicator(comm);
+  comm->FastDelete();
 #if GENERATE_DEBUG_LOG
   std::ostringstream mystr;
   mystr << "/tmp/client." << getpid() << ".log";
@@ -408,7 +586,9 @@ vtkMultiProcessController* vtkTCPNetworkAccessManager::ConnectToRemote(
 #endif
   comm->SetSocket(cs);
   int errorcode = HANDSHAKE_SOCKET_COMMUNICATOR_DIFFERENT;
-  if (!comm->Handshake() || (errorcode = this->ParaViewHandshake(controller, false, handshake)))
+  if (!comm->Handshake() ||
+    (errorcode = this->ParaViewHandshake(controller, false, handshake, shm)) ||
+    (shm && !this->NegotiateSharedMemory(comm, false, shm_size)))
   {
     controller->Delete();
     // handshake failed, must be bogus client, continue waiting (unless
@@ -422,7 +602,7 @@ vtkMultiProcessController* vtkTCPNetworkAccessManager::ConnectToRemote(
 
 //----------------------------------------------------------------------------
 vtkMultiProcessController* vtkTCPNetworkAccessManager::WaitForConnection(
-  int port, bool once, const char* handshake, bool nonblocking)
+  int port, bool once, const char* handshake, bool nonblocking, bool shm)
 {
   vtkServerSocket* server_socket = NULL;
   if (this->Internals->ServerSockets.find(port) != this->Internals->ServerSockets.end())
@@ -476,12 +656,16 @@ vtkMultiProcessController* vtkTCPNetworkAccessManager::WaitForConnection(
 
     controller = vtkSocketController::New();
     vtkSocketCommunicator* comm =
-      vtkSocketCommunicator::SafeDownCast(controller->GetCommunicator());
+      shm ? vtkSharedMemorySocketCommunicator::New() : vtkSocketCommunicator::New();
+    controller->SetCommunicator(comm);
+    comm->FastDelete();
     comm->SetSocket(client_socket);
     client_socket->FastDelete();
     int errorcode = HANDSHAKE_SOCKET_COMMUNICATOR_DIFFERENT;
+    bool shm_requested = false;
     if (comm->Handshake() == 0 ||
-      (errorcode = this->ParaViewHandshake(controller, true, handshake)))
+      (errorcode = this->ParaViewHandshake(controller, true, handshake, shm_requested)) ||
+      (shm_requested && !this->NegotiateSharedMemory(comm, true, 0)))
     {
       controller->Delete();
       controller = NULL;
@@ -565,10 +749,10 @@ int vtkTCPNetworkAccessManager::AnalyzeHandshakeAndGetErrorCode(
 
 //----------------------------------------------------------------------------
 int vtkTCPNetworkAccessManager::ParaViewHandshake(
-  vtkMultiProcessController* controller, bool server_side, const char* _handshake)
+  vtkMultiProcessController* controller, bool server_side, const char* _handshake, bool& shm)
 {
   const std::string handshake = _handshake ? _handshake : "";
-  int size = static_cast<int>(handshake.size() + 1);
+  const std::string suffix = vtkSharedMemoryHandshakeSuffix;
   if (server_side)
   {
     std::string other_handshake;
@@ -581,6 +765,13 @@ int vtkTCPNetworkAccessManager::ParaViewHandshake(
       other_handshake = _other_handshake;
       delete[] _other_handshake;
     }
+    // A request for shared memory is not part of what must match.
+    shm = other_handshake.size() > suffix.size() &&
+      other_handshake.compare(other_handshake.size() - suffix.size(), suffix.size(), suffix) == 0;
+    if (shm)
+    {
+      other_handshake.resize(other_handshake.size() - suffix.size());
+    }
     int errorCode = HANDSHAKE_NO_ERROR;
     if (handshake != other_handshake)
     {
@@ -591,10 +782,12 @@ int vtkTCPNetworkAccessManager::ParaViewHandshake(
   }
   else
   {
+    const std::string sent_handshake = shm ? handshake + suffix : handshake;
+    int size = static_cast<int>(sent_handshake.size() + 1);
     controller->Send(&size, 1, 1, 99991);
     if (size > 0)
     {
-      controller->Send(handshake.c_str(), size, 1, 99991);
+      controller->Send(sent_handshake.c_str(), size, 1, 99991);
     }
     int errorCode;
     controller->Receive(&errorCode, 1, 1, 99990);
@@ -602,6 +795,60 @@ int vtkTCPNetworkAccessManager::ParaViewHandshake(
   }
 }
 
+//----------------------------------------------------------------------------
+bool vtkTCPNetworkAccessManager::NegotiateSharedMemory(
+  vtkSocketCommunicator* comm, bool server_side, int shm_size)
+{
+  // The connecting side creates the segment and sends its name and key, or an
+  // empty string if it could not. The listening side attaches to it if it
+  // accepts shared memory, and tells whether it did, after which the name is
+  // removed from the system. Attaching fails unless both processes see the
+  // same segment, i.e. run on the same host, in which case the connection
+  // stays on TCP alone.
+  vtkSharedMemorySocketCommunicator* shm_comm =
+    vtkSharedMemorySocketCommunicator::SafeDownCast(comm);
+  if (server_side)
+  {
+    std::string offer;
+    if (!vtkReceiveString(comm, offer, 99992))
+    {
+      return false;
+    }
+    int attached = 0;
+    size_t separator = offer.rfind('|');
+    if (shm_comm && separator != std::string::npos)
+    {
+      vtkTypeUInt64 key = 0;
+      std::istringstream(offer.substr(separator + 1)) >> key;
+      attached = shm_comm->AttachSharedMemory(offer.substr(0, separator).c_str(), key) ? 1 : 0;
+    }
+    return comm->Send(&attached, 1, 1, 99993) != 0;
+  }
+  else
+  {
+    std::ostringstream offer;
+    if (shm_comm && shm_comm->CreateSharedMemory(static_cast<vtkIdType>(shm_size) * 1024 * 1024))
+    {
+      offer << shm_comm->GetSharedMemoryName() << "|" << shm_comm->GetSharedMemoryKey();
+    }
+    if (!vtkSendString(comm, offer.str(), 99992))
+    {
+      return false;
+    }
+    int attached = 0;
+    int status = comm->Receive(&attached, 1, 1, 99993);
+    if (shm_comm)
+    {
+      shm_comm->UnlinkSharedMemory();
+      if (!attached)
+      {
+        shm_comm->ReleaseSharedMemory();
+      }
+    }
+    return status != 0;
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkTCPNetworkAccessManager::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -27,6 +27,7 @@
 #include "vtkPVClientServerCoreCoreModule.h" //needed for exports
 
 class vtkMultiProcessController;
+class vtkSocketCommunicator;
 
 class VTKPVCLIENTSERVERCORECORE_EXPORT vtkTCPNetworkAccessManager : public vtkNetworkAccessManager
 {
@@ -55,6 +56,13 @@ public:
    * * \c tcp://<hostname\>:\<port\>
    * * \c tcp://localhost:\<port\>?listen=true& -- listen for connection on port.
    * * \c tcp://localhost:\<port\>?listen=true&multiple=true -- listen for multiple
+   * * \c shm://\<hostname\>:\<port\> -- same as tcp, but asks the remote
+   *   process to exchange large messages through shared memory, which succeeds
+   *   only when it runs on the same host and listens using \c shm:// as well
+   *   (see vtkSharedMemorySocketCommunicator). Otherwise the connection simply
+   *   stays on TCP. Servers that predate this option refuse such connections.
+   * * \c shm://localhost:\<port\>?listen=true& -- listen for connection on port,
+   *   accepting shared memory from clients that ask for it.
    * Examples:
    * * \c tcp://medea:12345
    * * \c tcp://localhost:12345?listen&handshake=3.8.12
@@ -70,6 +78,9 @@ public:
    * (in seconds) for which this call blocks to retry attempts to
    * connect to the host/port. If absent, default is 60s. 0 or
    * negative implies no retry attempts.
+   * shmsize   :- When connecting to remote using \c shm://, specify the size
+   * (in MiB) of the shared memory ring used in each direction, which the
+   * connecting side allocates. If absent, default is 32 MiB.
    */
   vtkMultiProcessController* NewConnection(const char* url) VTK_OVERRIDE;
 
@@ -80,7 +91,9 @@ public:
   void AbortPendingConnection() VTK_OVERRIDE;
 
   /**
-   * Process any network activity.
+   * Process any network activity. All connections with pending activity are
+   * serviced in one call (one message each). On Linux, sockets are monitored
+   * using epoll, otherwise select() is used.
    */
   int ProcessEvents(unsigned long timeout_msecs) VTK_OVERRIDE;
 
@@ -116,14 +129,14 @@ protected:
   /**
    * Connects to remote processes.
    */
-  vtkMultiProcessController* ConnectToRemote(
-    const char* hostname, int port, const char* handshake, int timeout_in_seconds);
+  vtkMultiProcessController* ConnectToRemote(const char* hostname, int port,
+    const char* handshake, int timeout_in_seconds, int shm_size = 0);
 
   /**
    * Waits for connection from remote process.
    */
   vtkMultiProcessController* WaitForConnection(
-    int port, bool once, const char* handshake, bool nonblocking);
+    int port, bool once, const char* handshake, bool nonblocking, bool shm = false);
 
   enum HandshakeErrors
   {
@@ -135,9 +148,24 @@ protected:
     HANDSHAKE_UNKNOWN_ERROR
   };
 
+  /**
+   * Exchanges the ParaView handshake. On the connecting side, \c shm tells
+   * whether to ask for shared memory. On the listening side, it is set to
+   * whether the other side asked for it.
+   */
   int ParaViewHandshake(
-    vtkMultiProcessController* controller, bool server_side, const char* handshake);
+    vtkMultiProcessController* controller, bool server_side, const char* handshake, bool& shm);
   void PrintHandshakeError(int errorcode, bool server_side);
+
+  /**
+   * Sets up shared memory between the two ends of a new connection, once the
+   * connecting side asked for it in the handshake. The connecting side creates
+   * a segment with rings of \c shm_size MiB, which the listening side attaches
+   * to if it accepts shared memory. Attaching only succeeds if both processes
+   * share the same host, so this is how the host is checked. Returns false
+   * only if the connection dropped.
+   */
+  bool NegotiateSharedMemory(vtkSocketCommunicator* comm, bool server_side, int shm_size);
   int AnalyzeHandshakeAndGetErrorCode(const char* clientHS, const char* serverHS);
 
   bool AbortPendingConnectionFlag;
@@ -0,0 +1,185 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCacheMemoryBudget.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Fills the animation caches of vtkPVCacheKeeper filters, and checks that the
+// memory budget of vtkCacheSizeKeeper is only exceeded when set, and that
+// evicting the caches releases all of them, but not the filter outputs.
+
+#include "vtkCacheSizeKeeper.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOutputWindow.h"
+#include "vtkPVCacheKeeper.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+
+#include <string>
+#include <vtksys/SystemInformation.hxx>
+
+namespace
+{
+// Records the warnings reported while evicting the caches.
+class vtkCacheMemoryBudgetOutputWindow : public vtkOutputWindow
+{
+public:
+  static vtkCacheMemoryBudgetOutputWindow* New();
+  vtkTypeMacro(vtkCacheMemoryBudgetOutputWindow, vtkOutputWindow);
+
+  void DisplayErrorText(const char* text) VTK_OVERRIDE { this->Errors += text; }
+  void DisplayWarningText(const char* text) VTK_OVERRIDE { this->Warnings += text; }
+  void DisplayGenericWarningText(const char* text) VTK_OVERRIDE { this->Warnings += text; }
+
+  std::string Errors;
+  std::string Warnings;
+
+private:
+  vtkCacheMemoryBudgetOutputWindow() {}
+};
+vtkStandardNewMacro(vtkCacheMemoryBudgetOutputWindow);
+
+// Caches the input of keeper for times 0 and 1.
+void FillCache(vtkPVCacheKeeper* keeper)
+{
+  keeper->SetCacheTime(0.0);
+  keeper->Update();
+  keeper->SetCacheTime(1.0);
+  keeper->Update();
+}
+
+bool TestEviction(vtkCacheSizeKeeper* sizeKeeper, vtkCacheMemoryBudgetOutputWindow* window)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(64);
+  sphere->SetPhiResolution(64);
+  vtkNew<vtkPVCacheKeeper> keepers[2];
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    keepers[cc]->SetInputConnection(sphere->GetOutputPort());
+    FillCache(keepers[cc].GetPointer());
+    if (!keepers[cc]->IsCached(0.0) || !keepers[cc]->IsCached(1.0))
+    {
+      cerr << "ERROR: time steps not cached." << endl;
+      return false;
+    }
+  }
+  if (sizeKeeper->GetCacheSize() == 0)
+  {
+    cerr << "ERROR: cache size not reported." << endl;
+    return false;
+  }
+
+  // A keeper no longer reporting to the size keeper keeps its cache.
+  vtkNew<vtkPVCacheKeeper> detached;
+  detached->SetInputConnection(sphere->GetOutputPort());
+  detached->SetCacheSizeKeeper(NULL);
+  FillCache(detached.GetPointer());
+
+  sizeKeeper->SetMemoryBudget(1);
+  sizeKeeper->EvictCaches();
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    vtkPolyData* output = vtkPolyData::SafeDownCast(keepers[cc]->GetOutputDataObject(0));
+    if (keepers[cc]->IsCached(0.0) || keepers[cc]->IsCached(1.0))
+    {
+      cerr << "ERROR: caches not evicted." << endl;
+      return false;
+    }
+    if (!output || output->GetNumberOfPoints() != sphere->GetOutput()->GetNumberOfPoints())
+    {
+      cerr << "ERROR: eviction released the output of the cache keeper." << endl;
+      return false;
+    }
+  }
+  if (!detached->IsCached(0.0) || !detached->IsCached(1.0))
+  {
+    cerr << "ERROR: eviction released a cache not reporting to the size keeper." << endl;
+    return false;
+  }
+  if (sizeKeeper->GetCacheSize() != 0)
+  {
+    cerr << "ERROR: " << sizeKeeper->GetCacheSize() << " KBs still reported as cached." << endl;
+    return false;
+  }
+  if (window->Warnings.find("Memory budget of 1 KBs exceeded") == std::string::npos)
+  {
+    cerr << "ERROR: eviction not reported." << endl;
+    return false;
+  }
+
+  // Nothing is left to release.
+  window->Warnings.clear();
+  sizeKeeper->EvictCaches();
+  if (!window->Warnings.empty())
+  {
+    cerr << "ERROR: empty caches reported as released." << endl;
+    return false;
+  }
+
+  // Caching resumes afterwards.
+  keepers[0]->SetCacheTime(2.0);
+  keepers[0]->Update();
+  if (!keepers[0]->IsCached(2.0) || sizeKeeper->GetCacheSize() == 0)
+  {
+    cerr << "ERROR: caching did not resume after eviction." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestCacheMemoryBudget(int, char* [])
+{
+  vtkCacheSizeKeeper* sizeKeeper = vtkCacheSizeKeeper::GetInstance();
+  const unsigned long memoryBudget = sizeKeeper->GetMemoryBudget();
+  const int cacheFull = sizeKeeper->GetCacheFull();
+  sizeKeeper->SetCacheFull(0);
+
+  vtkNew<vtkCacheMemoryBudgetOutputWindow> window;
+  vtkOutputWindow::SetInstance(window.GetPointer());
+
+  bool success = true;
+  sizeKeeper->SetMemoryBudget(0);
+  if (sizeKeeper->IsOverMemoryBudget())
+  {
+    cerr << "ERROR: over the memory budget while it is disabled." << endl;
+    success = false;
+  }
+
+  // Only testable where the memory used by the process is known.
+  vtksys::SystemInformation sysinfo;
+  sizeKeeper->SetMemoryBudget(1);
+  if (sysinfo.GetProcMemoryUsed() > 0 && !sizeKeeper->IsOverMemoryBudget())
+  {
+    cerr << "ERROR: not over a memory budget of 1 KB." << endl;
+    success = false;
+  }
+  sizeKeeper->SetMemoryBudget(VTK_UNSIGNED_LONG_MAX);
+  if (sizeKeeper->IsOverMemoryBudget())
+  {
+    cerr << "ERROR: over the largest memory budget." << endl;
+    success = false;
+  }
+
+  success &= TestEviction(sizeKeeper, window.GetPointer());
+  if (!window->Errors.empty())
+  {
+    cerr << "ERROR: unexpected errors: " << window->Errors << endl;
+    success = false;
+  }
+
+  vtkOutputWindow::SetInstance(NULL);
+  sizeKeeper->SetMemoryBudget(memoryBudget);
+  sizeKeeper->SetCacheFull(cacheFull);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMPIMoveDataAttributeCarriers.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that attribute carriers merged by vtkMPIMoveData line up with the
+// data appended by vtkMultiProcessControllerHelper::MergePieces() i.e. that
+// the merge follows the vtkAppendPolyData ordering. Also checks when the
+// topology of vtkPVGeometryFilter's output stays the same across executions,
+// which attribute-only deliveries require.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkMPIMoveData.h"
+#include "vtkMultiProcessControllerHelper.h"
+#include "vtkNew.h"
+#include "vtkPVGeometryFilter.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimeStamp.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Creates a piece with the given number of vertices, lines and triangles.
+// Array values are unique across pieces thanks to \c offset.
+vtkSmartPointer<vtkPolyData> CreatePiece(int numVerts, int numLines, int numPolys, double offset)
+{
+  vtkSmartPointer<vtkPolyData> piece = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> polys;
+  for (int cc = 0; cc < numVerts; ++cc)
+  {
+    vtkIdType id = points->InsertNextPoint(cc, 0, 0);
+    verts->InsertNextCell(1, &id);
+  }
+  for (int cc = 0; cc < numLines; ++cc)
+  {
+    vtkIdType ids[2];
+    ids[0] = points->InsertNextPoint(cc, 1, 0);
+    ids[1] = points->InsertNextPoint(cc, 2, 0);
+    lines->InsertNextCell(2, ids);
+  }
+  for (int cc = 0; cc < numPolys; ++cc)
+  {
+    vtkIdType ids[3];
+    ids[0] = points->InsertNextPoint(cc, 3, 0);
+    ids[1] = points->InsertNextPoint(cc, 4, 0);
+    ids[2] = points->InsertNextPoint(cc, 3, 1);
+    polys->InsertNextCell(3, ids);
+  }
+  piece->SetPoints(points.GetPointer());
+  piece->SetVerts(verts.GetPointer());
+  piece->SetLines(lines.GetPointer());
+  piece->SetPolys(polys.GetPointer());
+
+  vtkNew<vtkDoubleArray> pointArray;
+  pointArray->SetName("point_values");
+  pointArray->SetNumberOfComponents(2);
+  for (vtkIdType cc = 0; cc < piece->GetNumberOfPoints(); ++cc)
+  {
+    pointArray->InsertNextTuple2(offset + cc, -(offset + cc));
+  }
+  piece->GetPointData()->AddArray(pointArray.GetPointer());
+
+  vtkNew<vtkDoubleArray> cellArray;
+  cellArray->SetName("cell_values");
+  for (vtkIdType cc = 0; cc < piece->GetNumberOfCells(); ++cc)
+  {
+    cellArray->InsertNextTuple1(offset + cc);
+  }
+  piece->GetCellData()->AddArray(cellArray.GetPointer());
+  return piece;
+}
+
+bool CompareArrays(vtkDataArray* expected, vtkDataArray* actual)
+{
+  if (!expected || !actual || expected->GetNumberOfTuples() != actual->GetNumberOfTuples() ||
+    expected->GetNumberOfComponents() != actual->GetNumberOfComponents())
+  {
+    cerr << "ERROR: array mismatch." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < expected->GetNumberOfTuples(); ++cc)
+  {
+    for (int comp = 0; comp < expected->GetNumberOfComponents(); ++comp)
+    {
+      if (expected->GetComponent(cc, comp) != actual->GetComponent(cc, comp))
+      {
+        cerr << "ERROR: '" << expected->GetName() << "' differs at tuple " << cc << ": "
+             << expected->GetComponent(cc, comp) << " != " << actual->GetComponent(cc, comp)
+             << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Re-executes vtkPVGeometryFilter after modifying an input array, and returns
+// true if the topology of its output is not newer than the first execution
+// i.e. if vtkPVDataDeliveryManager could deliver only the arrays.
+bool IsTopologyKept(vtkDataSet* input, const char* arrayName)
+{
+  vtkNew<vtkPVGeometryFilter> geometry;
+  geometry->SetUseOutline(0);
+  geometry->SetInputData(input);
+  geometry->Update();
+
+  vtkMTimeType mtime;
+  std::vector<vtkIdType> signature;
+  if (!vtkMPIMoveData::GetTopologyInformation(geometry->GetOutputDataObject(0), mtime, signature))
+  {
+    cerr << "ERROR: unsupported geometry output." << endl;
+    return false;
+  }
+  vtkTimeStamp delivered;
+  delivered.Modified();
+
+  input->GetPointData()->GetArray(arrayName)->Modified();
+  geometry->Modified();
+  geometry->Update();
+  std::vector<vtkIdType> newSignature;
+  vtkMPIMoveData::GetTopologyInformation(geometry->GetOutputDataObject(0), mtime, newSignature);
+  return mtime <= delivered.GetMTime() && newSignature == signature;
+}
+}
+
+int TestMPIMoveDataAttributeCarriers(int, char* [])
+{
+  // Pieces as gathered from 4 processes, one of which has no data.
+  std::vector<vtkSmartPointer<vtkDataObject> > pieces;
+  pieces.push_back(CreatePiece(2, 1, 1, 100));
+  pieces.push_back(CreatePiece(0, 0, 0, 200));
+  pieces.push_back(CreatePiece(1, 2, 3, 300));
+  pieces.push_back(CreatePiece(3, 0, 2, 400));
+
+  // What a full delivery produces.
+  vtkNew<vtkPolyData> appended;
+  if (!vtkMultiProcessControllerHelper::MergePieces(pieces, appended.GetPointer()))
+  {
+    cerr << "ERROR: failed to merge pieces." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // What an attribute-only delivery produces.
+  std::vector<std::string> keys;
+  std::vector<vtkAbstractArray*> arrays;
+  vtkMPIMoveData::GetAttributeArrays(pieces[0], keys, arrays);
+  std::set<std::string> keys_to_send(keys.begin(), keys.end());
+  std::vector<vtkSmartPointer<vtkDataObject> > carriers;
+  for (size_t cc = 0; cc < pieces.size(); ++cc)
+  {
+    vtkSmartPointer<vtkPolyData> carrier;
+    carrier.TakeReference(vtkMPIMoveData::NewAttributeCarrier(pieces[cc], keys_to_send));
+    carriers.push_back(carrier);
+  }
+  vtkNew<vtkPolyData> merged;
+  if (!vtkMPIMoveData::MergeAttributeCarriers(carriers, merged.GetPointer()))
+  {
+    cerr << "ERROR: failed to merge attribute carriers." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Apply the carrier on the appended data with stale values.
+  vtkNew<vtkPolyData> previous;
+  previous->DeepCopy(appended.GetPointer());
+  previous->GetPointData()->GetArray("point_values")->FillComponent(0, 0);
+  previous->GetPointData()->GetArray("point_values")->FillComponent(1, 0);
+  previous->GetCellData()->GetArray("cell_values")->FillComponent(0, 0);
+  vtkSmartPointer<vtkDataObject> result;
+  result.TakeReference(
+    vtkMPIMoveData::ApplyAttributeCarrier(previous.GetPointer(), merged.GetPointer()));
+  vtkPolyData* resultPD = vtkPolyData::SafeDownCast(result);
+  if (!resultPD)
+  {
+    cerr << "ERROR: attribute carrier does not match the appended data." << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!CompareArrays(appended->GetPointData()->GetArray("point_values"),
+        resultPD->GetPointData()->GetArray("point_values")) ||
+    !CompareArrays(appended->GetCellData()->GetArray("cell_values"),
+        resultPD->GetCellData()->GetArray("cell_values")))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // vtkPVGeometryFilter passes the points and cells of vtkPolyData along, but
+  // creates new ones for other data types, e.g. image data, on every
+  // execution. Update vtkMPIMoveData::GetTopologyInformation() documentation
+  // if this changes.
+  if (!IsTopologyKept(vtkPolyData::SafeDownCast(pieces[2]), "point_values"))
+  {
+    cerr << "ERROR: topology of vtkPolyData modified by re-executing the geometry filter."
+         << endl;
+    return EXIT_FAILURE;
+  }
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(4, 4, 4);
+  vtkNew<vtkDoubleArray> imageValues;
+  imageValues->SetName("image_values");
+  imageValues->SetNumberOfTuples(image->GetNumberOfPoints());
+  imageValues->FillComponent(0, 1.0);
+  image->GetPointData()->AddArray(imageValues.GetPointer());
+  if (IsTopologyKept(image.GetPointer(), "image_values"))
+  {
+    cerr << "ERROR: topology of image data kept by re-executing the geometry filter." << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
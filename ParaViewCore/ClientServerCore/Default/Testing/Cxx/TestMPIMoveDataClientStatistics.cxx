@@ -0,0 +1,200 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMPIMoveDataClientStatistics.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Delivers data from a data-server vtkMPIMoveData to a client one over a
+// socket, with and without compression, and checks the statistics the client
+// reports for the transfer.
+
+#include "vtkCellArray.h"
+#include "vtkDummyController.h"
+#include "vtkMPIMoveData.h"
+#include "vtkMultiThreader.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkServerSocket.h"
+#include "vtkSmartPointer.h"
+#include "vtkSocketController.h"
+
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+const int NUMBER_OF_POINTS = 100 * 100;
+
+// Time the data-server waits before sending, in milliseconds.
+const int SEND_DELAY = 100;
+
+vtkSmartPointer<vtkPolyData> CreateData()
+{
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> verts;
+  for (int cc = 0; cc < NUMBER_OF_POINTS; ++cc)
+  {
+    vtkIdType id = points->InsertNextPoint(cc % 100, cc / 100, 0);
+    verts->InsertNextCell(1, &id);
+  }
+  data->SetPoints(points.GetPointer());
+  data->SetVerts(verts.GetPointer());
+  return data;
+}
+
+int GetFreePort()
+{
+  vtkNew<vtkServerSocket> socket;
+  if (socket->CreateServer(0) != 0)
+  {
+    return -1;
+  }
+  int port = socket->GetServerPort();
+  socket->CloseSocket();
+  return port;
+}
+
+struct DataServerData
+{
+  int Port;
+  vtkPolyData* Input;
+  int Status;
+};
+
+VTK_THREAD_RETURN_TYPE DataServer(void* arg)
+{
+  DataServerData* data =
+    static_cast<DataServerData*>(static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  vtkNew<vtkSocketController> client;
+  data->Status = client->WaitForConnection(data->Port);
+  if (data->Status)
+  {
+    vtkNew<vtkDummyController> controller;
+    vtkNew<vtkMPIMoveData> mover;
+    mover->SetController(controller.GetPointer());
+    mover->SetClientDataServerSocketController(client.GetPointer());
+    mover->SetServerToDataServer();
+    mover->SetMoveModeToCollect();
+    mover->SetInputData(data->Input);
+    vtksys::SystemTools::Delay(SEND_DELAY);
+    mover->Update();
+    if (mover->GetClientReceivedBytes() != 0 || mover->GetClientUncompressedBytes() != 0 ||
+      mover->GetClientReceiveTime() != 0)
+    {
+      cerr << "ERROR: client statistics reported on the data-server." << endl;
+      data->Status = 0;
+    }
+    mover->SetClientDataServerSocketController(NULL);
+    client->CloseConnection();
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Delivers \c input to the client and returns the received and uncompressed
+// bytes reported by the client.
+bool Deliver(vtkPolyData* input, bool compress, vtkIdType& received, vtkIdType& uncompressed)
+{
+  int port = GetFreePort();
+  if (port <= 0)
+  {
+    cerr << "ERROR: no port available." << endl;
+    return false;
+  }
+  vtkMPIMoveData::SetUseZLibCompression(compress);
+
+  DataServerData server;
+  server.Port = port;
+  server.Input = input;
+  server.Status = 0;
+  vtkNew<vtkMultiThreader> threader;
+  int id = threader->SpawnThread(DataServer, &server);
+
+  vtkNew<vtkSocketController> dataServer;
+  bool connected = false;
+  for (int cc = 0; cc < 100 && !connected; ++cc)
+  {
+    connected = dataServer->ConnectTo(const_cast<char*>("localhost"), port) != 0;
+    if (!connected)
+    {
+      vtksys::SystemTools::Delay(50);
+    }
+  }
+  if (!connected)
+  {
+    threader->TerminateThread(id);
+    cerr << "ERROR: connection failed." << endl;
+    return false;
+  }
+
+  vtkNew<vtkDummyController> controller;
+  vtkNew<vtkMPIMoveData> mover;
+  mover->SetController(controller.GetPointer());
+  mover->SetClientDataServerSocketController(dataServer.GetPointer());
+  mover->SetServerToClient();
+  mover->SetMoveModeToCollect();
+  mover->Update();
+  threader->TerminateThread(id);
+  mover->SetClientDataServerSocketController(NULL);
+  vtkMPIMoveData::SetUseZLibCompression(false);
+
+  bool success = server.Status != 0;
+  vtkPolyData* output = vtkPolyData::SafeDownCast(mover->GetOutputDataObject(0));
+  if (!output || output->GetNumberOfPoints() != NUMBER_OF_POINTS ||
+    output->GetNumberOfVerts() != NUMBER_OF_POINTS)
+  {
+    cerr << "ERROR: data not delivered to the client." << endl;
+    success = false;
+  }
+
+  received = mover->GetClientReceivedBytes();
+  uncompressed = mover->GetClientUncompressedBytes();
+  // The client waits for the data-server to send the data.
+  if (mover->GetClientReceiveTime() < 0.5 * SEND_DELAY / 1000.0)
+  {
+    cerr << "ERROR: unexpected receive time " << mover->GetClientReceiveTime() << endl;
+    success = false;
+  }
+  return success;
+}
+}
+
+int TestMPIMoveDataClientStatistics(int, char* [])
+{
+  vtkSocketController::Initialize();
+  vtkSmartPointer<vtkPolyData> input = CreateData();
+
+  vtkIdType received, uncompressed;
+  if (!Deliver(input, false, received, uncompressed))
+  {
+    return EXIT_FAILURE;
+  }
+  if (received <= 0 || uncompressed != received)
+  {
+    cerr << "ERROR: without compression, received " << received << " bytes for " << uncompressed
+         << " uncompressed bytes." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // The uncompressed size is read from the header of the compressed buffers.
+  vtkIdType compressed_received, compressed_uncompressed;
+  if (!Deliver(input, true, compressed_received, compressed_uncompressed))
+  {
+    return EXIT_FAILURE;
+  }
+  if (compressed_uncompressed != uncompressed || compressed_received >= uncompressed)
+  {
+    cerr << "ERROR: with compression, received " << compressed_received << " bytes for "
+         << compressed_uncompressed << " uncompressed bytes instead of " << uncompressed << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVDataSizeInformation.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Checks that vtkPVDataSizeInformation counts arrays shallow copied among
+// blocks once, reports the arrays also referenced outside of the data as
+// shared, and merges and serializes its values.
+
+#include "vtkCellArray.h"
+#include "vtkClientServerStream.h"
+#include "vtkDoubleArray.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPVDataSizeInformation.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTrivialProducer.h"
+
+namespace
+{
+const vtkIdType NUMBER_OF_POINTS = 10000;
+
+// No other object references the arrays of the returned data.
+vtkSmartPointer<vtkPolyData> CreateData()
+{
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkDoubleArray> values;
+  values->SetName("Values");
+  values->SetNumberOfTuples(NUMBER_OF_POINTS);
+  for (vtkIdType cc = 0; cc < NUMBER_OF_POINTS; ++cc)
+  {
+    points->InsertNextPoint(cc % 100, cc / 100, 0);
+    values->SetValue(cc, cc);
+  }
+  for (vtkIdType cc = 0; cc + 2 < NUMBER_OF_POINTS; cc += 2)
+  {
+    vtkIdType ids[3] = { cc, cc + 1, cc + 2 };
+    polys->InsertNextCell(3, ids);
+  }
+  data->SetPoints(points.GetPointer());
+  data->SetPolys(polys.GetPointer());
+  data->GetPointData()->AddArray(values.GetPointer());
+  return data;
+}
+
+int GetExpectedSize(vtkPolyData* data)
+{
+  return static_cast<int>(data->GetPoints()->GetData()->GetActualMemorySize() +
+    data->GetPolys()->GetData()->GetActualMemorySize() +
+    data->GetPointData()->GetArray("Values")->GetActualMemorySize());
+}
+
+bool Check(vtkPVDataSizeInformation* info, int memorySize, int sharedMemorySize, const char* what)
+{
+  if (info->GetMemorySize() != memorySize || info->GetSharedMemorySize() != sharedMemorySize)
+  {
+    cerr << "ERROR: " << what << ": " << info->GetMemorySize() << " KBs with "
+         << info->GetSharedMemorySize() << " KBs shared instead of " << memorySize << " KBs with "
+         << sharedMemorySize << " KBs shared." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestPVDataSizeInformation(int, char* [])
+{
+  bool success = true;
+  vtkSmartPointer<vtkPolyData> data = CreateData();
+  const int size = GetExpectedSize(data);
+  if (size <= 0)
+  {
+    cerr << "ERROR: unexpected data size " << size << endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkPVDataSizeInformation> info;
+  info->CopyFromObject(data);
+  success &= Check(info.GetPointer(), size, 0, "single block");
+
+  // The same block twice, as the output of an algorithm.
+  vtkNew<vtkMultiBlockDataSet> sameBlocks;
+  sameBlocks->SetBlock(0, data);
+  sameBlocks->SetBlock(1, data);
+  vtkNew<vtkTrivialProducer> producer;
+  producer->SetOutput(sameBlocks.GetPointer());
+  info->CopyFromObject(producer.GetPointer());
+  success &= Check(info.GetPointer(), size, 0, "same block twice");
+
+  // A shallow copy shares all of the arrays: they are counted once, and are
+  // shared only when the copy is not accounted for.
+  vtkNew<vtkPolyData> copy;
+  copy->ShallowCopy(data);
+  info->CopyFromObject(data);
+  success &= Check(info.GetPointer(), size, size, "shallow copied block");
+
+  vtkNew<vtkMultiBlockDataSet> copiedBlocks;
+  copiedBlocks->SetBlock(0, data);
+  copiedBlocks->SetBlock(1, copy.GetPointer());
+  info->CopyFromObject(copiedBlocks.GetPointer());
+  success &= Check(info.GetPointer(), size, 0, "block and its shallow copy");
+
+  // Only the values are shared with a new block.
+  vtkSmartPointer<vtkPolyData> other = CreateData();
+  other->GetPointData()->AddArray(data->GetPointData()->GetArray("Values"));
+  const int valuesSize =
+    static_cast<int>(data->GetPointData()->GetArray("Values")->GetActualMemorySize());
+  vtkNew<vtkMultiBlockDataSet> blocks;
+  blocks->SetBlock(0, other);
+  blocks->SetBlock(1, CreateData());
+  info->CopyFromObject(blocks.GetPointer());
+  success &= Check(info.GetPointer(), 2 * size, valuesSize, "blocks sharing an array");
+
+  // Merging as from several processes, and serialization.
+  vtkNew<vtkPVDataSizeInformation> single;
+  single->CopyFromObject(data);
+  info->AddInformation(single.GetPointer());
+  success &= Check(info.GetPointer(), 3 * size, valuesSize + size, "merged information");
+  if (info->GetMaximumMemorySize() != 2 * size)
+  {
+    cerr << "ERROR: maximum memory size " << info->GetMaximumMemorySize() << " instead of "
+         << 2 * size << endl;
+    success = false;
+  }
+
+  vtkClientServerStream stream;
+  info->CopyToStream(&stream);
+  vtkNew<vtkPVDataSizeInformation> received;
+  received->CopyFromStream(&stream);
+  success &= Check(received.GetPointer(), 3 * size, valuesSize + size, "serialized information");
+  if (received->GetMaximumMemorySize() != 2 * size)
+  {
+    cerr << "ERROR: maximum memory size not serialized." << endl;
+    success = false;
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -15,6 +15,8 @@
 #include "vtkPythonCalculator.h"
 
 #include "vtkCellData.h"
+#include "vtkCompositeDataIterator.h"
+#include "vtkCompositeDataSet.h"
 #include "vtkDataArray.h"
 #include "vtkDataObject.h"
 #include "vtkDataObjectTypes.h"
@@ -24,8 +26,11 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVOptions.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
 #include "vtkProcessModule.h"
 #include "vtkPythonInterpreter.h"
+#include "vtkSmartPointer.h"
 
 #include <algorithm>
 #include <map>
@@ -33,6 +38,28 @@
 #include <string>
 #include <vtksys/SystemTools.hxx>
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Returns the array of a leaf that is gathered/scattered, or the points when
+// name is NULL.
+vtkDataArray* vtkGetLeafArray(vtkDataObject* dobj, int association, const char* name)
+{
+  vtkDataSet* ds = vtkDataSet::SafeDownCast(dobj);
+  if (!ds)
+  {
+    return NULL;
+  }
+  if (!name)
+  {
+    vtkPointSet* ps = vtkPointSet::SafeDownCast(ds);
+    return ps && ps->GetPoints() ? ps->GetPoints()->GetData() : NULL;
+  }
+  vtkDataSetAttributes* dsa = ds->GetAttributes(association);
+  return dsa ? dsa->GetArray(name) : NULL;
+}
+}
+
 vtkStandardNewMacro(vtkPythonCalculator);
 
 //----------------------------------------------------------------------------
@@ -43,6 +70,7 @@ vtkPythonCalculator::vtkPythonCalculator()
   this->SetArrayName("result");
   this->SetExecuteMethod(vtkPythonCalculator::ExecuteScript, this);
   this->ArrayAssociation = vtkDataObject::FIELD_ASSOCIATION_POINTS;
+  this->ConcatenateBlocks = false;
 }
 
 //----------------------------------------------------------------------------
@@ -140,6 +168,110 @@ void vtkPythonCalculator::Exec(const char* expression)
   vtkPythonInterpreter::RunSimpleString(python_stream.str().c_str());
 }
 
+//----------------------------------------------------------------------------
+vtkDataArray* vtkPythonCalculator::GatherArray(
+  vtkCompositeDataSet* input, int association, const char* name)
+{
+  if (!input || (association != vtkDataObject::FIELD_ASSOCIATION_POINTS &&
+                  association != vtkDataObject::FIELD_ASSOCIATION_CELLS))
+  {
+    return NULL;
+  }
+
+  // Validate the arrays and count the tuples first so that the result is
+  // allocated only once.
+  vtkDataArray* first = NULL;
+  vtkIdType numTuples = 0;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(input->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataArray* array = vtkGetLeafArray(iter->GetCurrentDataObject(), association, name);
+    if (!array)
+    {
+      return NULL;
+    }
+    if (!first)
+    {
+      first = array;
+    }
+    else if (array->GetDataType() != first->GetDataType() ||
+      array->GetNumberOfComponents() != first->GetNumberOfComponents())
+    {
+      return NULL;
+    }
+    numTuples += array->GetNumberOfTuples();
+  }
+  if (!first)
+  {
+    return NULL;
+  }
+
+  vtkDataArray* result = first->NewInstance();
+  result->SetName(first->GetName());
+  result->SetNumberOfComponents(first->GetNumberOfComponents());
+  result->SetNumberOfTuples(numTuples);
+  vtkIdType offset = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataArray* array = vtkGetLeafArray(iter->GetCurrentDataObject(), association, name);
+    const vtkIdType count = array->GetNumberOfTuples();
+    if (count > 0)
+    {
+      result->InsertTuples(offset, count, 0, array);
+    }
+    offset += count;
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPythonCalculator::ScatterArray(
+  vtkDataArray* array, vtkCompositeDataSet* output, int association, const char* name)
+{
+  if (!array || !output || (association != vtkDataObject::FIELD_ASSOCIATION_POINTS &&
+                             association != vtkDataObject::FIELD_ASSOCIATION_CELLS))
+  {
+    return false;
+  }
+
+  vtkIdType numTuples = 0;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(output->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataSet* ds = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+    if (!ds)
+    {
+      return false;
+    }
+    numTuples += ds->GetNumberOfElements(association);
+  }
+  if (numTuples != array->GetNumberOfTuples())
+  {
+    return false;
+  }
+
+  vtkIdType offset = 0;
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataSet* ds = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+    const vtkIdType count = ds->GetNumberOfElements(association);
+    vtkSmartPointer<vtkDataArray> piece;
+    piece.TakeReference(array->NewInstance());
+    piece->SetName(name);
+    piece->SetNumberOfComponents(array->GetNumberOfComponents());
+    piece->SetNumberOfTuples(count);
+    if (count > 0)
+    {
+      piece->InsertTuples(0, count, offset, array);
+    }
+    ds->GetAttributes(association)->AddArray(piece);
+    offset += count;
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkPythonCalculator::FillOutputPortInformation(int vtkNotUsed(port), vtkInformation* info)
 {
@@ -169,4 +301,5 @@ int vtkPythonCalculator::FillInputPortInformation(int port, vtkInformation* info
 void vtkPythonCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "ConcatenateBlocks: " << this->ConcatenateBlocks << endl;
 }
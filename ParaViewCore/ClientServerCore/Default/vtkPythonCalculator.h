@@ -28,6 +28,11 @@
  * valid Python variable, it has to be accessed through a dictionary called
  * arrays (i.e. arrays['array_name']). The points can be accessed using the
  * points variable.
+ *
+ * For composite datasets, element-wise expressions can be evaluated once over
+ * the arrays of all the blocks concatenated together, instead of once per
+ * block, with the result split back into the blocks. See
+ * SetConcatenateBlocks().
 */
 
 #ifndef vtkPythonCalculator_h
@@ -36,6 +41,9 @@
 #include "vtkPVClientServerCoreDefaultModule.h" //needed for exports
 #include "vtkProgrammableFilter.h"
 
+class vtkCompositeDataSet;
+class vtkDataArray;
+
 class VTKPVCLIENTSERVERCOREDEFAULT_EXPORT vtkPythonCalculator : public vtkProgrammableFilter
 {
 public:
@@ -53,6 +61,42 @@ public:
   vtkGetMacro(ArrayAssociation, int);
   //@}
 
+  //@{
+  /**
+   * When on, element-wise expressions are evaluated once for a composite
+   * dataset, using the arrays of all the blocks concatenated together, rather
+   * than once per block. This avoids the Python overhead of looping over the
+   * blocks, which dominates for datasets with many small blocks such as AMR.
+   * Only expressions made of arithmetic, comparisons and element-wise
+   * functions (sin, sqrt, mag, ...) of arrays and numbers are concatenated;
+   * others, e.g. indexing arrays or using reductions, gradient() or volume(),
+   * and those using arrays missing on some blocks, are evaluated per block.
+   * The default is off.
+   */
+  vtkSetMacro(ConcatenateBlocks, bool);
+  vtkGetMacro(ConcatenateBlocks, bool);
+  vtkBooleanMacro(ConcatenateBlocks, bool);
+  //@}
+
+  /**
+   * For internal use only. Returns a new array with the arrays named \c name
+   * (or the points, if \c name is NULL) of all the leaves of \c input
+   * concatenated in traversal order. Returns NULL if there are no leaves, if a
+   * leaf is not a vtkDataSet or does not have the array, or if the arrays
+   * differ in type or number of components.
+   */
+  VTK_NEWINSTANCE
+  static vtkDataArray* GatherArray(vtkCompositeDataSet* input, int association, const char* name);
+
+  /**
+   * For internal use only. Splits \c array, which must have a tuple for each
+   * point (or cell) of all the leaves of \c output, and adds the pieces to the
+   * leaves as arrays named \c name. Returns false if the number of tuples does
+   * not match.
+   */
+  static bool ScatterArray(
+    vtkDataArray* array, vtkCompositeDataSet* output, int association, const char* name);
+
   //@{
   /**
    * Set the text of the python expression to execute. This expression
@@ -96,6 +140,7 @@ protected:
   char* Expression;
   char* ArrayName;
   int ArrayAssociation;
+  bool ConcatenateBlocks;
 
 private:
   vtkPythonCalculator(const vtkPythonCalculator&) = delete;
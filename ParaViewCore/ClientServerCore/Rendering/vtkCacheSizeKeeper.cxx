@@ -17,6 +17,8 @@
 #include "vtkObjectFactory.h"
 #include "vtkSmartPointer.h"
 
+#include <vtksys/SystemInformation.hxx>
+
 //----------------------------------------------------------------------------
 // Can't use vtkStandardNewMacro since it adds the instantiator function which
 // does not compile since vtkClientServerInterpreterInitializer::New() is
@@ -50,6 +52,7 @@ vtkCacheSizeKeeper::vtkCacheSizeKeeper()
   this->CacheSize = 0;
   this->CacheFull = 0;
   this->CacheLimit = 100 * 1024; // 100 MBs.
+  this->MemoryBudget = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -57,6 +60,29 @@ vtkCacheSizeKeeper::~vtkCacheSizeKeeper()
 {
 }
 
+//-----------------------------------------------------------------------------
+bool vtkCacheSizeKeeper::IsOverMemoryBudget()
+{
+  if (this->MemoryBudget == 0)
+  {
+    return false;
+  }
+  vtksys::SystemInformation sysinfo;
+  long long used = sysinfo.GetProcMemoryUsed();
+  return used > 0 && static_cast<unsigned long long>(used) > this->MemoryBudget;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCacheSizeKeeper::EvictCaches()
+{
+  if (this->CacheSize > 0)
+  {
+    vtkWarningMacro("Memory budget of " << this->MemoryBudget << " KBs exceeded. Releasing "
+                                        << this->CacheSize << " KBs of cached data.");
+  }
+  this->InvokeEvent(EvictCachesEvent);
+}
+
 //-----------------------------------------------------------------------------
 void vtkCacheSizeKeeper::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -64,4 +90,5 @@ void vtkCacheSizeKeeper::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "CacheSize: " << this->CacheSize << endl;
   os << indent << "CacheFull: " << this->CacheFull << endl;
   os << indent << "CacheLimit: " << this->CacheLimit << endl;
+  os << indent << "MemoryBudget: " << this->MemoryBudget << endl;
 }
@@ -19,11 +19,20 @@
  *
  * vtkCacheSizeKeeper keeps track of the amount of memory cached
  * by several vtkPVUpdateSuppressor objects.
+ *
+ * Besides the cache size limit, one can set a MemoryBudget for the whole
+ * process. When the memory used by any of the participating processes exceeds
+ * it, vtkPVView::Update calls EvictCaches() on all of them, which makes every
+ * vtkPVCacheKeeper, i.e. the geometry cached by representations for animation
+ * playback, release its data, and the cache is marked full. Only these caches
+ * are released: memory held by pipeline outputs or by other parts of the
+ * process is not affected by the budget.
 */
 
 #ifndef vtkCacheSizeKeeper_h
 #define vtkCacheSizeKeeper_h
 
+#include "vtkCommand.h" // needed for vtkCommand::UserEvent
 #include "vtkObject.h"
 #include "vtkPVClientServerCoreRenderingModule.h" //needed for exports
 
@@ -88,6 +97,34 @@ public:
   vtkSetMacro(CacheFull, int);
   //@}
 
+  //@{
+  /**
+   * Get/Set the memory budget for the process (in KBs) above which the
+   * animation caches are released. Must be set to the same value on all
+   * processes, since vtkPVView::Update uses it to decide whether to
+   * synchronize the memory state. 0 (default) disables the budget.
+   */
+  vtkGetMacro(MemoryBudget, unsigned long);
+  vtkSetMacro(MemoryBudget, unsigned long);
+  //@}
+
+  /**
+   * Returns true if a memory budget is set and the memory currently used by
+   * this process exceeds it.
+   */
+  bool IsOverMemoryBudget();
+
+  /**
+   * Fires EvictCachesEvent, making all caches reporting to this keeper release
+   * their data.
+   */
+  void EvictCaches();
+
+  enum
+  {
+    EvictCachesEvent = vtkCommand::UserEvent + 1
+  };
+
 protected:
   static vtkCacheSizeKeeper* New();
   vtkCacheSizeKeeper();
@@ -96,6 +133,7 @@ protected:
   unsigned long CacheSize;
   unsigned long CacheLimit;
   int CacheFull;
+  unsigned long MemoryBudget;
 
 private:
   vtkCacheSizeKeeper(const vtkCacheSizeKeeper&) = delete;
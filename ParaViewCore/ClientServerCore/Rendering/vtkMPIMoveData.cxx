@@ -14,24 +14,29 @@
 =========================================================================*/
 #include "vtkMPIMoveData.h"
 
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCharArray.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkDataSetReader.h"
 #include "vtkDirectedGraph.h"
+#include "vtkFieldData.h"
 #include "vtkGenericDataObjectReader.h"
 #include "vtkGenericDataObjectWriter.h"
 #include "vtkGraphReader.h"
 #include "vtkGraphWriter.h"
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkMPIMToNSocketConnection.h"
 #include "vtkMolecule.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiProcessController.h"
 #include "vtkMultiProcessControllerHelper.h"
+#include "vtkNew.h"
 #include "vtkNonOverlappingAMR.h"
 #include "vtkObjectFactory.h"
 #include "vtkOutlineFilter.h"
@@ -39,12 +44,14 @@
 #include "vtkPVConfig.h"
 #include "vtkPVSession.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkProcessModule.h"
 #include "vtkSmartPointer.h"
 #include "vtkSocketCommunicator.h"
 #include "vtkSocketController.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkStringArray.h"
 #include "vtkStructuredGrid.h"
 #include "vtkTimerLog.h"
 #include "vtkToolkits.h"
@@ -52,6 +59,8 @@
 #include "vtkUnstructuredGrid.h"
 
 #include "vtk_zlib.h"
+#include <algorithm>
+#include <map>
 #include <sstream>
 #include <vector>
 
@@ -66,6 +75,24 @@ bool vtkMPIMoveData::UseZLibCompression = false;
 
 namespace
 {
+// Returns true if the sender compressed the buffer with zlib, in which case
+// \c uncompressed_length is set from the buffer header (see
+// MarshalDataToBuffer()).
+bool vtkMPIMoveDataIsCompressed(
+  const char* buffer, vtkIdType length, vtkIdType& uncompressed_length)
+{
+  if (length < 8 || strncmp(buffer, "zlib", 4) != 0)
+  {
+    return false;
+  }
+  uncompressed_length = 0;
+  for (int cc = 0; cc < 4; cc++)
+  {
+    uncompressed_length = uncompressed_length | ((0xff & (buffer[4 + cc])) << 8 * cc);
+  }
+  return true;
+}
+
 bool vtkMPIMoveDataMerge(
   std::vector<vtkSmartPointer<vtkDataObject> >& pieces, vtkDataObject* result)
 {
@@ -96,6 +123,244 @@ void unsetGlobalIdsAttribute(vtkDataObject* piece)
     it->Delete();
   }
 }
+
+// Field data arrays used to describe an attribute carrier (see
+// vtkMPIMoveData::NewAttributeCarrier()).
+// Layout has 6 components per leaf: flat index, number of points, number of
+// verts, lines, polys and strips.
+const char* const CARRIER_LAYOUT = "__vtkMPIMoveData_AttributeLayout__";
+// All arrays in the data, sent or not, in order.
+const char* const CARRIER_KEYS = "__vtkMPIMoveData_AttributeKeys__";
+// Attribute type (or -1) for each entry in CARRIER_KEYS.
+const char* const CARRIER_ATTRIBUTE_TYPES = "__vtkMPIMoveData_AttributeTypes__";
+
+std::string vtkMPIMoveDataMakeKey(char association, unsigned int flat_index, const char* name)
+{
+  std::ostringstream key;
+  key << association << flat_index << ":" << name;
+  return key.str();
+}
+
+bool vtkMPIMoveDataSplitKey(
+  const std::string& key, char& association, unsigned int& flat_index, std::string& name)
+{
+  std::string::size_type pos = key.find(':');
+  if (key.size() < 3 || pos == std::string::npos)
+  {
+    return false;
+  }
+  association = key[0];
+  flat_index = static_cast<unsigned int>(atoi(key.substr(1, pos - 1).c_str()));
+  name = key.substr(pos + 1);
+  return true;
+}
+
+typedef std::vector<std::pair<unsigned int, vtkPolyData*> > vtkMPIMoveDataLeaves;
+
+// Collects the vtkPolyData leaves along with their flat indices. Returns false
+// if the data is not a vtkPolyData or a vtkMultiBlockDataSet of vtkPolyData.
+bool vtkMPIMoveDataGetLeaves(vtkDataObject* data, vtkMPIMoveDataLeaves& leaves)
+{
+  if (vtkPolyData* pd = vtkPolyData::SafeDownCast(data))
+  {
+    leaves.push_back(std::make_pair(0u, pd));
+    return true;
+  }
+  vtkMultiBlockDataSet* mb = vtkMultiBlockDataSet::SafeDownCast(data);
+  if (mb == NULL)
+  {
+    return false;
+  }
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(mb->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkPolyData* leaf = vtkPolyData::SafeDownCast(iter->GetCurrentDataObject());
+    if (leaf == NULL)
+    {
+      return false;
+    }
+    leaves.push_back(std::make_pair(iter->GetCurrentFlatIndex(), leaf));
+  }
+  return true;
+}
+
+vtkMTimeType vtkMPIMoveDataGetMTime(vtkObject* obj)
+{
+  return obj ? obj->GetMTime() : 0;
+}
+
+// Modification time of the arrays in the field data. The vtkFieldData itself
+// is modified by every ShallowCopy() along the pipeline, even when it ends up
+// holding the same arrays, so its own time is not used. The number of arrays
+// is added to \c numArrays to detect removed ones.
+vtkMTimeType vtkMPIMoveDataGetFieldDataMTime(vtkFieldData* fd, vtkIdType& numArrays)
+{
+  vtkMTimeType mtime = 0;
+  int count = fd ? fd->GetNumberOfArrays() : 0;
+  for (int cc = 0; cc < count; ++cc)
+  {
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(fd->GetAbstractArray(cc)));
+  }
+  numArrays += count;
+  return mtime;
+}
+
+// Number of points followed by number of verts, lines, polys and strips.
+void vtkMPIMoveDataGetCounts(vtkPolyData* pd, vtkIdType counts[5])
+{
+  counts[0] = pd->GetNumberOfPoints();
+  counts[1] = pd->GetNumberOfVerts();
+  counts[2] = pd->GetNumberOfLines();
+  counts[3] = pd->GetNumberOfPolys();
+  counts[4] = pd->GetNumberOfStrips();
+}
+
+// Merges attribute carriers from several processes in the same order that
+// vtkMultiProcessControllerHelper::MergePieces() would have appended the data
+// i.e. points from non-empty pieces in order, and cells grouped by cell type
+// (verts, lines, polys and strips) as vtkAppendPolyData does. This must stay
+// in sync with vtkAppendPolyData::ExecuteAppend(), which
+// TestMPIMoveDataAttributeCarriers checks.
+bool vtkMPIMoveDataMergeAttributeCarriers(
+  std::vector<vtkSmartPointer<vtkDataObject> >& pieces, vtkDataObject* result)
+{
+  if (pieces.size() == 0)
+  {
+    return false;
+  }
+  if (pieces.size() == 1)
+  {
+    result->ShallowCopy(pieces[0]);
+    return true;
+  }
+
+  typedef std::map<unsigned int, const vtkIdType*> LayoutType;
+  std::vector<LayoutType> layouts(pieces.size());
+  vtkFieldData* reference = NULL;
+  for (size_t cc = 0; cc < pieces.size(); ++cc)
+  {
+    vtkFieldData* fd = pieces[cc]->GetFieldData();
+    vtkIdTypeArray* layout = vtkIdTypeArray::SafeDownCast(fd->GetAbstractArray(CARRIER_LAYOUT));
+    if (layout == NULL || layout->GetNumberOfComponents() != 6)
+    {
+      vtkGenericWarningMacro("Invalid attribute carrier.");
+      return false;
+    }
+    bool has_points = false;
+    for (vtkIdType leaf = 0; leaf < layout->GetNumberOfTuples(); ++leaf)
+    {
+      const vtkIdType* tuple = layout->GetPointer(6 * leaf);
+      layouts[cc][static_cast<unsigned int>(tuple[0])] = tuple;
+      has_points |= (tuple[1] > 0);
+    }
+    if (reference == NULL && has_points)
+    {
+      reference = fd;
+    }
+  }
+  if (reference == NULL)
+  {
+    // all pieces are empty.
+    result->ShallowCopy(pieces[0]);
+    return true;
+  }
+
+  vtkNew<vtkFieldData> merged;
+
+  // Merged layout, summed over all pieces.
+  std::map<unsigned int, std::vector<vtkIdType> > totals;
+  for (size_t cc = 0; cc < pieces.size(); ++cc)
+  {
+    for (LayoutType::iterator iter = layouts[cc].begin(); iter != layouts[cc].end(); ++iter)
+    {
+      std::vector<vtkIdType>& total = totals[iter->first];
+      total.resize(5, 0);
+      for (int kk = 0; kk < 5; ++kk)
+      {
+        total[kk] += iter->second[kk + 1];
+      }
+    }
+  }
+  vtkNew<vtkIdTypeArray> layout;
+  layout->SetName(CARRIER_LAYOUT);
+  layout->SetNumberOfComponents(6);
+  for (std::map<unsigned int, std::vector<vtkIdType> >::iterator iter = totals.begin();
+       iter != totals.end(); ++iter)
+  {
+    layout->InsertNextValue(iter->first);
+    for (int kk = 0; kk < 5; ++kk)
+    {
+      layout->InsertNextValue(iter->second[kk]);
+    }
+  }
+  merged->AddArray(layout.GetPointer());
+  merged->AddArray(reference->GetAbstractArray(CARRIER_KEYS));
+  merged->AddArray(reference->GetAbstractArray(CARRIER_ATTRIBUTE_TYPES));
+
+  for (int arrayIdx = 0; arrayIdx < reference->GetNumberOfArrays(); ++arrayIdx)
+  {
+    vtkAbstractArray* refArray = reference->GetAbstractArray(arrayIdx);
+    const std::string key = refArray->GetName() ? refArray->GetName() : "";
+    char association;
+    unsigned int flat_index;
+    std::string name;
+    if (key == CARRIER_LAYOUT || key == CARRIER_KEYS || key == CARRIER_ATTRIBUTE_TYPES ||
+      !vtkMPIMoveDataSplitKey(key, association, flat_index, name))
+    {
+      continue;
+    }
+
+    vtkSmartPointer<vtkAbstractArray> array;
+    array.TakeReference(refArray->NewInstance());
+    array->SetName(key.c_str());
+    array->SetNumberOfComponents(refArray->GetNumberOfComponents());
+
+    // for points, there's a single block per piece; for cells, there's a block
+    // per cell type per piece.
+    const int numBlocks = association == 'P' ? 1 : 4;
+    for (int block = 0; block < numBlocks; ++block)
+    {
+      for (size_t cc = 0; cc < pieces.size(); ++cc)
+      {
+        LayoutType::iterator liter = layouts[cc].find(flat_index);
+        if (liter == layouts[cc].end() || liter->second[1] == 0)
+        {
+          // empty pieces are skipped when appending.
+          continue;
+        }
+        const vtkIdType* counts = liter->second + 1;
+        vtkIdType numTuples = association == 'P' ? counts[0] : counts[block + 1];
+        vtkIdType offset = 0;
+        for (int kk = 0; association != 'P' && kk < block; ++kk)
+        {
+          offset += counts[kk + 1];
+        }
+        if (numTuples == 0)
+        {
+          continue;
+        }
+        vtkAbstractArray* source = pieces[cc]->GetFieldData()->GetAbstractArray(key.c_str());
+        if (source == NULL || source->GetNumberOfTuples() < offset + numTuples)
+        {
+          vtkGenericWarningMacro("Mismatched attribute carriers for '" << key << "'.");
+          return false;
+        }
+        array->InsertTuples(array->GetNumberOfTuples(), numTuples, offset, source);
+      }
+    }
+    merged->AddArray(array);
+  }
+
+  vtkPolyData* output = vtkPolyData::SafeDownCast(result);
+  if (output == NULL)
+  {
+    return false;
+  }
+  output->Initialize();
+  output->SetFieldData(merged.GetPointer());
+  return true;
+}
 };
 
 vtkStandardNewMacro(vtkMPIMoveData);
@@ -132,6 +397,12 @@ vtkMPIMoveData::vtkMPIMoveData()
   this->UpdatePiece = 0;
 
   this->SkipDataServerGatherToZero = false;
+
+  this->ClientReceivedBytes = 0;
+  this->ClientUncompressedBytes = 0;
+  this->ClientReceiveTime = 0.0;
+
+  this->DeliverAttributesOnly = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -389,6 +660,10 @@ int vtkMPIMoveData::RequestData(
     }
   }
 
+  this->ClientReceivedBytes = 0;
+  this->ClientUncompressedBytes = 0;
+  this->ClientReceiveTime = 0.0;
+
   this->UpdatePiece = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_PIECE_NUMBER());
   this->UpdateNumberOfPieces =
     outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_NUMBER_OF_PIECES());
@@ -929,6 +1204,7 @@ void vtkMPIMoveData::ClientReceiveFromDataServer(vtkDataObject* output)
   }
 
   this->ClearBuffer();
+  double start_time = vtkTimerLog::GetUniversalTime();
   com->Receive(&(this->NumberOfBuffers), 1, 1, 23490);
   this->BufferLengths = new vtkIdType[this->NumberOfBuffers];
   com->Receive(this->BufferLengths, this->NumberOfBuffers, 1, 23491);
@@ -942,6 +1218,21 @@ void vtkMPIMoveData::ClientReceiveFromDataServer(vtkDataObject* output)
   }
   this->Buffers = new char[this->BufferTotalLength];
   com->Receive(this->Buffers, this->BufferTotalLength, 1, 23492);
+
+  // Keep track of the transfer so that the delivery manager can estimate the
+  // cost of subsequent deliveries. This excludes decompressing and
+  // unmarshaling the data, which happen on the client after the transfer.
+  this->ClientReceiveTime = vtkTimerLog::GetUniversalTime() - start_time;
+  this->ClientReceivedBytes = this->BufferTotalLength;
+  this->ClientUncompressedBytes = 0;
+  for (int idx = 0; idx < this->NumberOfBuffers; ++idx)
+  {
+    vtkIdType bufferLength = this->BufferLengths[idx];
+    vtkMPIMoveDataIsCompressed(
+      this->Buffers + this->BufferOffsets[idx], bufferLength, bufferLength);
+    this->ClientUncompressedBytes += bufferLength;
+  }
+
   this->ReconstructDataFromBuffer(output);
   this->ClearBuffer();
 }
@@ -1123,17 +1414,12 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
     vtkIdType bufferLength = this->BufferLengths[idx];
 
     char* realBuffer = 0;
-    if (bufferLength > 4 && strncmp(bufferArray, "zlib", 4) == 0)
+    vtkIdType uncompressed_length = 0;
+    if (vtkMPIMoveDataIsCompressed(bufferArray, bufferLength, uncompressed_length))
     {
       // sender used zlib compression. Decompress it.
       vtkIdType compressed_length = bufferLength - 8; // remove the zlib header.
-      vtkIdType uncompressed_length = 0;
-      for (int cc = 0; cc < 4; cc++)
-      {
-        uncompressed_length = uncompressed_length | ((0xff & (bufferArray[4 + cc])) << 8 * cc);
-      }
 
-      // using zlib compression.
       realBuffer = new char[uncompressed_length];
       uLongf destLen = uncompressed_length;
       vtkTimerLog::MarkStartEvent("Zlib uncompress");
@@ -1196,7 +1482,282 @@ void vtkMPIMoveData::ReconstructDataFromBuffer(vtkDataObject* data)
     realBuffer = 0;
   }
 
-  vtkMPIMoveDataMerge(pieces, data);
+  if (this->DeliverAttributesOnly)
+  {
+    vtkMPIMoveData::MergeAttributeCarriers(pieces, data);
+  }
+  else
+  {
+    vtkMPIMoveDataMerge(pieces, data);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMPIMoveData::GetAttributeArrays(
+  vtkDataObject* data, std::vector<std::string>& keys, std::vector<vtkAbstractArray*>& arrays)
+{
+  vtkMPIMoveDataLeaves leaves;
+  if (!vtkMPIMoveDataGetLeaves(data, leaves))
+  {
+    return false;
+  }
+
+  for (vtkMPIMoveDataLeaves::iterator iter = leaves.begin(); iter != leaves.end(); ++iter)
+  {
+    vtkDataSetAttributes* dsas[2] = { iter->second->GetPointData(), iter->second->GetCellData() };
+    const char associations[2] = { 'P', 'C' };
+    for (int cc = 0; cc < 2; ++cc)
+    {
+      for (int idx = 0; idx < dsas[cc]->GetNumberOfArrays(); ++idx)
+      {
+        vtkAbstractArray* array = dsas[cc]->GetAbstractArray(idx);
+        if (array == NULL || array->GetName() == NULL || array->GetName()[0] == '\0')
+        {
+          return false;
+        }
+        keys.push_back(vtkMPIMoveDataMakeKey(associations[cc], iter->first, array->GetName()));
+        arrays.push_back(array);
+      }
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMPIMoveData::GetTopologyInformation(
+  vtkDataObject* data, vtkMTimeType& mtime, std::vector<vtkIdType>& signature)
+{
+  vtkMPIMoveDataLeaves leaves;
+  if (!vtkMPIMoveDataGetLeaves(data, leaves))
+  {
+    return false;
+  }
+
+  vtkIdType numFieldArrays = 0;
+  mtime = vtkMPIMoveDataGetFieldDataMTime(data->GetFieldData(), numFieldArrays);
+  signature.clear();
+  for (vtkMPIMoveDataLeaves::iterator iter = leaves.begin(); iter != leaves.end(); ++iter)
+  {
+    vtkPolyData* pd = iter->second;
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(pd->GetPoints()));
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(pd->GetVerts()));
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(pd->GetLines()));
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(pd->GetPolys()));
+    mtime = std::max(mtime, vtkMPIMoveDataGetMTime(pd->GetStrips()));
+    if (pd != data)
+    {
+      mtime =
+        std::max(mtime, vtkMPIMoveDataGetFieldDataMTime(pd->GetFieldData(), numFieldArrays));
+    }
+    signature.push_back(static_cast<vtkIdType>(iter->first));
+    signature.push_back(pd->GetNumberOfPoints());
+    signature.push_back(pd->GetNumberOfCells());
+  }
+  signature.push_back(numFieldArrays);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkPolyData* vtkMPIMoveData::NewAttributeCarrier(
+  vtkDataObject* data, const std::set<std::string>& keys_to_send)
+{
+  vtkMPIMoveDataLeaves leaves;
+  if (!vtkMPIMoveDataGetLeaves(data, leaves))
+  {
+    return NULL;
+  }
+
+  vtkPolyData* carrier = vtkPolyData::New();
+  vtkFieldData* fd = carrier->GetFieldData();
+
+  vtkNew<vtkIdTypeArray> layout;
+  layout->SetName(CARRIER_LAYOUT);
+  layout->SetNumberOfComponents(6);
+  vtkNew<vtkStringArray> keys;
+  keys->SetName(CARRIER_KEYS);
+  vtkNew<vtkIntArray> types;
+  types->SetName(CARRIER_ATTRIBUTE_TYPES);
+
+  for (vtkMPIMoveDataLeaves::iterator iter = leaves.begin(); iter != leaves.end(); ++iter)
+  {
+    vtkIdType counts[5];
+    vtkMPIMoveDataGetCounts(iter->second, counts);
+    layout->InsertNextValue(static_cast<vtkIdType>(iter->first));
+    for (int kk = 0; kk < 5; ++kk)
+    {
+      layout->InsertNextValue(counts[kk]);
+    }
+
+    vtkDataSetAttributes* dsas[2] = { iter->second->GetPointData(), iter->second->GetCellData() };
+    const char associations[2] = { 'P', 'C' };
+    for (int cc = 0; cc < 2; ++cc)
+    {
+      for (int idx = 0; idx < dsas[cc]->GetNumberOfArrays(); ++idx)
+      {
+        vtkAbstractArray* array = dsas[cc]->GetAbstractArray(idx);
+        if (array == NULL || array->GetName() == NULL)
+        {
+          continue;
+        }
+        std::string key = vtkMPIMoveDataMakeKey(associations[cc], iter->first, array->GetName());
+        keys->InsertNextValue(key);
+        types->InsertNextValue(dsas[cc]->IsArrayAnAttribute(idx));
+        if (counts[0] > 0 && keys_to_send.find(key) != keys_to_send.end())
+        {
+          vtkAbstractArray* copy = array->NewInstance();
+          vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+          if (dataArray)
+          {
+            vtkDataArray::SafeDownCast(copy)->ShallowCopy(dataArray);
+          }
+          else
+          {
+            copy->DeepCopy(array);
+          }
+          copy->SetName(key.c_str());
+          fd->AddArray(copy);
+          copy->Delete();
+        }
+      }
+    }
+  }
+  fd->AddArray(layout.GetPointer());
+  fd->AddArray(keys.GetPointer());
+  fd->AddArray(types.GetPointer());
+  return carrier;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMPIMoveData::MergeAttributeCarriers(
+  std::vector<vtkSmartPointer<vtkDataObject> >& pieces, vtkDataObject* result)
+{
+  return vtkMPIMoveDataMergeAttributeCarriers(pieces, result);
+}
+
+//-----------------------------------------------------------------------------
+vtkDataObject* vtkMPIMoveData::ApplyAttributeCarrier(vtkDataObject* previous, vtkPolyData* carrier)
+{
+  vtkMPIMoveDataLeaves leaves;
+  if (previous == NULL || carrier == NULL || !vtkMPIMoveDataGetLeaves(previous, leaves))
+  {
+    return NULL;
+  }
+
+  vtkFieldData* fd = carrier->GetFieldData();
+  vtkIdTypeArray* layout = vtkIdTypeArray::SafeDownCast(fd->GetAbstractArray(CARRIER_LAYOUT));
+  vtkStringArray* keys = vtkStringArray::SafeDownCast(fd->GetAbstractArray(CARRIER_KEYS));
+  vtkIntArray* types = vtkIntArray::SafeDownCast(fd->GetAbstractArray(CARRIER_ATTRIBUTE_TYPES));
+  if (layout == NULL || keys == NULL || types == NULL || layout->GetNumberOfComponents() != 6 ||
+    keys->GetNumberOfValues() != types->GetNumberOfValues())
+  {
+    return NULL;
+  }
+
+  // Ensure that the topology matches the data we delivered earlier.
+  std::map<unsigned int, const vtkIdType*> counts;
+  for (vtkIdType cc = 0; cc < layout->GetNumberOfTuples(); ++cc)
+  {
+    const vtkIdType* tuple = layout->GetPointer(6 * cc);
+    counts[static_cast<unsigned int>(tuple[0])] = tuple + 1;
+  }
+  for (vtkMPIMoveDataLeaves::iterator iter = leaves.begin(); iter != leaves.end(); ++iter)
+  {
+    vtkIdType leafCounts[5];
+    vtkMPIMoveDataGetCounts(iter->second, leafCounts);
+    std::map<unsigned int, const vtkIdType*>::iterator citer = counts.find(iter->first);
+    if (citer == counts.end())
+    {
+      if (leafCounts[0] != 0)
+      {
+        return NULL;
+      }
+      continue;
+    }
+    if (!std::equal(leafCounts, leafCounts + 5, citer->second))
+    {
+      return NULL;
+    }
+  }
+
+  vtkSmartPointer<vtkDataObject> result;
+  result.TakeReference(previous->NewInstance());
+  vtkMPIMoveDataLeaves newLeaves;
+  if (vtkPolyData* pd = vtkPolyData::SafeDownCast(result))
+  {
+    pd->ShallowCopy(previous);
+    newLeaves.push_back(std::make_pair(0u, pd));
+  }
+  else
+  {
+    vtkMultiBlockDataSet* mb = vtkMultiBlockDataSet::SafeDownCast(result);
+    mb->CopyStructure(vtkMultiBlockDataSet::SafeDownCast(previous));
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(vtkMultiBlockDataSet::SafeDownCast(previous)->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkNew<vtkPolyData> leaf;
+      leaf->ShallowCopy(iter->GetCurrentDataObject());
+      mb->SetDataSet(iter, leaf.GetPointer());
+      newLeaves.push_back(std::make_pair(iter->GetCurrentFlatIndex(), leaf.GetPointer()));
+    }
+  }
+
+  for (size_t cc = 0; cc < leaves.size(); ++cc)
+  {
+    vtkPolyData* oldLeaf = leaves[cc].second;
+    vtkPolyData* newLeaf = newLeaves[cc].second;
+    const unsigned int flat_index = leaves[cc].first;
+    if (oldLeaf->GetNumberOfPoints() == 0)
+    {
+      continue;
+    }
+
+    newLeaf->GetPointData()->Initialize();
+    newLeaf->GetCellData()->Initialize();
+    for (vtkIdType kk = 0; kk < keys->GetNumberOfValues(); ++kk)
+    {
+      const std::string& key = keys->GetValue(kk);
+      char association;
+      unsigned int leaf_index;
+      std::string name;
+      if (!vtkMPIMoveDataSplitKey(key, association, leaf_index, name) || leaf_index != flat_index)
+      {
+        continue;
+      }
+
+      vtkDataSetAttributes* oldDSA =
+        association == 'P' ? oldLeaf->GetPointData() : oldLeaf->GetCellData();
+      vtkDataSetAttributes* newDSA =
+        association == 'P' ? newLeaf->GetPointData() : newLeaf->GetCellData();
+      vtkIdType numTuples =
+        association == 'P' ? oldLeaf->GetNumberOfPoints() : oldLeaf->GetNumberOfCells();
+
+      vtkAbstractArray* array = fd->GetAbstractArray(key.c_str());
+      if (array)
+      {
+        array->SetName(name.c_str());
+      }
+      else
+      {
+        array = oldDSA->GetAbstractArray(name.c_str());
+      }
+      if (array == NULL || array->GetNumberOfTuples() != numTuples)
+      {
+        return NULL;
+      }
+      int idx = newDSA->AddArray(array);
+      int type = types->GetValue(kk);
+      // global ids are not preserved when appending pieces (see
+      // unsetGlobalIdsAttribute), keep it that way.
+      if (type >= 0 && type != vtkDataSetAttributes::GLOBALIDS)
+      {
+        newDSA->SetActiveAttribute(idx, type);
+      }
+    }
+  }
+
+  result->Register(NULL);
+  return result.GetPointer();
 }
 
 //-----------------------------------------------------------------------------
@@ -1207,6 +1768,10 @@ void vtkMPIMoveData::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Server: " << this->Server << endl;
   os << indent << "MoveMode: " << this->MoveMode << endl;
   os << indent << "SkipDataServerGatherToZero: " << this->SkipDataServerGatherToZero << endl;
+  os << indent << "ClientReceivedBytes: " << this->ClientReceivedBytes << endl;
+  os << indent << "ClientUncompressedBytes: " << this->ClientUncompressedBytes << endl;
+  os << indent << "ClientReceiveTime: " << this->ClientReceiveTime << endl;
+  os << indent << "DeliverAttributesOnly: " << this->DeliverAttributesOnly << endl;
   os << indent << "OutputDataType: ";
   if (this->OutputDataType == VTK_POLY_DATA)
   {
@@ -21,6 +21,10 @@
  * processes. It can redistributed polydata from M to N processors.
  * Update: This filter can now support delivering vtkUniformGridAMR datasets in
  * PASS_THROUGH and/or COLLECT modes.
+ *
+ * For vtkPolyData and vtkMultiBlockDataSet comprising of vtkPolyData, this
+ * filter also supports delivering attribute arrays alone when the receiver
+ * already has the topology (see DeliverAttributesOnly).
 */
 
 #ifndef vtkMPIMoveData_h
@@ -28,8 +32,15 @@
 
 #include "vtkPVClientServerCoreRenderingModule.h" //needed for exports
 #include "vtkPassInputTypeAlgorithm.h"
+#include "vtkSmartPointer.h" // for vtkSmartPointer
+
+#include <set>    // for std::set
+#include <string> // for std::string
+#include <vector> // for std::vector
 
+class vtkAbstractArray;
 class vtkMultiProcessController;
+class vtkPolyData;
 class vtkSocketController;
 class vtkMPIMToNSocketConnection;
 class vtkDataSet;
@@ -131,6 +142,91 @@ public:
   vtkGetMacro(SkipDataServerGatherToZero, bool);
   //@}
 
+  //@{
+  /**
+   * Statistics for the data received by the client in the most recent
+   * RequestData(). ClientReceivedBytes is the number of bytes that went over
+   * the wire (i.e. after compression, if any) while ClientUncompressedBytes is
+   * the size of the marshaled data before compression. ClientReceiveTime is
+   * the time, in seconds, spent receiving the data, including waiting for the
+   * data-server to gather and marshal it, but not decompressing and
+   * unmarshaling it on the client. All are 0 on processes other than the
+   * client or when nothing was delivered to the client.
+   */
+  vtkGetMacro(ClientReceivedBytes, vtkIdType);
+  vtkGetMacro(ClientUncompressedBytes, vtkIdType);
+  vtkGetMacro(ClientReceiveTime, double);
+  //@}
+
+  //@{
+  /**
+   * When set, the input is expected to be an attribute carrier created by
+   * NewAttributeCarrier() rather than the data itself. Pieces gathered on the
+   * root node are then merged following the carrier layout instead of being
+   * appended. This is used to deliver only the attribute arrays for data whose
+   * topology is already available on the receiving process. Only COLLECT mode
+   * is supported and OutputDataType must be VTK_POLY_DATA. Off by default.
+   */
+  vtkSetMacro(DeliverAttributesOnly, bool);
+  vtkGetMacro(DeliverAttributesOnly, bool);
+  //@}
+
+  /**
+   * Collects the point and cell data arrays for a vtkPolyData or a
+   * vtkMultiBlockDataSet with vtkPolyData leaves. Each array is identified by
+   * a key encoding the association, the leaf's flat index and the array name.
+   * Returns false if the data type is not supported or if an array is unnamed.
+   */
+  static bool GetAttributeArrays(
+    vtkDataObject* data, std::vector<std::string>& keys, std::vector<vtkAbstractArray*>& arrays);
+
+  /**
+   * Provides the modification time for the topology i.e. the points, cells
+   * and field data arrays for a vtkPolyData or a vtkMultiBlockDataSet with
+   * vtkPolyData leaves. \c signature is filled with the flat index, number of
+   * points and number of cells for each leaf, followed by the total number of
+   * field data arrays. Returns false if the data type is not supported.
+   *
+   * The time only stays the same across executions when the pipeline passes
+   * the same vtkPoints and vtkCellArray objects along, e.g. with
+   * vtkPVGeometryFilter on vtkPolyData input (without outline, strips or
+   * triangulation) downstream of filters that only change arrays. When
+   * vtkPVGeometryFilter extracts the surface of any other data type, it
+   * creates new points and cells on every execution, so the topology is
+   * always newer than the previous delivery.
+   */
+  static bool GetTopologyInformation(
+    vtkDataObject* data, vtkMTimeType& mtime, std::vector<vtkIdType>& signature);
+
+  /**
+   * Creates an attribute carrier for \c data that includes the arrays whose
+   * keys (see GetAttributeArrays()) are in \c keys_to_send. The carrier
+   * records the complete list of arrays so that arrays that are not sent are
+   * picked from the previously delivered data and removed arrays are dropped.
+   * Returns NULL if the data type is not supported. Caller takes ownership.
+   */
+  static vtkPolyData* NewAttributeCarrier(
+    vtkDataObject* data, const std::set<std::string>& keys_to_send);
+
+  /**
+   * Combines a delivered attribute carrier with the data delivered earlier.
+   * The result shares the topology with \c previous. Returns NULL if the
+   * carrier does not match \c previous. Caller takes ownership.
+   */
+  static vtkDataObject* ApplyAttributeCarrier(vtkDataObject* previous, vtkPolyData* carrier);
+
+  /**
+   * Merges the attribute carriers gathered from several processes into \c
+   * result. The arrays are concatenated in the order in which
+   * vtkMultiProcessControllerHelper::MergePieces() appends the data they
+   * were created from with vtkAppendPolyData: empty pieces are skipped,
+   * point arrays follow the order of the pieces and cell arrays are grouped
+   * by cell type (verts, lines, polys then strips) and, within a cell type,
+   * follow the order of the pieces. Returns false if a carrier is invalid.
+   */
+  static bool MergeAttributeCarriers(
+    std::vector<vtkSmartPointer<vtkDataObject> >& pieces, vtkDataObject* result);
+
   enum MoveModes
   {
     PASS_THROUGH = 0,
@@ -179,6 +275,12 @@ protected:
 
   bool SkipDataServerGatherToZero;
 
+  vtkIdType ClientReceivedBytes;
+  vtkIdType ClientUncompressedBytes;
+  double ClientReceiveTime;
+
+  bool DeliverAttributesOnly;
+
   enum Servers
   {
     CLIENT = 0,
@@ -41,7 +41,6 @@ public:
 };
 
 vtkStandardNewMacro(vtkPVCacheKeeper);
-vtkCxxSetObjectMacro(vtkPVCacheKeeper, CacheSizeKeeper, vtkCacheSizeKeeper);
 //----------------------------------------------------------------------------
 int vtkPVCacheKeeper::CacheHit = 0;
 int vtkPVCacheKeeper::CacheMiss = 0;
@@ -53,6 +52,7 @@ vtkPVCacheKeeper::vtkPVCacheKeeper()
   this->CacheTime = 0.0;
   this->CachingEnabled = true;
   this->CacheSizeKeeper = 0;
+  this->EvictCachesObserverId = 0;
   this->SetCacheSizeKeeper(vtkCacheSizeKeeper::GetInstance());
 }
 
@@ -68,6 +68,29 @@ vtkPVCacheKeeper::~vtkPVCacheKeeper()
   this->Cache = 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkPVCacheKeeper::SetCacheSizeKeeper(vtkCacheSizeKeeper* keeper)
+{
+  if (this->CacheSizeKeeper == keeper)
+  {
+    return;
+  }
+  if (this->CacheSizeKeeper)
+  {
+    this->CacheSizeKeeper->RemoveObserver(this->EvictCachesObserverId);
+    this->CacheSizeKeeper->UnRegister(this);
+  }
+  this->CacheSizeKeeper = keeper;
+  this->EvictCachesObserverId = 0;
+  if (this->CacheSizeKeeper)
+  {
+    this->CacheSizeKeeper->Register(this);
+    this->EvictCachesObserverId = this->CacheSizeKeeper->AddObserver(
+      vtkCacheSizeKeeper::EvictCachesEvent, this, &vtkPVCacheKeeper::RemoveAllCaches);
+  }
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 void vtkPVCacheKeeper::RemoveAllCaches()
 {
@@ -21,7 +21,8 @@
  * When caching is enabled, is the current time step has been previously cached
  * then this filter shuts the update request, otherwise propagates the update
  * and then cache the result for later use.  The current time step is set using
- * SetCacheTime().
+ * SetCacheTime(). All caches are released when the vtkCacheSizeKeeper asks for
+ * them to be evicted, which happens when a process exceeds its memory budget.
  * @sa
  * vtkPVCacheKeeperPipeline
 */
@@ -118,6 +119,7 @@ private:
 
   class vtkCacheMap;
   vtkCacheMap* Cache;
+  unsigned long EvictCachesObserverId;
 
   static int CacheHit;
   static int CacheMiss;
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkPVDataDeliveryManager.h"
 
+#include "vtkAbstractArray.h"
 #include "vtkAlgorithmOutput.h"
 #include "vtkDataObject.h"
 #include "vtkExtentTranslator.h"
@@ -26,18 +27,31 @@
 #include "vtkPKdTree.h"
 #include "vtkPVDataRepresentation.h"
 #include "vtkPVRenderView.h"
+#include "vtkPVSession.h"
 #include "vtkPVStreamingMacros.h"
 #include "vtkPVTrivialProducer.h"
+#include "vtkPolyData.h"
+#include "vtkProcessModule.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTimerLog.h"
 #include "vtkWeakPointer.h"
 
 #include <assert.h>
+#include <functional>
 #include <map>
 #include <queue>
+#include <set>
+#include <string>
 #include <utility>
 
+namespace
+{
+// Data with more arrays than this is always delivered as is. This bounds the
+// size of the vector reduced to decide on attribute-only delivery.
+const int MAX_ATTRIBUTE_CARRIER_ARRAYS = 256;
+}
+
 //*****************************************************************************
 class vtkPVDataDeliveryManager::vtkInternals
 {
@@ -99,6 +113,15 @@ public:
     vtkMTimeType ActualMemorySize;
 
   public:
+    // TimeStamp of the data last delivered to the client. Used to determine
+    // which data still needs to be transferred if we switched to local
+    // rendering.
+    vtkMTimeType ClientDeliveryTimeStamp;
+
+    // Topology signature (see vtkMPIMoveData::GetTopologyInformation()) for
+    // the data last delivered to the client.
+    std::vector<vtkIdType> ClientDeliveryTopology;
+
     vtkOrderedCompositingInfo OrderedCompositingInfo;
 
     bool CloneDataToAllNodes;
@@ -111,6 +134,7 @@ public:
       : Producer(vtkSmartPointer<vtkPVTrivialProducer>::New())
       , TimeStamp(0)
       , ActualMemorySize(0)
+      , ClientDeliveryTimeStamp(0)
       , CloneDataToAllNodes(false)
       , DeliverToClientAndRenderingProcesses(false)
       , GatherBeforeDeliveringToClient(false)
@@ -216,6 +240,180 @@ public:
     return size;
   }
 
+  // Returns the size for visible data that has changed since it was last
+  // delivered to the client.
+  unsigned long GetUndeliveredVisibleDataSize(bool use_second_if_available)
+  {
+    unsigned long size = 0;
+    ItemsMapType::iterator iter;
+    for (iter = this->ItemsMap.begin(); iter != this->ItemsMap.end(); ++iter)
+    {
+      const ReprPortType& key = iter->first;
+      if (!this->IsRepresentationVisible(key.first))
+      {
+        // skip hidden representations.
+        continue;
+      }
+
+      const vtkItem& item = (use_second_if_available && iter->second.second.GetDataObject())
+        ? iter->second.second
+        : iter->second.first;
+      if (item.GetTimeStamp() > item.ClientDeliveryTimeStamp)
+      {
+        size += item.GetActualMemorySize();
+      }
+    }
+    return size;
+  }
+
+  // Update the running estimates for the cost of transferring data to the
+  // client and for the compression ratio. Small transfers are dominated by
+  // latency and are hence ignored.
+  void RecordClientDelivery(
+    double elapsed_time, vtkIdType received_bytes, vtkIdType uncompressed_bytes)
+  {
+    const vtkIdType minimum_bytes = 64 * 1024;
+    if (received_bytes < minimum_bytes || uncompressed_bytes <= 0 || elapsed_time <= 0)
+    {
+      return;
+    }
+    double cost = elapsed_time / (received_bytes / 1024.0);
+    double ratio = static_cast<double>(received_bytes) / uncompressed_bytes;
+    if (this->TransferCostPerKiB > 0)
+    {
+      this->TransferCostPerKiB = 0.5 * (this->TransferCostPerKiB + cost);
+      this->CompressionRatio = 0.5 * (this->CompressionRatio + ratio);
+    }
+    else
+    {
+      this->TransferCostPerKiB = cost;
+      this->CompressionRatio = ratio;
+    }
+  }
+
+  // Time (in seconds) to deliver a KiB of uncompressed data.
+  double GetDeliveryCostPerKiB() const
+  {
+    return this->TransferCostPerKiB * this->CompressionRatio;
+  }
+
+  // Returns true if the client is a separate process from the data-server(s)
+  // i.e. delivering data to the client requires a transfer over a socket.
+  static bool IsClientRemote(bool& is_client)
+  {
+    vtkProcessModule* pm = vtkProcessModule::GetProcessModule();
+    vtkPVSession* session = pm ? vtkPVSession::SafeDownCast(pm->GetActiveSession()) : NULL;
+    if (session == NULL)
+    {
+      return false;
+    }
+    int roles = session->GetProcessRoles();
+    is_client = (roles & vtkPVSession::CLIENT) != 0;
+    return !(is_client && (roles & vtkPVSession::DATA_SERVER) != 0);
+  }
+
+  // When delivering data to the client, if the topology has not changed since
+  // the last delivery on all data-server ranks, we can deliver just the
+  // modified attribute arrays. In practice, this requires the representation's
+  // pipeline to pass the points and cells along by reference (see
+  // vtkMPIMoveData::GetTopologyInformation()), which vtkPVGeometryFilter only
+  // does for vtkPolyData input. This determines if that's the case and returns
+  // the carrier to deliver (an empty vtkPolyData on the client). Returns NULL
+  // if the data needs to be delivered as is. Must be called on all processes
+  // since the decision is synchronized among them.
+  vtkSmartPointer<vtkPolyData> NewAttributeCarrier(
+    vtkItem* item, vtkPVRenderView* view, bool is_client)
+  {
+    vtkDataObject* data = item->GetDataObject();
+    std::vector<std::string> keys;
+    std::vector<vtkAbstractArray*> arrays;
+    bool has_points = false;
+
+    vtkIdType can_deliver_attributes = 0;
+    if (is_client)
+    {
+      vtkDataObject* delivered = item->GetDeliveredDataObject();
+      can_deliver_attributes = (item->ClientDeliveryTimeStamp > 0 && delivered != NULL &&
+                                 (delivered->IsA("vtkPolyData") ||
+                                   delivered->IsA("vtkMultiBlockDataSet")))
+        ? 1
+        : 0;
+    }
+    else
+    {
+      vtkMTimeType topology_mtime = 0;
+      std::vector<vtkIdType> topology;
+      if (item->ClientDeliveryTimeStamp > 0 &&
+        vtkMPIMoveData::GetTopologyInformation(data, topology_mtime, topology) &&
+        topology_mtime <= item->ClientDeliveryTimeStamp &&
+        topology == item->ClientDeliveryTopology &&
+        vtkMPIMoveData::GetAttributeArrays(data, keys, arrays))
+      {
+        can_deliver_attributes = 1;
+        // number of points of each leaf, skipping the trailing number of
+        // field data arrays.
+        for (size_t cc = 1; cc + 1 < topology.size(); cc += 3)
+        {
+          has_points |= (topology[cc] > 0);
+        }
+      }
+    }
+    // All ranks with data must have the same arrays, in the same order, for
+    // the pieces to be merged. Ranks without data don't participate. The
+    // decision, the array signature and the modified flags are packed in a
+    // single vector and reduced once (using MAX_OP, minimums are negated):
+    // [cannot deliver, -min hash, max hash, number of arrays, modified flags].
+    const int max_arrays = MAX_ATTRIBUTE_CARRIER_ARRAYS;
+    if (keys.size() > static_cast<size_t>(max_arrays))
+    {
+      can_deliver_attributes = 0;
+    }
+    std::vector<vtkIdType> values(4 + max_arrays, 0);
+    values[0] = can_deliver_attributes ? 0 : 1;
+    values[1] = values[2] = VTK_ID_MIN;
+    if (can_deliver_attributes && has_points)
+    {
+      std::string signature;
+      for (size_t cc = 0; cc < keys.size(); ++cc)
+      {
+        signature += keys[cc];
+        signature += '\n';
+      }
+      vtkIdType hash = static_cast<vtkIdType>(
+        std::hash<std::string>()(signature) % static_cast<size_t>(VTK_ID_MAX));
+      values[1] = -hash;
+      values[2] = hash;
+      values[3] = static_cast<vtkIdType>(keys.size());
+      for (size_t cc = 0; cc < keys.size(); ++cc)
+      {
+        values[4 + cc] = arrays[cc]->GetMTime() > item->ClientDeliveryTimeStamp ? 1 : 0;
+      }
+    }
+    view->SynchronizeMaximum(&values[0], static_cast<int>(values.size()));
+    if (values[0] != 0 || values[2] == VTK_ID_MIN || -values[1] != values[2])
+    {
+      return NULL;
+    }
+
+    // Arrays modified on any of the ranks.
+    std::set<std::string> keys_to_send;
+    for (vtkIdType cc = 0; has_points && cc < values[3]; ++cc)
+    {
+      if (values[4 + cc])
+      {
+        keys_to_send.insert(keys[cc]);
+      }
+    }
+
+    if (is_client)
+    {
+      return vtkSmartPointer<vtkPolyData>::New();
+    }
+    vtkSmartPointer<vtkPolyData> carrier;
+    carrier.TakeReference(vtkMPIMoveData::NewAttributeCarrier(data, keys_to_send));
+    return carrier;
+  }
+
   bool IsRepresentationVisible(unsigned int id) const
   {
     RepresentationsMapType::const_iterator riter = this->RepresentationsMap.find(id);
@@ -225,6 +423,20 @@ public:
 
   ItemsMapType ItemsMap;
   RepresentationsMapType RepresentationsMap;
+
+  // Running estimate for the time (in seconds) to transfer a KiB to the
+  // client, as received i.e. after compression. 0 until the first significant
+  // delivery is observed.
+  double TransferCostPerKiB;
+
+  // Running estimate for the ratio of received bytes to uncompressed bytes.
+  double CompressionRatio;
+
+  vtkInternals()
+    : TransferCostPerKiB(0.0)
+    , CompressionRatio(1.0)
+  {
+  }
 };
 
 //*****************************************************************************
@@ -261,6 +473,18 @@ unsigned long vtkPVDataDeliveryManager::GetVisibleDataSize(bool low_res)
   return this->Internals->GetVisibleDataSize(low_res);
 }
 
+//----------------------------------------------------------------------------
+unsigned long vtkPVDataDeliveryManager::GetUndeliveredVisibleDataSize(bool low_res)
+{
+  return this->Internals->GetUndeliveredVisibleDataSize(low_res);
+}
+
+//----------------------------------------------------------------------------
+double vtkPVDataDeliveryManager::GetDeliveryCostPerKiB()
+{
+  return this->Internals->GetDeliveryCostPerKiB();
+}
+
 //----------------------------------------------------------------------------
 void vtkPVDataDeliveryManager::RegisterRepresentation(vtkPVDataRepresentation* repr)
 {
@@ -504,6 +728,9 @@ void vtkPVDataDeliveryManager::Deliver(int use_lod, unsigned int size, unsigned
     : this->RenderView->GetUseDistributedRenderingForStillRender();
   int mode = this->RenderView->GetDataDistributionMode(using_remote_rendering);
 
+  bool is_client = false;
+  bool client_is_remote = vtkInternals::IsClientRemote(is_client);
+
   for (unsigned int cc = 0; cc < size; cc += 2)
   {
     int port = static_cast<int>(values[cc + 1]);
@@ -548,18 +775,70 @@ void vtkPVDataDeliveryManager::Deliver(int use_lod, unsigned int size, unsigned
       }
       dataMover->SetSkipDataServerGatherToZero(item->GatherBeforeDeliveringToClient == false);
     }
-    dataMover->SetInputData(data);
 
-    if (dataMover->GetOutputGeneratedOnProcess())
+    // When collecting data on the client, try to deliver only the arrays that
+    // changed if the client already has the topology.
+    vtkSmartPointer<vtkPolyData> carrier;
+    if (client_is_remote && mode == vtkMPIMoveData::COLLECT && !item->CloneDataToAllNodes &&
+      !item->DeliverToClientAndRenderingProcesses)
     {
-      // release old memory (not necessarily, but try).
-      item->SetDeliveredDataObject(NULL);
+      carrier = this->Internals->NewAttributeCarrier(item, this->RenderView, is_client);
     }
-    dataMover->Update();
-    if (item->GetDeliveredDataObject() == NULL)
+
+    bool delivered_to_client = !using_remote_rendering || item->CloneDataToAllNodes ||
+      item->DeliverToClientAndRenderingProcesses;
+
+    if (carrier)
+    {
+      dataMover->SetOutputDataType(VTK_POLY_DATA);
+      dataMover->SetDeliverAttributesOnly(true);
+      dataMover->SetInputData(carrier);
+      dataMover->Update();
+      if (is_client)
+      {
+        vtkPolyData* received = vtkPolyData::SafeDownCast(dataMover->GetOutputDataObject(0));
+        vtkDataObject* result =
+          vtkMPIMoveData::ApplyAttributeCarrier(item->GetDeliveredDataObject(), received);
+        if (result)
+        {
+          item->SetDeliveredDataObject(result);
+          result->Delete();
+        }
+        else
+        {
+          // the client will not agree to attribute-only delivery next time
+          // since ClientDeliveryTimeStamp is reset.
+          vtkWarningMacro("Failed to update delivered data with modified arrays. "
+                          "Data will be delivered in full on next update.");
+          delivered_to_client = false;
+          item->ClientDeliveryTimeStamp = 0;
+        }
+      }
+    }
+    else
+    {
+      dataMover->SetInputData(data);
+      if (dataMover->GetOutputGeneratedOnProcess())
+      {
+        // release old memory (not necessarily, but try).
+        item->SetDeliveredDataObject(NULL);
+      }
+      dataMover->Update();
+      if (item->GetDeliveredDataObject() == NULL)
+      {
+        item->SetDeliveredDataObject(dataMover->GetOutputDataObject(0));
+      }
+    }
+    if (delivered_to_client)
     {
-      item->SetDeliveredDataObject(dataMover->GetOutputDataObject(0));
+      item->ClientDeliveryTimeStamp = item->GetTimeStamp();
+      vtkMTimeType ignored;
+      item->ClientDeliveryTopology.clear();
+      vtkMPIMoveData::GetTopologyInformation(data, ignored, item->ClientDeliveryTopology);
     }
+    // only the client receives non-zero byte counts.
+    this->Internals->RecordClientDelivery(dataMover->GetClientReceiveTime(),
+      dataMover->GetClientReceivedBytes(), dataMover->GetClientUncompressedBytes());
   }
 
   vtkTimerLog::MarkEndEvent(use_lod ? "LowRes Data Migration" : "FullRes Data Migration");
@@ -796,6 +1075,8 @@ void vtkPVDataDeliveryManager::DeliverStreamedPieces(unsigned int size, unsigned
 void vtkPVDataDeliveryManager::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DeliveryCostPerKiB: " << this->Internals->GetDeliveryCostPerKiB() << endl;
+  os << indent << "CompressionRatio: " << this->Internals->CompressionRatio << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -129,6 +129,25 @@ public:
    */
   unsigned long GetVisibleDataSize(bool low_res);
 
+  /**
+   * Similar to GetVisibleDataSize() except that it only counts the data that
+   * has changed since it was last delivered to the client i.e. the data that
+   * would need to be transferred if the view switched to local rendering.
+   */
+  unsigned long GetUndeliveredVisibleDataSize(bool low_res);
+
+  /**
+   * Returns the observed cost, in seconds, of delivering one KiB of data to
+   * the client. This is measured on the client as data is delivered and
+   * includes the time spent marshaling, compressing and transferring the data.
+   * It is the product of the observed cost per KiB received
+   * (vtkMPIMoveData::GetClientReceivedBytes()) and the observed compression
+   * ratio, so that it applies to uncompressed data sizes.
+   * Returns 0 if no significant delivery has been observed yet or on
+   * processes other than the client.
+   */
+  double GetDeliveryCostPerKiB();
+
   /**
    * Provides access to the partitioning kd-tree that was generated using the
    * data provided by the representations. The view uses this kd-tree to decide
@@ -357,6 +357,9 @@ vtkPVRenderView::vtkPVRenderView()
   this->InteractiveRenderImageReductionFactor = 2;
   this->RemoteRenderingThreshold = 0;
   this->LODRenderingThreshold = 0;
+  this->UseDeliveryCostModel = false;
+  this->RemoteRenderingTimeThreshold = 0.5;
+  this->EstimatedDeliveryTime = -1.0;
   this->LODResolution = 0.5;
   this->UseOutlineForLODRendering = false;
   this->UseLightKit = false;
@@ -1253,6 +1256,7 @@ void vtkPVRenderView::Update()
   double local_size = this->GetDeliveryManager()->GetVisibleDataSize(false) / 1024.0;
   this->SynchronizedWindows->SynchronizeSize(local_size);
   // cout << "Full Geometry size: " << local_size << endl;
+  this->EstimatedDeliveryTime = this->EstimateDeliveryTime(/*using_lod=*/false);
 
   // Update decisions about lod-rendering and remote-rendering.
   this->UseLODForInteractiveRender = this->ShouldUseLODRendering(local_size);
@@ -1319,6 +1323,7 @@ void vtkPVRenderView::UpdateLOD()
   double local_size = this->GetDeliveryManager()->GetVisibleDataSize(true) / 1024.0;
   this->SynchronizedWindows->SynchronizeSize(local_size);
   // cout << "LOD Geometry size: " << local_size << endl;
+  this->EstimatedDeliveryTime = this->EstimateDeliveryTime(/*using_lod=*/true);
 
   this->UseDistributedRenderingForInteractiveRender =
     this->ShouldUseDistributedRendering(local_size, /*using_lod=*/true);
@@ -1862,6 +1867,28 @@ void vtkPVRenderView::SetForceDataDistributionMode(vtkInformation* info, int fla
   self->ForceDataDistributionMode = flag < 0 ? -1 : flag;
 }
 
+//----------------------------------------------------------------------------
+double vtkPVRenderView::EstimateDeliveryTime(bool using_lod)
+{
+  if (!this->UseDeliveryCostModel)
+  {
+    return -1.0;
+  }
+
+  // The undelivered data size is known on the data-server ranks while the
+  // cost of delivering it is only observed on the client.
+  double pending_size = this->GetDeliveryManager()->GetUndeliveredVisibleDataSize(using_lod);
+  this->SynchronizedWindows->SynchronizeSize(pending_size);
+
+  double cost = this->GetDeliveryManager()->GetDeliveryCostPerKiB();
+  this->SynchronizedWindows->Reduce(cost, vtkPVSynchronizedRenderWindows::MAX_OP);
+  if (cost <= 0)
+  {
+    return -1.0;
+  }
+  return pending_size * cost;
+}
+
 //----------------------------------------------------------------------------
 bool vtkPVRenderView::ShouldUseDistributedRendering(double geometry_size, bool using_lod)
 {
@@ -1904,6 +1931,11 @@ bool vtkPVRenderView::ShouldUseDistributedRendering(double geometry_size, bool u
       throw true;
     }
 
+    if (this->UseDeliveryCostModel && this->EstimatedDeliveryTime >= 0)
+    {
+      throw(this->RemoteRenderingTimeThreshold <= this->EstimatedDeliveryTime);
+    }
+
     throw(this->RemoteRenderingThreshold <= geometry_size);
   }
   catch (bool val)
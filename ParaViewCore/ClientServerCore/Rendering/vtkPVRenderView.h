@@ -236,6 +236,34 @@ public:
   vtkGetMacro(RemoteRenderingThreshold, double);
   //@}
 
+  //@{
+  /**
+   * When set, the decision between remote and local rendering is based on the
+   * estimated time to deliver the changed geometry to the client, rather than
+   * the total geometry size. The estimate uses the delivery cost observed for
+   * earlier transfers (see vtkPVDataDeliveryManager::GetDeliveryCostPerKiB())
+   * and only accounts for data not already on the client, so local rendering
+   * is used once everything is on the client. Until a transfer has been
+   * observed, RemoteRenderingThreshold is used instead.
+   * Off by default.
+   * \note CallOnAllProcesses
+   */
+  vtkSetMacro(UseDeliveryCostModel, bool);
+  vtkGetMacro(UseDeliveryCostModel, bool);
+  vtkBooleanMacro(UseDeliveryCostModel, bool);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the estimated delivery time in seconds above which
+   * remote-rendering should be used, if possible. Only used when
+   * UseDeliveryCostModel is set.
+   * \note CallOnAllProcesses
+   */
+  vtkSetClampMacro(RemoteRenderingTimeThreshold, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(RemoteRenderingTimeThreshold, double);
+  //@}
+
   //@{
   /**
    * Get/Set the data-size in megabytes above which LOD rendering should be
@@ -962,6 +990,15 @@ protected:
    */
   bool ShouldUseDistributedRendering(double geometry_size, bool using_lod);
 
+  /**
+   * Returns the estimated time, in seconds, to deliver the visible geometry
+   * that is not yet available on the client, which is 0 when all of it is
+   * available on the client. Returns -1 if the delivery cost model is
+   * disabled or if no delivery cost has been observed yet. This must be
+   * called on all processes since it synchronizes the estimate.
+   */
+  double EstimateDeliveryTime(bool using_lod);
+
   /**
    * Returns true if LOD rendering should be used based on the geometry size.
    */
@@ -1076,6 +1113,11 @@ protected:
   // In mega-bytes.
   double RemoteRenderingThreshold;
   double LODRenderingThreshold;
+
+  bool UseDeliveryCostModel;
+  // In seconds.
+  double RemoteRenderingTimeThreshold;
+  double EstimatedDeliveryTime;
   vtkBoundingBox GeometryBounds;
 
   bool UseInteractiveRenderingForScreenshots;
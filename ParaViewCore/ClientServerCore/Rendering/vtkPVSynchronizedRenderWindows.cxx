@@ -34,6 +34,7 @@
 #include "vtkTilesHelper.h"
 #include "vtkTuple.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <map>
 #include <set>
@@ -1507,7 +1508,7 @@ T vtkEvaluateReductionOperation(
 //----------------------------------------------------------------------------
 template <class T>
 bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
-  T& size, vtkPVSynchronizedRenderWindows::StandardOperations operation)
+  T* values, int count, vtkPVSynchronizedRenderWindows::StandardOperations operation)
 {
   // handle trivial case.
   if (this->Mode == BUILTIN || this->Mode == INVALID)
@@ -1527,9 +1528,9 @@ bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
   // render-server and data-server.
   if (parallelController)
   {
-    T result = size;
-    parallelController->Reduce(&size, &result, 1, operation, 0);
-    size = result;
+    std::vector<T> result(values, values + count);
+    parallelController->Reduce(values, &result[0], count, operation, 0);
+    std::copy(result.begin(), result.end(), values);
   }
 
   // on pvdataserver/pvrenderserver/pvserver/pvbatch, we now have collected the
@@ -1540,23 +1541,29 @@ bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
     {
       if (c_ds_controller)
       {
-        T other_size;
-        c_ds_controller->Receive(&other_size, 1, 1, 41232);
-        size = vtkEvaluateReductionOperation(size, other_size, operation);
+        std::vector<T> other_values(count);
+        c_ds_controller->Receive(&other_values[0], count, 1, 41232);
+        for (int cc = 0; cc < count; ++cc)
+        {
+          values[cc] = vtkEvaluateReductionOperation(values[cc], other_values[cc], operation);
+        }
       }
       if (c_rs_controller)
       {
-        T other_size;
-        c_rs_controller->Receive(&other_size, 1, 1, 41232);
-        size = vtkEvaluateReductionOperation(size, other_size, operation);
+        std::vector<T> other_values(count);
+        c_rs_controller->Receive(&other_values[0], count, 1, 41232);
+        for (int cc = 0; cc < count; ++cc)
+        {
+          values[cc] = vtkEvaluateReductionOperation(values[cc], other_values[cc], operation);
+        }
       }
       if (c_ds_controller)
       {
-        c_ds_controller->Send(&size, 1, 1, 41232);
+        c_ds_controller->Send(values, count, 1, 41232);
       }
       if (c_rs_controller)
       {
-        c_rs_controller->Send(&size, 1, 1, 41232);
+        c_rs_controller->Send(values, count, 1, 41232);
       }
     }
     break;
@@ -1565,16 +1572,16 @@ bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
       // both can't be set on a server process.
       if (c_ds_controller)
       {
-        c_ds_controller->Send(&size, 1, 1, 41232);
-        c_ds_controller->Receive(&size, 1, 1, 41232);
+        c_ds_controller->Send(values, count, 1, 41232);
+        c_ds_controller->Receive(values, count, 1, 41232);
       }
       break;
 
     case RENDER_SERVER:
       if (c_rs_controller)
       {
-        c_rs_controller->Send(&size, 1, 1, 41232);
-        c_rs_controller->Receive(&size, 1, 1, 41232);
+        c_rs_controller->Send(values, count, 1, 41232);
+        c_rs_controller->Receive(values, count, 1, 41232);
       }
       break;
 
@@ -1584,7 +1591,7 @@ bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
 
   if (parallelController)
   {
-    parallelController->Broadcast(&size, 1, 0);
+    parallelController->Broadcast(values, count, 0);
   }
   return true;
 }
@@ -1592,20 +1599,34 @@ bool vtkPVSynchronizedRenderWindows::ReduceTemplate(
 //----------------------------------------------------------------------------
 bool vtkPVSynchronizedRenderWindows::SynchronizeSize(double& size)
 {
-  return this->ReduceTemplate<double>(size, SUM_OP);
+  return this->ReduceTemplate<double>(&size, 1, SUM_OP);
 }
 
 //----------------------------------------------------------------------------
 bool vtkPVSynchronizedRenderWindows::SynchronizeSize(unsigned int& size)
 {
-  return this->ReduceTemplate<unsigned int>(size, SUM_OP);
+  return this->ReduceTemplate<unsigned int>(&size, 1, SUM_OP);
 }
 
 //----------------------------------------------------------------------------
 bool vtkPVSynchronizedRenderWindows::Reduce(
   vtkIdType& value, vtkPVSynchronizedRenderWindows::StandardOperations operation)
 {
-  return this->ReduceTemplate<vtkIdType>(value, operation);
+  return this->ReduceTemplate<vtkIdType>(&value, 1, operation);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVSynchronizedRenderWindows::Reduce(
+  double& value, vtkPVSynchronizedRenderWindows::StandardOperations operation)
+{
+  return this->ReduceTemplate<double>(&value, 1, operation);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVSynchronizedRenderWindows::Reduce(
+  vtkIdType* values, int count, vtkPVSynchronizedRenderWindows::StandardOperations operation)
+{
+  return count > 0 ? this->ReduceTemplate<vtkIdType>(values, count, operation) : true;
 }
 
 //----------------------------------------------------------------------------
@@ -152,6 +152,13 @@ public:
     SUM_OP = vtkCommunicator::SUM_OP
   };
   bool Reduce(vtkIdType& value, StandardOperations operation);
+  bool Reduce(double& value, StandardOperations operation);
+
+  /**
+   * Element-wise reduction of \c count values. \c count must be the same on
+   * all processes.
+   */
+  bool Reduce(vtkIdType* values, int count, StandardOperations operation);
 
   //@{
   /**
@@ -341,7 +348,7 @@ private:
   vtkObserver* Observer;
 
   template <class T>
-  bool ReduceTemplate(T& size, StandardOperations operation);
+  bool ReduceTemplate(T* values, int count, StandardOperations operation);
 
   static bool UseGenericOpenGLRenderWindow;
   vtkRenderWindow* NewRenderWindowInternal();
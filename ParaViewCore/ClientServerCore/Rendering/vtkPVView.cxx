@@ -259,6 +259,24 @@ bool vtkPVView::SynchronizeSize(unsigned int& size)
   return this->SynchronizedWindows->SynchronizeSize(size);
 }
 
+//----------------------------------------------------------------------------
+bool vtkPVView::SynchronizeMinimum(vtkIdType& value)
+{
+  return this->SynchronizedWindows->Reduce(value, vtkPVSynchronizedRenderWindows::MIN_OP);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVView::SynchronizeMaximum(vtkIdType& value)
+{
+  return this->SynchronizedWindows->Reduce(value, vtkPVSynchronizedRenderWindows::MAX_OP);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVView::SynchronizeMaximum(vtkIdType* values, int count)
+{
+  return this->SynchronizedWindows->Reduce(values, count, vtkPVSynchronizedRenderWindows::MAX_OP);
+}
+
 //----------------------------------------------------------------------------
 void vtkPVView::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -293,12 +311,26 @@ void vtkPVView::CleanupAfterScreenshot()
 void vtkPVView::Update()
 {
   vtkTimerLog::MarkStartEvent("vtkPVView::Update");
+  vtkCacheSizeKeeper* cacheSizeKeeper = vtkCacheSizeKeeper::GetInstance();
+
+  // When any of the processes has exceeded its memory budget, release the
+  // caches on all of them, so that they keep agreeing on what is cached.
+  vtkIdType over_budget = 0;
+  if (cacheSizeKeeper->GetMemoryBudget() > 0)
+  {
+    over_budget = cacheSizeKeeper->IsOverMemoryBudget() ? 1 : 0;
+    this->SynchronizedWindows->Reduce(over_budget, vtkPVSynchronizedRenderWindows::MAX_OP);
+    if (over_budget > 0)
+    {
+      cacheSizeKeeper->EvictCaches();
+    }
+  }
+
   // Ensure that cache size if synchronized among the processes.
   if (this->GetUseCache())
   {
-    vtkCacheSizeKeeper* cacheSizeKeeper = vtkCacheSizeKeeper::GetInstance();
     unsigned int cache_full = 0;
-    if (cacheSizeKeeper->GetCacheSize() > cacheSizeKeeper->GetCacheLimit())
+    if (over_budget > 0 || cacheSizeKeeper->GetCacheSize() > cacheSizeKeeper->GetCacheLimit())
     {
       cache_full = 1;
     }
@@ -113,6 +113,9 @@ public:
   bool SynchronizeBounds(double bounds[6]);
   bool SynchronizeSize(double& size);
   bool SynchronizeSize(unsigned int& size);
+  bool SynchronizeMinimum(vtkIdType& value);
+  bool SynchronizeMaximum(vtkIdType& value);
+  bool SynchronizeMaximum(vtkIdType* values, int count);
   //@}
 
   //@{
@@ -21,6 +21,8 @@
 
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <sstream>
 #include <string>
@@ -805,6 +807,29 @@ int vtkClientServerInterpreter::CallCommandFunction(const char* cname, vtkObject
   return function(this, ptr, method, msg, result, ctx);
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+struct vtkClientServerInterpreterMethodLess
+{
+  bool operator()(const char* a, const char* b) const { return strcmp(a, b) < 0; }
+};
+}
+
+int vtkClientServerInterpreter::FindMethodIndex(
+  const char* method, const char* const* names, int count)
+{
+  if (!method || count <= 0)
+  {
+    return -1;
+  }
+  const char* const* end = names + count;
+  const char* const* iter =
+    std::lower_bound(names, end, method, vtkClientServerInterpreterMethodLess());
+  return (iter != end && strcmp(*iter, method) == 0) ? static_cast<int>(iter - names) : -1;
+}
+
+//----------------------------------------------------------------------------
 void vtkClientServerInterpreter::AddNewInstanceFunction(const char* name,
   vtkClientServerNewInstanceFunction f, void* ctx, vtkContextFreeFunction freeFunction)
 {
@@ -150,6 +150,13 @@ public:
   int CallCommandFunction(const char* classname, vtkObjectBase* ptr, const char* method,
     const vtkClientServerStream& msg, vtkClientServerStream& result);
 
+  /**
+   * Called by generated code to find a method in the sorted table of method
+   * names wrapped for a class. Returns the index of the method in the table or
+   * -1 if not found. Do not call directly.
+   */
+  static int FindMethodIndex(const char* method, const char* const* names, int count);
+
   /**
    * Add a function used to create new objects.
    */
@@ -6,6 +6,7 @@ vtk_module(vtkPVCommon
     vtkIOXMLParser
     vtkClientServer
   PRIVATE_DEPENDS
+    vtkexpat
     vtksys
   TEST_DEPENDS
     vtkTestingCore
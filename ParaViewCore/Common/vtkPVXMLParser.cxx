@@ -17,6 +17,7 @@
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVXMLElement.h"
+#include "vtk_expat.h"
 #include <sstream>
 
 vtkStandardNewMacro(vtkPVXMLParser);
@@ -165,6 +166,20 @@ void vtkPVXMLParser::ReportXmlParseError()
   }
 }
 
+//-----------------------------------------------------------------------------
+vtkTypeInt64 vtkPVXMLParser::GetCurrentMarkupBegin()
+{
+  XML_Parser parser = static_cast<XML_Parser>(this->Parser);
+  return parser ? XML_GetCurrentByteIndex(parser) : -1;
+}
+
+//-----------------------------------------------------------------------------
+vtkTypeInt64 vtkPVXMLParser::GetCurrentMarkupEnd()
+{
+  XML_Parser parser = static_cast<XML_Parser>(this->Parser);
+  return parser ? XML_GetCurrentByteIndex(parser) + XML_GetCurrentByteCount(parser) : -1;
+}
+
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPVXMLElement> vtkPVXMLParser::ParseXML(
   const char* xmlcontents, bool suppress_errors)
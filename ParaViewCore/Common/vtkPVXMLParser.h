@@ -96,6 +96,13 @@ protected:
   // Overridden to implement the SuppressErrorMessages feature.
   void ReportXmlParseError() VTK_OVERRIDE;
 
+  // Offsets, in bytes from the start of the input, of the beginning and of
+  // the end of the markup being processed. Only valid while parsing i.e. from
+  // StartElement() and EndElement(), where subclasses can use them to locate
+  // elements in the input.
+  vtkTypeInt64 GetCurrentMarkupBegin();
+  vtkTypeInt64 GetCurrentMarkupEnd();
+
 private:
   vtkPVXMLParser(const vtkPVXMLParser&) = delete;
   void operator=(const vtkPVXMLParser&) = delete;
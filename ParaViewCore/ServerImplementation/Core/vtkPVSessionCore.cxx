@@ -27,6 +27,7 @@
 #include "vtkPVInformation.h"
 #include "vtkPVInstantiator.h"
 #include "vtkPVOptions.h"
+#include "vtkPVPluginLoader.h"
 #include "vtkPVSession.h"
 #include "vtkPVSessionCoreInterpreterHelper.h"
 #include "vtkProcessModule.h"
@@ -430,6 +431,16 @@ void vtkPVSessionCore::PushStateInternal(vtkSMMessage* message)
       return;
       // abort();
     }
+    // Plugins registered from a manifest are only loaded once one of their
+    // proxies is needed. This must happen before the SI object is created
+    // since the plugin may provide its class.
+    if (message->HasExtension(ProxyState::xml_group) &&
+      message->HasExtension(ProxyState::xml_name))
+    {
+      vtkPVPluginLoader::LoadDeferredPlugin(message->GetExtension(ProxyState::xml_group).c_str(),
+        message->GetExtension(ProxyState::xml_name).c_str());
+    }
+
     // Create the corresponding SI object.
     std::string classname = message->GetExtension(DefinitionHeader::server_class);
     vtkObject* object;
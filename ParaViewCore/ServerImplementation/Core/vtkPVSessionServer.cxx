@@ -143,6 +143,9 @@ public:
     // Add rendering backend information.
     handshake << ".renderingbackend.opengl2";
 
+    // Listening for clients, accept shared memory if enabled.
+    const char* listen_scheme = options->GetSharedMemory() ? "shm" : "tcp";
+
     // for forward connections, port number 0 is acceptable, while for
     // reverse-connections it's not.
     std::string client_url;
@@ -152,7 +155,7 @@ public:
       port = (port < 0) ? 11111 : port;
 
       std::ostringstream stream;
-      stream << "tcp://localhost:" << port << "?listen=true&" << handshake.str();
+      stream << listen_scheme << "://localhost:" << port << "?listen=true&" << handshake.str();
       stream << ((this->Owner->MultipleConnection && !this->Owner->DisableFurtherConnections)
           ? "&multiple=true"
           : "");
@@ -178,13 +181,15 @@ public:
       if (vtkProcessModule::GetProcessType() == vtkProcessModule::PROCESS_RENDER_SERVER)
       {
         std::ostringstream stream;
-        stream << "tcp://localhost:" << rsport << "?listen=true&" << handshake.str();
+        stream << listen_scheme << "://localhost:" << rsport << "?listen=true&"
+               << handshake.str();
         client_url = stream.str();
       }
       else if (vtkProcessModule::GetProcessType() == vtkProcessModule::PROCESS_DATA_SERVER)
       {
         std::ostringstream stream;
-        stream << "tcp://localhost:" << dsport << "?listen=true&" << handshake.str();
+        stream << listen_scheme << "://localhost:" << dsport << "?listen=true&"
+               << handshake.str();
         stream << ((this->Owner->MultipleConnection && !this->Owner->DisableFurtherConnections)
             ? "&multiple=true"
             : "");
@@ -575,6 +580,49 @@ void vtkPVSessionServer::OnClientServerMessageRMI(void* message, int message_len
       this->Internal->GetActiveController()->Send(css, 1, vtkPVSessionServer::REPLY_PULL);
     }
     break;
+
+    case vtkPVSessionServer::PUSH_BATCH:
+    {
+      // Same as PUSH for a sequence of messages, processed in order.
+      int count;
+      stream >> count;
+      for (int cc = 0; cc < count; ++cc)
+      {
+        std::string string;
+        stream >> string;
+        vtkSMMessage msg;
+        msg.ParseFromString(string);
+        if (!this->Internal->StoreShareOnly(&msg))
+        {
+          this->PushState(&msg);
+        }
+        this->NotifyOtherClients(&msg);
+      }
+    }
+    break;
+
+    case vtkPVSessionServer::PULL_BATCH:
+    {
+      // Same as PULL for a sequence of messages, with a single reply.
+      int count;
+      stream >> count;
+      vtkMultiProcessStream css;
+      css << count;
+      for (int cc = 0; cc < count; ++cc)
+      {
+        std::string string;
+        stream >> string;
+        vtkSMMessage msg;
+        msg.ParseFromString(string);
+        if (!this->Internal->RetreiveShareOnly(&msg))
+        {
+          this->PullState(&msg);
+        }
+        css << msg.SerializeAsString();
+      }
+      this->Internal->GetActiveController()->Send(css, 1, vtkPVSessionServer::REPLY_PULL);
+    }
+    break;
     case vtkPVSessionServer::REGISTER_SI:
     {
       std::string string;
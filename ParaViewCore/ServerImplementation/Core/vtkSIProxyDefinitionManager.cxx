@@ -35,7 +35,9 @@
 #include "vtkStringList.h"
 #include "vtkTimerLog.h"
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
@@ -54,15 +56,239 @@ typedef vtkSmartPointer<vtkPVXMLElement> XMLElement;
 typedef std::map<vtkStdString, XMLElement> StrToXmlMap;
 typedef std::map<vtkStdString, StrToXmlMap> StrToStrToXmlMap;
 
+//****************************************************************************/
+// Core definitions are not parsed into vtkPVXMLElement trees up front. The
+// configuration XML is indexed once (see vtkConfigurationIndexer) to locate
+// every proxy element and the matching slice of the source text is parsed the
+// first time that definition is requested. Most sessions touch a small
+// fraction of the few thousand proxies defined, so this avoids building (and
+// holding) the rest on every rank.
+class vtkDeferredProxyDefinitions
+{
+public:
+  struct Slice
+  {
+    std::shared_ptr<const std::string> Source;
+    size_t Begin;
+    size_t Length;
+    bool AttachHints;
+  };
+
+  // Callback used to attach the ShowInMenu hints on expansion.
+  std::function<void(vtkPVXMLElement*)> AttachHints;
+
+  // Object reporting the definitions that fail to parse.
+  vtkObject* Owner;
+
+  vtkDeferredProxyDefinitions()
+    : Owner(NULL)
+  {
+  }
+
+  //-------------------------------------------------------------------------
+  void Add(const vtkStdString& groupName, const vtkStdString& proxyName, const Slice& slice)
+  {
+    this->Slices[groupName][proxyName] = slice;
+  }
+  //-------------------------------------------------------------------------
+  void Remove(const vtkStdString& groupName, const vtkStdString& proxyName)
+  {
+    std::map<vtkStdString, std::map<vtkStdString, Slice> >::iterator it =
+      this->Slices.find(groupName);
+    if (it != this->Slices.end())
+    {
+      it->second.erase(proxyName);
+    }
+  }
+  //-------------------------------------------------------------------------
+  const Slice* Find(const vtkStdString& groupName, const vtkStdString& proxyName) const
+  {
+    std::map<vtkStdString, std::map<vtkStdString, Slice> >::const_iterator it =
+      this->Slices.find(groupName);
+    if (it != this->Slices.end())
+    {
+      std::map<vtkStdString, Slice>::const_iterator it2 = it->second.find(proxyName);
+      if (it2 != it->second.end())
+      {
+        return &it2->second;
+      }
+    }
+    return NULL;
+  }
+  //-------------------------------------------------------------------------
+  void Clear() { this->Slices.clear(); }
+  //-------------------------------------------------------------------------
+  // Parse the slice for (groupName, proxyName), if still pending, into
+  // `element`. Returns false if nothing was pending or the parse failed, in
+  // which case an error is reported.
+  bool Expand(const vtkStdString& groupName, const vtkStdString& proxyName, XMLElement& element)
+  {
+    const Slice* slice = this->Find(groupName, proxyName);
+    if (!slice)
+    {
+      return false;
+    }
+    element = this->Parse(*slice);
+    this->Remove(groupName, proxyName);
+    if (!element && this->Owner)
+    {
+      vtkErrorWithObjectMacro(this->Owner, << "Failed to parse the definition of proxy (group="
+                                            << groupName << ", name=" << proxyName << ").");
+    }
+    return element.GetPointer() != NULL;
+  }
+  //-------------------------------------------------------------------------
+  XMLElement Parse(const Slice& slice) const
+  {
+    vtkNew<vtkPVXMLParser> parser;
+    if (!parser->Parse(
+          slice.Source->c_str() + slice.Begin, static_cast<unsigned int>(slice.Length)))
+    {
+      return XMLElement();
+    }
+    XMLElement element = parser->GetRootElement();
+    if (slice.AttachHints && this->AttachHints)
+    {
+      this->AttachHints(element.GetPointer());
+    }
+    return element;
+  }
+
+private:
+  std::map<vtkStdString, std::map<vtkStdString, Slice> > Slices;
+};
+
+namespace
+{
+// A proxy (or extension) element located by vtkConfigurationIndexer.
+struct vtkIndexedDefinition
+{
+  std::string GroupTag;
+  std::string GroupName;
+  std::string Tag;
+  std::string Name;
+  size_t Begin;
+  size_t Length;
+};
+
+//---------------------------------------------------------------------------
+// Locates the proxy elements of a ServerManagerConfiguration document without
+// building vtkPVXMLElement trees for them. Mirrors the traversal done by
+// vtkSIProxyDefinitionManager::LoadConfigurationXML(vtkPVXMLElement*, bool).
+class vtkConfigurationIndexer : public vtkPVXMLParser
+{
+public:
+  static vtkConfigurationIndexer* New();
+  vtkTypeMacro(vtkConfigurationIndexer, vtkPVXMLParser);
+
+  // Returns false if the document could not be parsed or has no
+  // ServerManagerConfiguration element where LoadConfigurationXML() looks for
+  // it.
+  bool Index(const std::string& xml, std::vector<vtkIndexedDefinition>& index)
+  {
+    this->Definitions = &index;
+    this->Depth = 0;
+    this->ConfigurationDepth = 0;
+    this->ConfigurationDone = false;
+    this->SetSuppressErrorMessages(1);
+    bool success = this->Parse(xml.c_str(), static_cast<unsigned int>(xml.size())) != 0;
+    this->Definitions = NULL;
+    return success && this->ConfigurationDepth > 0;
+  }
+
+protected:
+  vtkConfigurationIndexer()
+    : Definitions(NULL)
+    , Depth(0)
+    , ConfigurationDepth(0)
+    , ConfigurationDone(false)
+  {
+  }
+
+  void StartElement(const char* name, const char** atts) VTK_OVERRIDE
+  {
+    // Only the first ServerManagerConfiguration, either the root or one of its
+    // children, is processed.
+    if (this->ConfigurationDepth == 0)
+    {
+      if (strcmp(name, "ServerManagerConfiguration") == 0 && this->Depth <= 1)
+      {
+        this->ConfigurationDepth = this->Depth + 1;
+      }
+    }
+    else if (!this->ConfigurationDone && this->Depth == this->ConfigurationDepth)
+    {
+      this->Current.GroupTag = name;
+      this->Current.GroupName = vtkConfigurationIndexer::GetName(atts);
+    }
+    else if (!this->ConfigurationDone && this->Depth == this->ConfigurationDepth + 1)
+    {
+      this->Current.Tag = name;
+      this->Current.Name = vtkConfigurationIndexer::GetName(atts);
+      this->Current.Begin = static_cast<size_t>(this->GetCurrentMarkupBegin());
+    }
+    ++this->Depth;
+  }
+
+  void EndElement(const char*) VTK_OVERRIDE
+  {
+    --this->Depth;
+    if (this->ConfigurationDepth > 0 && !this->ConfigurationDone)
+    {
+      if (this->Depth == this->ConfigurationDepth + 1 && !this->Current.Name.empty())
+      {
+        this->Current.Length =
+          static_cast<size_t>(this->GetCurrentMarkupEnd()) - this->Current.Begin;
+        this->Definitions->push_back(this->Current);
+      }
+      this->ConfigurationDone = this->Depth < this->ConfigurationDepth;
+    }
+  }
+
+  void CharacterDataHandler(const char*, int) VTK_OVERRIDE {}
+
+  static const char* GetName(const char** atts)
+  {
+    for (int cc = 0; atts && atts[cc]; cc += 2)
+    {
+      if (strcmp(atts[cc], "name") == 0)
+      {
+        return atts[cc + 1];
+      }
+    }
+    return "";
+  }
+
+  std::vector<vtkIndexedDefinition>* Definitions;
+  vtkIndexedDefinition Current;
+  unsigned int Depth;
+  unsigned int ConfigurationDepth;
+  bool ConfigurationDone;
+
+private:
+  vtkConfigurationIndexer(const vtkConfigurationIndexer&) = delete;
+  void operator=(const vtkConfigurationIndexer&) = delete;
+};
+vtkStandardNewMacro(vtkConfigurationIndexer);
+}
+
 class vtkSIProxyDefinitionManager::vtkInternals
 {
 public:
   // Keep State Flag of the ProcessType
   bool EnableXMLProxyDefinitionUpdate;
+  // Plugins whose XMLs have been processed. A plugin registered from its
+  // manifest is registered again once its library is loaded and its XMLs,
+  // in particular any Extension, must not be applied twice.
+  std::set<std::string> ProcessedPlugins;
   // Keep track of ServerManager definition
   StrToStrToXmlMap CoreDefinitions;
   // Keep track of custom definition
   StrToStrToXmlMap CustomsDefinitions;
+  // Core definitions that have not been parsed yet. AddElement() registers
+  // them in CoreDefinitions with a NULL element, which is replaced by the
+  // parsed definition when first requested.
+  vtkDeferredProxyDefinitions DeferredDefinitions;
   //-------------------------------------------------------------------------
   vtkInternals()
     : EnableXMLProxyDefinitionUpdate(true)
@@ -73,10 +299,16 @@ public:
   {
     this->CoreDefinitions.clear();
     this->CustomsDefinitions.clear();
+    this->DeferredDefinitions.Clear();
   }
   //-------------------------------------------------------------------------
   bool HasCoreDefinition(const char* groupName, const char* proxyName)
   {
+    // Avoid expanding a deferred definition just to test for its existence.
+    if (groupName && proxyName && this->DeferredDefinitions.Find(groupName, proxyName))
+    {
+      return true;
+    }
     return this->GetProxyElement(this->CoreDefinitions, groupName, proxyName) != NULL;
   }
   //-------------------------------------------------------------------------
@@ -113,7 +345,7 @@ public:
   }
   //-------------------------------------------------------------------------
   vtkPVXMLElement* GetProxyElement(
-    const StrToStrToXmlMap& map, const char* firstStr, const char* secondStr)
+    StrToStrToXmlMap& map, const char* firstStr, const char* secondStr)
   {
     vtkPVXMLElement* elementToReturn = NULL;
 
@@ -121,14 +353,20 @@ public:
     if (firstStr && secondStr)
     {
       // Find the value based on both keys
-      StrToStrToXmlMap::const_iterator it = map.find(firstStr);
+      StrToStrToXmlMap::iterator it = map.find(firstStr);
       if (it != map.end())
       {
         // We found a match for the first key
-        StrToXmlMap::const_iterator it2 = it->second.find(secondStr);
+        StrToXmlMap::iterator it2 = it->second.find(secondStr);
         if (it2 != it->second.end())
         {
-          // We found a match for the second key
+          // We found a match for the second key, parse it if needed.
+          if (it2->second.GetPointer() == NULL && &map == &this->CoreDefinitions &&
+            !this->DeferredDefinitions.Expand(it->first, it2->first, it2->second))
+          {
+            it->second.erase(it2);
+            return NULL;
+          }
           elementToReturn = it2->second.GetPointer();
         }
       }
@@ -266,6 +504,11 @@ public:
     }
     else
     {
+      if (this->CoreProxyIterator->second.GetPointer() == NULL && this->DeferredDefinitions)
+      {
+        this->DeferredDefinitions->Expand(
+          this->CurrentGroupName, this->CoreProxyIterator->first, this->CoreProxyIterator->second);
+      }
       return this->CoreProxyIterator->second.GetPointer();
     }
   }
@@ -296,6 +539,11 @@ public:
     this->CustomDefinitionMap = map;
     this->InvalidCustomIterator = true;
   }
+  //-------------------------------------------------------------------------
+  void RegisterDeferredDefinitions(vtkDeferredProxyDefinitions* deferred)
+  {
+    this->DeferredDefinitions = deferred;
+  }
 
   //-------------------------------------------------------------------------
   void GoToNextGroup() VTK_OVERRIDE { this->NextGroup(); }
@@ -306,6 +554,7 @@ protected:
     this->Initialized = false;
     this->CoreDefinitionMap = NULL;
     this->CustomDefinitionMap = 0;
+    this->DeferredDefinitions = NULL;
     this->InvalidCoreIterator = true;
     this->InvalidCustomIterator = true;
   }
@@ -408,6 +657,7 @@ private:
   StrToXmlMap::iterator CustomProxyIteratorEnd;
   StrToStrToXmlMap* CoreDefinitionMap;
   StrToStrToXmlMap* CustomDefinitionMap;
+  vtkDeferredProxyDefinitions* DeferredDefinitions;
   std::set<vtkStdString> GroupNames;
   std::set<vtkStdString>::iterator GroupNameIterator;
   bool InvalidCoreIterator;
@@ -421,6 +671,10 @@ vtkStandardNewMacro(vtkSIProxyDefinitionManager) vtkStandardNewMacro(vtkInternal
 {
   this->Internals = new vtkInternals;
   this->InternalsFlatten = new vtkInternals;
+  this->Internals->DeferredDefinitions.AttachHints = [this](vtkPVXMLElement* proxy) {
+    this->AttachShowInMenuHintsToProxy(proxy);
+  };
+  this->Internals->DeferredDefinitions.Owner = this;
 
   vtkPVPluginTracker* tracker = vtkPVPluginTracker::GetInstance();
 
@@ -475,7 +729,7 @@ void vtkSIProxyDefinitionManager::AddElement(
   const char* groupName, const char* proxyName, vtkPVXMLElement* element)
 {
   bool updated = false;
-  if (element->GetName() && strcmp(element->GetName(), "Extension") == 0)
+  if (element && element->GetName() && strcmp(element->GetName(), "Extension") == 0)
   {
     // This is an extension for an existing definition.
     vtkPVXMLElement* coreElem =
@@ -497,7 +751,12 @@ void vtkSIProxyDefinitionManager::AddElement(
   }
   else
   {
-    // Just referenced it
+    // Just referenced it. Without an element, the definition was registered
+    // with the deferred definitions and is parsed when first requested.
+    if (element)
+    {
+      this->Internals->DeferredDefinitions.Remove(groupName, proxyName);
+    }
     this->Internals->CoreDefinitions[groupName][proxyName] = element;
     updated = true;
   }
@@ -765,9 +1024,52 @@ bool vtkSIProxyDefinitionManager::LoadConfigurationXMLFromString(const char* xml
 bool vtkSIProxyDefinitionManager::LoadConfigurationXMLFromString(
   const char* xmlContent, bool attachHints)
 {
-  vtkNew<vtkPVXMLParser> parser;
-  return (parser->Parse(xmlContent) != 0) &&
-    this->LoadConfigurationXML(parser->GetRootElement(), attachHints);
+  if (!xmlContent)
+  {
+    return false;
+  }
+
+  // Locate the proxy definitions and defer parsing them until requested.
+  // Definitions cannot be parsed on their own if the document declares
+  // entities, so such documents are parsed at once. So are malformed documents,
+  // for the parser to report the error.
+  std::shared_ptr<const std::string> source = std::make_shared<const std::string>(xmlContent);
+  std::vector<vtkIndexedDefinition> index;
+  vtkNew<vtkConfigurationIndexer> indexer;
+  if (source->find("<!DOCTYPE") != std::string::npos || !indexer->Index(*source, index))
+  {
+    vtkNew<vtkPVXMLParser> parser;
+    return (parser->Parse(xmlContent) != 0) &&
+      this->LoadConfigurationXML(parser->GetRootElement(), attachHints);
+  }
+
+  for (size_t cc = 0; cc < index.size(); ++cc)
+  {
+    const vtkIndexedDefinition& item = index[cc];
+    vtkDeferredProxyDefinitions::Slice slice;
+    slice.Source = source;
+    slice.Begin = item.Begin;
+    slice.Length = item.Length;
+    slice.AttachHints = attachHints && item.GroupTag == "ProxyGroup" &&
+      (item.GroupName == "sources" || item.GroupName == "filters");
+    if (item.Tag == "Extension")
+    {
+      // Extensions modify an existing definition, so apply them right away.
+      XMLElement extension = this->Internals->DeferredDefinitions.Parse(slice);
+      if (!extension)
+      {
+        return false;
+      }
+      this->AddElement(item.GroupName.c_str(), item.Name.c_str(), extension);
+    }
+    else
+    {
+      this->Internals->DeferredDefinitions.Add(item.GroupName, item.Name, slice);
+      this->AddElement(item.GroupName.c_str(), item.Name.c_str(), NULL);
+    }
+  }
+  this->InvokeEvent(vtkSIProxyDefinitionManager::ProxyDefinitionsUpdated);
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -846,12 +1148,14 @@ vtkPVProxyDefinitionIterator* vtkSIProxyDefinitionManager::NewIterator(int scope
   {
     case vtkSIProxyDefinitionManager::CORE_DEFINITIONS: // Core only
       iterator->RegisterCoreDefinitionMap(&this->Internals->CoreDefinitions);
+      iterator->RegisterDeferredDefinitions(&this->Internals->DeferredDefinitions);
       break;
     case vtkSIProxyDefinitionManager::CUSTOM_DEFINITIONS: // Custom only
       iterator->RegisterCustomDefinitionMap(&this->Internals->CustomsDefinitions);
       break;
     default: // Both
       iterator->RegisterCoreDefinitionMap(&this->Internals->CoreDefinitions);
+      iterator->RegisterDeferredDefinitions(&this->Internals->DeferredDefinitions);
       iterator->RegisterCustomDefinitionMap(&this->Internals->CustomsDefinitions);
       break;
   }
@@ -1076,13 +1380,33 @@ void vtkSIProxyDefinitionManager::Pull(vtkSMMessage* msg)
   iter->GoToFirstItem();
   while (!iter->IsDoneWithTraversal())
   {
-    std::ostringstream xmlContent;
-    iter->GetProxyDefinition()->PrintXML(xmlContent, vtkIndent());
+    // Definitions that were never expanded can be sent as they were read.
+    const vtkDeferredProxyDefinitions::Slice* slice =
+      this->Internals->DeferredDefinitions.Find(iter->GetGroupName(), iter->GetProxyName());
+    if (slice && slice->AttachHints)
+    {
+      slice = NULL;
+    }
+    vtkPVXMLElement* definition = slice ? NULL : iter->GetProxyDefinition();
+    if (!slice && !definition)
+    {
+      iter->GoToNextItem();
+      continue;
+    }
 
     xmlDef = msg->AddExtension(ProxyDefinitionState::xml_definition_proxy);
     xmlDef->set_group(iter->GetGroupName());
     xmlDef->set_name(iter->GetProxyName());
-    xmlDef->set_xml(xmlContent.str());
+    if (definition)
+    {
+      std::ostringstream xmlContent;
+      definition->PrintXML(xmlContent, vtkIndent());
+      xmlDef->set_xml(xmlContent.str());
+    }
+    else
+    {
+      xmlDef->set_xml(slice->Source->substr(slice->Begin, slice->Length));
+    }
 
     iter->GoToNextItem();
   }
@@ -1115,14 +1439,20 @@ void vtkSIProxyDefinitionManager::Push(vtkSMMessage* msg)
   this->InternalsFlatten->Clear();
   vtkNew<vtkPVXMLParser> parser;
 
-  // Fill the definition with the content of the state
+  // Fill the definition with the content of the state. Core definitions are
+  // only parsed when first requested.
   int size = msg->ExtensionSize(ProxyDefinitionState::xml_definition_proxy);
   const ProxyDefinitionState_ProxyXMLDefinition* xmlDef;
   for (int i = 0; i < size; i++)
   {
     xmlDef = &msg->GetExtension(ProxyDefinitionState::xml_definition_proxy, i);
-    parser->Parse(xmlDef->xml().c_str());
-    this->AddElement(xmlDef->group().c_str(), xmlDef->name().c_str(), parser->GetRootElement());
+    vtkDeferredProxyDefinitions::Slice slice;
+    slice.Source = std::make_shared<const std::string>(xmlDef->xml());
+    slice.Begin = 0;
+    slice.Length = slice.Source->size();
+    slice.AttachHints = false;
+    this->Internals->DeferredDefinitions.Add(xmlDef->group(), xmlDef->name(), slice);
+    this->AddElement(xmlDef->group().c_str(), xmlDef->name().c_str(), NULL);
   }
 
   // Manage custom ones
@@ -1161,7 +1491,8 @@ void vtkSIProxyDefinitionManager::HandlePlugin(vtkPVPlugin* plugin)
     smplugin->GetXMLs(xmls);
 
     // Make sure only the SERVER is processing the XML proxy definition
-    if (this->Internals->EnableXMLProxyDefinitionUpdate)
+    if (this->Internals->EnableXMLProxyDefinitionUpdate &&
+      this->Internals->ProcessedPlugins.insert(plugin->GetPluginName()).second)
     {
       for (size_t cc = 0; cc < xmls.size(); cc++)
       {
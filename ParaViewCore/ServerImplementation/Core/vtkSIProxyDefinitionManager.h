@@ -280,7 +280,8 @@ protected:
 
   /**
    * Called by the XML parser to add an element from which a proxy
-   * can be created. Called during parsing.
+   * can be created. Called during parsing. \c element is NULL for a
+   * definition whose parsing is deferred until it is first requested.
    */
   void AddElement(const char* groupName, const char* proxyName, vtkPVXMLElement* element);
 
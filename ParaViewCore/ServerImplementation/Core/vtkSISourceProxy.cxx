@@ -20,6 +20,7 @@
 #include "vtkCommand.h"
 #include "vtkCompositeDataPipeline.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataObject.h"
 //#include "vtkGeometryRepresentation.h"
 #include "vtkInformation.h"
 #include "vtkMultiProcessController.h"
@@ -315,6 +316,22 @@ void vtkSISourceProxy::MarkStartEvent()
 //----------------------------------------------------------------------------
 void vtkSISourceProxy::MarkEndEvent()
 {
+  // Record the size of the outputs within the execution event, so that
+  // vtkPVTimerInformation can report it along with the execution time.
+  vtkAlgorithm* algorithm = vtkAlgorithm::SafeDownCast(this->GetVTKObject());
+  if (algorithm && vtkTimerLog::GetLogging())
+  {
+    unsigned long memory = 0;
+    for (int cc = 0; cc < algorithm->GetNumberOfOutputPorts(); ++cc)
+    {
+      vtkDataObject* output = algorithm->GetOutputDataObject(cc);
+      memory += output ? output->GetActualMemorySize() : 0;
+    }
+    std::ostringstream memoryEvent;
+    memoryEvent << "Output memory: " << memory << " KiB";
+    vtkTimerLog::MarkEvent(memoryEvent.str().c_str());
+  }
+
   std::ostringstream filterName;
   filterName << "Execute "
              << (this->GetVTKClassName() ? this->GetVTKClassName() : this->GetClassName())
@@ -0,0 +1,145 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestDeferredPluginProxy.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Registers a plugin from its manifest and checks that the plugin library is
+// only requested on the client when a proxy needs a class from it. The
+// "library" next to the manifest is not a shared library, so requesting it
+// reports an error that the test looks for.
+
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOutputWindow.h"
+#include "vtkPVPlugin.h"
+#include "vtkPVPluginLoader.h"
+#include "vtkProcessModule.h"
+#include "vtkSMSession.h"
+#include "vtkSMSessionProxyManager.h"
+#include "vtkSMSourceProxy.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+
+#include <fstream>
+#include <string>
+
+namespace
+{
+// Records the errors reported while the plugin is used.
+class vtkDeferredPluginOutputWindow : public vtkOutputWindow
+{
+public:
+  static vtkDeferredPluginOutputWindow* New();
+  vtkTypeMacro(vtkDeferredPluginOutputWindow, vtkOutputWindow);
+
+  void DisplayErrorText(const char* text) VTK_OVERRIDE { this->Errors += text; }
+  void DisplayWarningText(const char*) VTK_OVERRIDE {}
+  void DisplayGenericWarningText(const char*) VTK_OVERRIDE {}
+
+  std::string Errors;
+
+private:
+  vtkDeferredPluginOutputWindow() {}
+};
+vtkStandardNewMacro(vtkDeferredPluginOutputWindow);
+
+bool WriteFiles(const std::string& library, const std::string& manifest)
+{
+  // Not a shared library; only its name matters until it is requested.
+  std::ofstream lib(library.c_str());
+  lib << "not a plugin library" << endl;
+
+  std::ofstream xml(manifest.c_str());
+  xml << "<PluginManifest name=\"DeferredTestPlugin\" version=\"1.0\"\n"
+      << "  verification=\"" << _PV_PLUGIN_VERIFICATION_STRING << "\"\n"
+      << "  required_on_server=\"1\" required_on_client=\"1\" required_plugins=\"\">\n"
+      << "<ServerManagerConfiguration>\n"
+      << "  <ProxyGroup name=\"sources\">\n"
+      << "    <SourceProxy name=\"DeferredTestSphere\" class=\"vtkSphereSource\" />\n"
+      << "    <DeferredTestSourceProxy name=\"DeferredTestCustom\" class=\"vtkSphereSource\" />\n"
+      << "  </ProxyGroup>\n"
+      << "</ServerManagerConfiguration>\n"
+      << "</PluginManifest>\n";
+  return lib.good() && xml.good();
+}
+}
+
+int TestDeferredPluginProxy(int argc, char* argv[])
+{
+  char* tempDir =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  if (!tempDir)
+  {
+    cerr << "Could not determine temporary directory.\n";
+    return EXIT_FAILURE;
+  }
+  const std::string library = std::string(tempDir) + "/libDeferredTestPlugin.so";
+  const std::string manifest = std::string(tempDir) + "/DeferredTestPlugin.pvmanifest";
+  delete[] tempDir;
+  if (!WriteFiles(library, manifest))
+  {
+    cerr << "ERROR: failed to write the plugin manifest." << endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+  vtkNew<vtkDeferredPluginOutputWindow> window;
+  vtkOutputWindow::SetInstance(window.GetPointer());
+
+  int status = EXIT_SUCCESS;
+  {
+    vtkNew<vtkSMSession> session;
+    vtkSMSessionProxyManager* pxm = session->GetSessionProxyManager();
+
+    vtkNew<vtkPVPluginLoader> loader;
+    if (!loader->LoadPlugin(library.c_str()))
+    {
+      cerr << "ERROR: the plugin was not registered from its manifest." << endl;
+      status = EXIT_FAILURE;
+    }
+    else if (!window->Errors.empty())
+    {
+      cerr << "ERROR: the plugin library was requested on registration." << endl;
+      status = EXIT_FAILURE;
+    }
+
+    // A proxy using the stock proxy class does not need the library on the
+    // client.
+    vtkSmartPointer<vtkSMProxy> sphere;
+    sphere.TakeReference(pxm->NewProxy("sources", "DeferredTestSphere"));
+    if (!vtkSMSourceProxy::SafeDownCast(sphere))
+    {
+      cerr << "ERROR: failed to create a proxy defined by the manifest." << endl;
+      status = EXIT_FAILURE;
+    }
+    if (!window->Errors.empty())
+    {
+      cerr << "ERROR: the plugin library was requested for a stock proxy class." << endl;
+      status = EXIT_FAILURE;
+    }
+
+    // A proxy whose class comes from the plugin must request the library.
+    vtkSmartPointer<vtkSMProxy> custom;
+    custom.TakeReference(pxm->NewProxy("sources", "DeferredTestCustom"));
+    if (window->Errors.find("libDeferredTestPlugin") == std::string::npos)
+    {
+      cerr << "ERROR: the plugin library was not requested for the plugin's proxy class."
+           << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  vtkOutputWindow::SetInstance(NULL);
+  vtkInitializationHelper::Finalize();
+  return status;
+}
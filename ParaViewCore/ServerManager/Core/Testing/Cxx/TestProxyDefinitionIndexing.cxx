@@ -0,0 +1,215 @@
+/*=========================================================================
+
+Program:   ParaView
+Module:    TestProxyDefinitionIndexing.cxx
+
+Copyright (c) Kitware, Inc.
+All rights reserved.
+See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the proxy definitions vtkSIProxyDefinitionManager parses on first
+// use with the definitions loaded from a fully parsed document, and checks
+// that a definition that fails to parse on first use is reported.
+
+#include "vtkCommand.h"
+#include "vtkInitializationHelper.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkOutputWindow.h"
+#include "vtkPVXMLElement.h"
+#include "vtkPVXMLParser.h"
+#include "vtkProcessModule.h"
+#include "vtkSIProxyDefinitionManager.h"
+#include "vtkSMMessage.h"
+#include "vtkSmartPointer.h"
+
+#include <string>
+
+namespace
+{
+// Comments, CDATA sections, entities and markup characters in attribute
+// values must not confuse the indexing. The ServerManagerConfiguration is
+// nested in the root element, as in plugin XMLs.
+const char* CONFIGURATION =
+  "<?xml version=\"1.0\"?>\n"
+  "<!-- <ServerManagerConfiguration> in a comment -->\n"
+  "<Plugin>\n"
+  "<ServerManagerConfiguration>\n"
+  "  <ProxyGroup name=\"indexing_sources\">\n"
+  "    <SourceProxy name=\"Empty\" class=\"vtkSphereSource\"/>\n"
+  "    <SourceProxy name=\"A &amp; B\" class=\"vtkSphereSource\" label=\"a &gt; b\">\n"
+  "      <!-- </SourceProxy> -->\n"
+  "      <DoubleVectorProperty name=\"Radius\" command=\"SetRadius\"\n"
+  "        number_of_elements=\"1\" default_values=\"0.5\">\n"
+  "        <Documentation><![CDATA[ </DoubleVectorProperty> ]]></Documentation>\n"
+  "      </DoubleVectorProperty>\n"
+  "    </SourceProxy>\n"
+  "    <SourceProxy name='Quoted' class=\"vtkSphereSource\" label=\"/>\"></SourceProxy>\n"
+  "    <SourceProxy class=\"vtkSphereSource\"/>\n"
+  "  </ProxyGroup>\n"
+  "  <ProxyGroup name=\"indexing_sources\">\n"
+  "    <Extension name=\"Quoted\">\n"
+  "      <IntVectorProperty name=\"Resolution\" command=\"SetThetaResolution\"\n"
+  "        number_of_elements=\"1\" default_values=\"8\"/>\n"
+  "    </Extension>\n"
+  "  </ProxyGroup>\n"
+  "</ServerManagerConfiguration>\n"
+  "<ServerManagerConfiguration>\n"
+  "  <ProxyGroup name=\"indexing_sources\">\n"
+  "    <SourceProxy name=\"Ignored\" class=\"vtkSphereSource\"/>\n"
+  "  </ProxyGroup>\n"
+  "</ServerManagerConfiguration>\n"
+  "</Plugin>\n";
+
+const char* DOCTYPE_CONFIGURATION =
+  "<!DOCTYPE ServerManagerConfiguration [ <!ENTITY cls \"vtkSphereSource\"> ]>\n"
+  "<ServerManagerConfiguration>\n"
+  "  <ProxyGroup name=\"indexing_doctype\">\n"
+  "    <SourceProxy name=\"Entity\" class=\"&cls;\"/>\n"
+  "  </ProxyGroup>\n"
+  "</ServerManagerConfiguration>\n";
+
+// Records the errors reported.
+class vtkIndexingOutputWindow : public vtkOutputWindow
+{
+public:
+  static vtkIndexingOutputWindow* New();
+  vtkTypeMacro(vtkIndexingOutputWindow, vtkOutputWindow);
+
+  void DisplayErrorText(const char* text) VTK_OVERRIDE { this->Errors += text; }
+  void DisplayWarningText(const char*) VTK_OVERRIDE {}
+  void DisplayGenericWarningText(const char*) VTK_OVERRIDE {}
+
+  std::string Errors;
+
+private:
+  vtkIndexingOutputWindow() {}
+};
+vtkStandardNewMacro(vtkIndexingOutputWindow);
+
+// Counts the definitions registered.
+class vtkRegisterCounter : public vtkCommand
+{
+public:
+  static vtkRegisterCounter* New() { return new vtkRegisterCounter(); }
+  void Execute(vtkObject*, unsigned long, void*) VTK_OVERRIDE { this->Count++; }
+  int Count;
+
+private:
+  vtkRegisterCounter()
+    : Count(0)
+  {
+  }
+};
+
+bool CompareDefinitions(vtkSIProxyDefinitionManager* expected,
+  vtkSIProxyDefinitionManager* actual, const char* group, const char* name)
+{
+  vtkPVXMLElement* expectedDefinition = expected->GetProxyDefinition(group, name, false);
+  vtkPVXMLElement* actualDefinition = actual->GetProxyDefinition(group, name, false);
+  if (!expectedDefinition || !actualDefinition || !expectedDefinition->Equals(actualDefinition))
+  {
+    cerr << "ERROR: definition of (" << group << ", " << name << ") differs." << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestProxyDefinitionIndexing(int, char* argv[])
+{
+  vtkInitializationHelper::Initialize(argv[0], vtkProcessModule::PROCESS_CLIENT);
+  vtkNew<vtkIndexingOutputWindow> window;
+  vtkOutputWindow::SetInstance(window.GetPointer());
+
+  int status = EXIT_SUCCESS;
+  {
+    // Reference: definitions loaded from the parsed document.
+    vtkNew<vtkSIProxyDefinitionManager> expected;
+    vtkNew<vtkRegisterCounter> expectedCount;
+    expected->AddObserver(vtkCommand::RegisterEvent, expectedCount.GetPointer());
+    vtkSmartPointer<vtkPVXMLElement> root = vtkPVXMLParser::ParseXML(CONFIGURATION);
+    if (!expected->LoadConfigurationXML(root))
+    {
+      cerr << "ERROR: failed to load the parsed configuration." << endl;
+      status = EXIT_FAILURE;
+    }
+
+    vtkNew<vtkSIProxyDefinitionManager> actual;
+    vtkNew<vtkRegisterCounter> actualCount;
+    actual->AddObserver(vtkCommand::RegisterEvent, actualCount.GetPointer());
+    if (!actual->LoadConfigurationXMLFromString(CONFIGURATION))
+    {
+      cerr << "ERROR: failed to load the configuration." << endl;
+      status = EXIT_FAILURE;
+    }
+    if (actualCount->Count != expectedCount->Count || actualCount->Count != 4)
+    {
+      cerr << "ERROR: " << actualCount->Count << " definitions registered instead of "
+           << expectedCount->Count << endl;
+      status = EXIT_FAILURE;
+    }
+
+    const char* names[] = { "Empty", "A & B", "Quoted" };
+    for (int cc = 0; cc < 3; ++cc)
+    {
+      if (!actual->HasDefinition("indexing_sources", names[cc]) ||
+        !CompareDefinitions(expected.GetPointer(), actual.GetPointer(), "indexing_sources",
+          names[cc]))
+      {
+        status = EXIT_FAILURE;
+      }
+    }
+    vtkPVXMLElement* extended = actual->GetProxyDefinition("indexing_sources", "Quoted", false);
+    if (actual->HasDefinition("indexing_sources", "Ignored") || !extended ||
+      !extended->FindNestedElementByName("IntVectorProperty"))
+    {
+      cerr << "ERROR: unexpected definitions." << endl;
+      status = EXIT_FAILURE;
+    }
+
+    // Documents declaring entities are parsed at once.
+    if (!actual->LoadConfigurationXMLFromString(DOCTYPE_CONFIGURATION))
+    {
+      cerr << "ERROR: failed to load the configuration with a DOCTYPE." << endl;
+      status = EXIT_FAILURE;
+    }
+    vtkPVXMLElement* entity = actual->GetProxyDefinition("indexing_doctype", "Entity", false);
+    if (!entity || strcmp(entity->GetAttributeOrEmpty("class"), "vtkSphereSource") != 0)
+    {
+      cerr << "ERROR: entity not expanded." << endl;
+      status = EXIT_FAILURE;
+    }
+
+    // Definitions pushed from the server are parsed on first use, and reported
+    // if they fail to parse.
+    vtkSMMessage message;
+    ProxyDefinitionState_ProxyXMLDefinition* definition =
+      message.AddExtension(ProxyDefinitionState::xml_definition_proxy);
+    definition->set_group("indexing_pushed");
+    definition->set_name("Broken");
+    definition->set_xml("<SourceProxy name=\"Broken\" class=\"vtkSphereSource\">");
+    vtkNew<vtkSIProxyDefinitionManager> pushed;
+    pushed->Push(&message);
+    if (!window->Errors.empty() || !pushed->HasDefinition("indexing_pushed", "Broken"))
+    {
+      cerr << "ERROR: pushed definition not registered." << endl;
+      status = EXIT_FAILURE;
+    }
+    if (pushed->GetProxyDefinition("indexing_pushed", "Broken", false) != NULL ||
+      window->Errors.find("name=Broken") == std::string::npos)
+    {
+      cerr << "ERROR: the definition that failed to parse was not reported." << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  vtkOutputWindow::SetInstance(NULL);
+  vtkInitializationHelper::Finalize();
+  return status;
+}
@@ -549,18 +549,34 @@ void vtkSMProxy::UpdatePropertyInformation()
 
 //---------------------------------------------------------------------------
 void vtkSMProxy::UpdatePropertyInformationInternal(vtkSMProperty* single_property /*=NULL*/)
+{
+  vtkSMMessage message;
+  if (!this->BuildPropertyInformationRequest(&message, single_property))
+  {
+    return;
+  }
+
+  // Hmm, this changes message itself. Funky.
+  this->PullState(&message);
+
+  // Update internal values
+  this->LoadState(&message, this->Session->GetProxyLocator());
+}
+
+//---------------------------------------------------------------------------
+bool vtkSMProxy::BuildPropertyInformationRequest(
+  vtkSMMessage* message, vtkSMProperty* single_property /*=NULL*/)
 {
   this->CreateVTKObjects();
 
   // If no location, it means no state...
   if (!this->ObjectsCreated || this->Location == 0)
   {
-    return;
+    return false;
   }
 
   bool some_thing_to_fetch = false;
-  vtkSMMessage message;
-  Variant* var = message.AddExtension(PullRequest::arguments);
+  Variant* var = message->AddExtension(PullRequest::arguments);
   var->set_type(Variant::STRING);
 
   vtkSMProxyInternals::PropertyInfoMap::iterator it;
@@ -586,16 +602,10 @@ void vtkSMProxy::UpdatePropertyInformationInternal(vtkSMProperty* single_propert
     }
   }
 
-  if (!some_thing_to_fetch)
-  {
-    return;
-  }
-
-  // Hmm, this changes message itself. Funky.
-  this->PullState(&message);
-
-  // Update internal values
-  this->LoadState(&message, this->Session->GetProxyLocator());
+  // Same addressing as vtkSMRemoteObject::PullState().
+  message->set_global_id(this->GetGlobalID());
+  message->set_location(this->Location);
+  return some_thing_to_fetch;
 }
 
 //---------------------------------------------------------------------------
@@ -650,6 +650,7 @@ protected:
   friend class vtkSMSourceProxy;
   friend class vtkSMUndoRedoStateLoader;
   friend class vtkSMDeserializerProtobuf;
+  friend class vtkSMStateLoader;
   friend class vtkSMStateLocator;
   friend class vtkSMMultiServerSourceProxy;
   //@}
@@ -876,6 +877,15 @@ protected:
    */
   virtual void UpdatePropertyInformationInternal(vtkSMProperty* prop = NULL);
 
+  /**
+   * Fills \c message with the pull request UpdatePropertyInformationInternal()
+   * sends for \c prop (or for all information properties when NULL), so that
+   * requests for several proxies can be sent at once with
+   * vtkSMSession::PullStates(). The reply is applied with LoadState().
+   * Returns false when there is nothing to fetch.
+   */
+  bool BuildPropertyInformationRequest(vtkSMMessage* message, vtkSMProperty* prop = NULL);
+
   /**
   * vtkSMProxy tracks state of properties on this proxy in an internal State
   * object. Since it tracks all the properties by index, if there's a potential
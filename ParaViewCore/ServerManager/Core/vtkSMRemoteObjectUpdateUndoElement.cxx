@@ -26,6 +26,99 @@
 
 #include <vtkNew.h>
 
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Serializes all annotations of a proxy state, for comparison.
+std::string vtkSerializeAnnotations(const vtkSMMessage* state)
+{
+  std::string result = state->GetExtension(ProxyState::has_annotation) ? "1" : "0";
+  for (int cc = 0; cc < state->ExtensionSize(ProxyState::annotation); cc++)
+  {
+    result += state->GetExtension(ProxyState::annotation, cc).SerializeAsString();
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Keeps in state only the properties whose name is in \c changed.
+void vtkKeepProperties(vtkSMMessage* state, const std::set<std::string>& changed)
+{
+  std::vector<ProxyState_Property> kept;
+  for (int cc = 0; cc < state->ExtensionSize(ProxyState::property); cc++)
+  {
+    const ProxyState_Property& prop = state->GetExtension(ProxyState::property, cc);
+    if (changed.find(prop.name()) != changed.end())
+    {
+      kept.push_back(prop);
+    }
+  }
+  state->ClearExtension(ProxyState::property);
+  for (size_t cc = 0; cc < kept.size(); cc++)
+  {
+    state->AddExtension(ProxyState::property)->CopyFrom(kept[cc]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Reduces the full before and after states of a proxy to the properties that
+// differ between them, since vtkSMProxy::LoadState() only touches the
+// properties present in the state. Annotations are dropped when unchanged.
+// Everything else (sub-proxies, user data, ...) is kept as is since subclasses
+// rely on it.
+void vtkReduceToChanges(vtkSMMessage* before, vtkSMMessage* after)
+{
+  if (!before->HasExtension(ProxyState::xml_name) || !after->HasExtension(ProxyState::xml_name))
+  {
+    return;
+  }
+
+  std::map<std::string, std::string> beforeProperties;
+  for (int cc = 0; cc < before->ExtensionSize(ProxyState::property); cc++)
+  {
+    const ProxyState_Property& prop = before->GetExtension(ProxyState::property, cc);
+    beforeProperties[prop.name()] = prop.SerializeAsString();
+  }
+
+  std::set<std::string> changed;
+  for (int cc = 0; cc < after->ExtensionSize(ProxyState::property); cc++)
+  {
+    const ProxyState_Property& prop = after->GetExtension(ProxyState::property, cc);
+    std::map<std::string, std::string>::iterator iter = beforeProperties.find(prop.name());
+    if (iter == beforeProperties.end() || iter->second != prop.SerializeAsString())
+    {
+      changed.insert(prop.name());
+    }
+    if (iter != beforeProperties.end())
+    {
+      beforeProperties.erase(iter);
+    }
+  }
+  // Properties that are only present in the before state.
+  for (std::map<std::string, std::string>::iterator iter = beforeProperties.begin();
+       iter != beforeProperties.end(); ++iter)
+  {
+    changed.insert(iter->first);
+  }
+
+  vtkKeepProperties(before, changed);
+  vtkKeepProperties(after, changed);
+
+  if (vtkSerializeAnnotations(before) == vtkSerializeAnnotations(after))
+  {
+    before->ClearExtension(ProxyState::annotation);
+    before->ClearExtension(ProxyState::has_annotation);
+    after->ClearExtension(ProxyState::annotation);
+    after->ClearExtension(ProxyState::has_annotation);
+  }
+}
+}
+
 vtkStandardNewMacro(vtkSMRemoteObjectUpdateUndoElement);
 vtkSetObjectImplementationMacro(
   vtkSMRemoteObjectUpdateUndoElement, ProxyLocator, vtkSMProxyLocator);
@@ -111,6 +204,10 @@ void vtkSMRemoteObjectUpdateUndoElement::SetUndoRedoState(
   {
     this->BeforeState->CopyFrom(*before);
     this->AfterState->CopyFrom(*after);
+
+    // Only keep what changed, as the full states of all proxies touched in a
+    // long session add up.
+    vtkReduceToChanges(this->BeforeState, this->AfterState);
   }
   else
   {
@@ -118,6 +215,63 @@ void vtkSMRemoteObjectUpdateUndoElement::SetUndoRedoState(
       << "At least one of the provided states is NULL.");
   }
 }
+//-----------------------------------------------------------------------------
+void vtkSMRemoteObjectUpdateUndoElement::ApplyChanges(vtkSMMessage* state, bool before)
+{
+  const vtkSMMessage* changes = before ? this->BeforeState : this->AfterState;
+  if (!changes->HasExtension(ProxyState::xml_name) || !state->HasExtension(ProxyState::xml_name))
+  {
+    state->CopyFrom(*changes);
+    return;
+  }
+
+  std::map<std::string, int> changed;
+  for (int cc = 0; cc < changes->ExtensionSize(ProxyState::property); cc++)
+  {
+    changed[changes->GetExtension(ProxyState::property, cc).name()] = cc;
+  }
+
+  vtkSMMessage merged;
+  merged.CopyFrom(*changes);
+  merged.ClearExtension(ProxyState::property);
+  for (int cc = 0; cc < state->ExtensionSize(ProxyState::property); cc++)
+  {
+    const ProxyState_Property& prop = state->GetExtension(ProxyState::property, cc);
+    std::map<std::string, int>::iterator iter = changed.find(prop.name());
+    if (iter != changed.end())
+    {
+      merged.AddExtension(ProxyState::property)
+        ->CopyFrom(changes->GetExtension(ProxyState::property, iter->second));
+      changed.erase(iter);
+    }
+    else
+    {
+      merged.AddExtension(ProxyState::property)->CopyFrom(prop);
+    }
+  }
+  for (std::map<std::string, int>::iterator iter = changed.begin(); iter != changed.end(); ++iter)
+  {
+    merged.AddExtension(ProxyState::property)
+      ->CopyFrom(changes->GetExtension(ProxyState::property, iter->second));
+  }
+
+  // Annotations are only kept when they changed.
+  if (!changes->HasExtension(ProxyState::has_annotation))
+  {
+    if (state->HasExtension(ProxyState::has_annotation))
+    {
+      merged.SetExtension(
+        ProxyState::has_annotation, state->GetExtension(ProxyState::has_annotation));
+    }
+    for (int cc = 0; cc < state->ExtensionSize(ProxyState::annotation); cc++)
+    {
+      merged.AddExtension(ProxyState::annotation)
+        ->CopyFrom(state->GetExtension(ProxyState::annotation, cc));
+    }
+  }
+  state->CopyFrom(merged);
+}
+
 //-----------------------------------------------------------------------------
 vtkTypeUInt32 vtkSMRemoteObjectUpdateUndoElement::GetGlobalId()
 {
@@ -19,6 +19,9 @@
  * This class keeps the before and after state of the RemoteObject in the
  * vtkSMMessage form. It works with any proxy and RemoteObject. It is a very
  * generic undoElement.
+ *
+ * For proxies, only the properties that differ between the before and after
+ * states are kept, since undoing or redoing only needs to reload those.
 */
 
 #ifndef vtkSMRemoteObjectUpdateUndoElement_h
@@ -56,11 +59,19 @@ public:
   virtual void SetProxyLocator(vtkSMProxyLocator*);
 
   /**
-   * Set the state of the UndoElement
+   * Set the state of the UndoElement. For proxy states, \c before and \c after
+   * are reduced to the properties that differ between them.
    */
   virtual void SetUndoRedoState(const vtkSMMessage* before, const vtkSMMessage* after);
 
-  // Current full state of the UndoElement
+  /**
+   * Applies the changes kept for undo (\c before is true) or redo to \c state,
+   * which is expected to be the full state of the same object. This makes it
+   * possible to recover the full before or after state.
+   */
+  void ApplyChanges(vtkSMMessage* state, bool before);
+
+  // Current state of the UndoElement
   vtkSMMessage* BeforeState;
   vtkSMMessage* AfterState;
 
@@ -131,6 +131,15 @@ void vtkSMSession::PushState(vtkSMMessage* msg)
   this->Superclass::PushState(msg);
 }
 
+//----------------------------------------------------------------------------
+void vtkSMSession::PullStates(const std::vector<vtkSMMessage*>& messages)
+{
+  for (size_t cc = 0; cc < messages.size(); ++cc)
+  {
+    this->PullState(messages[cc]);
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkSMSession::UpdateStateHistory(vtkSMMessage* msg)
 {
@@ -26,6 +26,8 @@
 #include "vtkPVSessionBase.h"
 #include "vtkSmartPointer.h" // needed for vtkSmartPointer.
 
+#include <vector> // needed for std::vector.
+
 class vtkProcessModuleAutoMPI;
 class vtkSMCollaborationManager;
 class vtkSMProxyLocator;
@@ -145,6 +147,25 @@ public:
    */
   void PushState(vtkSMMessage* msg) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Between BeginPushStateBatch() and EndPushStateBatch(), a session talking
+   * to remote processes may queue the messages sent with PushState() and
+   * send them together. Any other communication with the servers flushes the
+   * queue first so the order in which the servers process the messages is
+   * unchanged. Calls may be nested. The default implementation does nothing.
+   */
+  virtual void BeginPushStateBatch() {}
+  virtual void EndPushStateBatch() {}
+  //@}
+
+  /**
+   * Pull several states. This is equivalent to calling PullState() on each
+   * message, which is what this implementation does, but a session talking
+   * to remote processes may answer all of them with a single round trip.
+   */
+  virtual void PullStates(const std::vector<vtkSMMessage*>& messages);
+
   /**
    * Sends the message to all clients.
    */
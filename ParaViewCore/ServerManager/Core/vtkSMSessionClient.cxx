@@ -41,9 +41,12 @@
 #include "vtkSMSettings.h"
 #include "vtkSocketCommunicator.h"
 
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <vtksys/RegularExpression.hxx>
+#include <vtksys/SystemTools.hxx>
 
 #include <assert.h>
 #include <set>
@@ -91,6 +94,7 @@ vtkSMSessionClient::vtkSMSessionClient()
   // Default value
   this->NoMoreDelete = false;
   this->NotBusy = 0;
+  this->PushStateBatchDepth = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -124,6 +128,9 @@ vtkSMSessionClient::~vtkSMSessionClient()
 //----------------------------------------------------------------------------
 vtkMultiProcessController* vtkSMSessionClient::GetController(ServerFlags processType)
 {
+  // The caller may talk to the server directly.
+  this->FlushPushStates();
+
   switch (processType)
   {
     case CLIENT:
@@ -149,7 +156,7 @@ vtkMultiProcessController* vtkSMSessionClient::GetController(ServerFlags process
 bool vtkSMSessionClient::Connect(const char* url)
 {
   this->SetURI(url);
-  vtksys::RegularExpression pvserver("^cs://([^:]+)(:([0-9]+))?");
+  vtksys::RegularExpression pvserver("^cs://([^:?]+)(:([0-9]+))?");
   vtksys::RegularExpression pvserver_reverse("^csrc://([^:]+)?(:([0-9]+))?");
 
   vtksys::RegularExpression pvrenderserver("^cdsrs://([^:]+):([0-9]+)/([^:]+):([0-9]+)");
@@ -170,6 +177,25 @@ bool vtkSMSessionClient::Connect(const char* url)
   // Add rendering backend information.
   handshake << ".renderingbackend.opengl2";
 
+  // Forward connections use shared memory only when asked to, with a "shm" or
+  // "shm=<MiB>" query parameter.
+  std::string scheme = "tcp";
+  std::string shm_size;
+  const char* query = strchr(url, '?');
+  if (query)
+  {
+    vtksys::RegularExpression shm_param("^shm(=([0-9]+))?$");
+    std::vector<vtksys::String> params = vtksys::SystemTools::SplitString(query + 1, '&');
+    for (size_t cc = 0; cc < params.size(); ++cc)
+    {
+      if (shm_param.find(params[cc]))
+      {
+        scheme = "shm";
+        shm_size = shm_param.match(2).empty() ? "" : "&shmsize=" + shm_param.match(2);
+      }
+    }
+  }
+
   std::string data_server_url;
   std::string render_server_url;
 
@@ -180,7 +206,7 @@ bool vtkSMSessionClient::Connect(const char* url)
     port = (port <= 0) ? 11111 : port;
 
     std::ostringstream stream;
-    stream << "tcp://" << hostname << ":" << port << "?" << handshake.str();
+    stream << scheme << "://" << hostname << ":" << port << "?" << handshake.str() << shm_size;
     data_server_url = stream.str();
   }
   else if (pvserver_reverse.find(url))
@@ -203,11 +229,13 @@ bool vtkSMSessionClient::Connect(const char* url)
     rsport = (rsport <= 0) ? 22221 : rsport;
 
     std::ostringstream stream;
-    stream << "tcp://" << dataserverhost << ":" << dsport << "?" << handshake.str();
+    stream << scheme << "://" << dataserverhost << ":" << dsport << "?" << handshake.str()
+           << shm_size;
     data_server_url = stream.str().c_str();
 
     std::ostringstream stream2;
-    stream2 << "tcp://" << renderserverhost << ":" << rsport << "?" << handshake.str();
+    stream2 << scheme << "://" << renderserverhost << ":" << rsport << "?" << handshake.str()
+            << shm_size;
     render_server_url = stream2.str();
   }
   else if (pvrenderserver_reverse.find(url))
@@ -436,6 +464,7 @@ bool vtkSMSessionClient::IsMPIInitialized(vtkTypeUInt32 servers)
 //----------------------------------------------------------------------------
 void vtkSMSessionClient::CloseSession()
 {
+  this->FlushPushStates();
   if (this->DataServerController)
   {
     this->DataServerController->TriggerRMIOnAllChildren(vtkPVSessionServer::CLOSE_SESSION);
@@ -499,8 +528,25 @@ void vtkSMSessionClient::PushState(vtkSMMessage* message)
   {
     controllers[num_controllers++] = this->RenderServerController;
   }
-  if (num_controllers > 0)
+  if (num_controllers > 0 && this->PushStateBatchDepth > 0 && !this->IsMultiClients())
+  {
+    const std::string serialized = message->SerializeAsString();
+    for (int cc = 0; cc < num_controllers; cc++)
+    {
+      if (controllers[cc] == this->DataServerController)
+      {
+        this->PendingDataServerPushes.push_back(serialized);
+      }
+      else
+      {
+        this->PendingRenderServerPushes.push_back(serialized);
+      }
+    }
+  }
+  else if (num_controllers > 0)
   {
+    this->FlushPushStates();
+
     vtkMultiProcessStream stream;
     stream << static_cast<int>(vtkPVSessionServer::PUSH);
     stream << message->SerializeAsString();
@@ -595,6 +641,8 @@ void vtkSMSessionClient::PullState(vtkSMMessage* message)
 
   if (controller)
   {
+    this->FlushPushStates();
+
     vtkMultiProcessStream stream;
     stream << static_cast<int>(vtkPVSessionServer::PULL);
     stream << message->SerializeAsString();
@@ -618,6 +666,122 @@ void vtkSMSessionClient::PullState(vtkSMMessage* message)
   this->EndBusyWork();
 }
 
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::PullStates(const std::vector<vtkSMMessage*>& messages)
+{
+  if (this->IsMultiClients())
+  {
+    this->Superclass::PullStates(messages);
+    return;
+  }
+
+  this->StartBusyWork();
+
+  // Same routing as PullState(): each message goes to a single location with
+  // the priority order (1) Client (2) DataServer (3) RenderServer.
+  std::vector<vtkSMMessage*> remote[2];
+  vtkMultiProcessController* controllers[2] = { this->DataServerController,
+    this->RenderServerController };
+  for (size_t cc = 0; cc < messages.size(); ++cc)
+  {
+    vtkSMMessage* message = messages[cc];
+    vtkTypeUInt32 location = this->GetRealLocation(message->location());
+    message->set_location(location);
+    if ((location & vtkPVSession::CLIENT) != 0)
+    {
+      this->Superclass::PullState(message);
+    }
+    else if ((location & (vtkPVSession::DATA_SERVER | vtkPVSession::DATA_SERVER_ROOT)) != 0)
+    {
+      remote[0].push_back(message);
+    }
+    else if ((location & (vtkPVSession::RENDER_SERVER | vtkPVSession::RENDER_SERVER_ROOT)) != 0)
+    {
+      remote[1].push_back(message);
+    }
+  }
+
+  this->FlushPushStates();
+  for (int index = 0; index < 2; ++index)
+  {
+    if (remote[index].empty() || controllers[index] == NULL)
+    {
+      continue;
+    }
+
+    vtkMultiProcessStream stream;
+    stream << static_cast<int>(vtkPVSessionServer::PULL_BATCH)
+           << static_cast<int>(remote[index].size());
+    for (size_t cc = 0; cc < remote[index].size(); ++cc)
+    {
+      stream << remote[index][cc]->SerializeAsString();
+    }
+    std::vector<unsigned char> raw_message;
+    stream.GetRawData(raw_message);
+    controllers[index]->TriggerRMIOnAllChildren(&raw_message[0],
+      static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+
+    // Get the replies, in the order of the requests.
+    vtkMultiProcessStream replyStream;
+    controllers[index]->Receive(replyStream, 1, vtkPVSessionServer::REPLY_PULL);
+    int count = 0;
+    replyStream >> count;
+    for (int cc = 0; cc < count && cc < static_cast<int>(remote[index].size()); ++cc)
+    {
+      std::string string;
+      replyStream >> string;
+      remote[index][cc]->ParseFromString(string);
+    }
+  }
+  this->EndBusyWork();
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::BeginPushStateBatch()
+{
+  this->PushStateBatchDepth++;
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::EndPushStateBatch()
+{
+  if (this->PushStateBatchDepth > 0 && --this->PushStateBatchDepth == 0)
+  {
+    this->FlushPushStates();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSMSessionClient::FlushPushStates()
+{
+  std::vector<std::string>* pending[2] = { &this->PendingDataServerPushes,
+    &this->PendingRenderServerPushes };
+  vtkMultiProcessController* controllers[2] = { this->DataServerController,
+    this->RenderServerController };
+  for (int index = 0; index < 2; ++index)
+  {
+    if (pending[index]->empty())
+    {
+      continue;
+    }
+    if (controllers[index] && !this->NoMoreDelete)
+    {
+      vtkMultiProcessStream stream;
+      stream << static_cast<int>(vtkPVSessionServer::PUSH_BATCH)
+             << static_cast<int>(pending[index]->size());
+      for (size_t cc = 0; cc < pending[index]->size(); ++cc)
+      {
+        stream << (*pending[index])[cc];
+      }
+      std::vector<unsigned char> raw_message;
+      stream.GetRawData(raw_message);
+      controllers[index]->TriggerRMIOnAllChildren(&raw_message[0],
+        static_cast<int>(raw_message.size()), vtkPVSessionServer::CLIENT_SERVER_MESSAGE_RMI);
+    }
+    pending[index]->clear();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkSMSessionClient::ExecuteStream(
   vtkTypeUInt32 location, const vtkClientServerStream& cssstream, bool ignore_errors)
@@ -643,6 +807,8 @@ void vtkSMSessionClient::ExecuteStream(
 
   if (num_controllers > 0)
   {
+    this->FlushPushStates();
+
     const unsigned char* data;
     size_t size;
     cssstream.GetData(&data, &size);
@@ -672,6 +838,7 @@ void vtkSMSessionClient::ExecuteStream(
 const vtkClientServerStream& vtkSMSessionClient::GetLastResult(vtkTypeUInt32 location)
 {
   this->StartBusyWork();
+  this->FlushPushStates();
   location = this->GetRealLocation(location);
 
   vtkMultiProcessController* controller = NULL;
@@ -720,6 +887,7 @@ bool vtkSMSessionClient::GatherInformation(
   vtkTypeUInt32 location, vtkPVInformation* information, vtkTypeUInt32 globalid)
 {
   this->StartBusyWork();
+  this->FlushPushStates();
   if (this->RenderServerController == NULL)
   {
     // re-route all render-server messages to data-server.
@@ -817,6 +985,7 @@ void vtkSMSessionClient::UnRegisterSIObject(vtkSMMessage* message)
   {
     return;
   }
+  this->FlushPushStates();
 
   vtkTypeUInt32 location = this->GetRealLocation(message->location());
   message->set_location(location);
@@ -858,6 +1027,7 @@ void vtkSMSessionClient::RegisterSIObject(vtkSMMessage* message)
   {
     return;
   }
+  this->FlushPushStates();
 
   vtkTypeUInt32 location = this->GetRealLocation(message->location());
   message->set_location(location);
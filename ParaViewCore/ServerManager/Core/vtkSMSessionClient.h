@@ -26,6 +26,8 @@
 #include "vtkPVServerManagerCoreModule.h" //needed for exports
 #include "vtkSMSession.h"
 
+#include <string> // needed for std::string
+
 class vtkMultiProcessController;
 class vtkPVServerInformation;
 class vtkSMCollaborationManager;
@@ -56,6 +58,13 @@ public:
    * csrc://<pvserver-host>:<pvserver-port>
    * cdsrsrc://<pvdataserver-host>:<pvdataserver-port>/<pvrenderserver-host>:<pvrenderserver-port>
    * In this case, the hostname is irrelevant and is ignored.
+   * When not using reverse connect, adding a "shm" query parameter, e.g.
+   * cs://localhost:11111?shm or cs://localhost:11111?shm=64, asks the servers to
+   * exchange large messages through shared memory rather than the socket, using
+   * rings of the given size in MiB (32 by default). That only happens if the
+   * servers run on the same host as the client and were started with
+   * --shared-memory; otherwise the connection uses the socket alone (see
+   * vtkTCPNetworkAccessManager).
    */
   virtual bool Connect(const char* url);
 
@@ -106,6 +115,17 @@ public:
   const vtkClientServerStream& GetLastResult(vtkTypeUInt32 location) VTK_OVERRIDE;
   //@}
 
+  //@{
+  /**
+   * Overridden to send the queued pushes with a single message per server
+   * and to pull all the states with a single round trip per server. When
+   * several clients are connected, messages are sent one by one as usual.
+   */
+  void BeginPushStateBatch() VTK_OVERRIDE;
+  void EndPushStateBatch() VTK_OVERRIDE;
+  void PullStates(const std::vector<vtkSMMessage*>& messages) VTK_OVERRIDE;
+  //@}
+
   //@{
   /**
    * When Connect() is waiting for a server to connect back to the client (in
@@ -228,6 +248,12 @@ protected:
    */
   vtkTypeUInt32 GetRealLocation(vtkTypeUInt32);
 
+  /**
+   * Sends the pushes queued since BeginPushStateBatch(). Called before any
+   * other communication with the servers.
+   */
+  void FlushPushStates();
+
   // Both maybe the same when connected to pvserver.
   vtkMultiProcessController* RenderServerController;
   vtkMultiProcessController* DataServerController;
@@ -267,6 +293,9 @@ private:
   void operator=(const vtkSMSessionClient&) = delete;
 
   int NotBusy;
+  int PushStateBatchDepth;
+  std::vector<std::string> PendingDataServerPushes;
+  std::vector<std::string> PendingRenderServerPushes;
   vtkTypeUInt32 LastGlobalID;
   vtkTypeUInt32 LastGlobalIDAvailable;
 };
@@ -21,6 +21,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVConfig.h" // for PARAVIEW_VERSION_*
 #include "vtkPVInstantiator.h"
+#include "vtkPVPluginLoader.h"
 #include "vtkPVProxyDefinitionIterator.h"
 #include "vtkPVXMLElement.h"
 #include "vtkPVXMLParser.h"
@@ -316,6 +317,12 @@ vtkSMProxy* vtkSMSessionProxyManager::NewProxy(
   std::ostringstream cname;
   cname << "vtkSM" << pelement->GetName() << ends;
   object = vtkPVInstantiator::CreateInstance(cname.str().c_str());
+  if (!object && vtkPVPluginLoader::LoadDeferredPlugin(groupname, proxyname))
+  {
+    // The proxy class is provided by a plugin registered from its manifest,
+    // whose library was not loaded yet.
+    object = vtkPVInstantiator::CreateInstance(cname.str().c_str());
+  }
 
   vtkSMProxy* proxy = vtkSMProxy::SafeDownCast(object);
   if (proxy)
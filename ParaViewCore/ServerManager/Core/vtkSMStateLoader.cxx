@@ -14,15 +14,20 @@
 =========================================================================*/
 #include "vtkSMStateLoader.h"
 
+#include "vtkClientServerStream.h"
+#include "vtkCommand.h"
 #include "vtkObjectFactory.h"
 #include "vtkPVInstantiator.h"
 #include "vtkPVXMLElement.h"
+#include "vtkSMMessage.h"
 #include "vtkSMProperty.h"
+#include "vtkSMPropertyIterator.h"
 #include "vtkSMPropertyLink.h"
 #include "vtkSMProxyIterator.h"
 #include "vtkSMProxyLink.h"
 #include "vtkSMProxyLocator.h"
 #include "vtkSMProxyManager.h"
+#include "vtkSMProxyProperty.h"
 #include "vtkSMSession.h"
 #include "vtkSMSessionProxyManager.h"
 #include "vtkSMSourceProxy.h"
@@ -31,6 +36,7 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <map>
 #include <vector>
 
 vtkObjectFactoryNewMacro(vtkSMStateLoader);
@@ -70,6 +76,7 @@ vtkSMStateLoader::vtkSMStateLoader()
   this->Internal = new vtkSMStateLoaderInternals;
   this->ServerManagerStateElement = 0;
   this->KeepIdMapping = 0;
+  this->BatchPipelineInformationUpdates = false;
   this->ProxyLocator = vtkSMProxyLocator::New();
 }
 
@@ -183,11 +190,17 @@ void vtkSMStateLoader::CreatedNewProxy(vtkTypeUInt32 id, vtkSMProxy* proxy)
     proxy->SetGlobalID(id);
   }
 
-  // Calling UpdateVTKObjects() will assign the proxy a GlobalId, if needed.
-  proxy->UpdateVTKObjects();
-  if (proxy->IsA("vtkSMSourceProxy"))
+  // In batched mode, the push and the pipeline information update happen in
+  // UpdatePipelineInformationOfCreatedProxies() instead.
+  bool batched = this->BatchPipelineInformationUpdates && this->Internal->DeferProxyRegistration;
+  if (!batched)
   {
-    vtkSMSourceProxy::SafeDownCast(proxy)->UpdatePipelineInformation();
+    // Calling UpdateVTKObjects() will assign the proxy a GlobalId, if needed.
+    proxy->UpdateVTKObjects();
+    if (proxy->IsA("vtkSMSourceProxy"))
+    {
+      vtkSMSourceProxy::SafeDownCast(proxy)->UpdatePipelineInformation();
+    }
   }
   if (this->Internal->DeferProxyRegistration)
   {
@@ -200,6 +213,191 @@ void vtkSMStateLoader::CreatedNewProxy(vtkTypeUInt32 id, vtkSMProxy* proxy)
   }
 }
 
+//---------------------------------------------------------------------------
+namespace
+{
+// Adds the proxies referred to by the proxy properties of \c proxy and of its
+// subproxies to \c dependencies.
+void vtkCollectProxyDependencies(vtkSMProxy* proxy, std::vector<vtkSMProxy*>& dependencies)
+{
+  vtkSmartPointer<vtkSMPropertyIterator> iter;
+  iter.TakeReference(proxy->NewPropertyIterator());
+  for (iter->Begin(); !iter->IsAtEnd(); iter->Next())
+  {
+    vtkSMProxyProperty* pp = vtkSMProxyProperty::SafeDownCast(iter->GetProperty());
+    for (unsigned int cc = 0; pp && cc < pp->GetNumberOfProxies(); ++cc)
+    {
+      if (pp->GetProxy(cc))
+      {
+        dependencies.push_back(pp->GetProxy(cc));
+      }
+    }
+  }
+  for (unsigned int cc = 0; cc < proxy->GetNumberOfSubProxies(); ++cc)
+  {
+    vtkCollectProxyDependencies(proxy->GetSubProxy(cc), dependencies);
+  }
+}
+
+// Depth-first visit placing each proxy after the created proxies it depends
+// on. \c state is 0 for unvisited, 1 while visiting and 2 once placed, so
+// cycles are broken at the first proxy revisited.
+void vtkSortByDependencies(vtkSMProxy* proxy, std::map<vtkSMProxy*, int>& state,
+  std::vector<vtkSMProxy*>& sorted)
+{
+  std::map<vtkSMProxy*, int>::iterator iter = state.find(proxy);
+  if (iter == state.end() || iter->second != 0)
+  {
+    return;
+  }
+  iter->second = 1;
+  std::vector<vtkSMProxy*> dependencies;
+  vtkCollectProxyDependencies(proxy, dependencies);
+  for (size_t cc = 0; cc < dependencies.size(); ++cc)
+  {
+    vtkSortByDependencies(dependencies[cc], state, sorted);
+  }
+  state[proxy] = 2;
+  sorted.push_back(proxy);
+}
+
+// Fires the vtkCommand::UpdateInformationEvent vtkSMSourceProxy fires at the
+// end of UpdatePipelineInformation().
+void vtkInvokeUpdateInformationEvent(vtkSMProxy* proxy)
+{
+  for (unsigned int cc = 0; cc < proxy->GetNumberOfSubProxies(); ++cc)
+  {
+    vtkInvokeUpdateInformationEvent(proxy->GetSubProxy(cc));
+  }
+  if (proxy->IsA("vtkSMSourceProxy"))
+  {
+    proxy->InvokeEvent(vtkCommand::UpdateInformationEvent);
+  }
+}
+}
+
+//---------------------------------------------------------------------------
+void vtkSMStateLoader::CollectPipelineInformationStreams(
+  vtkSMProxy* proxy, std::map<vtkTypeUInt32, vtkClientServerStream>& streams)
+{
+  // Server side part of vtkSMSourceProxy::UpdatePipelineInformation() for the
+  // proxy and its subproxies, in the order that method would issue it.
+  vtkTypeUInt32 location = proxy->GetFilteredLocation();
+  if (proxy->IsA("vtkSMSourceProxy") && proxy->GetObjectsCreated() && location != 0)
+  {
+    streams[location] << vtkClientServerStream::Invoke << SIPROXY(proxy)
+                      << "UpdatePipelineInformation" << vtkClientServerStream::End;
+  }
+  for (unsigned int cc = 0; cc < proxy->GetNumberOfSubProxies(); ++cc)
+  {
+    this->CollectPipelineInformationStreams(proxy->GetSubProxy(cc), streams);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSMStateLoader::CollectPropertyInformationRequests(vtkSMProxy* proxy,
+  std::vector<vtkSMProxy*>& proxies, std::vector<vtkSMMessage*>& requests)
+{
+  // Same traversal as vtkSMProxy::UpdatePipelineInformation().
+  for (unsigned int cc = 0; cc < proxy->GetNumberOfSubProxies(); ++cc)
+  {
+    this->CollectPropertyInformationRequests(proxy->GetSubProxy(cc), proxies, requests);
+  }
+  vtkSMMessage* request = new vtkSMMessage();
+  if (proxy->BuildPropertyInformationRequest(request))
+  {
+    proxies.push_back(proxy);
+    requests.push_back(request);
+  }
+  else
+  {
+    delete request;
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSMStateLoader::UpdatePipelineInformationOfCreatedProxies()
+{
+  vtkSMSession* session = this->GetSession();
+
+  // Order the created proxies so that each one comes after the proxies it
+  // refers to, which is the order in which the server must create them.
+  std::map<vtkSMProxy*, int> state;
+  std::vector<vtkSMProxy*> created;
+  for (vtkSMStateLoaderInternals::ProxyCreationOrderType::const_iterator iter =
+         this->Internal->ProxyCreationOrder.begin();
+       iter != this->Internal->ProxyCreationOrder.end(); ++iter)
+  {
+    vtkSMProxy* proxy = iter->second;
+    if (proxy && state.find(proxy) == state.end())
+    {
+      state[proxy] = 0;
+      created.push_back(proxy);
+    }
+  }
+  std::vector<vtkSMProxy*> sorted;
+  for (size_t cc = 0; cc < created.size(); ++cc)
+  {
+    vtkSortByDependencies(created[cc], state, sorted);
+  }
+
+  // Push the state of all the proxies, then request the pipeline information
+  // update. The session sends the pushes as one message per server, followed
+  // by one stream per location.
+  if (session)
+  {
+    session->BeginPushStateBatch();
+  }
+  std::vector<vtkSMProxy*> sources;
+  std::map<vtkTypeUInt32, vtkClientServerStream> streams;
+  for (size_t cc = 0; cc < sorted.size(); ++cc)
+  {
+    vtkSMProxy* proxy = sorted[cc];
+    // Calling UpdateVTKObjects() will assign the proxy a GlobalId, if needed.
+    proxy->UpdateVTKObjects();
+    if (proxy->IsA("vtkSMSourceProxy"))
+    {
+      this->CollectPipelineInformationStreams(proxy, streams);
+      sources.push_back(proxy);
+    }
+  }
+  if (session)
+  {
+    for (std::map<vtkTypeUInt32, vtkClientServerStream>::const_iterator iter = streams.begin();
+         iter != streams.end(); ++iter)
+    {
+      session->ExecuteStream(iter->first, iter->second, false);
+    }
+    session->EndPushStateBatch();
+  }
+
+  // Now fetch the information properties of all the sources at once. This is
+  // the part of vtkSMProxy::UpdatePipelineInformation() left to do.
+  std::vector<vtkSMProxy*> proxies;
+  std::vector<vtkSMMessage*> requests;
+  for (size_t cc = 0; cc < sources.size(); ++cc)
+  {
+    this->CollectPropertyInformationRequests(sources[cc], proxies, requests);
+  }
+  if (session && !requests.empty())
+  {
+    session->PullStates(requests);
+    for (size_t cc = 0; cc < requests.size(); ++cc)
+    {
+      proxies[cc]->LoadState(requests[cc], session->GetProxyLocator());
+    }
+  }
+  for (size_t cc = 0; cc < requests.size(); ++cc)
+  {
+    delete requests[cc];
+  }
+
+  for (size_t cc = 0; cc < sources.size(); ++cc)
+  {
+    vtkInvokeUpdateInformationEvent(sources[cc]);
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkSMStateLoader::RegisterProxy(vtkTypeUInt32 id, vtkSMProxy* proxy)
 {
@@ -608,6 +806,11 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
     }
   }
 
+  if (this->BatchPipelineInformationUpdates)
+  {
+    this->UpdatePipelineInformationOfCreatedProxies();
+  }
+
   // Register proxies in order they were created (as that's a good dependency
   // order).
   for (vtkSMStateLoaderInternals::ProxyCreationOrderType::const_iterator iter =
@@ -671,6 +874,8 @@ int vtkSMStateLoader::LoadStateInternal(vtkPVXMLElement* parent)
 void vtkSMStateLoader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "BatchPipelineInformationUpdates: " << this->BatchPipelineInformationUpdates
+     << endl;
 }
 
 //---------------------------------------------------------------------------
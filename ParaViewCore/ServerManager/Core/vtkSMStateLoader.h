@@ -27,10 +27,13 @@
 
 #include "vtkPVServerManagerCoreModule.h" //needed for exports
 #include "vtkSMDeserializerXML.h"
+#include "vtkSMMessageMinimal.h" // needed for vtkSMMessage
 
 #include <map>    // needed for API
 #include <string> // needed for API
+#include <vector> // needed for API
 
+class vtkClientServerStream;
 class vtkPVXMLElement;
 class vtkSMProxy;
 class vtkSMProxyLocator;
@@ -68,6 +71,23 @@ public:
   vtkBooleanMacro(KeepIdMapping, int);
   //@}
 
+  //@{
+  /**
+   * When on, the proxies created while loading the state are pushed and
+   * their pipeline information updated in one pass once all of them have been
+   * created, instead of after each proxy (see CreatedNewProxy()). The pushes
+   * go out in dependency order as one message per server, the server side
+   * updates as one stream per location and the information properties are
+   * pulled with one round trip per server, which matters when loading state
+   * on a remote server. Animation and time-keeper proxies are not affected.
+   * Default is off. vtkSMSessionProxyManager::LoadXMLState() never turns it
+   * on; pass it a loader with batching enabled to opt in.
+   */
+  vtkSetMacro(BatchPipelineInformationUpdates, bool);
+  vtkGetMacro(BatchPipelineInformationUpdates, bool);
+  vtkBooleanMacro(BatchPipelineInformationUpdates, bool);
+  //@}
+
   //@{
   /**
    * Return an array of ids. The ids are stored in the following order
@@ -97,6 +117,8 @@ protected:
    * true). It also called vtkSMProxy::UpdateVTKObjects() and
    * vtkSMProxy::UpdatePipelineInformation() (if applicable) to ensure that the
    * state loaded on the proxy is "pushed" and any info properties updated.
+   * When BatchPipelineInformationUpdates is on and registration is deferred,
+   * both are postponed to UpdatePipelineInformationOfCreatedProxies().
    * We also create a list to track the order in which proxies are created.
    * This order is a dependency order too and hence helps us register proxies in
    * order of dependencies.
@@ -162,9 +184,33 @@ protected:
    */
   vtkSMProxy* LocateExistingProxyUsingRegistrationName(vtkTypeUInt32 id);
 
+  /**
+   * Used when BatchPipelineInformationUpdates is on to push all the proxies
+   * created so far, ordered by their dependencies, and update their pipeline
+   * information.
+   */
+  void UpdatePipelineInformationOfCreatedProxies();
+
+  /**
+   * Appends to \c streams, keyed by location, the server side part of
+   * vtkSMSourceProxy::UpdatePipelineInformation() for \c proxy and its
+   * subproxies.
+   */
+  void CollectPipelineInformationStreams(
+    vtkSMProxy* proxy, std::map<vtkTypeUInt32, vtkClientServerStream>& streams);
+
+  /**
+   * Appends the information property requests of \c proxy and its subproxies
+   * to \c requests, and the proxy each one is for to \c proxies. The caller
+   * deletes the requests.
+   */
+  void CollectPropertyInformationRequests(
+    vtkSMProxy* proxy, std::vector<vtkSMProxy*>& proxies, std::vector<vtkSMMessage*>& requests);
+
   vtkPVXMLElement* ServerManagerStateElement;
   vtkSMProxyLocator* ProxyLocator;
   int KeepIdMapping;
+  bool BatchPipelineInformationUpdates;
 
 private:
   vtkSMStateLoader(const vtkSMStateLoader&) = delete;
@@ -64,14 +64,19 @@ public:
       if (elem)
       {
         elem->SetProxyLocator(this->UndoSetProxyLocator.GetPointer());
-        if (useBeforeState)
+
+        // Elements only keep what changed, so recover the full state from the
+        // latest known one.
+        vtkSMMessage state;
+        if (!this->UndoSetStateLocator->FindState(elem->GetGlobalId(), &state))
         {
-          this->UndoSetStateLocator->RegisterState(elem->BeforeState);
+          state.CopyFrom(useBeforeState ? *elem->BeforeState : *elem->AfterState);
         }
         else
         {
-          this->UndoSetStateLocator->RegisterState(elem->AfterState);
+          elem->ApplyChanges(&state, useBeforeState);
         }
+        this->UndoSetStateLocator->RegisterState(&state);
       }
     }
   }
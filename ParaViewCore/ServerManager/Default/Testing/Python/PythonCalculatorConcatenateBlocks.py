@@ -0,0 +1,105 @@
+# Compares the Python Calculator results on a multiblock dataset with
+# ConcatenateBlocks on and off, for element-wise expressions (evaluated over
+# the concatenated blocks) and for expressions that depend on the blocks or
+# communicate (evaluated per block in both cases). The evaluations of the
+# calculator module are counted to check which path each expression takes.
+from __future__ import print_function
+
+import sys
+
+import numpy as np
+
+from paraview.simple import *
+from paraview import calculator as calculator_module
+from paraview import servermanager
+import vtk.numpy_interface.dataset_adapter as dsa
+
+# Number of evaluations over the concatenated blocks, and block by block.
+counts = { "concatenated" : 0, "per_block" : 0 }
+
+def count_concatenated(original):
+    def wrapper(*args, **kwargs):
+        result = original(*args, **kwargs)
+        if result:
+            counts["concatenated"] += 1
+        return result
+    return wrapper
+
+def count_per_block(original):
+    def wrapper(*args, **kwargs):
+        counts["per_block"] += 1
+        return original(*args, **kwargs)
+    return wrapper
+
+# The calculator runs in this process with the builtin connection.
+calculator_module.compute_concatenated = \
+    count_concatenated(calculator_module.compute_concatenated)
+calculator_module.compute = count_per_block(calculator_module.compute)
+
+s1 = Sphere(ThetaResolution=16, PhiResolution=12)
+s2 = Sphere(Center=[2, 0, 0], Radius=0.75, ThetaResolution=24)
+s3 = Sphere(Center=[0, 3, 0], ThetaResolution=10, PhiResolution=20)
+group = GroupDatasets(Input=[s1, s2, s3])
+elevation = Elevation(Input=group, LowPoint=[0, 0, -1], HighPoint=[2, 3, 1])
+
+elementwise_expressions = [
+    "Elevation * 2 + sin(Elevation)",
+    "mag(Normals) + Elevation / (Elevation + 1)",
+    "(Elevation > 0.5) & (Elevation < 0.8)",
+    "cross(Normals, points) * 2.0 - Normals",
+]
+# indexing, order dependent or reductions.
+per_block_expressions = [
+    "Elevation - Elevation[0]",
+    "Elevation[::-1]",
+    "points[:, 0]",
+    "Elevation - mean(Elevation)",
+    "max(Elevation)",
+]
+
+calculator = PythonCalculator(Input=elevation)
+if calculator.ConcatenateBlocks != 0:
+    print("ERROR: ConcatenateBlocks is expected to be off by default.")
+    sys.exit(1)
+
+failed = False
+
+def evaluate(expression, concatenate, path):
+    global failed
+    counts["concatenated"] = counts["per_block"] = 0
+    calculator.Expression = expression
+    calculator.ConcatenateBlocks = concatenate
+    calculator.UpdatePipeline()
+    if counts["concatenated"] + counts["per_block"] == 0:
+        print("ERROR: '%s': not evaluated." % expression)
+        failed = True
+    elif path == "concatenated" and counts["per_block"] != 0:
+        print("ERROR: '%s': evaluated block by block instead of concatenated." % expression)
+        failed = True
+    elif path == "per_block" and counts["concatenated"] != 0:
+        print("ERROR: '%s': evaluated over the concatenated blocks." % expression)
+        failed = True
+    output = dsa.WrapDataObject(servermanager.Fetch(calculator))
+    return output.PointData["result"]
+
+for expression in elementwise_expressions + per_block_expressions:
+    expected = evaluate(expression, 0, "per_block")
+    actual = evaluate(expression, 1,
+        "concatenated" if expression in elementwise_expressions else "per_block")
+    if expected is dsa.NoneArray or actual is dsa.NoneArray:
+        if not (expected is dsa.NoneArray and actual is dsa.NoneArray):
+            print("ERROR: '%s': result missing on one of the outputs." % expression)
+            failed = True
+        continue
+    if len(expected.Arrays) != len(actual.Arrays):
+        print("ERROR: '%s': number of blocks differ." % expression)
+        failed = True
+        continue
+    for block, (a, b) in enumerate(zip(expected.Arrays, actual.Arrays)):
+        if a is dsa.NoneArray or b is dsa.NoneArray or a.shape != b.shape or \
+            not np.allclose(a, b, equal_nan=True):
+            print("ERROR: '%s': block %d differs." % (expression, block))
+            failed = True
+
+if failed:
+    sys.exit(1)
@@ -0,0 +1,78 @@
+# Compares the elements selected by queries evaluated with numpy and with the
+# sorted indices of vtkPVSortedArrayIndex (extract_selection.use_sorted_index).
+from __future__ import print_function
+
+import sys
+
+import numpy as np
+
+from paraview.simple import *
+from paraview import servermanager
+from paraview import extract_selection
+import vtk.numpy_interface.dataset_adapter as dsa
+
+if extract_selection.use_sorted_index:
+    print("ERROR: use_sorted_index is expected to be off by default.")
+    sys.exit(1)
+
+wavelet = Wavelet()
+calculator = Calculator(Input=wavelet, ResultArrayName="vec",
+    Function="coordsX*iHat + coordsY*jHat + RTData*kHat")
+cells = PointDatatoCellData(Input=calculator, PassPointData=1)
+cells.UpdatePipeline()
+
+# A value of the float RTData array, and a double that rounds to it. numpy
+# compares the float array with the bound in single precision, so 'RTData >
+# bound' does not select the elements equal to the value.
+rtdata = dsa.WrapDataObject(servermanager.Fetch(wavelet)).PointData["RTData"]
+value = float(rtdata[1234])
+bound = value * (1 + 1e-12)
+if np.float32(bound) != np.float32(value) or bound == value:
+    print("ERROR: failed to pick a bound rounding to an array value.")
+    sys.exit(1)
+
+queries = [
+    "RTData > %.17g" % bound,
+    "RTData >= %.17g" % bound,
+    "RTData == %.17g" % bound,
+    "RTData < %.17g" % value,
+    "RTData <= 100.25",
+    "(RTData >= 90.5) & (RTData < 120.1)",
+    "(RTData == %.17g) | (RTData < 60.3)" % value,
+    "RTData == min(RTData)",
+    "RTData == max(RTData)",
+    "vec[:,0] > 2.5",
+    "mag(vec) <= 150",
+    "vec[:,1] == max(vec[:,1])",
+    "id < 42",
+]
+
+def select(fieldType, query, indexed):
+    extract_selection.use_sorted_index = indexed
+    selection = SelectionQuerySource(FieldType=fieldType, QueryString=query)
+    extract = ExtractSelection(Input=cells, Selection=selection)
+    output = dsa.WrapDataObject(servermanager.Fetch(extract))
+    if fieldType == "POINT":
+        ids = output.PointData["vtkOriginalPointIds"]
+    else:
+        ids = output.CellData["vtkOriginalCellIds"]
+    Delete(extract)
+    Delete(selection)
+    return np.sort(ids) if ids is not dsa.NoneArray else np.empty(0)
+
+failed = False
+for fieldType in ("POINT", "CELL"):
+    for query in queries:
+        expected = select(fieldType, query, False)
+        actual = select(fieldType, query, True)
+        if expected.shape != actual.shape or not np.array_equal(expected, actual):
+            print("ERROR: %s '%s': %d elements selected with the index, %d with numpy." % \
+                (fieldType, query, len(actual), len(expected)))
+            failed = True
+        elif len(expected) == 0 and fieldType == "POINT":
+            print("ERROR: %s '%s': nothing selected." % (fieldType, query))
+            failed = True
+
+extract_selection.use_sorted_index = False
+if failed:
+    sys.exit(1)
@@ -50,6 +50,7 @@ vtkPVGeneralSettings::vtkPVGeneralSettings()
   , ScalarBarMode(vtkPVGeneralSettings::AUTOMATICALLY_HIDE_SCALAR_BARS)
   , CacheGeometryForAnimation(false)
   , AnimationGeometryCacheLimit(0)
+  , AnimationGeometryCacheMemoryBudget(0)
   , AnimationTimePrecision(17)
   , ShowAnimationShortcuts(0)
   , PropertiesPanelMode(vtkPVGeneralSettings::ALL_IN_ONE)
@@ -147,6 +148,17 @@ void vtkPVGeneralSettings::SetAnimationGeometryCacheLimit(unsigned long val)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkPVGeneralSettings::SetAnimationGeometryCacheMemoryBudget(unsigned long val)
+{
+  vtkCacheSizeKeeper::GetInstance()->SetMemoryBudget(val);
+  if (this->AnimationGeometryCacheMemoryBudget != val)
+  {
+    this->AnimationGeometryCacheMemoryBudget = val;
+    this->Modified();
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkPVGeneralSettings::SetScalarBarMode(int val)
 {
@@ -225,6 +237,8 @@ void vtkPVGeneralSettings::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ScalarBarMode: " << this->ScalarBarMode << "\n";
   os << indent << "CacheGeometryForAnimation: " << this->CacheGeometryForAnimation << "\n";
   os << indent << "AnimationGeometryCacheLimit: " << this->AnimationGeometryCacheLimit << "\n";
+  os << indent << "AnimationGeometryCacheMemoryBudget: " << this->AnimationGeometryCacheMemoryBudget
+     << "\n";
   os << indent << "PropertiesPanelMode: " << this->PropertiesPanelMode << "\n";
   os << indent << "LockPanels: " << this->LockPanels << "\n";
 }
@@ -152,6 +152,15 @@ public:
   vtkGetMacro(AnimationGeometryCacheLimit, unsigned long);
   //@}
 
+  //@{
+  /**
+   * Set the memory budget for each process in KBs. The geometry cached for
+   * animations is released when any process exceeds it. 0 disables the budget.
+   */
+  void SetAnimationGeometryCacheMemoryBudget(unsigned long val);
+  vtkGetMacro(AnimationGeometryCacheMemoryBudget, unsigned long);
+  //@}
+
   //@{
   /**
    * Set the precision of the animation time toolbar.
@@ -241,6 +250,7 @@ protected:
   int ScalarBarMode;
   bool CacheGeometryForAnimation;
   unsigned long AnimationGeometryCacheLimit;
+  unsigned long AnimationGeometryCacheMemoryBudget;
   int AnimationTimePrecision;
   bool ShowAnimationShortcuts;
   int PropertiesPanelMode;
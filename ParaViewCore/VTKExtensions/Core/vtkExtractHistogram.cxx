@@ -14,9 +14,11 @@
 =========================================================================*/
 #include "vtkExtractHistogram.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkDoubleArray.h"
 #include "vtkGraph.h"
@@ -27,10 +29,14 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTable.h"
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -260,11 +266,273 @@ void vtkExtractHistogram::FillBinExtents(vtkDoubleArray* bin_extents, double min
   }
 }
 
-inline int vtkExtractHistogramClamp(int value, int min, int max)
+namespace
 {
-  value = value < min ? min : value;
-  value = value > max ? max : value;
-  return value;
+//-----------------------------------------------------------------------------
+// Maps values to bins. Values below the first bin (and NaNs) go in the first
+// bin, values above the last bin in the last one.
+class vtkHistogramBinner
+{
+public:
+  vtkHistogramBinner(double min, double delta, double offset, int binCount)
+    : Min(min)
+    , Delta(delta)
+    , Offset(offset)
+    , LastBin(binCount - 1)
+  {
+  }
+
+  int operator()(double value) const
+  {
+    const double findex = (value - this->Min + this->Offset) / this->Delta;
+    if (!(findex >= 0.0))
+    {
+      return 0;
+    }
+    return findex >= this->LastBin ? this->LastBin : static_cast<int>(findex);
+  }
+
+  double Min;
+  double Delta;
+  double Offset;
+  int LastBin;
+};
+
+//-----------------------------------------------------------------------------
+// Adds the tuples of an array to the totals of their bin. Created once per
+// array so that the type of the array is resolved once, not per tuple.
+class vtkBinTotals
+{
+public:
+  virtual ~vtkBinTotals() {}
+  virtual void Add(vtkIdType begin, vtkIdType end, const int* bins, double* totals) const = 0;
+  int NumberOfComponents;
+};
+
+template <typename ArrayT>
+class vtkTypedBinTotals : public vtkBinTotals
+{
+public:
+  vtkTypedBinTotals(ArrayT* array)
+    : Array(array)
+  {
+    this->NumberOfComponents = array->GetNumberOfComponents();
+  }
+
+  void Add(vtkIdType begin, vtkIdType end, const int* bins, double* totals) const VTK_OVERRIDE
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(this->Array);
+    const int numComps = this->NumberOfComponents;
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      double* binTotals = totals + static_cast<size_t>(bins[cc - begin]) * numComps;
+      for (int comp = 0; comp < numComps; ++comp)
+      {
+        binTotals[comp] += static_cast<double>(accessor.Get(cc, comp));
+      }
+    }
+  }
+
+  ArrayT* Array;
+};
+
+struct vtkBinTotalsWorker
+{
+  vtkBinTotalsWorker()
+    : Result(NULL)
+  {
+  }
+
+  template <typename ArrayT>
+  void operator()(ArrayT* array)
+  {
+    this->Result = new vtkTypedBinTotals<ArrayT>(array);
+  }
+
+  vtkBinTotals* Result;
+};
+
+//-----------------------------------------------------------------------------
+// Counts the values of a component per bin, in per-thread buffers. The values
+// of the other arrays are summed per bin in the same pass, when averages are
+// requested.
+template <typename ArrayT>
+class vtkCountFunctor
+{
+public:
+  vtkCountFunctor(ArrayT* array, int component, const vtkHistogramBinner& binner,
+    const std::vector<vtkBinTotals*>& totals)
+    : Array(array)
+    , Component(component)
+    , Binner(binner)
+    , Totals(totals)
+  {
+  }
+
+  struct LocalData
+  {
+    std::vector<vtkIdType> Counts;
+    std::vector<std::vector<double> > Totals;
+    std::vector<int> Bins;
+  };
+
+  void Initialize()
+  {
+    const int binCount = this->Binner.LastBin + 1;
+    LocalData& local = this->Local.Local();
+    local.Counts.assign(binCount, 0);
+    local.Totals.resize(this->Totals.size());
+    for (size_t cc = 0; cc < this->Totals.size(); ++cc)
+    {
+      local.Totals[cc].assign(
+        static_cast<size_t>(binCount) * this->Totals[cc]->NumberOfComponents, 0.0);
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(this->Array);
+    LocalData& local = this->Local.Local();
+    if (this->Totals.empty())
+    {
+      for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+        ++local.Counts[this->Binner(static_cast<double>(accessor.Get(cc, this->Component)))];
+      }
+      return;
+    }
+
+    // The bins of a block of tuples are kept so that the other arrays can be
+    // summed with the same bins.
+    const vtkIdType blockSize = 1024;
+    local.Bins.resize(blockSize);
+    for (vtkIdType first = begin; first < end; first += blockSize)
+    {
+      const vtkIdType last = std::min(first + blockSize, end);
+      for (vtkIdType cc = first; cc < last; ++cc)
+      {
+        const int bin = this->Binner(static_cast<double>(accessor.Get(cc, this->Component)));
+        ++local.Counts[bin];
+        local.Bins[cc - first] = bin;
+      }
+      for (size_t cc = 0; cc < this->Totals.size(); ++cc)
+      {
+        this->Totals[cc]->Add(first, last, &local.Bins[0], &local.Totals[cc][0]);
+      }
+    }
+  }
+
+  void Reduce() {}
+
+  ArrayT* Array;
+  int Component;
+  vtkHistogramBinner Binner;
+  const std::vector<vtkBinTotals*>& Totals;
+  vtkSMPThreadLocal<LocalData> Local;
+};
+
+//-----------------------------------------------------------------------------
+// Fast path for 8-bit arrays: values are counted per raw value, without any
+// floating point arithmetic, and the 256 counts are mapped to bins at the end.
+template <typename ArrayT>
+class vtkByteCountFunctor
+{
+public:
+  typedef typename vtkDataArrayAccessor<ArrayT>::APIType ValueType;
+
+  vtkByteCountFunctor(ArrayT* array, int component)
+    : Array(array)
+    , Component(component)
+  {
+  }
+
+  void Initialize() { this->Counts.Local().assign(256, 0); }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(this->Array);
+    std::vector<vtkIdType>& counts = this->Counts.Local();
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      ++counts[static_cast<unsigned char>(accessor.Get(cc, this->Component))];
+    }
+  }
+
+  void Reduce() {}
+
+  ArrayT* Array;
+  int Component;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Counts;
+};
+
+//-----------------------------------------------------------------------------
+struct vtkCountWorker
+{
+  vtkCountWorker(
+    int component, const vtkHistogramBinner& binner, const std::vector<vtkBinTotals*>& totals)
+    : Component(component)
+    , Binner(binner)
+    , Totals(totals)
+    , Counts(binner.LastBin + 1, 0)
+  {
+    this->BinTotals.resize(totals.size());
+    for (size_t cc = 0; cc < totals.size(); ++cc)
+    {
+      this->BinTotals[cc].assign(
+        static_cast<size_t>(binner.LastBin + 1) * totals[cc]->NumberOfComponents, 0.0);
+    }
+  }
+
+  template <typename ArrayT>
+  void operator()(ArrayT* array)
+  {
+    typedef typename vtkDataArrayAccessor<ArrayT>::APIType ValueType;
+    const vtkIdType numTuples = array->GetNumberOfTuples();
+    if (std::numeric_limits<ValueType>::is_integer && sizeof(ValueType) == 1 &&
+      this->Totals.empty())
+    {
+      vtkByteCountFunctor<ArrayT> functor(array, this->Component);
+      vtkSMPTools::For(0, numTuples, functor);
+      for (typename vtkSMPThreadLocal<std::vector<vtkIdType> >::iterator iter =
+             functor.Counts.begin();
+           iter != functor.Counts.end(); ++iter)
+      {
+        for (int raw = 0; raw < 256; ++raw)
+        {
+          const ValueType value = static_cast<ValueType>(static_cast<unsigned char>(raw));
+          this->Counts[this->Binner(static_cast<double>(value))] += (*iter)[raw];
+        }
+      }
+      return;
+    }
+
+    typedef vtkCountFunctor<ArrayT> FunctorType;
+    FunctorType functor(array, this->Component, this->Binner, this->Totals);
+    vtkSMPTools::For(0, numTuples, functor);
+    for (typename vtkSMPThreadLocal<typename FunctorType::LocalData>::iterator iter =
+           functor.Local.begin();
+         iter != functor.Local.end(); ++iter)
+    {
+      for (size_t bin = 0; bin < this->Counts.size(); ++bin)
+      {
+        this->Counts[bin] += iter->Counts[bin];
+      }
+      for (size_t cc = 0; cc < this->BinTotals.size(); ++cc)
+      {
+        for (size_t idx = 0; idx < this->BinTotals[cc].size(); ++idx)
+        {
+          this->BinTotals[cc][idx] += iter->Totals[cc][idx];
+        }
+      }
+    }
+  }
+
+  int Component;
+  vtkHistogramBinner Binner;
+  const std::vector<vtkBinTotals*>& Totals;
+  std::vector<vtkIdType> Counts;
+  std::vector<std::vector<double> > BinTotals;
+};
 }
 
 //-----------------------------------------------------------------------------
@@ -279,50 +547,67 @@ void vtkExtractHistogram::BinAnArray(
     return;
   }
 
-  int num_of_tuples = data_array->GetNumberOfTuples();
+  const vtkIdType num_of_tuples = data_array->GetNumberOfTuples();
   double bin_delta =
     (max - min) / (this->CenterBinsAroundMinAndMax ? (this->BinCount - 1) : this->BinCount);
   double half_delta = bin_delta / 2.0;
-
-  for (int i = 0; i != num_of_tuples; ++i)
+  vtkHistogramBinner binner(
+    min, bin_delta, this->CenterBinsAroundMinAndMax ? half_delta : 0., this->BinCount);
+
+  // When averages are requested, the other arrays are summed per bin while
+  // the values are counted.
+  std::vector<vtkDataArray*> arrays;
+  std::vector<vtkBinTotals*> totals;
+  if (this->CalculateAverages && field)
   {
-    if (i % 1000 == 0)
+    int num_arrays = field->GetNumberOfArrays();
+    for (int idx = 0; idx < num_arrays; idx++)
     {
-      this->UpdateProgress(0.10 + 0.90 * i / num_of_tuples);
+      vtkDataArray* array = field->GetArray(idx);
+      if (array && array != data_array && array->GetName() &&
+        array->GetNumberOfTuples() >= num_of_tuples)
+      {
+        vtkBinTotalsWorker worker;
+        if (!vtkArrayDispatch::Dispatch::Execute(array, worker))
+        {
+          worker(array);
+        }
+        arrays.push_back(array);
+        totals.push_back(worker.Result);
+      }
     }
-    const double value = data_array->GetComponent(i, this->Component);
-    int index = static_cast<int>(
-      (value - min + (this->CenterBinsAroundMinAndMax ? half_delta : 0.)) / bin_delta);
+  }
 
-    // If the value is equal to max, include it in the last bin.
-    index = ::vtkExtractHistogramClamp(index, 0, this->BinCount - 1);
-    bin_values->SetValue(index, bin_values->GetValue(index) + 1);
+  this->UpdateProgress(0.10);
+  vtkCountWorker counter(this->Component, binner, totals);
+  if (!vtkArrayDispatch::Dispatch::Execute(data_array, counter))
+  {
+    counter(data_array);
+  }
+  for (int bin = 0; bin < this->BinCount; ++bin)
+  {
+    bin_values->SetValue(bin, bin_values->GetValue(bin) + static_cast<int>(counter.Counts[bin]));
+  }
 
-    if (this->CalculateAverages)
+  // For each bin, we keep the total of each array. At the end, each total is
+  // divided by the number of elements in the bin.
+  for (size_t cc = 0; cc < arrays.size(); ++cc)
+  {
+    vtkEHInternals::ArrayValuesType& arrayValues =
+      this->Internal->ArrayValues[arrays[cc]->GetName()];
+    arrayValues.TotalValues.resize(this->BinCount);
+    int numComps = totals[cc]->NumberOfComponents;
+    for (int bin = 0; bin < this->BinCount; ++bin)
     {
-      // Get all other arrays, add their value to the bin
-      // For each bin, we will need 2 values per array ->
-      // total, num. elements
-      // at the end, divide each total by num. elements
-      int num_arrays = field->GetNumberOfArrays();
-      for (int idx = 0; idx < num_arrays; idx++)
+      arrayValues.TotalValues[bin].resize(numComps);
+      for (int comp = 0; comp < numComps; comp++)
       {
-        vtkDataArray* array = field->GetArray(idx);
-        if (array && array != data_array && array->GetName())
-        {
-          vtkEHInternals::ArrayValuesType& arrayValues =
-            this->Internal->ArrayValues[array->GetName()];
-          arrayValues.TotalValues.resize(this->BinCount);
-          int numComps = array->GetNumberOfComponents();
-          arrayValues.TotalValues[index].resize(numComps);
-          for (int comp = 0; comp < numComps; comp++)
-          {
-            arrayValues.TotalValues[index][comp] += array->GetComponent(i, comp);
-          }
-        }
+        arrayValues.TotalValues[bin][comp] += counter.BinTotals[cc][bin * numComps + comp];
       }
     }
+    delete totals[cc];
   }
+  this->UpdateProgress(1.0);
 }
 
 //-----------------------------------------------------------------------------
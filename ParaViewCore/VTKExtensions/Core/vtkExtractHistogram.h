@@ -22,6 +22,10 @@
  * will have contain a vtkDoubleArray named "bin_extents" which contains
  * the boundaries between each histogram bin, and a vtkUnsignedLongArray
  * named "bin_values" which will contain the value for each bin.
+ *
+ * Values are binned in parallel using vtkSMPTools, accessing the arrays in
+ * their native type. Values outside the bin range (and NaNs) are counted in
+ * the first or last bin.
 */
 
 #ifndef vtkExtractHistogram_h
@@ -21,6 +21,7 @@
 #include "vtkCompositeDataSet.h"
 #include "vtkDataSet.h"
 #include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -28,12 +29,15 @@
 #include "vtkMultiProcessController.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
-#include "vtkPointData.h"
-#include "vtkPolygon.h"
-#include "vtkTriangle.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkIntegrateAttributes);
 
 class vtkIntegrateAttributes::vtkFieldList : public vtkDataSetAttributes::FieldList
@@ -69,112 +73,145 @@ public:
   }
 };
 
-//-----------------------------------------------------------------------------
-vtkIntegrateAttributes::vtkIntegrateAttributes()
+namespace
 {
-  this->IntegrationDimension = 0;
-  this->Sum = 0.0;
-  this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
-  this->Controller = 0;
-
-  this->PointFieldList = 0;
-  this->CellFieldList = 0;
-  this->FieldListIndex = 0;
-
-  this->DivideAllCellDataByVolume = false;
+// Cells are integrated in chunks of these many cells. Each chunk is summed up
+// separately and the chunks are then added in order, so that the result does
+// not depend on the number of threads.
+const vtkIdType vtkIntegrationChunkSize = 4096;
 
-  SetController(vtkMultiProcessController::GetGlobalController());
-}
+//-----------------------------------------------------------------------------
+// Input arrays to integrate, and the offset of their first component in
+// vtkIntegrationResult::PointValues or CellValues.
+struct vtkIntegrationFields
+{
+  std::vector<vtkDataArray*> Arrays;
+  std::vector<size_t> Offsets;
+};
 
 //-----------------------------------------------------------------------------
-vtkIntegrateAttributes::~vtkIntegrateAttributes()
+// Integrals over a range of cells.
+class vtkIntegrationResult
 {
-  if (this->Controller)
+public:
+  vtkIntegrationResult()
+    : Dimension(0)
+    , Sum(0.0)
+    , NumberOfSkippedCells(0)
   {
-    this->Controller->Delete();
-    this->Controller = 0;
+    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
   }
-}
 
-//----------------------------------------------------------------------------
-void vtkIntegrateAttributes::SetController(vtkMultiProcessController* controller)
-{
-  if (this->Controller)
+  void Initialize(size_t numPointValues, size_t numCellValues)
   {
-    this->Controller->UnRegister(this);
+    this->Dimension = 0;
+    this->NumberOfSkippedCells = 0;
+    this->PointValues.resize(numPointValues);
+    this->CellValues.resize(numCellValues);
+    this->Zero();
   }
 
-  this->Controller = controller;
+  // Same as vtkIntegrateAttributes::CompareIntegrationDimension(): higher
+  // dimension prevails.
+  bool CompareIntegrationDimension(int dim)
+  {
+    if (this->Dimension < dim)
+    {
+      this->Zero();
+      this->Dimension = dim;
+      return true;
+    }
+    return this->Dimension == dim;
+  }
 
-  if (this->Controller)
+  void Add(const vtkIntegrationResult& other)
   {
-    this->Controller->Register(this);
+    this->NumberOfSkippedCells += other.NumberOfSkippedCells;
+    if (other.Dimension == 0 || !this->CompareIntegrationDimension(other.Dimension))
+    {
+      return;
+    }
+    this->Sum += other.Sum;
+    this->SumCenter[0] += other.SumCenter[0];
+    this->SumCenter[1] += other.SumCenter[1];
+    this->SumCenter[2] += other.SumCenter[2];
+    for (size_t i = 0; i < this->PointValues.size(); ++i)
+    {
+      this->PointValues[i] += other.PointValues[i];
+    }
+    for (size_t i = 0; i < this->CellValues.size(); ++i)
+    {
+      this->CellValues[i] += other.CellValues[i];
+    }
   }
-}
 
-//----------------------------------------------------------------------------
-vtkExecutive* vtkIntegrateAttributes::CreateDefaultExecutive()
-{
-  return vtkCompositeDataPipeline::New();
-}
+  int Dimension;
+  double Sum;
+  double SumCenter[3];
+  std::vector<double> PointValues;
+  std::vector<double> CellValues;
+  vtkIdType NumberOfSkippedCells;
 
-//----------------------------------------------------------------------------
-int vtkIntegrateAttributes::FillInputPortInformation(int port, vtkInformation* info)
-{
-  if (!this->Superclass::FillInputPortInformation(port, info))
+private:
+  void Zero()
   {
-    return 0;
+    this->Sum = 0.0;
+    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
+    std::fill(this->PointValues.begin(), this->PointValues.end(), 0.0);
+    std::fill(this->CellValues.begin(), this->CellValues.end(), 0.0);
   }
-  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataObject");
-  return 1;
-}
+};
 
 //-----------------------------------------------------------------------------
-int vtkIntegrateAttributes::CompareIntegrationDimension(vtkDataSet* output, int dim)
+// Integrates chunks of cells of a dataset, one vtkIntegrationResult per chunk.
+class vtkIntegrateCells
 {
-  // higher dimension prevails
-  if (this->IntegrationDimension < dim)
-  { // Throw out results from lower dimension.
-    this->Sum = 0;
-    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
-    this->ZeroAttributes(output->GetPointData());
-    this->ZeroAttributes(output->GetCellData());
-    this->IntegrationDimension = dim;
-    return 1;
+public:
+  vtkIntegrateCells(vtkDataSet* input, const vtkIntegrationFields& pointFields,
+    const vtkIntegrationFields& cellFields, std::vector<vtkIntegrationResult>& results,
+    size_t numPointValues, size_t numCellValues)
+    : Input(input)
+    , GhostArray(input->GetCellGhostArray())
+    , PointFields(pointFields)
+    , CellFields(cellFields)
+    , Results(results)
+    , NumberOfPointValues(numPointValues)
+    , NumberOfCellValues(numCellValues)
+  {
   }
-  // Skip this cell if we are inetrgrting a higher dimension.
-  return (this->IntegrationDimension == dim);
-}
-
-//----------------------------------------------------------------------------
-void vtkIntegrateAttributes::ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid* output,
-  int fieldset_index, vtkIntegrateAttributes::vtkFieldList& pdList,
-  vtkIntegrateAttributes::vtkFieldList& cdList)
-{
-  vtkUnsignedCharArray* ghostArray = input->GetCellGhostArray();
 
-  // This is sort of a hack since it's incredibly painful to change all the
-  // signatures to take the pdList, cdList and fieldset_index.
-  this->PointFieldList = &pdList;
-  this->CellFieldList = &cdList;
-  this->FieldListIndex = fieldset_index;
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    const vtkIdType numCells = this->Input->GetNumberOfCells();
+    vtkIdList* cellPtIds = this->CellPtIds.Local();
+    vtkPoints* cellPoints = this->CellPoints.Local();
+    vtkGenericCell* cell = this->Cell.Local();
+    for (vtkIdType chunk = begin; chunk < end; ++chunk)
+    {
+      vtkIntegrationResult& result = this->Results[chunk];
+      result.Initialize(this->NumberOfPointValues, this->NumberOfCellValues);
+      const vtkIdType last = std::min((chunk + 1) * vtkIntegrationChunkSize, numCells);
+      for (vtkIdType cellId = chunk * vtkIntegrationChunkSize; cellId < last; ++cellId)
+      {
+        this->IntegrateCell(result, cellId, cellPtIds, cellPoints, cell);
+      }
+    }
+  }
 
-  vtkIdList* cellPtIds = vtkIdList::New();
-  vtkIdType numCells = input->GetNumberOfCells();
-  vtkIdType cellId;
-  vtkPoints* cellPoints = 0; // needed if we need to split 3D cells
-  int cellType;
-  for (cellId = 0; cellId < numCells; ++cellId)
+private:
+  void IntegrateCell(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* cellPtIds,
+    vtkPoints* cellPoints, vtkGenericCell* cell)
   {
-    cellType = input->GetCellType(cellId);
+    vtkDataSet* input = this->Input;
     // Make sure we are not integrating ghost/blanked cells.
-    if (ghostArray && (ghostArray->GetValue(cellId) &
-                        (vtkDataSetAttributes::DUPLICATECELL | vtkDataSetAttributes::HIDDENCELL)))
+    if (this->GhostArray &&
+      (this->GhostArray->GetValue(cellId) &
+        (vtkDataSetAttributes::DUPLICATECELL | vtkDataSetAttributes::HIDDENCELL)))
     {
-      continue;
+      return;
     }
 
-    switch (cellType)
+    switch (input->GetCellType(cellId))
     {
       // skip empty or 0D Cells
       case VTK_EMPTY_CELL:
@@ -184,145 +221,642 @@ void vtkIntegrateAttributes::ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid
 
       case VTK_POLY_LINE:
       case VTK_LINE:
-      {
-        if (this->CompareIntegrationDimension(output, 1))
+        if (result.CompareIntegrationDimension(1))
         {
           input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePolyLine(input, output, cellId, cellPtIds);
+          this->IntegratePolyLine(result, cellId, cellPtIds);
         }
-      }
-      break;
+        break;
 
       case VTK_TRIANGLE:
-      {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (result.CompareIntegrationDimension(2))
         {
           input->GetCellPoints(cellId, cellPtIds);
           this->IntegrateTriangle(
-            input, output, cellId, cellPtIds->GetId(0), cellPtIds->GetId(1), cellPtIds->GetId(2));
+            result, cellId, cellPtIds->GetId(0), cellPtIds->GetId(1), cellPtIds->GetId(2));
         }
-      }
-      break;
+        break;
 
       case VTK_TRIANGLE_STRIP:
-      {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (result.CompareIntegrationDimension(2))
         {
           input->GetCellPoints(cellId, cellPtIds);
-          this->IntegrateTriangleStrip(input, output, cellId, cellPtIds);
+          this->IntegrateTriangleStrip(result, cellId, cellPtIds);
         }
-      }
-      break;
+        break;
 
       case VTK_POLYGON:
-      {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (result.CompareIntegrationDimension(2))
         {
           input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePolygon(input, output, cellId, cellPtIds);
+          this->IntegratePolygon(result, cellId, cellPtIds);
         }
-      }
-      break;
+        break;
 
       case VTK_PIXEL:
-      {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (result.CompareIntegrationDimension(2))
         {
           input->GetCellPoints(cellId, cellPtIds);
-          this->IntegratePixel(input, output, cellId, cellPtIds);
+          this->IntegratePixel(result, cellId, cellPtIds);
         }
-      }
-      break;
+        break;
 
       case VTK_QUAD:
-      {
-        if (this->CompareIntegrationDimension(output, 2))
+        if (result.CompareIntegrationDimension(2))
         {
           vtkIdType pt1Id, pt2Id, pt3Id;
           input->GetCellPoints(cellId, cellPtIds);
           pt1Id = cellPtIds->GetId(0);
           pt2Id = cellPtIds->GetId(1);
           pt3Id = cellPtIds->GetId(2);
-          this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
+          this->IntegrateTriangle(result, cellId, pt1Id, pt2Id, pt3Id);
           pt2Id = cellPtIds->GetId(3);
-          this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
+          this->IntegrateTriangle(result, cellId, pt1Id, pt2Id, pt3Id);
         }
-      }
-      break;
+        break;
 
       case VTK_VOXEL:
-      {
-        if (this->CompareIntegrationDimension(output, 3))
+        if (result.CompareIntegrationDimension(3))
         {
           input->GetCellPoints(cellId, cellPtIds);
-          this->IntegrateVoxel(input, output, cellId, cellPtIds);
+          this->IntegrateVoxel(result, cellId, cellPtIds);
         }
-      }
-      break;
+        break;
 
       case VTK_TETRA:
-      {
-        if (this->CompareIntegrationDimension(output, 3))
+        if (result.CompareIntegrationDimension(3))
         {
-          vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
           input->GetCellPoints(cellId, cellPtIds);
-          pt1Id = cellPtIds->GetId(0);
-          pt2Id = cellPtIds->GetId(1);
-          pt3Id = cellPtIds->GetId(2);
-          pt4Id = cellPtIds->GetId(3);
-          this->IntegrateTetrahedron(input, output, cellId, pt1Id, pt2Id, pt3Id, pt4Id);
+          this->IntegrateTetrahedron(result, cellId, cellPtIds->GetId(0), cellPtIds->GetId(1),
+            cellPtIds->GetId(2), cellPtIds->GetId(3));
         }
-      }
-      break;
+        break;
 
       default:
       {
         // We need to explicitly get the cell
-        vtkCell* cell = input->GetCell(cellId);
+        input->GetCell(cellId, cell);
         int cellDim = cell->GetCellDimension();
-        if (cellDim == 0)
-        {
-          continue;
-        }
-        if (!this->CompareIntegrationDimension(output, cellDim))
+        if (cellDim == 0 || !result.CompareIntegrationDimension(cellDim))
         {
-          continue;
+          return;
         }
 
-        // We will need a place to store points from the cell's
-        // triangulate function
-        if (!cellPoints)
+        cell->Triangulate(1, cellPtIds, cellPoints);
+        switch (cellDim)
         {
-          cellPoints = vtkPoints::New();
+          case 1:
+            this->IntegrateGeneral1DCell(result, cellId, cellPtIds);
+            break;
+          case 2:
+            this->IntegrateGeneral2DCell(result, cellId, cellPtIds);
+            break;
+          case 3:
+            this->IntegrateGeneral3DCell(result, cellId, cellPtIds);
+            break;
+          default:
+            result.NumberOfSkippedCells++;
         }
+      }
+    }
+  }
+
+  void IntegrateData1(const vtkIntegrationFields& fields, std::vector<double>& values,
+    vtkIdType pt1Id, double k)
+  {
+    for (size_t i = 0; i < fields.Arrays.size(); ++i)
+    {
+      vtkDataArray* inArray = fields.Arrays[i];
+      double* vOut = &values[0] + fields.Offsets[i];
+      int numComponents = inArray->GetNumberOfComponents();
+      for (int j = 0; j < numComponents; ++j)
+      {
+        double dv = inArray->GetComponent(pt1Id, j);
+        vOut[j] += dv * k;
+      }
+    }
+  }
+
+  void IntegrateData2(const vtkIntegrationFields& fields, std::vector<double>& values,
+    vtkIdType pt1Id, vtkIdType pt2Id, double k)
+  {
+    for (size_t i = 0; i < fields.Arrays.size(); ++i)
+    {
+      vtkDataArray* inArray = fields.Arrays[i];
+      double* vOut = &values[0] + fields.Offsets[i];
+      int numComponents = inArray->GetNumberOfComponents();
+      for (int j = 0; j < numComponents; ++j)
+      {
+        double dv = 0.5 * (inArray->GetComponent(pt1Id, j) + inArray->GetComponent(pt2Id, j));
+        vOut[j] += dv * k;
+      }
+    }
+  }
+
+  void IntegrateData3(const vtkIntegrationFields& fields, std::vector<double>& values,
+    vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, double k)
+  {
+    for (size_t i = 0; i < fields.Arrays.size(); ++i)
+    {
+      vtkDataArray* inArray = fields.Arrays[i];
+      double* vOut = &values[0] + fields.Offsets[i];
+      int numComponents = inArray->GetNumberOfComponents();
+      for (int j = 0; j < numComponents; ++j)
+      {
+        double dv = (inArray->GetComponent(pt1Id, j) + inArray->GetComponent(pt2Id, j) +
+                      inArray->GetComponent(pt3Id, j)) /
+          3.0;
+        vOut[j] += dv * k;
+      }
+    }
+  }
+
+  void IntegrateData4(const vtkIntegrationFields& fields, std::vector<double>& values,
+    vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id, double k)
+  {
+    for (size_t i = 0; i < fields.Arrays.size(); ++i)
+    {
+      vtkDataArray* inArray = fields.Arrays[i];
+      double* vOut = &values[0] + fields.Offsets[i];
+      int numComponents = inArray->GetNumberOfComponents();
+      for (int j = 0; j < numComponents; ++j)
+      {
+        double dv = (inArray->GetComponent(pt1Id, j) + inArray->GetComponent(pt2Id, j) +
+                      inArray->GetComponent(pt3Id, j) + inArray->GetComponent(pt4Id, j)) *
+          0.25;
+        vOut[j] += dv * k;
+      }
+    }
+  }
+
+  void IntegrateLine(vtkIntegrationResult& result, vtkIdType cellId, vtkIdType pt1Id,
+    vtkIdType pt2Id)
+  {
+    double pt1[3], pt2[3], mid[3];
+    this->Input->GetPoint(pt1Id, pt1);
+    this->Input->GetPoint(pt2Id, pt2);
+
+    // Compute the length of the line.
+    double length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
+    result.Sum += length;
+
+    // Compute the middle, which is really just another attribute.
+    mid[0] = (pt1[0] + pt2[0]) * 0.5;
+    mid[1] = (pt1[1] + pt2[1]) * 0.5;
+    mid[2] = (pt1[2] + pt2[2]) * 0.5;
+    // Add weighted to sumCenter.
+    result.SumCenter[0] += mid[0] * length;
+    result.SumCenter[1] += mid[1] * length;
+    result.SumCenter[2] += mid[2] * length;
+
+    // Now integrate the rest of the attributes.
+    this->IntegrateData2(this->PointFields, result.PointValues, pt1Id, pt2Id, length);
+    this->IntegrateData1(this->CellFields, result.CellValues, cellId, length);
+  }
+
+  void IntegratePolyLine(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    vtkIdType numLines = ptIds->GetNumberOfIds() - 1;
+    for (vtkIdType lineIdx = 0; lineIdx < numLines; ++lineIdx)
+    {
+      this->IntegrateLine(result, cellId, ptIds->GetId(lineIdx), ptIds->GetId(lineIdx + 1));
+    }
+  }
+
+  void IntegrateGeneral1DCell(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    // Determine the number of lines
+    vtkIdType nPnts = ptIds->GetNumberOfIds();
+    // There should be an even number of points from the triangulation
+    if (nPnts % 2)
+    {
+      result.NumberOfSkippedCells++;
+      return;
+    }
+    for (vtkIdType pid = 0; pid < nPnts; pid += 2)
+    {
+      this->IntegrateLine(result, cellId, ptIds->GetId(pid), ptIds->GetId(pid + 1));
+    }
+  }
+
+  void IntegrateTriangleStrip(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    vtkIdType numTris = ptIds->GetNumberOfIds() - 2;
+    for (vtkIdType triIdx = 0; triIdx < numTris; ++triIdx)
+    {
+      this->IntegrateTriangle(result, cellId, ptIds->GetId(triIdx), ptIds->GetId(triIdx + 1),
+        ptIds->GetId(triIdx + 2));
+    }
+  }
+
+  // Works for convex polygons, and interpoaltion is not correct.
+  void IntegratePolygon(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    vtkIdType numTris = ptIds->GetNumberOfIds() - 2;
+    vtkIdType pt1Id = ptIds->GetId(0);
+    for (vtkIdType triIdx = 0; triIdx < numTris; ++triIdx)
+    {
+      this->IntegrateTriangle(
+        result, cellId, pt1Id, ptIds->GetId(triIdx + 1), ptIds->GetId(triIdx + 2));
+    }
+  }
+
+  // For axis alligned rectangular cells
+  void IntegratePixel(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* cellPtIds)
+  {
+    vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
+    double pts[4][3];
+    pt1Id = cellPtIds->GetId(0);
+    pt2Id = cellPtIds->GetId(1);
+    pt3Id = cellPtIds->GetId(2);
+    pt4Id = cellPtIds->GetId(3);
+    this->Input->GetPoint(pt1Id, pts[0]);
+    this->Input->GetPoint(pt2Id, pts[1]);
+    this->Input->GetPoint(pt3Id, pts[2]);
+    this->Input->GetPoint(pt4Id, pts[3]);
+
+    double l, w, a, mid[3];
+
+    // get the lengths of its 2 orthogonal sides.  Since only 1 coordinate
+    // can be different we can add the differences in all 3 directions
+    l = (pts[0][0] - pts[1][0]) + (pts[0][1] - pts[1][1]) + (pts[0][2] - pts[1][2]);
+
+    w = (pts[0][0] - pts[2][0]) + (pts[0][1] - pts[2][1]) + (pts[0][2] - pts[2][2]);
+
+    a = fabs(l * w);
+    result.Sum += a;
+    // Compute the middle, which is really just another attribute.
+    mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.25;
+    mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.25;
+    mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.25;
+    // Add weighted to sumCenter.
+    result.SumCenter[0] += mid[0] * a;
+    result.SumCenter[1] += mid[1] * a;
+    result.SumCenter[2] += mid[2] * a;
+
+    // Now integrate the rest of the attributes.
+    this->IntegrateData4(this->PointFields, result.PointValues, pt1Id, pt2Id, pt3Id, pt4Id, a);
+    this->IntegrateData1(this->CellFields, result.CellValues, cellId, a);
+  }
+
+  void IntegrateTriangle(vtkIntegrationResult& result, vtkIdType cellId, vtkIdType pt1Id,
+    vtkIdType pt2Id, vtkIdType pt3Id)
+  {
+    double pt1[3], pt2[3], pt3[3];
+    double mid[3], v1[3], v2[3];
+    double cross[3];
+    double k;
+
+    this->Input->GetPoint(pt1Id, pt1);
+    this->Input->GetPoint(pt2Id, pt2);
+    this->Input->GetPoint(pt3Id, pt3);
+
+    // Compute two legs.
+    v1[0] = pt2[0] - pt1[0];
+    v1[1] = pt2[1] - pt1[1];
+    v1[2] = pt2[2] - pt1[2];
+    v2[0] = pt3[0] - pt1[0];
+    v2[1] = pt3[1] - pt1[1];
+    v2[2] = pt3[2] - pt1[2];
+
+    // Use the cross product to compute the area of the parallelogram.
+    vtkMath::Cross(v1, v2, cross);
+    k = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
+
+    if (k == 0.0)
+    {
+      return;
+    }
+    result.Sum += k;
+
+    // Compute the middle, which is really just another attribute.
+    mid[0] = (pt1[0] + pt2[0] + pt3[0]) / 3.0;
+    mid[1] = (pt1[1] + pt2[1] + pt3[1]) / 3.0;
+    mid[2] = (pt1[2] + pt2[2] + pt3[2]) / 3.0;
+    // Add weighted to sumCenter.
+    result.SumCenter[0] += mid[0] * k;
+    result.SumCenter[1] += mid[1] * k;
+    result.SumCenter[2] += mid[2] * k;
+
+    // Now integrate the rest of the attributes.
+    this->IntegrateData3(this->PointFields, result.PointValues, pt1Id, pt2Id, pt3Id, k);
+    this->IntegrateData1(this->CellFields, result.CellValues, cellId, k);
+  }
+
+  void IntegrateGeneral2DCell(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    vtkIdType nPnts = ptIds->GetNumberOfIds();
+    // There should be a number of points that is a multiple of 3
+    // from the triangulation
+    if (nPnts % 3)
+    {
+      result.NumberOfSkippedCells++;
+      return;
+    }
+    for (vtkIdType triIdx = 0; triIdx < nPnts; triIdx += 3)
+    {
+      this->IntegrateTriangle(result, cellId, ptIds->GetId(triIdx), ptIds->GetId(triIdx + 1),
+        ptIds->GetId(triIdx + 2));
+    }
+  }
+
+  // For Tetrahedral cells
+  void IntegrateTetrahedron(vtkIntegrationResult& result, vtkIdType cellId, vtkIdType pt1Id,
+    vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id)
+  {
+    double pts[4][3];
+    this->Input->GetPoint(pt1Id, pts[0]);
+    this->Input->GetPoint(pt2Id, pts[1]);
+    this->Input->GetPoint(pt3Id, pts[2]);
+    this->Input->GetPoint(pt4Id, pts[3]);
+
+    double a[3], b[3], c[3], n[3], v, mid[3];
+    // Compute the principle vectors around pt0 and the
+    // centroid
+    for (int i = 0; i < 3; i++)
+    {
+      a[i] = pts[1][i] - pts[0][i];
+      b[i] = pts[2][i] - pts[0][i];
+      c[i] = pts[3][i] - pts[0][i];
+      mid[i] = (pts[0][i] + pts[1][i] + pts[2][i] + pts[3][i]) * 0.25;
+    }
+
+    // Calulate the volume of the tet which is 1/6 * the box product
+    vtkMath::Cross(a, b, n);
+    v = vtkMath::Dot(c, n) / 6.0;
+    result.Sum += v;
+
+    // Add weighted to sumCenter.
+    result.SumCenter[0] += mid[0] * v;
+    result.SumCenter[1] += mid[1] * v;
+    result.SumCenter[2] += mid[2] * v;
+
+    // Integrate the attributes on the cell itself
+    this->IntegrateData1(this->CellFields, result.CellValues, cellId, v);
+
+    // Integrate the attributes associated with the points
+    this->IntegrateData4(this->PointFields, result.PointValues, pt1Id, pt2Id, pt3Id, pt4Id, v);
+  }
+
+  // For axis alligned hexahedral cells
+  void IntegrateVoxel(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* cellPtIds)
+  {
+    vtkIdType pt1Id, pt2Id, pt3Id, pt4Id, pt5Id;
+    double pts[5][3];
+    pt1Id = cellPtIds->GetId(0);
+    pt2Id = cellPtIds->GetId(1);
+    pt3Id = cellPtIds->GetId(2);
+    pt4Id = cellPtIds->GetId(3);
+    pt5Id = cellPtIds->GetId(4);
+    this->Input->GetPoint(pt1Id, pts[0]);
+    this->Input->GetPoint(pt2Id, pts[1]);
+    this->Input->GetPoint(pt3Id, pts[2]);
+    this->Input->GetPoint(pt4Id, pts[3]);
+    this->Input->GetPoint(pt5Id, pts[4]);
+
+    double l, w, h, v, mid[3];
+
+    // Calulate the volume of the voxel
+    l = pts[1][0] - pts[0][0];
+    w = pts[2][1] - pts[0][1];
+    h = pts[4][2] - pts[0][2];
+    v = fabs(l * w * h);
+    result.Sum += v;
+
+    // Partially Compute the middle, which is really just another attribute.
+    mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.125;
+    mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.125;
+    mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.125;
+
+    // Integrate the attributes on the cell itself
+    this->IntegrateData1(this->CellFields, result.CellValues, cellId, v);
+
+    // Integrate the attributes associated with the points on the bottom face
+    // note that since IntegrateData4 is going to weigh everything by 1/4
+    // we need to pass down 1/2 the volume so they will be weighted by 1/8
+    this->IntegrateData4(
+      this->PointFields, result.PointValues, pt1Id, pt2Id, pt3Id, pt4Id, v * 0.5);
+
+    // Now process the top face points
+    pt1Id = cellPtIds->GetId(5);
+    pt2Id = cellPtIds->GetId(6);
+    pt3Id = cellPtIds->GetId(7);
+    this->Input->GetPoint(pt1Id, pts[0]);
+    this->Input->GetPoint(pt2Id, pts[1]);
+    this->Input->GetPoint(pt3Id, pts[2]);
+    // Finish Computing the middle, which is really just another attribute.
+    mid[0] += (pts[0][0] + pts[1][0] + pts[2][0] + pts[4][0]) * 0.125;
+    mid[1] += (pts[0][1] + pts[1][1] + pts[2][1] + pts[4][1]) * 0.125;
+    mid[2] += (pts[0][2] + pts[1][2] + pts[2][2] + pts[4][2]) * 0.125;
+
+    // Add weighted to sumCenter.
+    result.SumCenter[0] += mid[0] * v;
+    result.SumCenter[1] += mid[1] * v;
+    result.SumCenter[2] += mid[2] * v;
+
+    // Integrate the attributes associated with the points on the top face
+    // note that since IntegrateData4 is going to weigh everything by 1/4
+    // we need to pass down 1/2 the volume so they will be weighted by 1/8
+    this->IntegrateData4(
+      this->PointFields, result.PointValues, pt1Id, pt2Id, pt3Id, pt5Id, v * 0.5);
+  }
+
+  void IntegrateGeneral3DCell(vtkIntegrationResult& result, vtkIdType cellId, vtkIdList* ptIds)
+  {
+    vtkIdType nPnts = ptIds->GetNumberOfIds();
+    // There should be a number of points that is a multiple of 4
+    // from the triangulation
+    if (nPnts % 4)
+    {
+      result.NumberOfSkippedCells++;
+      return;
+    }
+    for (vtkIdType tetIdx = 0; tetIdx < nPnts; tetIdx += 4)
+    {
+      this->IntegrateTetrahedron(result, cellId, ptIds->GetId(tetIdx), ptIds->GetId(tetIdx + 1),
+        ptIds->GetId(tetIdx + 2), ptIds->GetId(tetIdx + 3));
+    }
+  }
+
+  vtkDataSet* Input;
+  vtkUnsignedCharArray* GhostArray;
+  const vtkIntegrationFields& PointFields;
+  const vtkIntegrationFields& CellFields;
+  std::vector<vtkIntegrationResult>& Results;
+  size_t NumberOfPointValues;
+  size_t NumberOfCellValues;
+  vtkSMPThreadLocalObject<vtkIdList> CellPtIds;
+  vtkSMPThreadLocalObject<vtkPoints> CellPoints;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+};
+
+//-----------------------------------------------------------------------------
+// Returns the offset of the first component of each array of outda in a flat
+// vector of all components, and sets total to the number of components.
+std::vector<size_t> vtkComputeOffsets(vtkDataSetAttributes* outda, size_t& total)
+{
+  std::vector<size_t> offsets(outda->GetNumberOfArrays(), 0);
+  total = 0;
+  for (int i = 0; i < outda->GetNumberOfArrays(); ++i)
+  {
+    offsets[i] = total;
+    total += outda->GetArray(i)->GetNumberOfComponents();
+  }
+  return offsets;
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkIntegrateAttributes::vtkIntegrateAttributes()
+{
+  this->IntegrationDimension = 0;
+  this->Sum = 0.0;
+  this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
+  this->Controller = 0;
+
+  this->DivideAllCellDataByVolume = false;
+
+  SetController(vtkMultiProcessController::GetGlobalController());
+}
+
+//-----------------------------------------------------------------------------
+vtkIntegrateAttributes::~vtkIntegrateAttributes()
+{
+  if (this->Controller)
+  {
+    this->Controller->Delete();
+    this->Controller = 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkIntegrateAttributes::SetController(vtkMultiProcessController* controller)
+{
+  if (this->Controller)
+  {
+    this->Controller->UnRegister(this);
+  }
+
+  this->Controller = controller;
+
+  if (this->Controller)
+  {
+    this->Controller->Register(this);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkExecutive* vtkIntegrateAttributes::CreateDefaultExecutive()
+{
+  return vtkCompositeDataPipeline::New();
+}
+
+//----------------------------------------------------------------------------
+int vtkIntegrateAttributes::FillInputPortInformation(int port, vtkInformation* info)
+{
+  if (!this->Superclass::FillInputPortInformation(port, info))
+  {
+    return 0;
+  }
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataObject");
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+int vtkIntegrateAttributes::CompareIntegrationDimension(vtkDataSet* output, int dim)
+{
+  // higher dimension prevails
+  if (this->IntegrationDimension < dim)
+  { // Throw out results from lower dimension.
+    this->Sum = 0;
+    this->SumCenter[0] = this->SumCenter[1] = this->SumCenter[2] = 0.0;
+    this->ZeroAttributes(output->GetPointData());
+    this->ZeroAttributes(output->GetCellData());
+    this->IntegrationDimension = dim;
+    return 1;
+  }
+  // Skip this cell if we are inetrgrting a higher dimension.
+  return (this->IntegrationDimension == dim);
+}
 
-        cell->Triangulate(1, cellPtIds, cellPoints);
-        switch (cellDim)
-        {
-          case 1:
-            this->IntegrateGeneral1DCell(input, output, cellId, cellPtIds);
-            break;
-          case 2:
-            this->IntegrateGeneral2DCell(input, output, cellId, cellPtIds);
-            break;
-          case 3:
-            this->IntegrateGeneral3DCell(input, output, cellId, cellPtIds);
-            break;
-          default:
-            vtkWarningMacro("Unsupported Cell Dimension = " << cellDim);
-        }
-      }
+//----------------------------------------------------------------------------
+void vtkIntegrateAttributes::ExecuteBlock(vtkDataSet* input, vtkUnstructuredGrid* output,
+  int fieldset_index, vtkIntegrateAttributes::vtkFieldList& pdList,
+  vtkIntegrateAttributes::vtkFieldList& cdList)
+{
+  // Find where the integral of each input array goes.
+  size_t numPointValues, numCellValues;
+  std::vector<size_t> pointOffsets = vtkComputeOffsets(output->GetPointData(), numPointValues);
+  std::vector<size_t> cellOffsets = vtkComputeOffsets(output->GetCellData(), numCellValues);
+  vtkIntegrationFields pointFields, cellFields;
+  for (int i = 0; i < pdList.GetNumberOfFields(); ++i)
+  {
+    if (pdList.GetFieldIndex(i) >= 0)
+    {
+      pointFields.Arrays.push_back(
+        input->GetPointData()->GetArray(pdList.GetDSAIndex(fieldset_index, i)));
+      pointFields.Offsets.push_back(pointOffsets[pdList.GetFieldIndex(i)]);
+    }
+  }
+  for (int i = 0; i < cdList.GetNumberOfFields(); ++i)
+  {
+    if (cdList.GetFieldIndex(i) >= 0)
+    {
+      cellFields.Arrays.push_back(
+        input->GetCellData()->GetArray(cdList.GetDSAIndex(fieldset_index, i)));
+      cellFields.Offsets.push_back(cellOffsets[cdList.GetFieldIndex(i)]);
     }
   }
-  cellPtIds->Delete();
-  if (cellPoints)
+
+  vtkIdType numCells = input->GetNumberOfCells();
+  if (numCells == 0)
+  {
+    return;
+  }
+  // Build the cell structures (for vtkPolyData) before going multithreaded.
+  input->GetCellType(0);
+
+  std::vector<vtkIntegrationResult> results(
+    (numCells + vtkIntegrationChunkSize - 1) / vtkIntegrationChunkSize);
+  vtkIntegrateCells functor(input, pointFields, cellFields, results, numPointValues, numCellValues);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(results.size()), 1, functor);
+
+  // Add the chunks up in order.
+  vtkIntegrationResult total;
+  total.Initialize(numPointValues, numCellValues);
+  for (size_t cc = 0; cc < results.size(); ++cc)
   {
-    cellPoints->Delete();
+    total.Add(results[cc]);
+  }
+  if (total.NumberOfSkippedCells > 0)
+  {
+    vtkWarningMacro("Skipped " << total.NumberOfSkippedCells
+                               << " cells with an unexpected triangulation.");
   }
 
-  this->PointFieldList = NULL;
-  this->CellFieldList = NULL;
-  this->FieldListIndex = 0;
+  if (total.Dimension == 0 || !this->CompareIntegrationDimension(output, total.Dimension))
+  {
+    return;
+  }
+  this->Sum += total.Sum;
+  this->SumCenter[0] += total.SumCenter[0];
+  this->SumCenter[1] += total.SumCenter[1];
+  this->SumCenter[2] += total.SumCenter[2];
+  vtkDataSetAttributes* outdas[2] = { output->GetPointData(), output->GetCellData() };
+  const std::vector<double>* values[2] = { &total.PointValues, &total.CellValues };
+  const std::vector<size_t>* offsets[2] = { &pointOffsets, &cellOffsets };
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    for (int i = 0; i < outdas[cc]->GetNumberOfArrays(); ++i)
+    {
+      vtkDataArray* outArray = outdas[cc]->GetArray(i);
+      for (int j = 0; j < outArray->GetNumberOfComponents(); ++j)
+      {
+        outArray->SetComponent(
+          0, j, outArray->GetComponent(0, j) + (*values[cc])[(*offsets[cc])[i] + j]);
+      }
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -506,86 +1040,62 @@ int vtkIntegrateAttributes::RequestData(
   }
   sumArray->Delete();
 
-  int globalMin = this->PieceNodeMinToNode0(output);
-  int processId = this->Controller->GetLocalProcessId();
-  int numProcs = this->Controller->GetNumberOfProcesses();
-  if (globalMin == numProcs)
+  // Add up the results of all processes on the root.
+  this->ReducePiecesToNode0(output);
+  if (this->Controller && this->Controller->GetLocalProcessId() > 0)
   {
-    // there is no data in any of the processors
-    if (this->Sum != 0.0 && this->DivideAllCellDataByVolume)
-    {
-      DivideDataArraysByConstant(output->GetCellData(), true, this->Sum);
-    }
     return 1;
   }
-  if (processId > 0)
+
+  // now that we have all of the sums from each process
+  // set the point location with the global value
+  if (this->Sum != 0.0)
   {
-    if (processId != globalMin)
+    pt[0] = this->SumCenter[0] / this->Sum;
+    pt[1] = this->SumCenter[1] / this->Sum;
+    pt[2] = this->SumCenter[2] / this->Sum;
+    if (this->DivideAllCellDataByVolume)
     {
-      this->SendPiece(output);
+      DivideDataArraysByConstant(output->GetCellData(), true, this->Sum);
     }
   }
   else
   {
-    for (int id = 1; id < numProcs; ++id)
-    {
-      if (id != globalMin)
-      {
-        this->ReceivePiece(output, id);
-      }
-    }
-
-    // now that we have all of the sums from each process
-    // set the point location with the global value
-    if (this->Sum != 0.0)
-    {
-      pt[0] = this->SumCenter[0] / this->Sum;
-      pt[1] = this->SumCenter[1] / this->Sum;
-      pt[2] = this->SumCenter[2] / this->Sum;
-      if (this->DivideAllCellDataByVolume)
-      {
-        DivideDataArraysByConstant(output->GetCellData(), true, this->Sum);
-      }
-    }
-    else
-    {
-      pt[0] = this->SumCenter[0];
-      pt[1] = this->SumCenter[1];
-      pt[2] = this->SumCenter[2];
-    }
-    output->GetPoints()->SetPoint(0, pt);
+    pt[0] = this->SumCenter[0];
+    pt[1] = this->SumCenter[1];
+    pt[2] = this->SumCenter[2];
   }
+  output->GetPoints()->SetPoint(0, pt);
 
   return 1;
 }
 
-int vtkIntegrateAttributes::PieceNodeMinToNode0(vtkUnstructuredGrid* data)
+//-----------------------------------------------------------------------------
+void vtkIntegrateAttributes::ReducePiecesToNode0(vtkUnstructuredGrid* data)
 {
-  int numProcs = this->Controller->GetNumberOfProcesses();
-  int processId = this->Controller->GetLocalProcessId();
-  int localMin = (data->GetNumberOfCells() == 0 ? numProcs : processId);
-  int globalMin = numProcs;
-  if (numProcs == 1)
-  {
-    return 0;
-  }
-  this->Controller->AllReduce(&localMin, &globalMin, 1, vtkCommunicator::MIN_OP);
-  if (globalMin == 0 || globalMin == numProcs)
-  {
-    return globalMin;
-  }
-  if (processId == 0)
+  if (!this->Controller)
   {
-    this->ReceivePiece(data, globalMin);
+    return;
   }
-  else if (processId == globalMin)
+  // Binary tree reduction: at each step, every other remaining process sends
+  // its piece to its left neighbor.
+  int numProcs = this->Controller->GetNumberOfProcesses();
+  int processId = this->Controller->GetLocalProcessId();
+  for (int step = 1; step < numProcs; step *= 2)
   {
-    this->SendPiece(data);
+    if (processId % (2 * step) != 0)
+    {
+      this->SendPiece(data, processId - step);
+      return;
+    }
+    if (processId + step < numProcs)
+    {
+      this->ReceivePiece(data, processId + step);
+    }
   }
-  return globalMin;
 }
 
-void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src)
+void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src, int toId)
 {
   double msg[5];
   msg[0] = (double)(this->IntegrationDimension);
@@ -593,8 +1103,8 @@ void vtkIntegrateAttributes::SendPiece(vtkUnstructuredGrid* src)
   msg[2] = this->SumCenter[0];
   msg[3] = this->SumCenter[1];
   msg[4] = this->SumCenter[2];
-  this->Controller->Send(msg, 5, 0, vtkIntegrateAttributes::IntegrateAttrInfo);
-  this->Controller->Send(src, 0, vtkIntegrateAttributes::IntegrateAttrData);
+  this->Controller->Send(msg, 5, toId, vtkIntegrateAttributes::IntegrateAttrInfo);
+  this->Controller->Send(src, toId, vtkIntegrateAttributes::IntegrateAttrData);
   // Done sending.  Reset src so satellites will have empty data.
   src->Initialize();
 }
@@ -605,7 +1115,20 @@ void vtkIntegrateAttributes::ReceivePiece(vtkUnstructuredGrid* mergeTo, int from
   this->Controller->Receive(msg, 5, fromId, vtkIntegrateAttributes::IntegrateAttrInfo);
   vtkUnstructuredGrid* tmp = vtkUnstructuredGrid::New();
   this->Controller->Receive(tmp, fromId, vtkIntegrateAttributes::IntegrateAttrData);
-  if (this->CompareIntegrationDimension(mergeTo, (int)(msg[0])))
+  const int dim = static_cast<int>(msg[0]);
+  if (dim > this->IntegrationDimension)
+  {
+    // Throw out the results of lower dimension, including the array holding
+    // their length or area, which the piece received replaces.
+    this->IntegrationDimension = dim;
+    this->Sum = msg[1];
+    this->SumCenter[0] = msg[2];
+    this->SumCenter[1] = msg[3];
+    this->SumCenter[2] = msg[4];
+    mergeTo->GetPointData()->DeepCopy(tmp->GetPointData());
+    mergeTo->GetCellData()->DeepCopy(tmp->GetCellData());
+  }
+  else if (dim == this->IntegrationDimension)
   {
     this->Sum += msg[1];
     this->SumCenter[0] += msg[2];
@@ -662,135 +1185,6 @@ void vtkIntegrateAttributes::ZeroAttributes(vtkDataSetAttributes* outda)
     }
   }
 }
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateData1(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, double k, vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = vIn1;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateData2(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, double k, vtkIntegrateAttributes::vtkFieldList& fieldList,
-  int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = 0.5 * (vIn1 + vIn2);
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-//-----------------------------------------------------------------------------
-// Is the extra performance worth duplicating this code with IntergrateData2.
-void vtkIntegrateAttributes::IntegrateData3(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, double k,
-  vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, vIn3, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vIn3 = inArray->GetComponent(pt3Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = (vIn1 + vIn2 + vIn3) / 3.0;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-
-//-----------------------------------------------------------------------------
-// Is the extra performance worth duplicating this code with IntergrateData2.
-void vtkIntegrateAttributes::IntegrateData4(vtkDataSetAttributes* inda, vtkDataSetAttributes* outda,
-  vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id, double k,
-  vtkIntegrateAttributes::vtkFieldList& fieldList, int index)
-{
-  int numArrays, i, numComponents, j;
-  vtkDataArray* inArray;
-  vtkDataArray* outArray;
-  numArrays = fieldList.GetNumberOfFields();
-  double vIn1, vIn2, vIn3, vIn4, dv, vOut;
-  for (i = 0; i < numArrays; ++i)
-  {
-    if (fieldList.GetFieldIndex(i) < 0)
-    {
-      continue;
-    }
-    // We could template for speed.
-    inArray = inda->GetArray(fieldList.GetDSAIndex(index, i));
-    outArray = outda->GetArray(fieldList.GetFieldIndex(i));
-    numComponents = inArray->GetNumberOfComponents();
-    for (j = 0; j < numComponents; ++j)
-    {
-      vIn1 = inArray->GetComponent(pt1Id, j);
-      vIn2 = inArray->GetComponent(pt2Id, j);
-      vIn3 = inArray->GetComponent(pt3Id, j);
-      vIn4 = inArray->GetComponent(pt4Id, j);
-      vOut = outArray->GetComponent(0, j);
-      dv = (vIn1 + vIn2 + vIn3 + vIn4) * 0.25;
-      vOut += dv * k;
-      outArray->SetComponent(0, j, vOut);
-    }
-  }
-}
-
 //-----------------------------------------------------------------------------
 // Used to sum arrays from all processes.
 void vtkIntegrateAttributes::IntegrateSatelliteData(
@@ -838,378 +1232,6 @@ void vtkIntegrateAttributes::IntegrateSatelliteData(
   }
 }
 
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegratePolyLine(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  double length;
-  double pt1[3], pt2[3], mid[3];
-  vtkIdType numLines, lineIdx;
-  vtkIdType pt1Id, pt2Id;
-
-  numLines = ptIds->GetNumberOfIds() - 1;
-  for (lineIdx = 0; lineIdx < numLines; ++lineIdx)
-  {
-    pt1Id = ptIds->GetId(lineIdx);
-    pt2Id = ptIds->GetId(lineIdx + 1);
-    input->GetPoint(pt1Id, pt1);
-    input->GetPoint(pt2Id, pt2);
-
-    // Compute the length of the line.
-    length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
-    this->Sum += length;
-
-    // Compute the middle, which is really just another attribute.
-    mid[0] = (pt1[0] + pt2[0]) * 0.5;
-    mid[1] = (pt1[1] + pt2[1]) * 0.5;
-    mid[2] = (pt1[2] + pt2[2]) * 0.5;
-    // Add weighted to sumCenter.
-    this->SumCenter[0] += mid[0] * length;
-    this->SumCenter[1] += mid[1] * length;
-    this->SumCenter[2] += mid[2] * length;
-
-    // Now integrate the rest of the attributes.
-    this->IntegrateData2(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, length,
-      *this->PointFieldList, this->FieldListIndex);
-    this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, length,
-      *this->CellFieldList, this->FieldListIndex);
-  }
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral1DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  // Determine the number of lines
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be an even number of points from the triangulation
-  if (nPnts % 2)
-  {
-    vtkWarningMacro("Odd number of points(" << nPnts << ")  encountered - skipping "
-                                            << " 1D Cell: " << cellId);
-    return;
-  }
-
-  double length;
-  double pt1[3], pt2[3], mid[3];
-  vtkIdType pid = 0;
-  vtkIdType pt1Id, pt2Id;
-
-  while (pid < nPnts)
-  {
-    pt1Id = ptIds->GetId(pid++);
-    pt2Id = ptIds->GetId(pid++);
-    input->GetPoint(pt1Id, pt1);
-    input->GetPoint(pt2Id, pt2);
-
-    // Compute the length of the line.
-    length = sqrt(vtkMath::Distance2BetweenPoints(pt1, pt2));
-    this->Sum += length;
-
-    // Compute the middle, which is really just another attribute.
-    mid[0] = (pt1[0] + pt2[0]) * 0.5;
-    mid[1] = (pt1[1] + pt2[1]) * 0.5;
-    mid[2] = (pt1[2] + pt2[2]) * 0.5;
-    // Add weighted to sumCenter.
-    this->SumCenter[0] += mid[0] * length;
-    this->SumCenter[1] += mid[1] * length;
-    this->SumCenter[2] += mid[2] * length;
-
-    // Now integrate the rest of the attributes.
-    this->IntegrateData2(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, length,
-      *this->PointFieldList, this->FieldListIndex);
-    this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, length,
-      *this->CellFieldList, this->FieldListIndex);
-  }
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateTriangleStrip(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType numTris, triIdx;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  numTris = ptIds->GetNumberOfIds() - 2;
-  for (triIdx = 0; triIdx < numTris; ++triIdx)
-  {
-    pt1Id = ptIds->GetId(triIdx);
-    pt2Id = ptIds->GetId(triIdx + 1);
-    pt3Id = ptIds->GetId(triIdx + 2);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// Works for convex polygons, and interpoaltion is not correct.
-void vtkIntegrateAttributes::IntegratePolygon(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType numTris, triIdx;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  numTris = ptIds->GetNumberOfIds() - 2;
-  pt1Id = ptIds->GetId(0);
-  for (triIdx = 0; triIdx < numTris; ++triIdx)
-  {
-    pt2Id = ptIds->GetId(triIdx + 1);
-    pt3Id = ptIds->GetId(triIdx + 2);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// For axis alligned rectangular cells
-void vtkIntegrateAttributes::IntegratePixel(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds)
-{
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
-  double pts[4][3];
-  pt1Id = cellPtIds->GetId(0);
-  pt2Id = cellPtIds->GetId(1);
-  pt3Id = cellPtIds->GetId(2);
-  pt4Id = cellPtIds->GetId(3);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-
-  double l, w, a, mid[3];
-
-  // get the lengths of its 2 orthogonal sides.  Since only 1 coordinate
-  // can be different we can add the differences in all 3 directions
-  l = (pts[0][0] - pts[1][0]) + (pts[0][1] - pts[1][1]) + (pts[0][2] - pts[1][2]);
-
-  w = (pts[0][0] - pts[2][0]) + (pts[0][1] - pts[2][1]) + (pts[0][2] - pts[2][2]);
-
-  a = fabs(l * w);
-  this->Sum += a;
-  // Compute the middle, which is really just another attribute.
-  mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.25;
-  mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.25;
-  mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.25;
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * a;
-  this->SumCenter[1] += mid[1] * a;
-  this->SumCenter[2] += mid[2] * a;
-
-  // Now integrate the rest of the attributes.
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id, a,
-    *this->PointFieldList, this->FieldListIndex);
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, a, *this->CellFieldList,
-    this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateTriangle(vtkDataSet* input, vtkUnstructuredGrid* output,
-  vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id)
-{
-  double pt1[3], pt2[3], pt3[3];
-  double mid[3], v1[3], v2[3];
-  double cross[3];
-  double k;
-
-  input->GetPoint(pt1Id, pt1);
-  input->GetPoint(pt2Id, pt2);
-  input->GetPoint(pt3Id, pt3);
-
-  // Compute two legs.
-  v1[0] = pt2[0] - pt1[0];
-  v1[1] = pt2[1] - pt1[1];
-  v1[2] = pt2[2] - pt1[2];
-  v2[0] = pt3[0] - pt1[0];
-  v2[1] = pt3[1] - pt1[1];
-  v2[2] = pt3[2] - pt1[2];
-
-  // Use the cross product to compute the area of the parallelogram.
-  vtkMath::Cross(v1, v2, cross);
-  k = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) * 0.5;
-
-  if (k == 0.0)
-  {
-    return;
-  }
-  this->Sum += k;
-
-  // Compute the middle, which is really just another attribute.
-  mid[0] = (pt1[0] + pt2[0] + pt3[0]) / 3.0;
-  mid[1] = (pt1[1] + pt2[1] + pt3[1]) / 3.0;
-  mid[2] = (pt1[2] + pt2[2] + pt3[2]) / 3.0;
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * k;
-  this->SumCenter[1] += mid[1] * k;
-  this->SumCenter[2] += mid[2] * k;
-
-  // Now integrate the rest of the attributes.
-  this->IntegrateData3(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, k,
-    *this->PointFieldList, this->FieldListIndex);
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, k, *this->CellFieldList,
-    this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral2DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be a number of points that is a multiple of 3
-  // from the triangulation
-  if (nPnts % 3)
-  {
-    vtkWarningMacro("Number of points (" << nPnts << ") is not divisiable by 3 - skipping "
-                                         << " 2D Cell: " << cellId);
-    return;
-  }
-
-  vtkIdType triIdx = 0;
-  vtkIdType pt1Id, pt2Id, pt3Id;
-
-  while (triIdx < nPnts)
-  {
-    pt1Id = ptIds->GetId(triIdx++);
-    pt2Id = ptIds->GetId(triIdx++);
-    pt3Id = ptIds->GetId(triIdx++);
-    this->IntegrateTriangle(input, output, cellId, pt1Id, pt2Id, pt3Id);
-  }
-}
-
-//-----------------------------------------------------------------------------
-// For Tetrahedral cells
-void vtkIntegrateAttributes::IntegrateTetrahedron(vtkDataSet* input, vtkUnstructuredGrid* output,
-  vtkIdType cellId, vtkIdType pt1Id, vtkIdType pt2Id, vtkIdType pt3Id, vtkIdType pt4Id)
-{
-  double pts[4][3];
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-
-  double a[3], b[3], c[3], n[3], v, mid[3];
-  int i;
-  // Compute the principle vectors around pt0 and the
-  // centroid
-  for (i = 0; i < 3; i++)
-  {
-    a[i] = pts[1][i] - pts[0][i];
-    b[i] = pts[2][i] - pts[0][i];
-    c[i] = pts[3][i] - pts[0][i];
-    mid[i] = (pts[0][i] + pts[1][i] + pts[2][i] + pts[3][i]) * 0.25;
-  }
-
-  // Calulate the volume of the tet which is 1/6 * the box product
-  vtkMath::Cross(a, b, n);
-  v = vtkMath::Dot(c, n) / 6.0;
-  this->Sum += v;
-
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * v;
-  this->SumCenter[1] += mid[1] * v;
-  this->SumCenter[2] += mid[2] * v;
-
-  // Integrate the attributes on the cell itself
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, v, *this->CellFieldList,
-    this->FieldListIndex);
-
-  // Integrate the attributes associated with the points
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id, v,
-    *this->PointFieldList, this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-// For axis alligned hexahedral cells
-void vtkIntegrateAttributes::IntegrateVoxel(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* cellPtIds)
-{
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id, pt5Id;
-  double pts[5][3];
-  pt1Id = cellPtIds->GetId(0);
-  pt2Id = cellPtIds->GetId(1);
-  pt3Id = cellPtIds->GetId(2);
-  pt4Id = cellPtIds->GetId(3);
-  pt5Id = cellPtIds->GetId(4);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  input->GetPoint(pt4Id, pts[3]);
-  input->GetPoint(pt5Id, pts[4]);
-
-  double l, w, h, v, mid[3];
-
-  // Calulate the volume of the voxel
-  l = pts[1][0] - pts[0][0];
-  w = pts[2][1] - pts[0][1];
-  h = pts[4][2] - pts[0][2];
-  v = fabs(l * w * h);
-  this->Sum += v;
-
-  // Partially Compute the middle, which is really just another attribute.
-  mid[0] = (pts[0][0] + pts[1][0] + pts[2][0] + pts[3][0]) * 0.125;
-  mid[1] = (pts[0][1] + pts[1][1] + pts[2][1] + pts[3][1]) * 0.125;
-  mid[2] = (pts[0][2] + pts[1][2] + pts[2][2] + pts[3][2]) * 0.125;
-
-  // Integrate the attributes on the cell itself
-  this->IntegrateData1(input->GetCellData(), output->GetCellData(), cellId, v, *this->CellFieldList,
-    this->FieldListIndex);
-
-  // Integrate the attributes associated with the points on the bottom face
-  // note that since IntegrateData4 is going to weigh everything by 1/4
-  // we need to pass down 1/2 the volume so they will be weighted by 1/8
-
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt4Id,
-    v * 0.5, *this->PointFieldList, this->FieldListIndex);
-
-  // Now process the top face points
-  pt1Id = cellPtIds->GetId(5);
-  pt2Id = cellPtIds->GetId(6);
-  pt3Id = cellPtIds->GetId(7);
-  input->GetPoint(pt1Id, pts[0]);
-  input->GetPoint(pt2Id, pts[1]);
-  input->GetPoint(pt3Id, pts[2]);
-  // Finish Computing the middle, which is really just another attribute.
-  mid[0] += (pts[0][0] + pts[1][0] + pts[2][0] + pts[4][0]) * 0.125;
-  mid[1] += (pts[0][1] + pts[1][1] + pts[2][1] + pts[4][1]) * 0.125;
-  mid[2] += (pts[0][2] + pts[1][2] + pts[2][2] + pts[4][2]) * 0.125;
-
-  // Add weighted to sumCenter.
-  this->SumCenter[0] += mid[0] * v;
-  this->SumCenter[1] += mid[1] * v;
-  this->SumCenter[2] += mid[2] * v;
-
-  // Integrate the attributes associated with the points on the top face
-  // note that since IntegrateData4 is going to weigh everything by 1/4
-  // we need to pass down 1/2 the volume so they will be weighted by 1/8
-  this->IntegrateData4(input->GetPointData(), output->GetPointData(), pt1Id, pt2Id, pt3Id, pt5Id,
-    v * 0.5, *this->PointFieldList, this->FieldListIndex);
-}
-
-//-----------------------------------------------------------------------------
-void vtkIntegrateAttributes::IntegrateGeneral3DCell(
-  vtkDataSet* input, vtkUnstructuredGrid* output, vtkIdType cellId, vtkIdList* ptIds)
-{
-
-  vtkIdType nPnts = ptIds->GetNumberOfIds();
-  // There should be a number of points that is a multiple of 4
-  // from the triangulation
-  if (nPnts % 4)
-  {
-    vtkWarningMacro("Number of points (" << nPnts << ") is not divisiable by 4 - skipping "
-                                         << " 3D Cell: " << cellId);
-    return;
-  }
-
-  vtkIdType tetIdx = 0;
-  vtkIdType pt1Id, pt2Id, pt3Id, pt4Id;
-
-  while (tetIdx < nPnts)
-  {
-    pt1Id = ptIds->GetId(tetIdx++);
-    pt2Id = ptIds->GetId(tetIdx++);
-    pt3Id = ptIds->GetId(tetIdx++);
-    pt4Id = ptIds->GetId(tetIdx++);
-    this->IntegrateTetrahedron(input, output, cellId, pt1Id, pt2Id, pt3Id, pt4Id);
-  }
-}
-
 //-----------------------------------------------------------------------------
 void vtkIntegrateAttributes::DivideDataArraysByConstant(
   vtkDataSetAttributes* data, bool skipLastArray, double sum)
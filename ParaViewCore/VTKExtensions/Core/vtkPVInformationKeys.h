@@ -22,8 +22,9 @@
 
 #include "vtkPVVTKExtensionsCoreModule.h" // needed for export macro
 
-class vtkInformationStringKey;
 class vtkInformationDoubleVectorKey;
+class vtkInformationObjectBaseKey;
+class vtkInformationStringKey;
 
 class VTKPVVTKEXTENSIONSCORE_EXPORT vtkPVInformationKeys
 {
@@ -39,8 +40,16 @@ public:
    * information.
    */
   static vtkInformationDoubleVectorKey* WHOLE_BOUNDING_BOX();
+  //@}
+
+  /**
+   * Key to store, in the update request of an input, the controller that the
+   * algorithms upstream should use to communicate instead of their own, e.g.
+   * the controller of a group of processes of vtkPVExtractArraysOverTime in
+   * time-parallel mode. It is copied upstream along with the request.
+   */
+  static vtkInformationObjectBaseKey* UPDATE_CONTROLLER();
 };
-//@}
 
 #endif // vtkPVInformationKeys_h
 // VTK-HeaderTest-Exclude: vtkPVInformationKeys.h
@@ -23,10 +23,13 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMultiProcessController.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkReductionFilter.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTable.h"
+#include "vtkTrivialProducer.h"
 
 #include <sstream>
 #include <string>
@@ -69,6 +72,7 @@ vtkParallelSerialWriter::vtkParallelSerialWriter()
   this->PostGatherHelper = 0;
 
   this->WriteAllTimeSteps = 0;
+  this->WriteInParallel = 0;
   this->NumberOfTimeSteps = 0;
   this->CurrentTimeIndex = 0;
 
@@ -219,6 +223,11 @@ void vtkParallelSerialWriter::WriteATimestep(vtkDataObject* input)
 void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* input)
 {
   vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+  if (this->WriteInParallel && controller && controller->GetNumberOfProcesses() > 1)
+  {
+    this->WriteAFileInParallel(filename, input);
+    return;
+  }
 
   vtkSmartPointer<vtkReductionFilter> reductionFilter = vtkSmartPointer<vtkReductionFilter>::New();
   reductionFilter->SetController(controller);
@@ -237,26 +246,83 @@ void vtkParallelSerialWriter::WriteAFile(const char* filename, vtkDataObject* in
     vtkDataObject* output = reductionFilter->GetOutputDataObject(0);
     if (vtkIsEmpty(output) == false)
     {
-      std::ostringstream fname;
-      if (this->WriteAllTimeSteps)
-      {
-        std::string path = vtksys::SystemTools::GetFilenamePath(filename);
-        std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
-        std::string ext = vtksys::SystemTools::GetFilenameLastExtension(filename);
-        fname << path << "/" << fnamenoext << "." << this->CurrentTimeIndex << ext;
-      }
-      else
-      {
-        fname << filename;
-      }
       this->Writer->SetInputDataObject(output);
-      this->SetWriterFileName(fname.str().c_str());
+      this->SetWriterFileName(this->GetTimeStepFileName(filename).c_str());
       this->WriteInternal();
       this->Writer->SetInputConnection(0);
     }
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkParallelSerialWriter::WriteAFileInParallel(const char* filename, vtkDataObject* input)
+{
+  vtkMultiProcessController* controller = vtkMultiProcessController::GetGlobalController();
+
+  vtkSmartPointer<vtkDataObject> local = input;
+  if (input && this->PreGatherHelper)
+  {
+    // same as vtkReductionFilter: don't use the input directly so that the
+    // helper gets the piece and time info.
+    this->PreGatherHelper->RemoveAllInputs();
+    vtkSmartPointer<vtkDataObject> incopy;
+    incopy.TakeReference(input->NewInstance());
+    incopy->ShallowCopy(input);
+    vtkNew<vtkTrivialProducer> incopyProducer;
+    incopyProducer->SetOutput(incopy);
+    this->PreGatherHelper->AddInputConnection(0, incopyProducer->GetOutputPort());
+    this->PreGatherHelper->Update();
+    local = this->PreGatherHelper->GetOutputDataObject(0);
+    this->PreGatherHelper->RemoveAllInputs();
+  }
+  if (!local)
+  {
+    local = vtkSmartPointer<vtkTable>::New();
+  }
+
+  // Like in serial, nothing is written if the data is empty on all nodes.
+  int nonEmpty = vtkIsEmpty(local) ? 0 : 1;
+  int anyNonEmpty = 0;
+  controller->AllReduce(&nonEmpty, &anyNonEmpty, 1, vtkCommunicator::MAX_OP);
+  if (!anyNonEmpty || !this->Writer)
+  {
+    return;
+  }
+
+  vtkClientServerStream stream;
+  stream << vtkClientServerStream::Invoke << this->Writer << "SetController"
+         << static_cast<vtkObjectBase*>(controller) << vtkClientServerStream::End;
+  this->Interpreter->ProcessStream(stream);
+
+  this->Writer->SetInputDataObject(local);
+  this->SetWriterFileName(this->GetTimeStepFileName(filename).c_str());
+  this->WriteInternal();
+  this->Writer->SetInputConnection(0);
+
+  stream.Reset();
+  stream << vtkClientServerStream::Invoke << this->Writer << "SetController"
+         << static_cast<vtkObjectBase*>(NULL) << vtkClientServerStream::End;
+  this->Interpreter->ProcessStream(stream);
+}
+
+//----------------------------------------------------------------------------
+std::string vtkParallelSerialWriter::GetTimeStepFileName(const char* filename)
+{
+  std::ostringstream fname;
+  if (this->WriteAllTimeSteps)
+  {
+    std::string path = vtksys::SystemTools::GetFilenamePath(filename);
+    std::string fnamenoext = vtksys::SystemTools::GetFilenameWithoutLastExtension(filename);
+    std::string ext = vtksys::SystemTools::GetFilenameLastExtension(filename);
+    fname << path << "/" << fnamenoext << "." << this->CurrentTimeIndex << ext;
+  }
+  else
+  {
+    fname << filename;
+  }
+  return fname.str();
+}
+
 //----------------------------------------------------------------------------
 // Overload standard modified time function. If the internal reader is
 // modified, then this object is modified as well.
@@ -304,4 +370,5 @@ void vtkParallelSerialWriter::SetWriterFileName(const char* fname)
 void vtkParallelSerialWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "WriteInParallel: " << this->WriteInParallel << endl;
 }
@@ -22,6 +22,11 @@
  * and PostGatherHelper.
  * This also makes it possible to write time-series for temporal datasets using
  * simple non-time-aware writers.
+ *
+ * Writers that can write a single file collectively (such as vtkCSVWriter) may
+ * be used with WriteInParallel on. The data is then not gathered: the writer
+ * is invoked on every node with that node's data (after the PreGatherHelper)
+ * and is given the global controller using its SetController() method.
 */
 
 #ifndef vtkParallelSerialWriter_h
@@ -30,6 +35,8 @@
 #include "vtkDataObjectAlgorithm.h"
 #include "vtkPVVTKExtensionsCoreModule.h" //needed for exports
 
+#include <string> // for std::string
+
 class vtkClientServerInterpreter;
 
 class VTKPVVTKEXTENSIONSCORE_EXPORT vtkParallelSerialWriter : public vtkDataObjectAlgorithm
@@ -129,6 +136,19 @@ public:
   vtkBooleanMacro(WriteAllTimeSteps, int);
   //@}
 
+  //@{
+  /**
+   * When on, the internal writer is invoked on all nodes instead of on the root
+   * node only, with the data of each node, and the PostGatherHelper is not
+   * used. The internal writer must provide SetController(), and write the data
+   * of all nodes when given a controller. Nodes without data are given an
+   * empty vtkTable. Off by default.
+   */
+  vtkGetMacro(WriteInParallel, int);
+  vtkSetMacro(WriteInParallel, int);
+  vtkBooleanMacro(WriteInParallel, int);
+  //@}
+
   /**
    * Get/Set the interpreter to use to call methods on the writer.
    */
@@ -151,6 +171,8 @@ private:
 
   void WriteATimestep(vtkDataObject* input);
   void WriteAFile(const char* fname, vtkDataObject* input);
+  void WriteAFileInParallel(const char* fname, vtkDataObject* input);
+  std::string GetTimeStepFileName(const char* fname);
 
   void SetWriterFileName(const char* fname);
   void WriteInternal();
@@ -165,6 +187,7 @@ private:
   int GhostLevel;
 
   int WriteAllTimeSteps;
+  int WriteInParallel;
   int NumberOfTimeSteps;
   int CurrentTimeIndex;
 
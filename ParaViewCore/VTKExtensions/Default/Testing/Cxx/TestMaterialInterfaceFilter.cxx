@@ -0,0 +1,163 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestMaterialInterfaceFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Runs vtkMaterialInterfaceFilter on an AMR dataset with and without the
+// timing report and the OBB computation, and checks that the fragments do not
+// change, that the cleaned fragment meshes are valid and that the report
+// covers every stage.
+
+#include "vtkDataArray.h"
+#include "vtkDummyController.h"
+#include "vtkMaterialInterfaceFilter.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkMultiPieceDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSpyPlotReader.h"
+#include "vtkTestUtilities.h"
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+const char* MATERIAL_ARRAY = "Material volume fraction - 2";
+
+bool CheckFragments(vtkMaterialInterfaceFilter* filter, bool computeOBB, vtkPolyData* statistics)
+{
+  vtkMultiBlockDataSet* fragments =
+    vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(0));
+  vtkMultiBlockDataSet* centers = vtkMultiBlockDataSet::SafeDownCast(filter->GetOutputDataObject(1));
+  vtkMultiPieceDataSet* meshes =
+    fragments ? vtkMultiPieceDataSet::SafeDownCast(fragments->GetBlock(0)) : NULL;
+  vtkPolyData* stats = centers ? vtkPolyData::SafeDownCast(centers->GetBlock(0)) : NULL;
+  if (!meshes || !stats)
+  {
+    cerr << "ERROR: missing outputs." << endl;
+    return false;
+  }
+
+  const vtkIdType nFragments = stats->GetNumberOfPoints();
+  if (nFragments == 0 || static_cast<vtkIdType>(meshes->GetNumberOfPieces()) != nFragments)
+  {
+    cerr << "ERROR: " << nFragments << " fragment centers for " << meshes->GetNumberOfPieces()
+         << " fragment meshes." << endl;
+    return false;
+  }
+  for (unsigned int cc = 0; cc < meshes->GetNumberOfPieces(); ++cc)
+  {
+    vtkPolyData* mesh = vtkPolyData::SafeDownCast(meshes->GetPiece(cc));
+    if (!mesh || mesh->GetNumberOfPoints() == 0 || mesh->GetNumberOfCells() == 0)
+    {
+      cerr << "ERROR: fragment " << cc << " has no geometry." << endl;
+      return false;
+    }
+  }
+
+  vtkDataArray* obbOrigins = stats->GetPointData()->GetArray("Bounding Box Origin");
+  if (computeOBB != (obbOrigins != NULL))
+  {
+    cerr << "ERROR: OBB arrays " << (computeOBB ? "missing." : "unexpected.") << endl;
+    return false;
+  }
+
+  if (statistics->GetNumberOfPoints() == 0)
+  {
+    statistics->ShallowCopy(stats);
+    return true;
+  }
+
+  // Same fragments as the previous execution.
+  vtkDataArray* expected = statistics->GetPointData()->GetArray("Volume");
+  vtkDataArray* actual = stats->GetPointData()->GetArray("Volume");
+  if (!expected || !actual || statistics->GetNumberOfPoints() != nFragments)
+  {
+    cerr << "ERROR: fragments differ between executions." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < nFragments; ++cc)
+  {
+    double a = expected->GetTuple1(cc);
+    double b = actual->GetTuple1(cc);
+    if (std::abs(a - b) > 1e-9 * std::abs(a))
+    {
+      cerr << "ERROR: volume of fragment " << cc << " differs: " << a << " != " << b << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestMaterialInterfaceFilter(int argc, char* argv[])
+{
+  vtkNew<vtkDummyController> controller;
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  char* fname =
+    vtkTestUtilities::ExpandDataFileName(argc, argv, "SPCTH/Dave_Karelitz_Small/spcth_a");
+  vtkNew<vtkSpyPlotReader> reader;
+  reader->SetFileName(fname);
+  reader->SetGlobalController(controller.GetPointer());
+  reader->MergeXYZComponentsOn();
+  reader->DownConvertVolumeFractionOn();
+  reader->SetCellArrayStatus(MATERIAL_ARRAY, 1);
+  delete[] fname;
+
+  vtkNew<vtkMaterialInterfaceFilter> filter;
+  filter->SetInputConnection(reader->GetOutputPort());
+  filter->SelectMaterialArray(MATERIAL_ARRAY);
+  filter->SetMaterialFractionThreshold(0.5);
+
+  int success = 1;
+  vtkNew<vtkPolyData> statistics;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    const bool enabled = pass == 1;
+    filter->SetEnableTimingReport(enabled);
+    filter->SetComputeOBB(enabled);
+    filter->Update();
+    if (!CheckFragments(filter.GetPointer(), enabled, statistics.GetPointer()))
+    {
+      success = 0;
+    }
+
+    std::string report = filter->GetTimingReport();
+    if (!enabled)
+    {
+      if (!report.empty())
+      {
+        cerr << "ERROR: timing report produced while disabled." << endl;
+        success = 0;
+      }
+      continue;
+    }
+    const char* stages[] = { "Process 0:", "InitializeBlocksTime", "ShareGhostBlocksTime",
+      "ProcessBlocksTime", "ResolveEquivalencesTime", "ComputeGeometricAttributesTime",
+      "NumberOfBlocks" };
+    for (size_t cc = 0; cc < sizeof(stages) / sizeof(stages[0]); ++cc)
+    {
+      if (report.find(stages[cc]) == std::string::npos)
+      {
+        cerr << "ERROR: '" << stages[cc] << "' missing from the timing report:\n"
+             << report << endl;
+        success = 0;
+      }
+    }
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,208 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVArrayCalculator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the output of vtkPVArrayCalculator, which runs the byte code of
+// the function over blocks of tuples, with the output of vtkArrayCalculator,
+// which evaluates it one tuple at a time with vtkFunctionParser, for
+// functions covering every operation of the parser.
+
+#include "vtkArrayCalculator.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPVArrayCalculator.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// More than a block of tuples of the vectorized evaluation.
+const vtkIdType NUMBER_OF_POINTS = 2500;
+
+// Records whether the function was evaluated over blocks of tuples, or by
+// the superclass.
+class vtkTestPVArrayCalculator : public vtkPVArrayCalculator
+{
+public:
+  static vtkTestPVArrayCalculator* New();
+  vtkTypeMacro(vtkTestPVArrayCalculator, vtkPVArrayCalculator);
+
+  bool Vectorized;
+
+protected:
+  vtkTestPVArrayCalculator()
+    : Vectorized(false)
+  {
+  }
+
+  int RequestData(vtkInformation* request, vtkInformationVector** inputVector,
+    vtkInformationVector* outputVector) VTK_OVERRIDE
+  {
+    vtkDataObject* input = vtkDataObject::GetData(inputVector[0], 0);
+    vtkDataObject* output = vtkDataObject::GetData(outputVector, 0);
+    this->UpdateArrayAndVariableNames(input, input->GetAttributes(vtkDataObject::POINT));
+    this->Vectorized = this->ExecuteVectorized(input, output, vtkDataObject::POINT);
+    return this->Vectorized ? 1 : this->Superclass::RequestData(request, inputVector, outputVector);
+  }
+
+private:
+  vtkTestPVArrayCalculator(const vtkTestPVArrayCalculator&) = delete;
+  void operator=(const vtkTestPVArrayCalculator&) = delete;
+};
+vtkStandardNewMacro(vtkTestPVArrayCalculator);
+
+// Scalars "s" (with zeros and values out of [-1, 1]) and "t" (float), and
+// vectors "v" (with null vectors) and "w" (int).
+void CreateInput(vtkPolyData* input)
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> s;
+  s->SetName("s");
+  vtkNew<vtkFloatArray> t;
+  t->SetName("t");
+  vtkNew<vtkDoubleArray> v;
+  v->SetName("v");
+  v->SetNumberOfComponents(3);
+  vtkNew<vtkIntArray> w;
+  w->SetName("w");
+  w->SetNumberOfComponents(3);
+  for (vtkIdType cc = 0; cc < NUMBER_OF_POINTS; ++cc)
+  {
+    points->InsertNextPoint(cc * 0.01, std::sin(cc * 0.1), (cc % 11) - 5);
+    s->InsertNextValue(((cc % 7) - 3) * 0.5);
+    t->InsertNextValue(static_cast<float>(std::cos(cc * 0.1)));
+    v->InsertNextTuple3((cc % 5) - 2, ((cc % 3) - 1) * 0.5, (cc % 2) * 0.25);
+    w->InsertNextTuple3((cc % 4) - 1, 2 - (cc % 3), cc % 5);
+  }
+  input->SetPoints(points.GetPointer());
+  input->GetPointData()->AddArray(s.GetPointer());
+  input->GetPointData()->AddArray(t.GetPointer());
+  input->GetPointData()->AddArray(v.GetPointer());
+  input->GetPointData()->AddArray(w.GetPointer());
+}
+
+bool CompareArrays(const char* function, vtkDataArray* expected, vtkDataArray* actual)
+{
+  if (!expected || !actual || expected->GetNumberOfTuples() != actual->GetNumberOfTuples() ||
+    expected->GetNumberOfComponents() != actual->GetNumberOfComponents())
+  {
+    cerr << "ERROR: '" << function << "': result arrays mismatch." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < expected->GetNumberOfTuples(); ++cc)
+  {
+    for (int comp = 0; comp < expected->GetNumberOfComponents(); ++comp)
+    {
+      const double a = expected->GetComponent(cc, comp);
+      const double b = actual->GetComponent(cc, comp);
+      const bool nans = vtkMath::IsNan(a) && vtkMath::IsNan(b);
+      if (!nans && std::abs(a - b) > 1e-12 * std::max(1.0, std::abs(a)))
+      {
+        cerr << "ERROR: '" << function << "' differs at tuple " << cc << ": " << a
+             << " != " << b << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestFunction(vtkPolyData* input, const char* function, bool coordinateResults = false)
+{
+  vtkNew<vtkArrayCalculator> reference;
+  reference->SetInputData(input);
+  reference->SetAttributeType(vtkDataObject::POINT);
+  reference->AddScalarArrayName("s");
+  reference->AddScalarArrayName("t");
+  reference->AddVectorArrayName("v");
+  reference->AddVectorArrayName("w");
+  reference->AddCoordinateScalarVariable("coordsX", 0);
+  reference->AddCoordinateScalarVariable("coordsY", 1);
+  reference->AddCoordinateScalarVariable("coordsZ", 2);
+  reference->AddCoordinateVectorVariable("coords", 0, 1, 2);
+
+  vtkNew<vtkTestPVArrayCalculator> calculator;
+  calculator->SetInputData(input);
+
+  vtkArrayCalculator* calculators[2] = { reference.GetPointer(), calculator.GetPointer() };
+  vtkDataArray* results[2];
+  for (int cc = 0; cc < 2; ++cc)
+  {
+    calculators[cc]->SetFunction(function);
+    calculators[cc]->SetResultArrayName("Result");
+    calculators[cc]->SetCoordinateResults(coordinateResults ? 1 : 0);
+    calculators[cc]->ReplaceInvalidValuesOn();
+    calculators[cc]->SetReplacementValue(-999.0);
+    calculators[cc]->Update();
+    vtkPolyData* output = vtkPolyData::SafeDownCast(calculators[cc]->GetOutput());
+    results[cc] = coordinateResults ? output->GetPoints()->GetData()
+                                    : output->GetPointData()->GetArray("Result");
+  }
+
+  if (!calculator->Vectorized)
+  {
+    cerr << "ERROR: '" << function << "' was not evaluated over blocks of tuples." << endl;
+    return false;
+  }
+  return CompareArrays(function, results[0], results[1]);
+}
+}
+
+int TestPVArrayCalculator(int, char* [])
+{
+  vtkNew<vtkPolyData> input;
+  CreateInput(input.GetPointer());
+
+  const char* scalarFunctions[] = {
+    // immediates and arithmetic, with divisions by zero.
+    "s + 2.5 - t * s / (t - 0.5)", "t / s", "-s + (+t)", "abs(s) ^ 1.5", "s ^ 2",
+    // functions, with values out of their domain.
+    "abs(s) + exp(t) + ceil(s) + floor(t)", "log(s)", "ln(t)", "log10(s)", "sqrt(s)",
+    "sin(s) + cos(t) + tan(s)", "asin(s)", "acos(s)", "atan(s)",
+    "sinh(s) + cosh(t) + tanh(s)", "min(s, t) + max(s, t)", "sign(s)",
+    // comparisons and conditions.
+    "if(s > 0, s, t)", "if((s < t) | ((s = 0) & (t > 0)), 1, 0)",
+    // vector operations with a scalar result.
+    "dot(v, w)", "mag(v)", "mag(w) + s",
+    // coordinates.
+    "coordsX * coordsY + coordsZ",
+  };
+  const char* vectorFunctions[] = {
+    "cross(v, w)", "-v", "+w", "v + w", "v - w", "s * v", "v * t", "v / s", "norm(v)",
+    "norm(w) + iHat", "iHat + 2 * jHat + 3 * kHat", "if(s > 0, v, w)",
+    "if(t < 0, cross(w, v), -v)", "coords + v",
+  };
+
+  int success = 1;
+  for (size_t cc = 0; cc < sizeof(scalarFunctions) / sizeof(scalarFunctions[0]); ++cc)
+  {
+    success &= TestFunction(input.GetPointer(), scalarFunctions[cc]) ? 1 : 0;
+  }
+  for (size_t cc = 0; cc < sizeof(vectorFunctions) / sizeof(vectorFunctions[0]); ++cc)
+  {
+    success &= TestFunction(input.GetPointer(), vectorFunctions[cc]) ? 1 : 0;
+  }
+  success &= TestFunction(input.GetPointer(), "coords + s * v", true) ? 1 : 0;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -783,7 +783,8 @@ void vtkAMRDualContour::FinalizeRequest()
 vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
   vtkNonOverlappingAMR* hbdsInput, const char* arrayNameToProcess)
 {
-  this->Helper->SetupData(hbdsInput, arrayNameToProcess);
+  // Ghost values of degenerate regions are still in flight when this returns.
+  this->Helper->BeginSetupData(hbdsInput, arrayNameToProcess);
 
   vtkMultiBlockDataSet* mbdsOutput0 = vtkMultiBlockDataSet::New();
   mbdsOutput0->SetNumberOfBlocks(1);
@@ -809,16 +810,47 @@ vtkMultiBlockDataSet* vtkAMRDualContour::DoRequestData(
   // Loop through blocks
   int numLevels = hbdsInput->GetNumberOfLevels();
 
-  // Add each block.
+  // Add each block.  Blocks whose ghost values have arrived are contoured
+  // while messages for the others are still in flight.  Levels are still
+  // processed in order because locators are only shared with neighbors in
+  // the same or higher levels.
+  std::vector<int> waitingBlocks;
   for (int level = 0; level < numLevels; ++level)
   {
     int numBlocks = this->Helper->GetNumberOfBlocksInLevel(level);
+    waitingBlocks.clear();
     for (int blockId = 0; blockId < numBlocks; ++blockId)
     {
       vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, blockId);
-      this->ProcessBlock(block, blockId, arrayNameToProcess);
+      if (this->Helper->IsBlockReady(block))
+      {
+        this->ProcessBlock(block, blockId, arrayNameToProcess);
+      }
+      else
+      {
+        waitingBlocks.push_back(blockId);
+      }
+    }
+    while (!waitingBlocks.empty())
+    {
+      bool received = this->Helper->WaitForRegionRemoteCopy();
+      std::vector<int>::iterator iter = waitingBlocks.begin();
+      while (iter != waitingBlocks.end())
+      {
+        vtkAMRDualGridHelperBlock* block = this->Helper->GetBlock(level, *iter);
+        if (!received || this->Helper->IsBlockReady(block))
+        {
+          this->ProcessBlock(block, *iter, arrayNameToProcess);
+          iter = waitingBlocks.erase(iter);
+        }
+        else
+        {
+          ++iter;
+        }
+      }
     }
   }
+  this->Helper->FinishSetupData();
 
   this->FinalizeCopyAttributes(this->Mesh);
   this->BlockIdCellArray->Delete();
@@ -35,6 +35,7 @@
 #define VTK_CREATE(type, name) vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
 
 #include <list>
+#include <set>
 #include <vector>
 
 #include "vtksys/SystemTools.hxx"
@@ -207,6 +208,15 @@ public:
     vtkGenericWarningMacro(<< "Nothing to wait for.");
     return value_type();
   }
+  // Description:
+  // Cancels all of the communication without waiting for it and empties the
+  // list.
+  void CancelAll()
+  {
+    for (iterator i = this->begin(); i != this->end(); i++)
+      i->Request.Cancel();
+    this->clear();
+  }
 };
 #endif // VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
 
@@ -721,6 +731,8 @@ vtkAMRDualGridHelper::vtkAMRDualGridHelper()
   this->EnableDegenerateCells = 1;
   this->EnableAsynchronousCommunication = 1;
   this->NumberOfBlocksInThisProcess = 0;
+  this->PendingSendList = 0;
+  this->PendingReceiveList = 0;
   for (ii = 0; ii < 3; ++ii)
   {
     this->StandardBlockDimensions[ii] = 0;
@@ -746,6 +758,10 @@ vtkAMRDualGridHelper::~vtkAMRDualGridHelper()
 
   this->SetArrayName(0);
 
+  // Waiting here could deadlock with processes that are not exchanging
+  // anymore, so outstanding requests are cancelled instead.
+  this->CancelSetupData();
+
   for (ii = 0; ii < numberOfLevels; ++ii)
   {
     delete this->Levels[ii];
@@ -2088,6 +2104,21 @@ void vtkAMRDualGridHelper::ProcessRegionRemoteCopyQueueMPIAsynchronous(bool hack
   vtkTimerLogSmartMarkEvent markevent(
     "ProcessRegionRemoteCopyQueueMPIAsynchronous", this->Controller);
 
+  vtkAMRDualGridHelperCommRequestList sendList;
+  vtkAMRDualGridHelperCommRequestList receiveList;
+
+  this->BeginRegionRemoteCopyQueueMPIAsynchronous(sendList, receiveList);
+
+  // Finally, finish all communications as they come in.
+  this->FinishDegenerateRegionsCommMPIAsynchronous(hackLevelFlag, sendList, receiveList);
+}
+
+//-----------------------------------------------------------------------------
+// Posts all the receives and sends for the degenerate region queue without
+// waiting for any of them to complete.
+void vtkAMRDualGridHelper::BeginRegionRemoteCopyQueueMPIAsynchronous(
+  vtkAMRDualGridHelperCommRequestList& sendList, vtkAMRDualGridHelperCommRequestList& receiveList)
+{
   vtkMPIController* controller = vtkMPIController::SafeDownCast(this->Controller);
   if (!controller)
   {
@@ -2100,9 +2131,6 @@ void vtkAMRDualGridHelper::ProcessRegionRemoteCopyQueueMPIAsynchronous(bool hack
   int numProcs = controller->GetNumberOfProcesses();
   int myProc = controller->GetLocalProcessId();
 
-  vtkAMRDualGridHelperCommRequestList sendList;
-  vtkAMRDualGridHelperCommRequestList receiveList;
-
   VTK_CREATE(vtkIdTypeArray, srcProcs);
   srcProcs->SetNumberOfValues(numProcs);
   VTK_CREATE(vtkIdTypeArray, destProcs);
@@ -2142,9 +2170,6 @@ void vtkAMRDualGridHelper::ProcessRegionRemoteCopyQueueMPIAsynchronous(bool hack
       this->SendDegenerateRegionsFromQueueMPIAsynchronous(recvProc, messageLength, sendList);
     }
   }
-
-  // Finally, finish all communications as they come in.
-  this->FinishDegenerateRegionsCommMPIAsynchronous(hackLevelFlag, sendList, receiveList);
 }
 
 void vtkAMRDualGridHelper::ReceiveDegenerateRegionsFromQueueMPIAsynchronous(
@@ -2335,6 +2360,20 @@ int vtkAMRDualGridHelper::SetupData(vtkNonOverlappingAMR* input, const char* arr
 {
   vtkTimerLogSmartMarkEvent markevent("vtkAMRDualGridHelper::SetupData", this->Controller);
 
+  int retVal = this->BeginSetupData(input, arrayName);
+  this->FinishSetupData();
+  return retVal;
+}
+
+//----------------------------------------------------------------------------
+int vtkAMRDualGridHelper::BeginSetupData(vtkNonOverlappingAMR* input, const char* arrayName)
+{
+  // No barrier here, the whole point is to let processes run ahead.
+  vtkTimerLogSmartMarkEvent markevent("vtkAMRDualGridHelper::BeginSetupData");
+
+  // Complete any previous exchange before the queue is rebuilt.
+  this->FinishSetupData();
+
   int blockId, numBlocks;
   int numLevels = input->GetNumberOfLevels();
 
@@ -2381,6 +2420,20 @@ int vtkAMRDualGridHelper::SetupData(vtkNonOverlappingAMR* input, const char* arr
   this->AssignSharedRegions();
 
   // Copy regions on level boundaries between processes.
+#ifdef VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  if (!this->SkipGhostCopy && this->EnableAsynchronousCommunication &&
+    this->Controller->IsA("vtkMPIController"))
+  {
+    // Only post the messages. They are completed by WaitForRegionRemoteCopy()
+    // or FinishSetupData().
+    this->PendingSendList = new vtkAMRDualGridHelperCommRequestList;
+    this->PendingReceiveList = new vtkAMRDualGridHelperCommRequestList;
+    this->BeginRegionRemoteCopyQueueMPIAsynchronous(
+      *this->PendingSendList, *this->PendingReceiveList);
+    this->CountPendingRemoteCopies();
+    return VTK_OK;
+  }
+#endif // VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
   this->ProcessRegionRemoteCopyQueue(false);
 
   // Setup faces for seeding connectivity between blocks.
@@ -2388,6 +2441,115 @@ int vtkAMRDualGridHelper::SetupData(vtkNonOverlappingAMR* input, const char* arr
 
   return VTK_OK;
 }
+
+//----------------------------------------------------------------------------
+bool vtkAMRDualGridHelper::IsBlockReady(vtkAMRDualGridHelperBlock* block)
+{
+  return this->PendingRemoteCopies.find(block) == this->PendingRemoteCopies.end();
+}
+
+//----------------------------------------------------------------------------
+bool vtkAMRDualGridHelper::WaitForRegionRemoteCopy()
+{
+#ifdef VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  if (this->PendingReceiveList && !this->PendingReceiveList->empty())
+  {
+    vtkAMRDualGridHelperCommRequest request = this->PendingReceiveList->WaitAny();
+    vtkCharArray* recvBuffer = vtkCharArray::SafeDownCast(request.Buffer);
+    this->UnmarshalDegenerateRegionMessage(
+      recvBuffer->GetPointer(0), recvBuffer->GetNumberOfTuples(), request.SendProcess, false);
+    this->MarkRemoteCopyReceived(request.SendProcess);
+    return true;
+  }
+#endif // VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkAMRDualGridHelper::FinishSetupData()
+{
+#ifdef VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  if (this->PendingReceiveList)
+  {
+    this->FinishDegenerateRegionsCommMPIAsynchronous(
+      false, *this->PendingSendList, *this->PendingReceiveList);
+    delete this->PendingSendList;
+    delete this->PendingReceiveList;
+    this->PendingSendList = 0;
+    this->PendingReceiveList = 0;
+  }
+#endif // VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  this->PendingRemoteCopies.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkAMRDualGridHelper::CancelSetupData()
+{
+#ifdef VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  if (this->PendingReceiveList)
+  {
+    vtkErrorMacro("FinishSetupData() was not called after BeginSetupData(). "
+                  "Cancelling the outstanding ghost region exchange.");
+    this->PendingSendList->CancelAll();
+    this->PendingReceiveList->CancelAll();
+    delete this->PendingSendList;
+    delete this->PendingReceiveList;
+    this->PendingSendList = 0;
+    this->PendingReceiveList = 0;
+  }
+#endif // VTK_AMR_DUAL_GRID_USE_MPI_ASYNCHRONOUS
+  this->PendingRemoteCopies.clear();
+}
+
+//----------------------------------------------------------------------------
+// A local block is pending until every remote process that sends regions
+// into it has delivered its message.
+void vtkAMRDualGridHelper::CountPendingRemoteCopies()
+{
+  int myProc = this->Controller->GetLocalProcessId();
+  std::set<std::pair<vtkAMRDualGridHelperBlock*, int> > senders;
+
+  this->PendingRemoteCopies.clear();
+  std::vector<vtkAMRDualGridHelperDegenerateRegion>::iterator region;
+  for (region = this->DegenerateRegionQueue.begin(); region != this->DegenerateRegionQueue.end();
+       region++)
+  {
+    int srcProc = region->SourceBlock->ProcessId;
+    if (region->ReceivingBlock->ProcessId == myProc && srcProc != myProc &&
+      senders.insert(std::make_pair(region->ReceivingBlock, srcProc)).second)
+    {
+      this->PendingRemoteCopies[region->ReceivingBlock] += 1;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkAMRDualGridHelper::MarkRemoteCopyReceived(int srcProc)
+{
+  int myProc = this->Controller->GetLocalProcessId();
+  std::set<vtkAMRDualGridHelperBlock*> receivers;
+
+  std::vector<vtkAMRDualGridHelperDegenerateRegion>::iterator region;
+  for (region = this->DegenerateRegionQueue.begin(); region != this->DegenerateRegionQueue.end();
+       region++)
+  {
+    if (region->SourceBlock->ProcessId == srcProc && region->ReceivingBlock->ProcessId == myProc)
+    {
+      receivers.insert(region->ReceivingBlock);
+    }
+  }
+
+  std::set<vtkAMRDualGridHelperBlock*>::iterator iter;
+  for (iter = receivers.begin(); iter != receivers.end(); ++iter)
+  {
+    std::map<vtkAMRDualGridHelperBlock*, int>::iterator pending =
+      this->PendingRemoteCopies.find(*iter);
+    if (pending != this->PendingRemoteCopies.end() && --pending->second <= 0)
+    {
+      this->PendingRemoteCopies.erase(pending);
+    }
+  }
+}
 void vtkAMRDualGridHelper::ClearRegionRemoteCopyQueue()
 {
   this->DegenerateRegionQueue.clear();
@@ -97,6 +97,26 @@ public:
 
   int Initialize(vtkNonOverlappingAMR* input);
   int SetupData(vtkNonOverlappingAMR* input, const char* arrayName);
+
+  //@{
+  /**
+   * Split version of SetupData() that lets the caller overlap work with the
+   * exchange of degenerate regions between processes. BeginSetupData() only
+   * posts the messages when asynchronous MPI communication is used (it falls
+   * back to the blocking exchange otherwise). A local block may be processed
+   * as soon as IsBlockReady() returns true for it.
+   * WaitForRegionRemoteCopy() blocks until one more message has been copied
+   * into the local blocks and returns false when nothing is left to wait for.
+   * FinishSetupData() completes all outstanding communication; it must be
+   * called explicitly on every process before the helper is used for anything
+   * else or destroyed. A helper destroyed with outstanding communication
+   * reports an error and cancels the requests instead of waiting on them.
+   */
+  int BeginSetupData(vtkNonOverlappingAMR* input, const char* arrayName);
+  bool IsBlockReady(vtkAMRDualGridHelperBlock* block);
+  bool WaitForRegionRemoteCopy();
+  void FinishSetupData();
+  //@}
   const double* GetGlobalOrigin() { return this->GlobalOrigin; }
   const double* GetRootSpacing() { return this->RootSpacing; }
   int GetNumberOfBlocks() { return this->NumberOfBlocksInThisProcess; }
@@ -207,6 +227,17 @@ private:
   void FinishDegenerateRegionsCommMPIAsynchronous(bool hackLevelFlag,
     vtkAMRDualGridHelperCommRequestList& sendList,
     vtkAMRDualGridHelperCommRequestList& receiveList);
+  void BeginRegionRemoteCopyQueueMPIAsynchronous(vtkAMRDualGridHelperCommRequestList& sendList,
+    vtkAMRDualGridHelperCommRequestList& receiveList);
+
+  // Outstanding communication between BeginSetupData() and FinishSetupData().
+  vtkAMRDualGridHelperCommRequestList* PendingSendList;
+  vtkAMRDualGridHelperCommRequestList* PendingReceiveList;
+  // Number of remote processes each local block still waits on.
+  std::map<vtkAMRDualGridHelperBlock*, int> PendingRemoteCopies;
+  void CountPendingRemoteCopies();
+  void MarkRemoteCopyReceived(int srcProc);
+  void CancelSetupData();
 
   // Degenerate regions that span processes.  We keep them in a queue
   // to communicate and process all at once.
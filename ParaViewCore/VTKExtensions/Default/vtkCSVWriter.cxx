@@ -20,18 +20,24 @@
 #include "vtkDataArray.h"
 #include "vtkErrorCode.h"
 #include "vtkInformation.h"
+#include "vtkMultiProcessController.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPointSet.h"
 #include "vtkPolyData.h"
 #include "vtkPolyLineToRectilinearGridFilter.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkTable.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
 #include <sstream>
 #include <vector>
 
 vtkStandardNewMacro(vtkCSVWriter);
+vtkCxxSetObjectMacro(vtkCSVWriter, Controller, vtkMultiProcessController);
 //-----------------------------------------------------------------------------
 vtkCSVWriter::vtkCSVWriter()
 {
@@ -44,6 +50,7 @@ vtkCSVWriter::vtkCSVWriter()
   this->FileName = 0;
   this->Precision = 5;
   this->UseScientificNotation = true;
+  this->Controller = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -52,6 +59,7 @@ vtkCSVWriter::~vtkCSVWriter()
   this->SetStringDelimiter(0);
   this->SetFieldDelimiter(0);
   this->SetFileName(0);
+  this->SetController(0);
   delete this->Stream;
 }
 
@@ -88,120 +96,285 @@ bool vtkCSVWriter::OpenFile()
   return true;
 }
 
+namespace
+{
+// Rows are formatted in chunks of these many rows, and these many chunks are
+// formatted in parallel before being written out.
+const vtkIdType vtkCSVRowsPerChunk = 8192;
+const vtkIdType vtkCSVChunksPerBatch = 64;
+
+//-----------------------------------------------------------------------------
+struct vtkCSVFormat
+{
+  std::string FieldDelimiter;
+  std::string StringDelimiter;
+  int Precision;
+  bool UseScientificNotation;
+};
+
+//-----------------------------------------------------------------------------
+// Converting values to text without going through an ostream. The results
+// match what `ostream << value` produces with the stream set up as in
+// vtkCSVWriter::WriteTable().
+void vtkCSVAppendUnsigned(std::string& out, unsigned long long value, bool negative)
+{
+  char buffer[32];
+  char* end = buffer + sizeof(buffer);
+  char* ptr = end;
+  do
+  {
+    *--ptr = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  if (negative)
+  {
+    *--ptr = '-';
+  }
+  out.append(ptr, end);
+}
+
+void vtkCSVAppendValue(std::string& out, long long value, const vtkCSVFormat&)
+{
+  // negate in unsigned arithmetic so that the most negative value works too.
+  const bool negative = value < 0;
+  const unsigned long long magnitude = static_cast<unsigned long long>(value);
+  vtkCSVAppendUnsigned(out, negative ? 0ull - magnitude : magnitude, negative);
+}
+
+void vtkCSVAppendValue(std::string& out, unsigned long long value, const vtkCSVFormat&)
+{
+  vtkCSVAppendUnsigned(out, value, false);
+}
+
+// char types are written as numbers.
+void vtkCSVAppendValue(std::string& out, char value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, signed char value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, unsigned char value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<unsigned long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, short value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, unsigned short value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<unsigned long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, int value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, unsigned int value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<unsigned long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, long value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<long long>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, unsigned long value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<unsigned long long>(value), format);
+}
+
+// Any other type (vtkVariant, vtkUnicodeString) goes through an ostream.
+template <class T>
+void vtkCSVAppendValue(std::string& out, const T& value, const vtkCSVFormat& format)
+{
+  std::ostringstream stream;
+  if (format.UseScientificNotation)
+  {
+    stream << std::scientific;
+  }
+  stream << std::setprecision(format.Precision) << value;
+  out += stream.str();
+}
+
+void vtkCSVAppendValue(std::string& out, double value, const vtkCSVFormat& format)
+{
+  char buffer[128];
+  const int length = snprintf(buffer, sizeof(buffer),
+    format.UseScientificNotation ? "%.*e" : "%.*g", format.Precision, value);
+  if (length >= 0 && length < static_cast<int>(sizeof(buffer)))
+  {
+    out.append(buffer, length);
+  }
+  else
+  {
+    // very large precisions.
+    vtkCSVAppendValue<double>(out, value, format);
+  }
+}
+
+void vtkCSVAppendValue(std::string& out, float value, const vtkCSVFormat& format)
+{
+  vtkCSVAppendValue(out, static_cast<double>(value), format);
+}
+
+void vtkCSVAppendValue(std::string& out, const vtkStdString& value, const vtkCSVFormat& format)
+{
+  out += format.StringDelimiter;
+  out += value;
+  out += format.StringDelimiter;
+}
+
 //-----------------------------------------------------------------------------
+// Formats the values of all components of a column for a given row.
+class vtkCSVColumn
+{
+public:
+  virtual ~vtkCSVColumn() {}
+  virtual void Append(vtkIdType row, std::string& out, bool& first) const = 0;
+};
+
 template <class iterT>
-void vtkCSVWriterGetDataString(
-  iterT* iter, vtkIdType tupleIndex, ofstream* stream, vtkCSVWriter* writer, bool* first)
+class vtkCSVColumnT : public vtkCSVColumn
 {
-  int numComps = iter->GetNumberOfComponents();
-  vtkIdType index = tupleIndex * numComps;
-  for (int cc = 0; cc < numComps; cc++)
+public:
+  vtkCSVColumnT(iterT* iter, const vtkCSVFormat& format)
+    : Iter(iter)
+    , Format(format)
+  {
+  }
+
+  void Append(vtkIdType row, std::string& out, bool& first) const VTK_OVERRIDE
   {
-    if ((index + cc) < iter->GetNumberOfValues())
+    const int numComps = this->Iter->GetNumberOfComponents();
+    const vtkIdType numValues = this->Iter->GetNumberOfValues();
+    const vtkIdType index = row * numComps;
+    for (int cc = 0; cc < numComps; cc++)
     {
-      if (*first == false)
+      if (!first)
       {
-        (*stream) << writer->GetFieldDelimiter();
+        out += this->Format.FieldDelimiter;
       }
-      *first = false;
-      (*stream) << iter->GetValue(index + cc);
-    }
-    else
-    {
-      if (*first == false)
+      first = false;
+      if ((index + cc) < numValues)
       {
-        (*stream) << writer->GetFieldDelimiter();
+        vtkCSVAppendValue(out, this->Iter->GetValue(index + cc), this->Format);
       }
-      *first = false;
     }
   }
+
+private:
+  iterT* Iter;
+  const vtkCSVFormat& Format;
+};
+
+template <class iterT>
+vtkCSVColumn* vtkNewCSVColumn(iterT* iter, const vtkCSVFormat& format)
+{
+  return new vtkCSVColumnT<iterT>(iter, format);
 }
 
 //-----------------------------------------------------------------------------
-template <>
-void vtkCSVWriterGetDataString(vtkArrayIteratorTemplate<vtkStdString>* iter, vtkIdType tupleIndex,
-  ofstream* stream, vtkCSVWriter* writer, bool* first)
+// Formats rows of a table into text.
+class vtkCSVRowFormatter
 {
-  int numComps = iter->GetNumberOfComponents();
-  vtkIdType index = tupleIndex * numComps;
-  for (int cc = 0; cc < numComps; cc++)
+public:
+  vtkCSVRowFormatter(vtkDataSetAttributes* dsa, const vtkCSVFormat& format)
   {
-    if ((index + cc) < iter->GetNumberOfValues())
+    for (int cc = 0; cc < dsa->GetNumberOfArrays(); cc++)
     {
-      if (*first == false)
+      vtkSmartPointer<vtkArrayIterator> iter;
+      iter.TakeReference(dsa->GetAbstractArray(cc)->NewIterator());
+      vtkCSVColumn* column = NULL;
+      switch (iter->GetDataType())
       {
-        (*stream) << writer->GetFieldDelimiter();
+        vtkArrayIteratorTemplateMacro(
+          column = vtkNewCSVColumn(static_cast<VTK_TT*>(iter.GetPointer()), format));
       }
-      *first = false;
-      (*stream) << writer->GetString(iter->GetValue(index + cc));
-    }
-    else
-    {
-      if (*first == false)
+      if (column)
       {
-        (*stream) << writer->GetFieldDelimiter();
+        this->Iterators.push_back(iter);
+        this->Columns.push_back(column);
       }
-      *first = false;
     }
   }
-}
 
-//-----------------------------------------------------------------------------
-template <>
-void vtkCSVWriterGetDataString(vtkArrayIteratorTemplate<char>* iter, vtkIdType tupleIndex,
-  ofstream* stream, vtkCSVWriter* writer, bool* first)
-{
-  int numComps = iter->GetNumberOfComponents();
-  vtkIdType index = tupleIndex * numComps;
-  for (int cc = 0; cc < numComps; cc++)
+  ~vtkCSVRowFormatter()
   {
-    if ((index + cc) < iter->GetNumberOfValues())
+    for (size_t cc = 0; cc < this->Columns.size(); cc++)
     {
-      if (*first == false)
-      {
-        (*stream) << writer->GetFieldDelimiter();
-      }
-      *first = false;
-      (*stream) << static_cast<int>(iter->GetValue(index + cc));
+      delete this->Columns[cc];
     }
-    else
+  }
+
+  void Format(vtkIdType begin, vtkIdType end, std::string& out) const
+  {
+    out.clear();
+    for (vtkIdType row = begin; row < end; row++)
     {
-      if (*first == false)
+      bool first = true;
+      for (size_t cc = 0; cc < this->Columns.size(); cc++)
       {
-        (*stream) << writer->GetFieldDelimiter();
+        this->Columns[cc]->Append(row, out, first);
       }
-      *first = false;
+      out += "\n";
     }
   }
-}
+
+private:
+  vtkCSVRowFormatter(const vtkCSVRowFormatter&) = delete;
+  void operator=(const vtkCSVRowFormatter&) = delete;
+
+  std::vector<vtkSmartPointer<vtkArrayIterator> > Iterators;
+  std::vector<vtkCSVColumn*> Columns;
+};
 
 //-----------------------------------------------------------------------------
-template <>
-void vtkCSVWriterGetDataString(vtkArrayIteratorTemplate<unsigned char>* iter, vtkIdType tupleIndex,
-  ofstream* stream, vtkCSVWriter* writer, bool* first)
+// Formats the rows [FirstRow, LastRow) into chunks of vtkCSVRowsPerChunk rows.
+class vtkCSVFormatChunks
 {
-  int numComps = iter->GetNumberOfComponents();
-  vtkIdType index = tupleIndex * numComps;
-  for (int cc = 0; cc < numComps; cc++)
+public:
+  vtkCSVFormatChunks(const vtkCSVRowFormatter& formatter, vtkIdType firstRow, vtkIdType lastRow,
+    std::vector<std::string>& chunks)
+    : Formatter(formatter)
+    , FirstRow(firstRow)
+    , LastRow(lastRow)
+    , Chunks(chunks)
   {
-    if ((index + cc) < iter->GetNumberOfValues())
-    {
-      if (*first == false)
-      {
-        (*stream) << writer->GetFieldDelimiter();
-      }
-      *first = false;
-      (*stream) << static_cast<int>(iter->GetValue(index + cc));
-    }
-    else
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType chunk = begin; chunk < end; chunk++)
     {
-      if (*first == false)
-      {
-        (*stream) << writer->GetFieldDelimiter();
-      }
-      *first = false;
+      const vtkIdType first = this->FirstRow + chunk * vtkCSVRowsPerChunk;
+      const vtkIdType last = std::min(first + vtkCSVRowsPerChunk, this->LastRow);
+      this->Formatter.Format(first, last, this->Chunks[chunk]);
     }
   }
+
+  void Execute()
+  {
+    const vtkIdType numChunks =
+      (this->LastRow - this->FirstRow + vtkCSVRowsPerChunk - 1) / vtkCSVRowsPerChunk;
+    this->Chunks.resize(numChunks);
+    vtkSMPTools::For(0, numChunks, 1, *this);
+  }
+
+private:
+  const vtkCSVRowFormatter& Formatter;
+  vtkIdType FirstRow;
+  vtkIdType LastRow;
+  std::vector<std::string>& Chunks;
+};
 }
 
 //-----------------------------------------------------------------------------
@@ -235,25 +408,18 @@ void vtkCSVWriter::WriteTable(vtkTable* table)
 {
   vtkIdType numRows = table->GetNumberOfRows();
   vtkDataSetAttributes* dsa = table->GetRowData();
-  if (!this->OpenFile())
-  {
-    return;
-  }
 
-  std::vector<vtkSmartPointer<vtkArrayIterator> > columnsIters;
-
-  int cc;
-  int numArrays = dsa->GetNumberOfArrays();
-  bool first = true;
   // Write headers:
-  for (cc = 0; cc < numArrays; cc++)
+  std::string header;
+  bool first = true;
+  for (int cc = 0; cc < dsa->GetNumberOfArrays(); cc++)
   {
     vtkAbstractArray* array = dsa->GetAbstractArray(cc);
     for (int comp = 0; comp < array->GetNumberOfComponents(); comp++)
     {
       if (!first)
       {
-        (*this->Stream) << this->FieldDelimiter;
+        header += this->FieldDelimiter;
       }
       first = false;
 
@@ -263,38 +429,173 @@ void vtkCSVWriter::WriteTable(vtkTable* table)
       {
         array_name << ":" << comp;
       }
-      (*this->Stream) << this->GetString(array_name.str());
+      header += this->GetString(array_name.str());
+    }
+  }
+  header += "\n";
+
+  vtkCSVFormat format;
+  format.FieldDelimiter = this->FieldDelimiter ? this->FieldDelimiter : "";
+  format.StringDelimiter =
+    (this->UseStringDelimiter && this->StringDelimiter) ? this->StringDelimiter : "";
+  format.Precision = this->Precision;
+  format.UseScientificNotation = this->UseScientificNotation;
+  vtkCSVRowFormatter formatter(dsa, format);
+
+  std::vector<std::string> chunks;
+  if (this->Controller && this->Controller->GetNumberOfProcesses() > 1)
+  {
+    vtkCSVFormatChunks(formatter, 0, numRows, chunks).Execute();
+    this->WriteTableInParallel(first ? std::string() : header, chunks);
+    return;
+  }
+
+  if (!this->OpenFile())
+  {
+    return;
+  }
+  this->Stream->write(header.c_str(), header.size());
+
+  // Format a batch of chunks in parallel, then write them in order.
+  const vtkIdType rowsPerBatch = vtkCSVRowsPerChunk * vtkCSVChunksPerBatch;
+  for (vtkIdType batch = 0; batch < numRows; batch += rowsPerBatch)
+  {
+    const vtkIdType last = std::min(batch + rowsPerBatch, numRows);
+    vtkCSVFormatChunks(formatter, batch, last, chunks).Execute();
+    for (size_t cc = 0; cc < chunks.size(); cc++)
+    {
+      this->Stream->write(chunks[cc].c_str(), chunks[cc].size());
     }
-    vtkArrayIterator* iter = array->NewIterator();
-    columnsIters.push_back(iter);
-    iter->Delete();
+    this->UpdateProgress(static_cast<double>(last) / numRows);
   }
-  (*this->Stream) << "\n";
 
-  // push the floating point precision/notation type.
-  if (this->UseScientificNotation)
+  this->Stream->close();
+  delete this->Stream;
+  this->Stream = 0;
+}
+
+//-----------------------------------------------------------------------------
+void vtkCSVWriter::WriteTableInParallel(
+  const std::string& header, const std::vector<std::string>& chunks)
+{
+  vtkMultiProcessController* controller = this->Controller;
+  const int numProcs = controller->GetNumberOfProcesses();
+  const int myId = controller->GetLocalProcessId();
+
+  // Exchange the size of the header and rows of every process. Processes with
+  // no columns pass an empty header; the first process with columns writes
+  // the header at the start of the file.
+  vtkIdType sizes[2] = { static_cast<vtkIdType>(header.size()), 0 };
+  for (size_t cc = 0; cc < chunks.size(); cc++)
   {
-    (*this->Stream) << std::scientific;
+    sizes[1] += static_cast<vtkIdType>(chunks[cc].size());
   }
+  std::vector<vtkIdType> allSizes(2 * numProcs, 0);
+  controller->AllGather(sizes, &allSizes[0], 2);
 
-  (*this->Stream) << std::setprecision(this->Precision);
+  int headerWriter = -1;
+  vtkIdType offset = 0;
+  for (int cc = 0; cc < numProcs; cc++)
+  {
+    if (headerWriter == -1 && allSizes[2 * cc] > 0)
+    {
+      headerWriter = cc;
+      offset += allSizes[2 * cc];
+    }
+  }
+  for (int cc = 0; cc < myId; cc++)
+  {
+    offset += allSizes[2 * cc + 1];
+  }
 
-  for (vtkIdType index = 0; index < numRows; index++)
+  // Rows are only meaningful under a single header: every process with
+  // columns must have the same columns, in the same order, as the process
+  // writing the header.
+  if (headerWriter != -1)
   {
-    first = true;
-    std::vector<vtkSmartPointer<vtkArrayIterator> >::iterator iter;
-    for (iter = columnsIters.begin(); iter != columnsIters.end(); ++iter)
+    std::string expected = header;
+    int length = static_cast<int>(expected.size());
+    controller->Broadcast(&length, 1, headerWriter);
+    expected.resize(length);
+    controller->Broadcast(&expected[0], length, headerWriter);
+    int match = (header.empty() || header == expected) ? 1 : 0;
+    int allMatch = 0;
+    controller->AllReduce(&match, &allMatch, 1, vtkCommunicator::MIN_OP);
+    if (!allMatch)
     {
-      switch ((*iter)->GetDataType())
+      if (!match)
       {
-        vtkArrayIteratorTemplateMacro(vtkCSVWriterGetDataString(
-          static_cast<VTK_TT*>(iter->GetPointer()), index, this->Stream, this, &first));
+        vtkErrorMacro(<< "Columns on process " << myId << " differ from the columns on process "
+                      << headerWriter << ". Nothing written.");
       }
+      this->SetErrorCode(vtkErrorCode::UnknownError);
+      return;
     }
-    (*this->Stream) << "\n";
   }
 
-  this->Stream->close();
+  // The root creates (or truncates) the file before anyone writes to it.
+  int status = 1;
+  if (myId == 0)
+  {
+    status = this->OpenFile() ? 1 : 0;
+    if (status)
+    {
+      if (headerWriter == -1)
+      {
+        // no process has any columns.
+        (*this->Stream) << "\n";
+      }
+      this->Stream->close();
+      delete this->Stream;
+      this->Stream = 0;
+    }
+  }
+  controller->Broadcast(&status, 1, 0);
+  if (!status)
+  {
+    if (myId != 0)
+    {
+      this->SetErrorCode(vtkErrorCode::CannotOpenFileError);
+    }
+    return;
+  }
+
+  if (myId == headerWriter || sizes[1] > 0)
+  {
+    ofstream stream(this->FileName, ios::in | ios::out | ios::binary);
+    if (stream.fail())
+    {
+      vtkErrorMacro(<< "Unable to open file: " << this->FileName);
+      this->SetErrorCode(vtkErrorCode::CannotOpenFileError);
+    }
+    else
+    {
+      if (myId == headerWriter)
+      {
+        stream.write(header.c_str(), header.size());
+      }
+      stream.seekp(offset);
+      for (size_t cc = 0; cc < chunks.size(); cc++)
+      {
+        stream.write(chunks[cc].c_str(), chunks[cc].size());
+      }
+      if (stream.fail())
+      {
+        vtkErrorMacro(<< "Failed to write to file: " << this->FileName);
+        this->SetErrorCode(vtkErrorCode::OutOfDiskSpaceError);
+      }
+    }
+  }
+
+  // The file is complete only once every process is done. A failure on any
+  // process is a failure for all of them.
+  unsigned long errorCode = this->GetErrorCode();
+  unsigned long globalErrorCode = 0;
+  controller->AllReduce(&errorCode, &globalErrorCode, 1, vtkCommunicator::MAX_OP);
+  if (globalErrorCode != vtkErrorCode::NoError && errorCode == vtkErrorCode::NoError)
+  {
+    this->SetErrorCode(globalErrorCode);
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -309,4 +610,5 @@ void vtkCSVWriter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "FileName: " << (this->FileName ? this->FileName : "none") << endl;
   os << indent << "UseScientificNotation: " << this->UseScientificNotation << endl;
   os << indent << "Precision: " << this->Precision << endl;
+  os << indent << "Controller: " << this->Controller << endl;
 }
@@ -16,6 +16,18 @@
  * @class   vtkCSVWriter
  * @brief   CSV writer for vtkTable
  * Writes a vtkTable as a delimited text file (such as CSV).
+ *
+ * Rows are formatted into text in chunks, in parallel using vtkSMPTools, and
+ * the chunks are then written out in order.
+ *
+ * When a Controller with more than one process is set, writing is collective:
+ * each process formats its own rows and writes them into the same file, at an
+ * offset computed from the sizes of the text produced by the processes before
+ * it. The file is thus identical to the one obtained by appending the tables
+ * of all processes, in process order, and writing the result. This requires
+ * the file to be on a file system shared by all processes. Processes with
+ * columns must all have the same columns, otherwise nothing is written. A
+ * failure on any process sets the error code on all of them.
 */
 
 #ifndef vtkCSVWriter_h
@@ -24,6 +36,10 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include "vtkWriter.h"
 
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+class vtkMultiProcessController;
 class vtkStdString;
 class vtkTable;
 
@@ -86,6 +102,16 @@ public:
   vtkBooleanMacro(UseScientificNotation, bool);
   //@}
 
+  //@{
+  /**
+   * Get/Set the controller used to write the tables of all processes into a
+   * single file. When NULL (default) or with a single process, each call
+   * writes the local table only.
+   */
+  void SetController(vtkMultiProcessController*);
+  vtkGetObjectMacro(Controller, vtkMultiProcessController);
+  //@}
+
   //@{
   /**
    * Internal method: decortes the "string" with the "StringDelimiter" if
@@ -103,6 +129,12 @@ protected:
   void WriteData() VTK_OVERRIDE;
   virtual void WriteTable(vtkTable* rectilinearGrid);
 
+  /**
+   * Writes the header and rows formatted by each process at their offset in
+   * the file. Called by WriteTable() when writing in parallel.
+   */
+  void WriteTableInParallel(const std::string& header, const std::vector<std::string>& chunks);
+
   // see algorithm for more info.
   // This writer takes in vtkTable.
   int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
@@ -113,6 +145,7 @@ protected:
   bool UseStringDelimiter;
   int Precision;
   bool UseScientificNotation;
+  vtkMultiProcessController* Controller;
 
   ofstream* Stream;
 
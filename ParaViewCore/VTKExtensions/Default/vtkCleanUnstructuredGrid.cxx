@@ -15,36 +15,339 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCleanUnstructuredGrid.h"
 
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCollection.h"
+#include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkIntArray.h"
-#include "vtkMergePoints.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Bins points on a regular grid of at most 2^21 bins per axis, and orders the
+// bins along a Morton curve.
+class vtkPointBinner
+{
+public:
+  static const vtkTypeUInt64 MaxBin = (1 << 21) - 1;
+
+  vtkPointBinner(const double bounds[6], double binSize)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      double extent = bounds[2 * i + 1] - bounds[2 * i];
+      double size = std::max(binSize, extent / MaxBin);
+      this->Origin[i] = bounds[2 * i];
+      this->InverseSize[i] = size > 0.0 ? 1.0 / size : 1.0;
+    }
+  }
+
+  void GetBin(const float x[3], vtkTypeUInt64 ijk[3]) const
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      double index = (x[i] - this->Origin[i]) * this->InverseSize[i];
+      ijk[i] = !(index > 0.0) ? 0 : (index < MaxBin ? static_cast<vtkTypeUInt64>(index) : MaxBin);
+    }
+  }
+
+  static vtkTypeUInt64 GetKey(const vtkTypeUInt64 ijk[3])
+  {
+    return vtkPointBinner::Spread(ijk[0]) | (vtkPointBinner::Spread(ijk[1]) << 1) |
+      (vtkPointBinner::Spread(ijk[2]) << 2);
+  }
+
+private:
+  // Inserts two 0 bits after each of the 21 lower bits of v.
+  static vtkTypeUInt64 Spread(vtkTypeUInt64 v)
+  {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+  }
+
+  double Origin[3];
+  double InverseSize[3];
+};
+
+const vtkTypeUInt64 vtkPointBinner::MaxBin;
+
+//----------------------------------------------------------------------------
+// Fetches the point coordinates, in single precision like vtkMergePoints
+// compares them, and computes the bin key of each point.
+class vtkComputePointKeys
+{
+public:
+  vtkComputePointKeys(vtkDataSet* input, const vtkPointBinner& binner, std::vector<float>& coords,
+    std::vector<vtkTypeUInt64>& keys)
+    : Input(input)
+    , Binner(binner)
+    , Coords(coords)
+    , Keys(keys)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double pt[3];
+    vtkTypeUInt64 ijk[3];
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      this->Input->GetPoint(id, pt);
+      float* x = &this->Coords[3 * id];
+      x[0] = static_cast<float>(pt[0]);
+      x[1] = static_cast<float>(pt[1]);
+      x[2] = static_cast<float>(pt[2]);
+      this->Binner.GetBin(x, ijk);
+      this->Keys[id] = vtkPointBinner::GetKey(ijk);
+    }
+  }
+
+private:
+  vtkDataSet* Input;
+  const vtkPointBinner& Binner;
+  std::vector<float>& Coords;
+  std::vector<vtkTypeUInt64>& Keys;
+};
+
+//----------------------------------------------------------------------------
+// Orders points by bin, then by coordinates (so that coincident points are
+// contiguous), then by id.
+class vtkPointOrder
+{
+public:
+  vtkPointOrder(const std::vector<float>& coords, const std::vector<vtkTypeUInt64>& keys,
+    bool compareCoordinates)
+    : Coords(&coords[0])
+    , Keys(&keys[0])
+    , CompareCoordinates(compareCoordinates)
+  {
+  }
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    if (this->Keys[a] != this->Keys[b])
+    {
+      return this->Keys[a] < this->Keys[b];
+    }
+    if (this->CompareCoordinates)
+    {
+      const float* xa = this->Coords + 3 * a;
+      const float* xb = this->Coords + 3 * b;
+      for (int i = 0; i < 3; i++)
+      {
+        if (xa[i] != xb[i])
+        {
+          return xa[i] < xb[i];
+        }
+      }
+    }
+    return a < b;
+  }
+
+  bool SameCoordinates(vtkIdType a, vtkIdType b) const
+  {
+    const float* xa = this->Coords + 3 * a;
+    const float* xb = this->Coords + 3 * b;
+    return xa[0] == xb[0] && xa[1] == xb[1] && xa[2] == xb[2];
+  }
+
+private:
+  const float* Coords;
+  const vtkTypeUInt64* Keys;
+  bool CompareCoordinates;
+};
+
+//----------------------------------------------------------------------------
+// For each point, finds the point of lowest id within the tolerance by looking
+// at the points in the 27 bins around it. Bins are at least as large as the
+// tolerance.
+class vtkFindPointsWithinTolerance
+{
+public:
+  vtkFindPointsWithinTolerance(const vtkPointBinner& binner, const std::vector<float>& coords,
+    const std::vector<vtkIdType>& order, const std::vector<vtkTypeUInt64>& sortedKeys,
+    double tolerance, std::vector<vtkIdType>& merged)
+    : Binner(binner)
+    , Coords(coords)
+    , Order(order)
+    , SortedKeys(sortedKeys)
+    , Tolerance2(tolerance * tolerance)
+    , Merged(merged)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkTypeUInt64 ijk[3], nijk[3];
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      const float* x = &this->Coords[3 * id];
+      vtkIdType best = id;
+      this->Binner.GetBin(x, ijk);
+      for (int k = -1; k <= 1; k++)
+      {
+        for (int j = -1; j <= 1; j++)
+        {
+          for (int i = -1; i <= 1; i++)
+          {
+            if ((i < 0 && ijk[0] == 0) || (j < 0 && ijk[1] == 0) || (k < 0 && ijk[2] == 0) ||
+              (i > 0 && ijk[0] == vtkPointBinner::MaxBin) ||
+              (j > 0 && ijk[1] == vtkPointBinner::MaxBin) ||
+              (k > 0 && ijk[2] == vtkPointBinner::MaxBin))
+            {
+              continue;
+            }
+            nijk[0] = ijk[0] + i;
+            nijk[1] = ijk[1] + j;
+            nijk[2] = ijk[2] + k;
+            const vtkTypeUInt64 key = vtkPointBinner::GetKey(nijk);
+            std::vector<vtkTypeUInt64>::const_iterator first =
+              std::lower_bound(this->SortedKeys.begin(), this->SortedKeys.end(), key);
+            // points of a bin are sorted by id.
+            for (size_t p = first - this->SortedKeys.begin();
+                 p < this->SortedKeys.size() && this->SortedKeys[p] == key && this->Order[p] < best;
+                 ++p)
+            {
+              const float* y = &this->Coords[3 * this->Order[p]];
+              const double dx = x[0] - y[0], dy = x[1] - y[1], dz = x[2] - y[2];
+              if (dx * dx + dy * dy + dz * dz <= this->Tolerance2)
+              {
+                best = this->Order[p];
+                break;
+              }
+            }
+          }
+        }
+      }
+      this->Merged[id] = best;
+    }
+  }
+
+private:
+  const vtkPointBinner& Binner;
+  const std::vector<float>& Coords;
+  const std::vector<vtkIdType>& Order;
+  const std::vector<vtkTypeUInt64>& SortedKeys;
+  double Tolerance2;
+  std::vector<vtkIdType>& Merged;
+};
+
+//----------------------------------------------------------------------------
+// Copies the coordinates of the points that are kept.
+class vtkCopyUniquePoints
+{
+public:
+  vtkCopyUniquePoints(
+    const std::vector<float>& coords, const std::vector<vtkIdType>& uniqueIds, float* output)
+    : Coords(coords)
+    , UniqueIds(uniqueIds)
+    , Output(output)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType newId = begin; newId < end; ++newId)
+    {
+      std::copy(&this->Coords[3 * this->UniqueIds[newId]],
+        &this->Coords[3 * this->UniqueIds[newId]] + 3, this->Output + 3 * newId);
+    }
+  }
+
+private:
+  const std::vector<float>& Coords;
+  const std::vector<vtkIdType>& UniqueIds;
+  float* Output;
+};
+
+//----------------------------------------------------------------------------
+// Remaps the point ids of the cells (and polyhedron faces) of an unstructured
+// grid, in place in copies of its connectivity arrays.
+class vtkRemapCells
+{
+public:
+  vtkRemapCells(const vtkIdType* ptMap, const vtkIdType* locations, vtkIdType* connectivity,
+    const vtkIdType* faceLocations, vtkIdType* faces)
+    : PtMap(ptMap)
+    , Locations(locations)
+    , Connectivity(connectivity)
+    , FaceLocations(faceLocations)
+    , Faces(faces)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType* cell = this->Connectivity + this->Locations[cellId];
+      for (vtkIdType i = 1; i <= cell[0]; ++i)
+      {
+        cell[i] = this->PtMap[cell[i]];
+      }
+      if (this->Faces && this->FaceLocations[cellId] >= 0)
+      {
+        vtkIdType* face = this->Faces + this->FaceLocations[cellId];
+        vtkIdType numFaces = *face++;
+        for (vtkIdType f = 0; f < numFaces; ++f)
+        {
+          vtkIdType numPts = *face++;
+          for (vtkIdType i = 0; i < numPts; ++i, ++face)
+          {
+            *face = this->PtMap[*face];
+          }
+        }
+      }
+    }
+  }
+
+private:
+  const vtkIdType* PtMap;
+  const vtkIdType* Locations;
+  vtkIdType* Connectivity;
+  const vtkIdType* FaceLocations;
+  vtkIdType* Faces;
+};
+}
+
 vtkStandardNewMacro(vtkCleanUnstructuredGrid);
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::vtkCleanUnstructuredGrid()
 {
-  this->Locator = vtkMergePoints::New();
+  this->Tolerance = 0.0;
 }
 
 //----------------------------------------------------------------------------
 vtkCleanUnstructuredGrid::~vtkCleanUnstructuredGrid()
 {
-  this->Locator->Delete();
-  this->Locator = NULL;
 }
 
 //----------------------------------------------------------------------------
 void vtkCleanUnstructuredGrid::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "Tolerance: " << this->Tolerance << endl;
 }
 
 //----------------------------------------------------------------------------
@@ -71,73 +374,151 @@ int vtkCleanUnstructuredGrid::RequestData(vtkInformation* vtkNotUsed(request),
     return 1;
   }
 
-  output->GetPointData()->CopyAllocate(input->GetPointData());
   output->GetCellData()->PassData(input->GetCellData());
 
   // First, create a new points array that eliminate duplicate points.
   // Also create a mapping from the old point id to the new.
-  vtkPoints* newPts = vtkPoints::New();
   vtkIdType num = input->GetNumberOfPoints();
-  vtkIdType id;
-  vtkIdType newId;
-  vtkIdType* ptMap = new vtkIdType[num];
-  double pt[3];
+  const bool useTolerance = this->Tolerance > 0.0;
+  vtkPointBinner binner(input->GetBounds(), this->Tolerance);
+  std::vector<float> coords(3 * num);
+  std::vector<vtkTypeUInt64> keys(num);
+  // Make sure the input is ready for multithreaded access.
+  if (num > 0)
+  {
+    double pt[3];
+    input->GetPoint(0, pt);
+  }
+  vtkComputePointKeys computeKeys(input, binner, coords, keys);
+  vtkSMPTools::For(0, num, computeKeys);
+  this->UpdateProgress(0.2);
 
-  this->Locator->InitPointInsertion(newPts, input->GetBounds(), num);
+  // Sort the points so that coincident points are contiguous (or points
+  // of a same bin, when using a tolerance).
+  std::vector<vtkIdType> order(num);
+  for (vtkIdType id = 0; id < num; ++id)
+  {
+    order[id] = id;
+  }
+  vtkPointOrder pointOrder(coords, keys, !useTolerance);
+  vtkSMPTools::Sort(order.begin(), order.end(), pointOrder);
+  this->UpdateProgress(0.4);
 
-  vtkIdType progressStep = num / 100;
-  if (progressStep == 0)
+  // merged[id] is the id of a lower (or same) id point that id is merged with.
+  std::vector<vtkIdType> merged(num);
+  if (useTolerance)
   {
-    progressStep = 1;
+    std::vector<vtkTypeUInt64> sortedKeys(num);
+    for (vtkIdType p = 0; p < num; ++p)
+    {
+      sortedKeys[p] = keys[order[p]];
+    }
+    vtkFindPointsWithinTolerance findPoints(
+      binner, coords, order, sortedKeys, this->Tolerance, merged);
+    vtkSMPTools::For(0, num, findPoints);
   }
-  for (id = 0; id < num; ++id)
+  else
+  {
+    // The first point of each run of coincident points has the lowest id.
+    for (vtkIdType p = 0; p < num; ++p)
+    {
+      vtkIdType id = order[p];
+      bool same = p > 0 && keys[order[p - 1]] == keys[id] &&
+        pointOrder.SameCoordinates(order[p - 1], id);
+      merged[id] = same ? merged[order[p - 1]] : id;
+    }
+  }
+  std::vector<vtkIdType>().swap(order);
+  std::vector<vtkTypeUInt64>().swap(keys);
+  this->UpdateProgress(0.6);
+
+  // Number the points that are kept in the order of their ids, as inserting
+  // them one by one into a locator would.
+  vtkIdType* ptMap = new vtkIdType[num];
+  std::vector<vtkIdType> uniqueIds;
+  for (vtkIdType id = 0; id < num; ++id)
   {
-    if (id % progressStep == 0)
+    if (merged[id] == id)
     {
-      this->UpdateProgress(0.8 * ((float)id / num));
+      ptMap[id] = static_cast<vtkIdType>(uniqueIds.size());
+      uniqueIds.push_back(id);
     }
-    input->GetPoint(id, pt);
-    if (this->Locator->InsertUniquePoint(pt, newId))
+    else
     {
-      output->GetPointData()->CopyData(input->GetPointData(), id, newId);
+      ptMap[id] = ptMap[merged[id]];
     }
-    ptMap[id] = newId;
   }
+  vtkIdType numNewPts = static_cast<vtkIdType>(uniqueIds.size());
+
+  vtkPoints* newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numNewPts);
+  vtkCopyUniquePoints copyPoints(
+    coords, uniqueIds, static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0));
+  vtkSMPTools::For(0, numNewPts, copyPoints);
   output->SetPoints(newPts);
   newPts->Delete();
 
+  output->GetPointData()->CopyAllocate(input->GetPointData(), numNewPts);
+  for (vtkIdType newId = 0; newId < numNewPts; ++newId)
+  {
+    output->GetPointData()->CopyData(input->GetPointData(), uniqueIds[newId], newId);
+  }
+  this->UpdateProgress(0.8);
+
   // Now copy the cells.
-  vtkIdList* cellPoints = vtkIdList::New();
-  num = input->GetNumberOfCells();
-  output->Allocate(num);
-  for (id = 0; id < num; ++id)
+  vtkUnstructuredGrid* ugInput = vtkUnstructuredGrid::SafeDownCast(input);
+  if (ugInput && ugInput->GetCells() && ugInput->GetCellLocationsArray())
   {
-    if (id % progressStep == 0)
+    // Remap the connectivity arrays in parallel.
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->DeepCopy(ugInput->GetCells()->GetData());
+    vtkNew<vtkCellArray> cells;
+    cells->SetCells(ugInput->GetNumberOfCells(), connectivity.GetPointer());
+
+    vtkSmartPointer<vtkIdTypeArray> faces;
+    if (ugInput->GetFaces())
     {
-      this->UpdateProgress(0.8 + 0.2 * ((float)id / num));
+      faces = vtkSmartPointer<vtkIdTypeArray>::New();
+      faces->DeepCopy(ugInput->GetFaces());
     }
-    // special handling for polyhedron cells
-    if (vtkUnstructuredGrid::SafeDownCast(input) && input->GetCellType(id) == VTK_POLYHEDRON)
+
+    vtkRemapCells remapCells(ptMap, ugInput->GetCellLocationsArray()->GetPointer(0),
+      connectivity->GetPointer(0),
+      faces ? ugInput->GetFaceLocations()->GetPointer(0) : NULL,
+      faces ? faces->GetPointer(0) : NULL);
+    vtkSMPTools::For(0, ugInput->GetNumberOfCells(), remapCells);
+
+    output->SetCells(ugInput->GetCellTypesArray(), ugInput->GetCellLocationsArray(),
+      cells.GetPointer(), faces ? ugInput->GetFaceLocations() : NULL, faces);
+  }
+  else
+  {
+    vtkIdType progressStep = num / 100;
+    if (progressStep == 0)
     {
-      vtkUnstructuredGrid::SafeDownCast(input)->GetFaceStream(id, cellPoints);
-      vtkUnstructuredGrid::ConvertFaceStreamPointIds(cellPoints, ptMap);
+      progressStep = 1;
     }
-    else
+    vtkIdList* cellPoints = vtkIdList::New();
+    num = input->GetNumberOfCells();
+    output->Allocate(num);
+    for (vtkIdType id = 0; id < num; ++id)
     {
+      if (id % progressStep == 0)
+      {
+        this->UpdateProgress(0.8 + 0.2 * ((float)id / num));
+      }
       input->GetCellPoints(id, cellPoints);
       for (int i = 0; i < cellPoints->GetNumberOfIds(); i++)
       {
-        int cellPtId = cellPoints->GetId(i);
-        newId = ptMap[cellPtId];
-        cellPoints->SetId(i, newId);
+        cellPoints->SetId(i, ptMap[cellPoints->GetId(i)]);
       }
+      output->InsertNextCell(input->GetCellType(id), cellPoints);
     }
-    output->InsertNextCell(input->GetCellType(id), cellPoints);
+    cellPoints->Delete();
+    output->Squeeze();
   }
 
   delete[] ptMap;
-  cellPoints->Delete();
-  output->Squeeze();
 
   return 1;
 }
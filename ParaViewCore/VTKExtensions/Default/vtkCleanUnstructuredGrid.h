@@ -20,8 +20,14 @@
  *
  * vtkCleanUnstructuredGrid is a filter that takes unstructured grid data as
  * input and generates unstructured grid data as output. vtkCleanUnstructuredGrid can
- * merge duplicate points (with coincident coordinates) using the vtkMergePoints object
- * to merge points.
+ * merge duplicate points (with coincident coordinates).
+ *
+ * Points are merged in parallel using vtkSMPTools: points are binned and sorted
+ * along a Morton curve so that coincident points end up next to each other,
+ * and the connectivity is then remapped in parallel. When Tolerance is 0, the
+ * output is the same as when inserting the points one by one in a
+ * vtkMergePoints: points are compared in single precision and a point is
+ * replaced by the first point with the same coordinates.
  *
  * @sa
  * vtkCleanPolyData
@@ -33,8 +39,6 @@
 #include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
 #include "vtkUnstructuredGridAlgorithm.h"
 
-class vtkPointLocator;
-
 class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkCleanUnstructuredGrid
   : public vtkUnstructuredGridAlgorithm
 {
@@ -45,11 +49,22 @@ public:
 
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Points closer than this distance are merged. A point is merged with the
+   * point of lowest id within the tolerance, which may itself have been merged
+   * with a point of lower id. Default is 0, i.e. only points with the same
+   * coordinates are merged.
+   */
+  vtkSetClampMacro(Tolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Tolerance, double);
+  //@}
+
 protected:
   vtkCleanUnstructuredGrid();
   ~vtkCleanUnstructuredGrid() override;
 
-  vtkPointLocator* Locator;
+  double Tolerance;
 
   int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) VTK_OVERRIDE;
   int FillInputPortInformation(int port, vtkInformation* info) VTK_OVERRIDE;
@@ -14,23 +14,74 @@
 =========================================================================*/
 #include "vtkHybridProbeFilter.h"
 
+#include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataSet.h"
 #include "vtkCompositeDataToUnstructuredGridFilter.h"
+#include "vtkDataSet.h"
 #include "vtkExtractSelection.h"
+#include "vtkGenericCell.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPProbeFilter.h"
+#include "vtkPVCachedCellLocator.h"
 #include "vtkPointSource.h"
+#include "vtkSelection.h"
 #include "vtkSelectionNode.h"
 #include "vtkSelectionSource.h"
+#include "vtkSmartPointer.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Returns the id of the cell containing the location, using the cached
+// locator for the dataset, or -1 if none. The tolerance is the one
+// vtkProbeFilter computes by default, so that this finds the cell
+// InterpolateAtLocation() interpolates in.
+vtkIdType vtkFindCellContaining(vtkDataSet* ds, double location[3])
+{
+  if (!ds || ds->GetNumberOfCells() == 0)
+  {
+    return -1;
+  }
+  vtkNew<vtkPVCachedCellLocator> locator;
+  locator->SetDataSet(ds);
+  locator->BuildLocator();
+
+  double tol2 = ds->GetLength();
+  tol2 = tol2 ? tol2 * tol2 / 1000.0 : 0.001;
+
+  vtkNew<vtkGenericCell> cell;
+  std::vector<double> weights(std::max(ds->GetMaxCellSize(), 1));
+  double pcoords[3];
+  return locator->FindCell(location, tol2, cell.GetPointer(), pcoords, &weights[0]);
+}
+
+// Returns a selection node selecting a single cell by id.
+vtkSmartPointer<vtkSelectionNode> vtkNewCellSelectionNode(vtkIdType cellId)
+{
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetNumberOfTuples(1);
+  ids->SetValue(0, cellId);
+
+  vtkSmartPointer<vtkSelectionNode> node = vtkSmartPointer<vtkSelectionNode>::New();
+  node->SetContentType(vtkSelectionNode::INDICES);
+  node->SetFieldType(vtkSelectionNode::CELL);
+  node->SetSelectionList(ids.GetPointer());
+  return node;
+}
+}
+
 vtkStandardNewMacro(vtkHybridProbeFilter);
 //----------------------------------------------------------------------------
 vtkHybridProbeFilter::vtkHybridProbeFilter()
   : Mode(vtkHybridProbeFilter::INTERPOLATE_AT_LOCATION)
+  , UseCachedCellLocator(false)
 {
   this->Location[0] = this->Location[1] = this->Location[2] = 0.0;
 }
@@ -84,6 +135,13 @@ bool vtkHybridProbeFilter::InterpolateAtLocation(vtkDataObject* input, vtkUnstru
   pointSource->SetOutputPointsPrecision(vtkAlgorithm::DOUBLE_PRECISION);
 
   vtkNew<vtkPProbeFilter> probe;
+  if (this->UseCachedCellLocator)
+  {
+    // Using the cached locator means that only moving the location does not
+    // rebuild a locator for the input.
+    vtkNew<vtkPVCachedCellLocator> locator;
+    probe->SetCellLocatorPrototype(locator.GetPointer());
+  }
   probe->SetInputConnection(0, pointSource->GetOutputPort());
   probe->SetInputDataObject(1, input);
   probe->Update();
@@ -96,14 +154,54 @@ bool vtkHybridProbeFilter::InterpolateAtLocation(vtkDataObject* input, vtkUnstru
 bool vtkHybridProbeFilter::ExtractCellContainingLocation(
   vtkDataObject* input, vtkUnstructuredGrid* output)
 {
-  vtkNew<vtkSelectionSource> selSource;
-  selSource->AddLocation(this->Location[0], this->Location[1], this->Location[2]);
-  selSource->SetContentType(vtkSelectionNode::LOCATIONS);
-  selSource->SetFieldType(vtkSelectionNode::CELL);
+  vtkNew<vtkSelection> selection;
+  if (!this->UseCachedCellLocator)
+  {
+    vtkNew<vtkSelectionSource> selSource;
+    selSource->AddLocation(this->Location[0], this->Location[1], this->Location[2]);
+    selSource->SetContentType(vtkSelectionNode::LOCATIONS);
+    selSource->SetFieldType(vtkSelectionNode::CELL);
+    selSource->Update();
+    selection->ShallowCopy(selSource->GetOutput());
+  }
+  else if (vtkCompositeDataSet* cd = vtkCompositeDataSet::SafeDownCast(input))
+  {
+    // Locate the cell using the cached locators and extract it by id, instead
+    // of having vtkExtractSelection search the dataset for the location.
+    vtkSmartPointer<vtkCompositeDataIterator> iter;
+    iter.TakeReference(cd->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+      vtkDataSet* block = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+      vtkIdType cellId = vtkFindCellContaining(block, this->Location);
+      if (cellId >= 0)
+      {
+        vtkSmartPointer<vtkSelectionNode> node = vtkNewCellSelectionNode(cellId);
+        node->GetProperties()->Set(
+          vtkSelectionNode::COMPOSITE_INDEX(), static_cast<int>(iter->GetCurrentFlatIndex()));
+        selection->AddNode(node);
+      }
+    }
+  }
+  else
+  {
+    vtkIdType cellId = vtkFindCellContaining(vtkDataSet::SafeDownCast(input), this->Location);
+    if (cellId >= 0)
+    {
+      selection->AddNode(vtkNewCellSelectionNode(cellId));
+    }
+  }
+
+  if (selection->GetNumberOfNodes() == 0)
+  {
+    // location is not in any cell on this process.
+    output->Initialize();
+    return true;
+  }
 
   vtkNew<vtkExtractSelection> extractor;
   extractor->SetInputDataObject(0, input);
-  extractor->SetInputConnection(1, selSource->GetOutputPort());
+  extractor->SetInputData(1, selection.GetPointer());
   extractor->PreserveTopologyOff();
   extractor->Update();
 
@@ -128,4 +226,5 @@ void vtkHybridProbeFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Mode: " << this->Mode << endl;
   os << indent << "Location: " << this->Location[0] << ", " << this->Location[1] << ", "
      << this->Location[2] << endl;
+  os << indent << "UseCachedCellLocator: " << this->UseCachedCellLocator << endl;
 }
@@ -25,7 +25,9 @@
  * exactly what he/she is looking for -- interpolate at point location (probe)
  * or extract cell containing the point (extract selection).
  *
- * Internally this filter uses vtkPProbeFilter and vtkExtractSelection.
+ * Internally this filter uses vtkPProbeFilter and vtkExtractSelection. When
+ * UseCachedCellLocator is on, cells are located using vtkPVCachedCellLocator,
+ * so moving the location does not require rebuilding a locator for the input.
 */
 
 #ifndef vtkHybridProbeFilter_h
@@ -62,6 +64,17 @@ public:
   vtkGetVector3Macro(Location, double);
   //@}
 
+  //@{
+  /**
+   * When on, cells are located with vtkPVCachedCellLocator instead of
+   * vtkDataSet::FindCell(), which is faster when only the location changes
+   * between executions. Default is off.
+   */
+  vtkSetMacro(UseCachedCellLocator, bool);
+  vtkGetMacro(UseCachedCellLocator, bool);
+  vtkBooleanMacro(UseCachedCellLocator, bool);
+  //@}
+
 protected:
   vtkHybridProbeFilter();
   ~vtkHybridProbeFilter() override;
@@ -75,6 +88,7 @@ protected:
 
   double Location[3];
   int Mode;
+  bool UseCachedCellLocator;
 
 private:
   vtkHybridProbeFilter(const vtkHybridProbeFilter&) = delete;
@@ -68,6 +68,8 @@
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkMarchingCubesTriangleCases.h"
 #include "vtkOBBTree.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangleFilter.h"
 // STL
 #include <fstream>
@@ -1548,15 +1550,9 @@ vtkMaterialInterfaceFilter::vtkMaterialInterfaceFilter()
 {
   this->Controller = vtkMultiProcessController::GetGlobalController();
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
   // Lets profile to see what takes the most time for large number of processes.
-  this->InitializeBlocksTimer = vtkSmartPointer<vtkTimerLog>::New();
-  this->ShareGhostBlocksTimer = vtkSmartPointer<vtkTimerLog>::New();
-  this->NumberOfBlocks = 0;
-  this->NumberOfGhostBlocks = 0;
-  this->ProcessBlocksTimer = vtkSmartPointer<vtkTimerLog>::New();
-  this->ResolveEquivalencesTimer = vtkSmartPointer<vtkTimerLog>::New();
-#endif
+  this->EnableTimingReport = false;
+  this->ResetTimingStages();
 
 #ifdef vtkMaterialInterfaceFilterDEBUG
   int myProcId = this->Controller->GetLocalProcessId();
@@ -1851,10 +1847,7 @@ int vtkMaterialInterfaceFilter::InitializeBlocks(vtkNonOverlappingAMR* input,
   int numProcs = this->Controller->GetNumberOfProcesses();
   vtkMaterialInterfaceFilterHalfSphere* sphere = 0;
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->InitializeBlocksTimer->StartTimer();
-#endif
+  this->StartTimingStage(INITIALIZE_BLOCKS);
 
   // leaving this logic alone rather than moving it into the
   // this->ClipFunction conditional because I don't know enought of the class to
@@ -2025,22 +2018,12 @@ int vtkMaterialInterfaceFilter::InitializeBlocks(vtkNonOverlappingAMR* input,
     this->AddBlock(block, this->GetBlockGhostLevel());
   }
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->InitializeBlocksTimer->StopTimer();
-#endif
-
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->ShareGhostBlocksTimer->StartTimer();
-#endif
+  this->EndTimingStage(INITIALIZE_BLOCKS);
+  this->StartTimingStage(SHARE_GHOST_BLOCKS);
 
 // cerr << "start ghost blocks\n" << endl;
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->NumberOfBlocks = this->NumberOfInputBlocks;
-#endif
+  this->NumberOfBlocks += this->NumberOfInputBlocks;
 
   // Broadcast all of the block meta data to all processes.
   // Setup ghost layer blocks.
@@ -2050,10 +2033,7 @@ int vtkMaterialInterfaceFilter::InitializeBlocks(vtkNonOverlappingAMR* input,
     this->ShareGhostBlocks();
   }
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->ShareGhostBlocksTimer->StopTimer();
-#endif
+  this->EndTimingStage(SHARE_GHOST_BLOCKS);
 
   return VTK_OK;
 }
@@ -2881,10 +2861,7 @@ void vtkMaterialInterfaceFilter::ShareGhostBlocks()
 // Process, extent
 // ...
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->NumberOfGhostBlocks = this->GhostBlocks.size();
-#endif
+  this->NumberOfGhostBlocks += static_cast<long>(this->GhostBlocks.size());
 
   /*
 
@@ -3396,11 +3373,7 @@ void vtkMaterialInterfaceFilter::PrepareForPass(vtkNonOverlappingAMR* hbdsInput,
 int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
   vtkInformationVector** inputVector, vtkInformationVector* outputVector)
 {
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  this->NumberOfBlocks = 0;
-  this->NumberOfGhostBlocks = 0;
-#endif
+  this->ResetTimingStages();
 
   if (this->ClipFunction)
   {
@@ -3588,40 +3561,28 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
     //
     this->ProgressBlockInc = this->ProgressMaterialInc / (double)this->NumberOfInputBlocks / 2.0;
 //
-#ifdef vtkMaterialInterfaceFilterPROFILE
-    // Lets profile to see what takes the most time for large number of processes.
-    this->ProcessBlocksTimer->StartTimer();
-#endif
+    this->StartTimingStage(PROCESS_BLOCKS);
     int blockId;
     for (blockId = 0; blockId < this->NumberOfInputBlocks; ++blockId)
     {
       // build fragments
       this->ProcessBlock(blockId);
     }
-#ifdef vtkMaterialInterfaceFilterPROFILE
-    // Lets profile to see what takes the most time for large number of processes.
-    this->ProcessBlocksTimer->StopTimer();
-#endif
+    this->EndTimingStage(PROCESS_BLOCKS);
 // char tmp[128];
 // sprintf(tmp, "C:/Law/tmp/mifSurface%d.vtp", this->Controller->GetLocalProcessId());
 // this->SaveBlockSurfaces(tmp);
 // sprintf(tmp, "C:/Law/tmp/mifGhost%d.vtp", this->Controller->GetLocalProcessId());
 // this->SaveGhostSurfaces(tmp);
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-    // Lets profile to see what takes the most time for large number of processes.
-    this->ResolveEquivalencesTimer->StartTimer();
-#endif
+    this->StartTimingStage(RESOLVE_EQUIVALENCES);
 
     // resolve: Merge local and remote geometry
     // correct integrated attributes, finialize integrations
     this->PrepareForResolveEquivalences();
     this->ResolveEquivalences();
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-    // Lets profile to see what takes the most time for large number of processes.
-    this->ResolveEquivalencesTimer->StopTimer();
-#endif
+    this->EndTimingStage(RESOLVE_EQUIVALENCES);
 
     // update the resolved fragment count, so that next pass will start
     // where we left off here
@@ -3677,65 +3638,10 @@ int vtkMaterialInterfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
        << " MTime: " << this->GetMTime() << "." << endl;
 #endif
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
-  // Lets profile to see what takes the most time for large number of processes.
-  double initializeTime, shareGhostBlocksTime, processBlocksTime, resolveEquivalencesTime;
-  unsigned long numberOfBlocks, numberOfGhostBlocks;
-  initializeTime = this->InitializeBlocksTimer->GetElapsedTime();
-  shareGhostBlocksTime = this->ShareGhostBlocksTimer->GetElapsedTime();
-  processBlocksTime = this->ProcessBlocksTimer->GetElapsedTime();
-  resolveEquivalencesTime = this->ResolveEquivalencesTimer->GetElapsedTime();
-  numberOfBlocks = this->NumberOfBlocks;
-  numberOfGhostBlocks = this->NumberOfGhostBlocks;
-  if (this->Controller == 0)
-  {
-    cout << "InitializeTime: " << initializeTime << endl;
-    cout << "ShareGhostBlocksTime: " << shareGhostBlocksTime << endl;
-    cout << "NumberOfBlocks: " << numberOfBlocks << endl;
-    cout << "NumberOfGhostBlocks: " << numberOfGhostBlocks << endl;
-    cout << "ProcessBlocksTime: " << processBlocksTime << endl;
-    cout << "ResolveEquivalencesTimer: " << resolveEquivalencesTime << endl;
-  }
-  else
+  if (this->EnableTimingReport)
   {
-    int numProcs = this->Controller->GetNumberOfProcesses();
-    if (this->Controller->GetLocalProcessId() == 0)
-    {
-      cout << "Process 0: \n";
-      cout << "  InitializeTime: " << initializeTime << endl;
-      cout << "  ShareGhostBlocksTime: " << shareGhostBlocksTime << endl;
-      cout << "  NumberOfBlocks: " << numberOfBlocks << endl;
-      cout << "  NumberOfGhostBlocks: " << numberOfGhostBlocks << endl;
-      cout << "  ProcessBlocksTime: " << processBlocksTime << endl;
-      cout << "  ResolveEquivalencesTimer: " << resolveEquivalencesTime << endl;
-      for (int procIdx = 1; procIdx < numProcs; ++procIdx)
-      {
-        this->Controller->Receive(&initializeTime, 1, procIdx, 234908);
-        this->Controller->Receive(&shareGhostBlocksTime, 1, procIdx, 234909);
-        this->Controller->Receive(&processBlocksTime, 1, procIdx, 234910);
-        this->Controller->Receive(&resolveEquivalencesTime, 1, procIdx, 234911);
-        this->Controller->Receive(&numberOfBlocks, 1, procIdx, 234912);
-        this->Controller->Receive(&numberOfGhostBlocks, 1, procIdx, 234913);
-        cout << "Process " << procIdx << ": \n";
-        cout << "  InitializeTime: " << initializeTime << endl;
-        cout << "  ShareGhostBlocksTime: " << shareGhostBlocksTime << endl;
-        cout << "  NumberOfBlocks: " << numberOfBlocks << endl;
-        cout << "  NumberOfGhostBlocks: " << numberOfGhostBlocks << endl;
-        cout << "  ProcessBlocksTime: " << processBlocksTime << endl;
-        cout << "  ResolveEquivalencesTimer: " << resolveEquivalencesTime << endl;
-      }
-    }
-    else
-    {
-      this->Controller->Send(&initializeTime, 1, 0, 234908);
-      this->Controller->Send(&shareGhostBlocksTime, 1, 0, 234909);
-      this->Controller->Send(&processBlocksTime, 1, 0, 234910);
-      this->Controller->Send(&resolveEquivalencesTime, 1, 0, 234911);
-      this->Controller->Send(&numberOfBlocks, 1, 0, 234912);
-      this->Controller->Send(&numberOfGhostBlocks, 1, 0, 234913);
-    }
+    this->GatherTimingReport();
   }
-#endif
 
   return 1;
 }
@@ -5745,6 +5651,104 @@ void vtkMaterialInterfaceFilter::PrintSelf(ostream& os, vtkIndent indent)
 {
   // TODO print state
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "EnableTimingReport: " << this->EnableTimingReport << endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilter::ResetTimingStages()
+{
+  for (int i = 0; i < NUMBER_OF_TIMING_STAGES; ++i)
+  {
+    this->StageStartTimes[i] = 0.0;
+    this->StageTimes[i] = 0.0;
+  }
+  this->NumberOfBlocks = 0;
+  this->NumberOfGhostBlocks = 0;
+  this->TimingReport.clear();
+}
+
+namespace
+{
+const char* vtkMaterialInterfaceFilterStageNames[] = { "InitializeBlocks", "ShareGhostBlocks",
+  "ProcessBlocks", "ResolveEquivalences", "ComputeGeometricAttributes" };
+}
+
+//----------------------------------------------------------------------------
+// Stages are timed on every execution, which is cheap, and they accumulate
+// over the material passes. Only logging and reporting are optional.
+void vtkMaterialInterfaceFilter::StartTimingStage(int stage)
+{
+  this->StageStartTimes[stage] = vtkTimerLog::GetUniversalTime();
+  if (this->EnableTimingReport)
+  {
+    std::string event = "vtkMaterialInterfaceFilter::";
+    event += vtkMaterialInterfaceFilterStageNames[stage];
+    vtkTimerLog::MarkStartEvent(event.c_str());
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilter::EndTimingStage(int stage)
+{
+  this->StageTimes[stage] += vtkTimerLog::GetUniversalTime() - this->StageStartTimes[stage];
+  if (this->EnableTimingReport)
+  {
+    std::string event = "vtkMaterialInterfaceFilter::";
+    event += vtkMaterialInterfaceFilterStageNames[stage];
+    vtkTimerLog::MarkEndEvent(event.c_str());
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMaterialInterfaceFilter::GatherTimingReport()
+{
+  const int nValues = NUMBER_OF_TIMING_STAGES + 2;
+  double localValues[NUMBER_OF_TIMING_STAGES + 2];
+  for (int i = 0; i < NUMBER_OF_TIMING_STAGES; ++i)
+  {
+    localValues[i] = this->StageTimes[i];
+  }
+  localValues[NUMBER_OF_TIMING_STAGES] = static_cast<double>(this->NumberOfBlocks);
+  localValues[NUMBER_OF_TIMING_STAGES + 1] = static_cast<double>(this->NumberOfGhostBlocks);
+
+  int numProcs = 1;
+  int myProcId = 0;
+  if (this->Controller)
+  {
+    numProcs = this->Controller->GetNumberOfProcesses();
+    myProcId = this->Controller->GetLocalProcessId();
+  }
+
+  vector<double> allValues(nValues * numProcs);
+  if (numProcs > 1)
+  {
+    this->Controller->Gather(localValues, &allValues[0], nValues, 0);
+  }
+  else
+  {
+    std::copy(localValues, localValues + nValues, allValues.begin());
+  }
+
+  this->TimingReport.clear();
+  if (myProcId != 0)
+  {
+    return;
+  }
+
+  ostringstream report;
+  for (int procIdx = 0; procIdx < numProcs; ++procIdx)
+  {
+    const double* values = &allValues[nValues * procIdx];
+    report << "Process " << procIdx << ":\n";
+    for (int i = 0; i < NUMBER_OF_TIMING_STAGES; ++i)
+    {
+      report << "  " << vtkMaterialInterfaceFilterStageNames[i] << "Time: " << values[i] << "\n";
+    }
+    report << "  NumberOfBlocks: " << static_cast<long>(values[NUMBER_OF_TIMING_STAGES]) << "\n";
+    report << "  NumberOfGhostBlocks: " << static_cast<long>(values[NUMBER_OF_TIMING_STAGES + 1])
+           << "\n";
+  }
+  this->TimingReport = report.str();
 }
 
 //----------------------------------------------------------------------------
@@ -8236,7 +8240,13 @@ void vtkMaterialInterfaceFilter::ResolveEquivalences()
 
   // Compute geometric attributes, and gather them for
   // stats output.
+  // ResolveEquivalences is itself timed, pause it so that the stages
+  // are disjoint.
+  this->EndTimingStage(RESOLVE_EQUIVALENCES);
+  this->StartTimingStage(COMPUTE_GEOMETRIC_ATTRIBUTES);
   this->ComputeGeometricAttributes();
+  this->EndTimingStage(COMPUTE_GEOMETRIC_ATTRIBUTES);
+  this->StartTimingStage(RESOLVE_EQUIVALENCES);
   this->GatherGeometricAttributes(0);
 #ifdef vtkMaterialInterfaceFilterDEBUG
   cerr << "[" << __LINE__ << "] " << myProcId
@@ -9256,6 +9266,116 @@ void vtkMaterialInterfaceFilter::CopyAttributesToOutput2()
   repStrips->Delete();
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// Functor computing the OBBs of a range of local fragments.
+// (c_x,c_y,c_z),(max_x,max_y,max_z),(mid_x,mid_y,mid_z),(min_x,min_y,min_z),|max|,|mid|,|min|
+class vtkMaterialInterfaceFilterComputeOBBs
+{
+public:
+  vtkMaterialInterfaceFilterComputeOBBs(vtkMultiPieceDataSet* fragments, const int* globalIds,
+    const int* splitMarkers, double* obbs)
+    : Fragments(fragments)
+    , GlobalIds(globalIds)
+    , SplitMarkers(splitMarkers)
+    , OBBs(obbs)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkOBBTree* obbCalc = this->OBBCalc.Local();
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      // skip split fragments, these have already been
+      // taken care of.
+      if (this->SplitMarkers[i] == 1)
+      {
+        continue;
+      }
+
+      // get fragment mesh
+      vtkPolyData* thisFragment =
+        dynamic_cast<vtkPolyData*>(this->Fragments->GetPiece(this->GlobalIds[i]));
+
+      // compute OBB
+      double* pObb = this->OBBs + 15 * i;
+      double size[3];
+      obbCalc->ComputeOBB(thisFragment, pObb, pObb + 3, pObb + 6, pObb + 9, size);
+
+      // compute magnitudes
+      for (int q = 0; q < 3; ++q)
+      {
+        pObb[12 + q] = 0;
+      }
+      for (int q = 0; q < 3; ++q)
+      {
+        pObb[12] += pObb[3 + q] * pObb[3 + q];
+        pObb[13] += pObb[6 + q] * pObb[6 + q];
+        pObb[14] += pObb[9 + q] * pObb[9 + q];
+      }
+      for (int q = 0; q < 3; ++q)
+      {
+        pObb[12 + q] = sqrt(pObb[12 + q]);
+      }
+    }
+  }
+
+private:
+  vtkMultiPieceDataSet* Fragments;
+  const int* GlobalIds;
+  const int* SplitMarkers;
+  double* OBBs;
+  vtkSMPThreadLocalObject<vtkOBBTree> OBBCalc;
+};
+
+// Functor computing the AABB centers of a range of local fragments.
+class vtkMaterialInterfaceFilterComputeAABBCenters
+{
+public:
+  vtkMaterialInterfaceFilterComputeAABBCenters(vtkMultiPieceDataSet* fragments,
+    const int* globalIds, const int* splitMarkers, double* centers)
+    : Fragments(fragments)
+    , GlobalIds(globalIds)
+    , SplitMarkers(splitMarkers)
+    , Centers(centers)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double aabb[6];
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      // skip fragments with geometry split over multiple
+      // processes. These have been already taken care of.
+      if (this->SplitMarkers[i] == 1)
+      {
+        continue;
+      }
+
+      vtkPolyData* thisFragment =
+        dynamic_cast<vtkPolyData*>(this->Fragments->GetPiece(this->GlobalIds[i]));
+
+      // AABB calculation
+      thisFragment->GetBounds(aabb);
+      double* pCoaabb = this->Centers + 3 * i;
+      for (int q = 0, k = 0; q < 3; ++q, k += 2)
+      {
+        pCoaabb[q] = (aabb[k] + aabb[k + 1]) / 2.0;
+      }
+    }
+  }
+
+private:
+  vtkMultiPieceDataSet* Fragments;
+  const int* GlobalIds;
+  const int* SplitMarkers;
+  double* Centers;
+};
+}
+
 //----------------------------------------------------------------------------
 // For each fragment compute its oriented bounding box(OBB).
 //
@@ -9271,55 +9391,16 @@ int vtkMaterialInterfaceFilter::ComputeLocalFragmentOBB()
 
   int nLocal = static_cast<int>(resolvedFragmentIds.size());
 
-  // OBB set up
-  vtkOBBTree* obbCalc;
-  double* pObb;
-  obbCalc = vtkOBBTree::New();
   assert("FragmentOBBs has incorrect size." && this->FragmentOBBs->GetNumberOfTuples() == nLocal);
-  pObb = this->FragmentOBBs->GetPointer(0);
-
-  // Traverse the fragments we own
-  for (int i = 0; i < nLocal; ++i)
+  if (nLocal == 0)
   {
-    // skip split fragments, these have already been
-    // taken care of.
-    if (fragmentSplitMarker[i] == 1)
-    {
-      pObb += 15;
-      continue;
-    }
-
-    // get fragment mesh
-    int globalId = resolvedFragmentIds[i];
-    vtkPolyData* thisFragment = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
-
-    // compute OBB
-    double size[3];
-    // (c_x,c_y,c_z),(max_x,max_y,max_z),(mid_x,mid_y,mid_z),(min_x,min_y,min_z),|max|,|mid|,|min|
-    obbCalc->ComputeOBB(thisFragment, pObb, pObb + 3, pObb + 6, pObb + 9, size);
-    // obbCalc->ComputeOBB(thisFragment->GetPoints(),pObb,pObb+3,pObb+6,pObb+9,size);
-
-    // compute magnitudes
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12 + q] = 0;
-    }
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12] += pObb[3 + q] * pObb[3 + q];
-      pObb[13] += pObb[6 + q] * pObb[6 + q];
-      pObb[14] += pObb[9 + q] * pObb[9 + q];
-    }
-    for (int q = 0; q < 3; ++q)
-    {
-      pObb[12 + q] = sqrt(pObb[12 + q]);
-    }
-
-    pObb += 15;
-  } // fragment traversal
+    return 1;
+  }
 
-  // OBB clean up
-  obbCalc->Delete();
+  // Fragments are independent, each thread uses its own OBB calculator.
+  vtkMaterialInterfaceFilterComputeOBBs worker(resolvedFragments, &resolvedFragmentIds[0],
+    &fragmentSplitMarker[0], this->FragmentOBBs->GetPointer(0));
+  vtkSMPTools::For(0, nLocal, worker);
 
   return 1;
 }
@@ -9342,32 +9423,15 @@ int vtkMaterialInterfaceFilter::ComputeLocalFragmentAABBCenters()
   // AABB set up
   assert("FragmentAABBCenters is expected to be pre-allocated." &&
     this->FragmentAABBCenters->GetNumberOfTuples() == nLocal);
-  double aabb[6];
-  double* pCoaabb = this->FragmentAABBCenters->GetPointer(0);
-
-  // Traverse the fragments we own
-  for (int i = 0; i < nLocal; ++i)
+  if (nLocal == 0)
   {
-    // skip fragments with geometry split over multiple
-    // processes. These have been already taken care of.
-    if (fragmentSplitMarker[i] == 1)
-    {
-      pCoaabb += 3;
-      continue;
-    }
-
-    int globalId = resolvedFragmentIds[i];
-
-    vtkPolyData* thisFragment = dynamic_cast<vtkPolyData*>(resolvedFragments->GetPiece(globalId));
+    return 1;
+  }
 
-    // AABB calculation
-    thisFragment->GetBounds(aabb);
-    for (int q = 0, k = 0; q < 3; ++q, k += 2)
-    {
-      pCoaabb[q] = (aabb[k] + aabb[k + 1]) / 2.0;
-    }
-    pCoaabb += 3;
-  } // fragment traversal
+  // Traverse the fragments we own
+  vtkMaterialInterfaceFilterComputeAABBCenters worker(resolvedFragments, &resolvedFragmentIds[0],
+    &fragmentSplitMarker[0], this->FragmentAABBCenters->GetPointer(0));
+  vtkSMPTools::For(0, nLocal, worker);
 
   return 1;
 }
@@ -26,10 +26,8 @@
  * #define vtkMaterialInterfaceFilterDEBUG
  * \endcode
  *
- * This will turn on profiling of how long each part of the filter takes
- * \code{.cpp}
- * #define vtkMaterialInterfaceFilterPROFILE
- * \endcode
+ * Profiling of how long each part of the filter takes is turned on at
+ * runtime with EnableTimingReport.
 */
 
 #ifndef vtkMaterialInterfaceFilter_h
@@ -327,6 +325,26 @@ public:
   vtkGetMacro(InvertVolumeFraction, int);
   //@}
 
+  //@{
+  /**
+   * When on, the time spent by each process in the main stages of the
+   * filter is gathered on process 0 after each execution and made available
+   * with GetTimingReport(), which the client reads through the TimingReport
+   * information property. The stages are disjoint and are also logged with
+   * vtkTimerLog.
+   * Off by default.
+   */
+  vtkSetMacro(EnableTimingReport, bool);
+  vtkGetMacro(EnableTimingReport, bool);
+  vtkBooleanMacro(EnableTimingReport, bool);
+  //@}
+
+  /**
+   * Report produced by the last execution when EnableTimingReport is on.
+   * It is empty on processes other than 0.
+   */
+  const char* GetTimingReport() { return this->TimingReport.c_str(); }
+
   /**
    * Return the mtime also considering the locator and clip function.
    */
@@ -713,15 +731,26 @@ protected:
   // By default set to 1
   unsigned char BlockGhostLevel;
 
-#ifdef vtkMaterialInterfaceFilterPROFILE
   // Lets profile to see what takes the most time for large number of processes.
-  vtkSmartPointer<vtkTimerLog> InitializeBlocksTimer;
-  vtkSmartPointer<vtkTimerLog> ShareGhostBlocksTimer;
+  enum TimingStages
+  {
+    INITIALIZE_BLOCKS = 0,
+    SHARE_GHOST_BLOCKS,
+    PROCESS_BLOCKS,
+    RESOLVE_EQUIVALENCES,
+    COMPUTE_GEOMETRIC_ATTRIBUTES,
+    NUMBER_OF_TIMING_STAGES
+  };
+  bool EnableTimingReport;
+  std::string TimingReport;
+  double StageStartTimes[NUMBER_OF_TIMING_STAGES];
+  double StageTimes[NUMBER_OF_TIMING_STAGES];
   long NumberOfBlocks;
   long NumberOfGhostBlocks;
-  vtkSmartPointer<vtkTimerLog> ProcessBlocksTimer;
-  vtkSmartPointer<vtkTimerLog> ResolveEquivalencesTimer;
-#endif
+  void StartTimingStage(int stage);
+  void EndTimingStage(int stage);
+  void ResetTimingStages();
+  void GatherTimingReport();
 
 private:
   vtkMaterialInterfaceFilter(const vtkMaterialInterfaceFilter&) = delete;
@@ -14,7 +14,9 @@
 =========================================================================*/
 #include "vtkPVArrayCalculator.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataObject.h"
 #include "vtkDataSet.h"
 #include "vtkFunctionParser.h"
@@ -24,13 +26,21 @@
 #include "vtkObjectFactory.h"
 #include "vtkPVPostFilter.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTable.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -67,12 +77,690 @@ public:
     this->Calc->AddScalarVariable(name.c_str(), this->ArrayName, this->Component);
   }
 };
+
+//----------------------------------------------------------------------------
+// Function parser giving access to the byte code of the parsed function.
+class vtkPVArrayCalculatorParser : public vtkFunctionParser
+{
+public:
+  static vtkPVArrayCalculatorParser* New();
+  vtkTypeMacro(vtkPVArrayCalculatorParser, vtkFunctionParser);
+
+  const unsigned int* GetByteCode() const { return this->ByteCode; }
+  int GetByteCodeSize() const { return this->ByteCodeSize; }
+  const double* GetImmediates() const { return this->Immediates; }
+
+protected:
+  vtkPVArrayCalculatorParser() {}
+  ~vtkPVArrayCalculatorParser() override {}
+
+private:
+  vtkPVArrayCalculatorParser(const vtkPVArrayCalculatorParser&) = delete;
+  void operator=(const vtkPVArrayCalculatorParser&) = delete;
+};
+vtkStandardNewMacro(vtkPVArrayCalculatorParser);
+
+//----------------------------------------------------------------------------
+// Where the values of a variable come from: components of an array, or of the
+// points of a dataset when Array is NULL.
+struct vtkCalculatorBinding
+{
+  vtkCalculatorBinding()
+    : Array(NULL)
+  {
+    this->Components[0] = this->Components[1] = this->Components[2] = 0;
+  }
+
+  vtkDataArray* Array;
+  int Components[3];
+};
+
+//----------------------------------------------------------------------------
+// One operation of the byte code. Top is the position of the top of the
+// parser's stack before the operation; each position of the stack holds the
+// values of a block of tuples.
+struct vtkCalculatorInstruction
+{
+  unsigned int OpCode;
+  int Top;
+  double Immediate;
+  vtkCalculatorBinding Variable;
+};
+
+//----------------------------------------------------------------------------
+// Translates the byte code of the parsed function into a list of
+// instructions, and computes the depth of the stack. Returns false if the
+// byte code uses a variable without binding or an unknown operation.
+bool vtkCompileFunction(vtkPVArrayCalculatorParser* parser,
+  const std::map<std::string, vtkCalculatorBinding>& scalars,
+  const std::map<std::string, vtkCalculatorBinding>& vectors,
+  std::vector<vtkCalculatorInstruction>& program, int& depth)
+{
+  const int numScalars = parser->GetNumberOfScalarVariables();
+  const int numVectors = parser->GetNumberOfVectorVariables();
+  const unsigned int* byteCode = parser->GetByteCode();
+  const double* immediates = parser->GetImmediates();
+
+  program.clear();
+  depth = 0;
+  int top = -1;
+  int numImmediates = 0;
+  for (int cc = 0; cc < parser->GetByteCodeSize(); cc++)
+  {
+    vtkCalculatorInstruction instruction;
+    instruction.OpCode = byteCode[cc];
+    instruction.Top = top;
+    instruction.Immediate = 0.0;
+    switch (byteCode[cc])
+    {
+      case VTK_PARSER_IMMEDIATE:
+        instruction.Immediate = immediates[numImmediates++];
+        top++;
+        break;
+
+      case VTK_PARSER_UNARY_MINUS:
+      case VTK_PARSER_UNARY_PLUS:
+      case VTK_PARSER_ABSOLUTE_VALUE:
+      case VTK_PARSER_EXPONENT:
+      case VTK_PARSER_CEILING:
+      case VTK_PARSER_FLOOR:
+      case VTK_PARSER_LOGARITHM:
+      case VTK_PARSER_LOGARITHME:
+      case VTK_PARSER_LOGARITHM10:
+      case VTK_PARSER_SQUARE_ROOT:
+      case VTK_PARSER_SINE:
+      case VTK_PARSER_COSINE:
+      case VTK_PARSER_TANGENT:
+      case VTK_PARSER_ARCSINE:
+      case VTK_PARSER_ARCCOSINE:
+      case VTK_PARSER_ARCTANGENT:
+      case VTK_PARSER_HYPERBOLIC_SINE:
+      case VTK_PARSER_HYPERBOLIC_COSINE:
+      case VTK_PARSER_HYPERBOLIC_TANGENT:
+      case VTK_PARSER_SIGN:
+      case VTK_PARSER_VECTOR_UNARY_MINUS:
+      case VTK_PARSER_VECTOR_UNARY_PLUS:
+      case VTK_PARSER_NORMALIZE:
+        break;
+
+      case VTK_PARSER_ADD:
+      case VTK_PARSER_SUBTRACT:
+      case VTK_PARSER_MULTIPLY:
+      case VTK_PARSER_DIVIDE:
+      case VTK_PARSER_POWER:
+      case VTK_PARSER_MIN:
+      case VTK_PARSER_MAX:
+      case VTK_PARSER_LESS_THAN:
+      case VTK_PARSER_GREATER_THAN:
+      case VTK_PARSER_EQUAL_TO:
+      case VTK_PARSER_AND:
+      case VTK_PARSER_OR:
+      case VTK_PARSER_SCALAR_TIMES_VECTOR:
+      case VTK_PARSER_VECTOR_TIMES_SCALAR:
+      case VTK_PARSER_VECTOR_OVER_SCALAR:
+        top--;
+        break;
+
+      case VTK_PARSER_IF:
+      case VTK_PARSER_MAGNITUDE:
+        top -= 2;
+        break;
+
+      case VTK_PARSER_CROSS:
+      case VTK_PARSER_VECTOR_ADD:
+      case VTK_PARSER_VECTOR_SUBTRACT:
+        top -= 3;
+        break;
+
+      case VTK_PARSER_VECTOR_IF:
+        top -= 4;
+        break;
+
+      case VTK_PARSER_DOT_PRODUCT:
+        top -= 5;
+        break;
+
+      case VTK_PARSER_IHAT:
+      case VTK_PARSER_JHAT:
+      case VTK_PARSER_KHAT:
+        top += 3;
+        break;
+
+      default:
+      {
+        if (byteCode[cc] < VTK_PARSER_BEGIN_VARIABLES)
+        {
+          return false;
+        }
+        const int index = static_cast<int>(byteCode[cc] - VTK_PARSER_BEGIN_VARIABLES);
+        const bool isScalar = index < numScalars;
+        if (!isScalar && index - numScalars >= numVectors)
+        {
+          return false;
+        }
+        const std::map<std::string, vtkCalculatorBinding>& bindings = isScalar ? scalars : vectors;
+        const char* name = isScalar ? parser->GetScalarVariableName(index)
+                                    : parser->GetVectorVariableName(index - numScalars);
+        std::map<std::string, vtkCalculatorBinding>::const_iterator iter =
+          bindings.find(name ? name : "");
+        if (iter == bindings.end())
+        {
+          return false;
+        }
+        instruction.OpCode = isScalar ? VTK_PARSER_BEGIN_VARIABLES : VTK_PARSER_BEGIN_VARIABLES + 1;
+        instruction.Variable = iter->second;
+        top += isScalar ? 1 : 3;
+      }
+    }
+    program.push_back(instruction);
+    depth = std::max(depth, top + 1);
+    if (top < 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+struct vtkLoadComponentWorker
+{
+  vtkLoadComponentWorker(vtkIdType begin, vtkIdType end, int component, double* values)
+    : Begin(begin)
+    , End(end)
+    , Component(component)
+    , Values(values)
+  {
+  }
+
+  template <typename ArrayT>
+  void operator()(ArrayT* array)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    for (vtkIdType cc = this->Begin; cc < this->End; ++cc)
+    {
+      this->Values[cc - this->Begin] = static_cast<double>(accessor.Get(cc, this->Component));
+    }
+  }
+
+  vtkIdType Begin;
+  vtkIdType End;
+  int Component;
+  double* Values;
+};
+
+struct vtkStoreComponentWorker
+{
+  vtkStoreComponentWorker(vtkIdType begin, vtkIdType end, int component, const double* values)
+    : Begin(begin)
+    , End(end)
+    , Component(component)
+    , Values(values)
+  {
+  }
+
+  template <typename ArrayT>
+  void operator()(ArrayT* array)
+  {
+    typedef typename vtkDataArrayAccessor<ArrayT>::APIType ValueType;
+    vtkDataArrayAccessor<ArrayT> accessor(array);
+    for (vtkIdType cc = this->Begin; cc < this->End; ++cc)
+    {
+      accessor.Set(cc, this->Component, static_cast<ValueType>(this->Values[cc - this->Begin]));
+    }
+  }
+
+  vtkIdType Begin;
+  vtkIdType End;
+  int Component;
+  const double* Values;
+};
+
+//----------------------------------------------------------------------------
+// Runs the compiled function over blocks of tuples. The operations match
+// vtkFunctionParser::Evaluate(), including the replacement of invalid values.
+// When invalid values are not replaced, Invalid is set instead.
+class vtkCalculatorKernel
+{
+public:
+  static const vtkIdType BlockSize = 1024;
+
+  vtkCalculatorKernel(const std::vector<vtkCalculatorInstruction>& program, int depth,
+    vtkDataSet* dataSet, vtkDataArray* result, bool replaceInvalid, double replacement)
+    : Program(program)
+    , Depth(depth)
+    , DataSet(dataSet)
+    , Result(result)
+    , ReplaceInvalid(replaceInvalid)
+    , Replacement(replacement)
+  {
+  }
+
+  void Initialize()
+  {
+    this->Stack.Local().resize(this->Depth * BlockSize);
+    this->Invalid.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cc = begin; cc < end; cc += BlockSize)
+    {
+      this->Execute(cc, std::min(cc + BlockSize, end));
+    }
+  }
+
+  void Reduce() {}
+
+  bool HasInvalidValues()
+  {
+    for (vtkSMPThreadLocal<unsigned char>::iterator iter = this->Invalid.begin();
+         iter != this->Invalid.end(); ++iter)
+    {
+      if (*iter)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  void Load(vtkIdType begin, vtkIdType end, const vtkCalculatorBinding& binding, int component,
+    double* values)
+  {
+    if (binding.Array)
+    {
+      vtkLoadComponentWorker worker(begin, end, binding.Components[component], values);
+      if (!vtkArrayDispatch::Dispatch::Execute(binding.Array, worker))
+      {
+        worker(binding.Array);
+      }
+    }
+    else
+    {
+      double x[3];
+      for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+        this->DataSet->GetPoint(cc, x);
+        values[cc - begin] = x[binding.Components[component]];
+      }
+    }
+  }
+
+  // Handles an invalid value, returning the value to use instead.
+  double InvalidValue(unsigned char& invalid) const
+  {
+    invalid = this->ReplaceInvalid ? invalid : 1;
+    return this->Replacement;
+  }
+
+  void Execute(vtkIdType begin, vtkIdType end)
+  {
+    const int n = static_cast<int>(end - begin);
+    double* stack = &this->Stack.Local()[0];
+    unsigned char& invalid = this->Invalid.Local();
+    for (size_t ii = 0; ii < this->Program.size(); ++ii)
+    {
+      const vtkCalculatorInstruction& instruction = this->Program[ii];
+      double* s0 = stack + instruction.Top * BlockSize; // top of the stack
+      double* s1 = s0 - BlockSize;
+      double* s2 = s1 - BlockSize;
+      double* s3 = s2 - BlockSize;
+      double* s4 = s3 - BlockSize;
+      double* s5 = s4 - BlockSize;
+      double* s6 = s5 - BlockSize;
+      double* next = s0 + BlockSize;
+      switch (instruction.OpCode)
+      {
+        case VTK_PARSER_IMMEDIATE:
+          std::fill(next, next + n, instruction.Immediate);
+          break;
+        case VTK_PARSER_UNARY_MINUS:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = -s0[k];
+          }
+          break;
+        case VTK_PARSER_UNARY_PLUS:
+        case VTK_PARSER_VECTOR_UNARY_PLUS:
+          break;
+        case VTK_PARSER_ADD:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] += s0[k];
+          }
+          break;
+        case VTK_PARSER_SUBTRACT:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] -= s0[k];
+          }
+          break;
+        case VTK_PARSER_MULTIPLY:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] *= s0[k];
+          }
+          break;
+        case VTK_PARSER_DIVIDE:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s0[k] == 0 ? this->InvalidValue(invalid) : s1[k] / s0[k];
+          }
+          break;
+        case VTK_PARSER_POWER:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = pow(s1[k], s0[k]);
+          }
+          break;
+        case VTK_PARSER_ABSOLUTE_VALUE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = fabs(s0[k]);
+          }
+          break;
+        case VTK_PARSER_EXPONENT:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = exp(s0[k]);
+          }
+          break;
+        case VTK_PARSER_CEILING:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = ceil(s0[k]);
+          }
+          break;
+        case VTK_PARSER_FLOOR:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = floor(s0[k]);
+          }
+          break;
+        case VTK_PARSER_LOGARITHM:
+        case VTK_PARSER_LOGARITHME:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = s0[k] <= 0 ? this->InvalidValue(invalid) : log(s0[k]);
+          }
+          break;
+        case VTK_PARSER_LOGARITHM10:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = s0[k] <= 0 ? this->InvalidValue(invalid) : log10(s0[k]);
+          }
+          break;
+        case VTK_PARSER_SQUARE_ROOT:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = s0[k] < 0 ? this->InvalidValue(invalid) : sqrt(s0[k]);
+          }
+          break;
+        case VTK_PARSER_SINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = sin(s0[k]);
+          }
+          break;
+        case VTK_PARSER_COSINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = cos(s0[k]);
+          }
+          break;
+        case VTK_PARSER_TANGENT:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = tan(s0[k]);
+          }
+          break;
+        case VTK_PARSER_ARCSINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = (s0[k] < -1 || s0[k] > 1) ? this->InvalidValue(invalid) : asin(s0[k]);
+          }
+          break;
+        case VTK_PARSER_ARCCOSINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = (s0[k] < -1 || s0[k] > 1) ? this->InvalidValue(invalid) : acos(s0[k]);
+          }
+          break;
+        case VTK_PARSER_ARCTANGENT:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = atan(s0[k]);
+          }
+          break;
+        case VTK_PARSER_HYPERBOLIC_SINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = sinh(s0[k]);
+          }
+          break;
+        case VTK_PARSER_HYPERBOLIC_COSINE:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = cosh(s0[k]);
+          }
+          break;
+        case VTK_PARSER_HYPERBOLIC_TANGENT:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = tanh(s0[k]);
+          }
+          break;
+        case VTK_PARSER_MIN:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s0[k] < s1[k] ? s0[k] : s1[k];
+          }
+          break;
+        case VTK_PARSER_MAX:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s0[k] > s1[k] ? s0[k] : s1[k];
+          }
+          break;
+        case VTK_PARSER_SIGN:
+          for (int k = 0; k < n; k++)
+          {
+            s0[k] = s0[k] < 0 ? -1.0 : (s0[k] == 0 ? 0.0 : 1.0);
+          }
+          break;
+        case VTK_PARSER_CROSS:
+          for (int k = 0; k < n; k++)
+          {
+            const double x = s4[k] * s0[k] - s3[k] * s1[k];
+            const double y = s3[k] * s2[k] - s5[k] * s0[k];
+            const double z = s5[k] * s1[k] - s4[k] * s2[k];
+            s5[k] = x;
+            s4[k] = y;
+            s3[k] = z;
+          }
+          break;
+        case VTK_PARSER_VECTOR_UNARY_MINUS:
+          for (int k = 0; k < n; k++)
+          {
+            s2[k] = -s2[k];
+            s1[k] = -s1[k];
+            s0[k] = -s0[k];
+          }
+          break;
+        case VTK_PARSER_DOT_PRODUCT:
+          for (int k = 0; k < n; k++)
+          {
+            s5[k] = s5[k] * s2[k] + s4[k] * s1[k] + s3[k] * s0[k];
+          }
+          break;
+        case VTK_PARSER_VECTOR_ADD:
+          for (int k = 0; k < n; k++)
+          {
+            s5[k] += s2[k];
+            s4[k] += s1[k];
+            s3[k] += s0[k];
+          }
+          break;
+        case VTK_PARSER_VECTOR_SUBTRACT:
+          for (int k = 0; k < n; k++)
+          {
+            s5[k] -= s2[k];
+            s4[k] -= s1[k];
+            s3[k] -= s0[k];
+          }
+          break;
+        case VTK_PARSER_SCALAR_TIMES_VECTOR:
+          for (int k = 0; k < n; k++)
+          {
+            const double scale = s3[k];
+            s3[k] = scale * s2[k];
+            s2[k] = scale * s1[k];
+            s1[k] = scale * s0[k];
+          }
+          break;
+        case VTK_PARSER_VECTOR_TIMES_SCALAR:
+          for (int k = 0; k < n; k++)
+          {
+            s3[k] *= s0[k];
+            s2[k] *= s0[k];
+            s1[k] *= s0[k];
+          }
+          break;
+        case VTK_PARSER_VECTOR_OVER_SCALAR:
+          for (int k = 0; k < n; k++)
+          {
+            if (s0[k] == 0)
+            {
+              s3[k] = s2[k] = s1[k] = this->InvalidValue(invalid);
+            }
+            else
+            {
+              s3[k] /= s0[k];
+              s2[k] /= s0[k];
+              s1[k] /= s0[k];
+            }
+          }
+          break;
+        case VTK_PARSER_MAGNITUDE:
+          for (int k = 0; k < n; k++)
+          {
+            s2[k] = sqrt(s2[k] * s2[k] + s1[k] * s1[k] + s0[k] * s0[k]);
+          }
+          break;
+        case VTK_PARSER_NORMALIZE:
+          for (int k = 0; k < n; k++)
+          {
+            const double magnitude = sqrt(s2[k] * s2[k] + s1[k] * s1[k] + s0[k] * s0[k]);
+            if (magnitude == 0)
+            {
+              s2[k] = s1[k] = s0[k] = this->InvalidValue(invalid);
+            }
+            else
+            {
+              s2[k] /= magnitude;
+              s1[k] /= magnitude;
+              s0[k] /= magnitude;
+            }
+          }
+          break;
+        case VTK_PARSER_IHAT:
+        case VTK_PARSER_JHAT:
+        case VTK_PARSER_KHAT:
+          std::fill(next, next + n, instruction.OpCode == VTK_PARSER_IHAT ? 1.0 : 0.0);
+          std::fill(next + BlockSize, next + BlockSize + n,
+            instruction.OpCode == VTK_PARSER_JHAT ? 1.0 : 0.0);
+          std::fill(next + 2 * BlockSize, next + 2 * BlockSize + n,
+            instruction.OpCode == VTK_PARSER_KHAT ? 1.0 : 0.0);
+          break;
+        case VTK_PARSER_IF:
+          for (int k = 0; k < n; k++)
+          {
+            s2[k] = s2[k] != 0.0 ? s1[k] : s0[k];
+          }
+          break;
+        case VTK_PARSER_VECTOR_IF:
+          for (int k = 0; k < n; k++)
+          {
+            const bool condition = s6[k] != 0.0;
+            s6[k] = condition ? s5[k] : s2[k];
+            s5[k] = condition ? s4[k] : s1[k];
+            s4[k] = condition ? s3[k] : s0[k];
+          }
+          break;
+        case VTK_PARSER_LESS_THAN:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s1[k] < s0[k] ? 1.0 : 0.0;
+          }
+          break;
+        case VTK_PARSER_GREATER_THAN:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s1[k] > s0[k] ? 1.0 : 0.0;
+          }
+          break;
+        case VTK_PARSER_EQUAL_TO:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = s1[k] == s0[k] ? 1.0 : 0.0;
+          }
+          break;
+        case VTK_PARSER_AND:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = (s1[k] != 0.0 && s0[k] != 0.0) ? 1.0 : 0.0;
+          }
+          break;
+        case VTK_PARSER_OR:
+          for (int k = 0; k < n; k++)
+          {
+            s1[k] = (s1[k] != 0.0 || s0[k] != 0.0) ? 1.0 : 0.0;
+          }
+          break;
+        case VTK_PARSER_BEGIN_VARIABLES:
+          this->Load(begin, end, instruction.Variable, 0, next);
+          break;
+        default: // vector variable
+          this->Load(begin, end, instruction.Variable, 0, next);
+          this->Load(begin, end, instruction.Variable, 1, next + BlockSize);
+          this->Load(begin, end, instruction.Variable, 2, next + 2 * BlockSize);
+          break;
+      }
+    }
+
+    // The result is at the bottom of the stack.
+    for (int comp = 0; comp < this->Result->GetNumberOfComponents(); comp++)
+    {
+      vtkStoreComponentWorker worker(begin, end, comp, stack + comp * BlockSize);
+      if (!vtkArrayDispatch::Dispatch::Execute(this->Result, worker))
+      {
+        worker(this->Result);
+      }
+    }
+  }
+
+  const std::vector<vtkCalculatorInstruction>& Program;
+  int Depth;
+  vtkDataSet* DataSet;
+  vtkDataArray* Result;
+  bool ReplaceInvalid;
+  double Replacement;
+  vtkSMPThreadLocal<std::vector<double> > Stack;
+  vtkSMPThreadLocal<unsigned char> Invalid;
+};
+
+const vtkIdType vtkCalculatorKernel::BlockSize;
 }
 
 vtkStandardNewMacro(vtkPVArrayCalculator);
 // ----------------------------------------------------------------------------
 vtkPVArrayCalculator::vtkPVArrayCalculator()
 {
+  // Use a parser whose byte code can be run by ExecuteVectorized().
+  this->FunctionParser->Delete();
+  this->FunctionParser = vtkPVArrayCalculatorParser::New();
 }
 
 // ----------------------------------------------------------------------------
@@ -199,9 +887,167 @@ int vtkPVArrayCalculator::RequestData(
     this->UpdateArrayAndVariableNames(input, dataAttrs);
   }
 
+  vtkDataObject* output = vtkDataObject::GetData(outputVector, 0);
+  if (numTuples > 0 && dataAttrs && this->ExecuteVectorized(input, output, attributeType))
+  {
+    return 1;
+  }
   return this->Superclass::RequestData(request, inputVector, outputVector);
 }
 
+// ----------------------------------------------------------------------------
+bool vtkPVArrayCalculator::ExecuteVectorized(
+  vtkDataObject* input, vtkDataObject* output, int attributeType)
+{
+  vtkDataSet* dsInput = vtkDataSet::SafeDownCast(input);
+  vtkDataSet* dsOutput = vtkDataSet::SafeDownCast(output);
+  vtkTable* tableInput = vtkTable::SafeDownCast(input);
+  vtkTable* tableOutput = vtkTable::SafeDownCast(output);
+  if (!(dsInput && dsOutput) && !(tableInput && tableOutput))
+  {
+    return false;
+  }
+  if (!this->Function || !*this->Function || !this->ResultArrayName ||
+    !*this->ResultArrayName)
+  {
+    return false;
+  }
+
+  // Bind the variables to the arrays (or points) providing their values and
+  // register them with the parser, as the superclass would.
+  vtkDataSetAttributes* inFD = input->GetAttributes(attributeType);
+  std::map<std::string, vtkCalculatorBinding> scalars;
+  std::map<std::string, vtkCalculatorBinding> vectors;
+  for (int i = 0; i < this->NumberOfScalarArrays; i++)
+  {
+    vtkDataArray* array = inFD->GetArray(this->ScalarArrayNames[i]);
+    if (!array || array->GetNumberOfComponents() <= this->SelectedScalarComponents[i])
+    {
+      return false;
+    }
+    vtkCalculatorBinding& binding = scalars[this->ScalarVariableNames[i]];
+    binding.Array = array;
+    binding.Components[0] = this->SelectedScalarComponents[i];
+    this->FunctionParser->SetScalarVariableValue(this->ScalarVariableNames[i], 0.0);
+  }
+  for (int i = 0; i < this->NumberOfVectorArrays; i++)
+  {
+    vtkDataArray* array = inFD->GetArray(this->VectorArrayNames[i]);
+    if (!array)
+    {
+      return false;
+    }
+    vtkCalculatorBinding& binding = vectors[this->VectorVariableNames[i]];
+    binding.Array = array;
+    for (int comp = 0; comp < 3; comp++)
+    {
+      binding.Components[comp] = this->SelectedVectorComponents[i][comp];
+      if (array->GetNumberOfComponents() <= binding.Components[comp])
+      {
+        return false;
+      }
+    }
+    this->FunctionParser->SetVectorVariableValue(this->VectorVariableNames[i], 0.0, 0.0, 0.0);
+  }
+  if (attributeType == vtkDataObject::POINT && dsInput)
+  {
+    vtkPointSet* psInput = vtkPointSet::SafeDownCast(dsInput);
+    vtkDataArray* points =
+      psInput && psInput->GetPoints() ? psInput->GetPoints()->GetData() : NULL;
+    double x[3];
+    dsInput->GetPoint(0, x); // make sure GetPoint() can be called from several threads.
+    for (int i = 0; i < this->NumberOfCoordinateScalarArrays; i++)
+    {
+      vtkCalculatorBinding& binding = scalars[this->CoordinateScalarVariableNames[i]];
+      binding.Array = points;
+      binding.Components[0] = this->SelectedCoordinateScalarComponents[i];
+      this->FunctionParser->SetScalarVariableValue(this->CoordinateScalarVariableNames[i], 0.0);
+    }
+    for (int i = 0; i < this->NumberOfCoordinateVectorArrays; i++)
+    {
+      vtkCalculatorBinding& binding = vectors[this->CoordinateVectorVariableNames[i]];
+      binding.Array = points;
+      for (int comp = 0; comp < 3; comp++)
+      {
+        binding.Components[comp] = this->SelectedCoordinateVectorComponents[i][comp];
+      }
+      this->FunctionParser->SetVectorVariableValue(
+        this->CoordinateVectorVariableNames[i], 0.0, 0.0, 0.0);
+    }
+  }
+
+  // Parse the function and compile its byte code.
+  const bool isScalar = this->FunctionParser->IsScalarResult() != 0;
+  if (!isScalar && !this->FunctionParser->IsVectorResult())
+  {
+    return false;
+  }
+  std::vector<vtkCalculatorInstruction> program;
+  int depth = 0;
+  if (!vtkCompileFunction(static_cast<vtkPVArrayCalculatorParser*>(this->FunctionParser),
+        scalars, vectors, program, depth))
+  {
+    return false;
+  }
+
+  const vtkIdType numTuples = input->GetNumberOfElements(attributeType);
+  vtkSmartPointer<vtkDataArray> resultArray;
+  resultArray.TakeReference(vtkDataArray::CreateDataArray(this->ResultArrayType));
+  resultArray->SetNumberOfComponents(isScalar ? 1 : 3);
+  resultArray->SetNumberOfTuples(numTuples);
+  resultArray->SetName(this->ResultArrayName);
+
+  vtkCalculatorKernel kernel(program, depth, dsInput, resultArray, this->ReplaceInvalidValues != 0,
+    this->ReplacementValue);
+  vtkSMPTools::For(0, numTuples, vtkCalculatorKernel::BlockSize, kernel);
+  if (kernel.HasInvalidValues())
+  {
+    // let the superclass report the errors.
+    return false;
+  }
+
+  if (dsInput)
+  {
+    dsOutput->CopyStructure(dsInput);
+    dsOutput->CopyAttributes(dsInput);
+  }
+  else
+  {
+    tableOutput->ShallowCopy(tableInput);
+  }
+
+  vtkPointSet* psOutput = vtkPointSet::SafeDownCast(output);
+  vtkDataSetAttributes* outFD = output->GetAttributes(attributeType);
+  if (!isScalar && this->CoordinateResults != 0 && psOutput)
+  {
+    vtkPoints* newPoints = vtkPoints::New();
+    newPoints->SetData(resultArray);
+    psOutput->SetPoints(newPoints);
+    newPoints->Delete();
+  }
+  else
+  {
+    outFD->AddArray(resultArray);
+    if (isScalar)
+    {
+      outFD->SetActiveScalars(this->ResultArrayName);
+    }
+    else
+    {
+      outFD->SetActiveVectors(this->ResultArrayName);
+      if (this->ResultNormals)
+      {
+        outFD->SetActiveNormals(this->ResultArrayName);
+      }
+      if (this->ResultTCoords)
+      {
+        outFD->SetActiveTCoords(this->ResultArrayName);
+      }
+    }
+  }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 void vtkPVArrayCalculator::PrintSelf(ostream& os, vtkIndent indent)
 {
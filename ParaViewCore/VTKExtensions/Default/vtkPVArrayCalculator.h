@@ -24,6 +24,12 @@
  *  their mapping with the input fields. We extend vtkArrayCalculator to
  *  automatically add scalar/vector fields mapping using the array available in
  *  the input.
+ *
+ *  The parsed function is not evaluated one tuple at a time by
+ *  vtkFunctionParser. Its byte code is instead run over blocks of tuples, in
+ *  parallel using vtkSMPTools, each operation processing a whole block. The
+ *  results are the same. When invalid values are not replaced and some are
+ *  found, the superclass evaluates the function so that they get reported.
  * @sa
  *  vtkArrayCalculator vtkFunctionParser
 */
@@ -62,11 +68,18 @@ protected:
    * RequestData() only.
    */
   void UpdateArrayAndVariableNames(vtkDataObject* theInputObj, vtkDataSetAttributes* inDataAttrs);
+  //@}
+
+  /**
+   * Evaluates the function over blocks of tuples and sets up the output like
+   * the superclass does. Returns false if the function or the input are not
+   * supported, in which case the superclass should execute instead.
+   */
+  bool ExecuteVectorized(vtkDataObject* input, vtkDataObject* output, int attributeType);
 
 private:
   vtkPVArrayCalculator(const vtkPVArrayCalculator&) = delete;
   void operator=(const vtkPVArrayCalculator&) = delete;
 };
-//@}
 
 #endif
@@ -0,0 +1,401 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVCachedCellLocator.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPVCachedCellLocator.h"
+
+#include "vtkCallbackCommand.h"
+#include "vtkCellArray.h"
+#include "vtkCommand.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSimpleCriticalSection.h"
+#include "vtkStaticCellLocator.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+#include <map>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Returns the time the points or cells of the dataset were last modified.
+// Unlike vtkDataSet::GetMTime(), this ignores changes to the attributes.
+vtkMTimeType vtkGetGeometryMTime(vtkDataSet* ds)
+{
+  vtkMTimeType mtime = ds->vtkObject::GetMTime();
+  if (vtkPointSet* ps = vtkPointSet::SafeDownCast(ds))
+  {
+    if (vtkPoints* points = ps->GetPoints())
+    {
+      mtime = std::max(mtime, points->GetMTime());
+    }
+  }
+  if (vtkPolyData* pd = vtkPolyData::SafeDownCast(ds))
+  {
+    vtkCellArray* cells[4] = { pd->GetVerts(), pd->GetLines(), pd->GetPolys(), pd->GetStrips() };
+    for (int cc = 0; cc < 4; cc++)
+    {
+      mtime = cells[cc] ? std::max(mtime, cells[cc]->GetMTime()) : mtime;
+    }
+  }
+  else if (vtkUnstructuredGrid* ug = vtkUnstructuredGrid::SafeDownCast(ds))
+  {
+    mtime = ug->GetCells() ? std::max(mtime, ug->GetCells()->GetMTime()) : mtime;
+    mtime = ug->GetCellTypesArray() ? std::max(mtime, ug->GetCellTypesArray()->GetMTime()) : mtime;
+  }
+  else if (vtkRectilinearGrid* rg = vtkRectilinearGrid::SafeDownCast(ds))
+  {
+    vtkDataArray* coords[3] = { rg->GetXCoordinates(), rg->GetYCoordinates(),
+      rg->GetZCoordinates() };
+    for (int cc = 0; cc < 3; cc++)
+    {
+      mtime = coords[cc] ? std::max(mtime, coords[cc]->GetMTime()) : mtime;
+    }
+  }
+  return mtime;
+}
+
+//----------------------------------------------------------------------------
+// The cache does not keep datasets alive: an idle locator has its dataset
+// unset, and is handed the dataset again by Get(). Entries are released when
+// their dataset is deleted.
+class vtkLocatorCache
+{
+public:
+  vtkLocatorCache()
+    : Limit(1024 * 1024)
+    , Size(0)
+    , Counter(0)
+  {
+    this->DeleteObserver->SetCallback(&vtkLocatorCache::OnDataSetDeleted);
+    this->DeleteObserver->SetClientData(this);
+  }
+
+  ~vtkLocatorCache() { this->Clear(); }
+
+  vtkSmartPointer<vtkStaticCellLocator> Get(vtkDataSet* ds)
+  {
+    vtkMTimeType mtime = vtkGetGeometryMTime(ds);
+
+    this->Lock.Lock();
+    Entry& entry = this->Entries[ds];
+    if (!entry.DataSet)
+    {
+      entry.DataSet = ds;
+      entry.ObserverTag = ds->AddObserver(vtkCommand::DeleteEvent, this->DeleteObserver);
+    }
+    if (!entry.Locator || entry.GeometryMTime != mtime)
+    {
+      this->Size -= std::min(this->Size, entry.Size);
+
+      // Users of the previous locator keep it (and its dataset) until they
+      // release it.
+      entry.Locator = vtkSmartPointer<vtkStaticCellLocator>::New();
+      entry.Locator->SetDataSet(ds);
+      entry.Locator->BuildLocator();
+      entry.GeometryMTime = mtime;
+      entry.Users = 0;
+
+      // vtkStaticCellLocator keeps the bounds of every cell and (at least) one
+      // cell/bin pair per cell. The dataset is counted as well since the
+      // locator is of no use without it and keeps it alive while in use.
+      entry.Size = static_cast<unsigned long>(
+                     (ds->GetNumberOfCells() * (6 * sizeof(double) + 2 * sizeof(vtkIdType))) /
+                       1024 +
+                     1) +
+        ds->GetActualMemorySize();
+      this->Size += entry.Size;
+    }
+    else if (entry.Users == 0)
+    {
+      entry.Locator->SetDataSet(ds);
+    }
+    entry.Users++;
+    entry.LastUse = ++this->Counter;
+    vtkSmartPointer<vtkStaticCellLocator> result = entry.Locator;
+
+    this->ReleaseLeastRecentlyUsed();
+    this->Lock.Unlock();
+    return result;
+  }
+
+  // Called when a vtkPVCachedCellLocator no longer uses the locator. Once
+  // unused, the cached locator no longer references the dataset.
+  void Release(vtkStaticCellLocator* locator)
+  {
+    // Released after unlocking since this may delete the dataset, which
+    // calls OnDataSetDeleted().
+    vtkSmartPointer<vtkDataSet> dataset = locator->GetDataSet();
+
+    this->Lock.Lock();
+    EntriesType::iterator iter = this->Entries.find(dataset.GetPointer());
+    if (iter != this->Entries.end() && iter->second.Locator == locator &&
+      iter->second.Users > 0 && --iter->second.Users == 0)
+    {
+      locator->SetDataSet(NULL);
+    }
+    this->Lock.Unlock();
+  }
+
+  void Clear()
+  {
+    this->Lock.Lock();
+    for (EntriesType::iterator iter = this->Entries.begin(); iter != this->Entries.end(); ++iter)
+    {
+      this->RemoveObserver(iter->second);
+    }
+    this->Entries.clear();
+    this->Size = 0;
+    this->Lock.Unlock();
+  }
+
+  unsigned long Limit;
+  unsigned long Size;
+
+private:
+  struct Entry
+  {
+    Entry()
+      : GeometryMTime(0)
+      , Size(0)
+      , LastUse(0)
+      , Users(0)
+      , ObserverTag(0)
+    {
+    }
+    vtkSmartPointer<vtkStaticCellLocator> Locator;
+    vtkWeakPointer<vtkDataSet> DataSet;
+    vtkMTimeType GeometryMTime;
+    unsigned long Size;
+    vtkTypeUInt64 LastUse;
+    int Users;
+    unsigned long ObserverTag;
+  };
+  typedef std::map<vtkDataSet*, Entry> EntriesType;
+
+  // Releases the entry of a dataset being deleted. Since a locator in use
+  // references its dataset, the entry is unused at this point.
+  static void OnDataSetDeleted(vtkObject* caller, unsigned long, void* clientdata, void*)
+  {
+    vtkLocatorCache* self = reinterpret_cast<vtkLocatorCache*>(clientdata);
+    self->Lock.Lock();
+    EntriesType::iterator iter = self->Entries.find(static_cast<vtkDataSet*>(caller));
+    if (iter != self->Entries.end())
+    {
+      self->Size -= std::min(self->Size, iter->second.Size);
+      self->Entries.erase(iter);
+    }
+    self->Lock.Unlock();
+  }
+
+  void RemoveObserver(Entry& entry)
+  {
+    if (entry.DataSet)
+    {
+      entry.DataSet->RemoveObserver(entry.ObserverTag);
+    }
+  }
+
+  // Releases the least recently used locators until the cache fits in its
+  // limit, always keeping the most recently used one.
+  void ReleaseLeastRecentlyUsed()
+  {
+    while (this->Size > this->Limit && this->Entries.size() > 1)
+    {
+      EntriesType::iterator oldest = this->Entries.begin();
+      for (EntriesType::iterator iter = this->Entries.begin(); iter != this->Entries.end(); ++iter)
+      {
+        if (iter->second.LastUse < oldest->second.LastUse)
+        {
+          oldest = iter;
+        }
+      }
+      this->Size -= std::min(this->Size, oldest->second.Size);
+      this->RemoveObserver(oldest->second);
+      this->Entries.erase(oldest);
+    }
+  }
+
+  EntriesType Entries;
+  vtkTypeUInt64 Counter;
+  vtkSimpleCriticalSection Lock;
+  vtkNew<vtkCallbackCommand> DeleteObserver;
+};
+
+vtkLocatorCache& vtkGetLocatorCache()
+{
+  static vtkLocatorCache cache;
+  return cache;
+}
+}
+
+vtkStandardNewMacro(vtkPVCachedCellLocator);
+//----------------------------------------------------------------------------
+vtkPVCachedCellLocator::vtkPVCachedCellLocator()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkPVCachedCellLocator::~vtkPVCachedCellLocator()
+{
+  this->ReleaseLocator();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::SetCacheLimit(unsigned long kbytes)
+{
+  vtkGetLocatorCache().Limit = kbytes;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPVCachedCellLocator::GetCacheLimit()
+{
+  return vtkGetLocatorCache().Limit;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPVCachedCellLocator::GetCacheSize()
+{
+  return vtkGetLocatorCache().Size;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::ClearCache()
+{
+  vtkGetLocatorCache().Clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::BuildLocator()
+{
+  if (!this->DataSet)
+  {
+    vtkErrorMacro("Input not set!");
+    return;
+  }
+  this->ReleaseLocator();
+  this->Locator = vtkGetLocatorCache().Get(this->DataSet);
+  this->BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::FreeSearchStructure()
+{
+  this->ReleaseLocator();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::ReleaseLocator()
+{
+  if (this->Locator)
+  {
+    vtkGetLocatorCache().Release(this->Locator);
+    this->Locator = NULL;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::GenerateRepresentation(int level, vtkPolyData* pd)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  if (this->Locator)
+  {
+    this->Locator->GenerateRepresentation(level, pd);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkPVCachedCellLocator::FindCell(
+  double x[3], double tol2, vtkGenericCell* GenCell, double pcoords[3], double* weights)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  return this->Locator ? this->Locator->FindCell(x, tol2, GenCell, pcoords, weights) : -1;
+}
+
+//----------------------------------------------------------------------------
+int vtkPVCachedCellLocator::IntersectWithLine(double a0[3], double a1[3], double tol, double& t,
+  double x[3], double pcoords[3], int& subId, vtkIdType& cellId, vtkGenericCell* cell)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  return this->Locator
+    ? this->Locator->IntersectWithLine(a0, a1, tol, t, x, pcoords, subId, cellId, cell)
+    : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::FindClosestPoint(double x[3], double closestPoint[3],
+  vtkGenericCell* cell, vtkIdType& cellId, int& subId, double& dist2)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  cellId = -1;
+  if (this->Locator)
+  {
+    this->Locator->FindClosestPoint(x, closestPoint, cell, cellId, subId, dist2);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkPVCachedCellLocator::FindClosestPointWithinRadius(double x[3], double radius,
+  double closestPoint[3], vtkGenericCell* cell, vtkIdType& cellId, int& subId, double& dist2,
+  int& inside)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  cellId = -1;
+  return this->Locator ? this->Locator->FindClosestPointWithinRadius(
+                           x, radius, closestPoint, cell, cellId, subId, dist2, inside)
+                       : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::FindCellsWithinBounds(double* bbox, vtkIdList* cells)
+{
+  if (!this->Locator)
+  {
+    this->BuildLocator();
+  }
+  if (this->Locator)
+  {
+    this->Locator->FindCellsWithinBounds(bbox, cells);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPVCachedCellLocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheLimit: " << vtkPVCachedCellLocator::GetCacheLimit() << endl;
+  os << indent << "CacheSize: " << vtkPVCachedCellLocator::GetCacheSize() << endl;
+}
@@ -0,0 +1,117 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVCachedCellLocator.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkPVCachedCellLocator
+ * @brief   cell locator sharing a process-wide cache of built locators.
+ *
+ * vtkPVCachedCellLocator is a vtkAbstractCellLocator that forwards all queries
+ * to a vtkStaticCellLocator obtained from a cache shared by all instances in
+ * the process. Locators are cached per dataset and are rebuilt only when the
+ * dataset's points or cells change. This avoids rebuilding the locator each
+ * time a filter such as vtkProbeFilter re-executes because only the probe
+ * location changed, since such filters create a new locator from their
+ * prototype on every execution.
+ *
+ * The memory used by the cached locators, including their datasets, is capped
+ * using SetCacheLimit(). When the limit is exceeded, the least recently used
+ * locators are released. The cache does not keep datasets alive: a cached
+ * locator only references its dataset while a vtkPVCachedCellLocator uses it,
+ * and is released when the dataset is deleted.
+ *
+ * vtkStaticCellLocator is built in parallel using vtkSMPTools.
+*/
+
+#ifndef vtkPVCachedCellLocator_h
+#define vtkPVCachedCellLocator_h
+
+#include "vtkAbstractCellLocator.h"
+#include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+#include "vtkSmartPointer.h"                 // needed for vtkSmartPointer
+
+class vtkStaticCellLocator;
+
+class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPVCachedCellLocator : public vtkAbstractCellLocator
+{
+public:
+  static vtkPVCachedCellLocator* New();
+  vtkTypeMacro(vtkPVCachedCellLocator, vtkAbstractCellLocator);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Get/Set the maximum memory used by the cached locators and their datasets
+   * in the process (in KBs). The most recently used locator is always kept,
+   * even if it exceeds the limit by itself. Default is 1 GB.
+   */
+  static void SetCacheLimit(unsigned long kbytes);
+  static unsigned long GetCacheLimit();
+  //@}
+
+  /**
+   * Returns the memory currently accounted to the cached locators (in KBs).
+   */
+  static unsigned long GetCacheSize();
+
+  /**
+   * Releases all cached locators.
+   */
+  static void ClearCache();
+
+  //@{
+  /**
+   * Satisfy vtkLocator's API. BuildLocator() fetches the locator for the
+   * current dataset from the cache, building it if needed.
+   */
+  void BuildLocator() VTK_OVERRIDE;
+  void FreeSearchStructure() VTK_OVERRIDE;
+  void GenerateRepresentation(int level, vtkPolyData* pd) VTK_OVERRIDE;
+  //@}
+
+  //@{
+  /**
+   * Queries forwarded to the cached locator.
+   */
+  using vtkAbstractCellLocator::FindCell;
+  using vtkAbstractCellLocator::FindClosestPoint;
+  using vtkAbstractCellLocator::FindClosestPointWithinRadius;
+  using vtkAbstractCellLocator::IntersectWithLine;
+  vtkIdType FindCell(double x[3], double tol2, vtkGenericCell* GenCell, double pcoords[3],
+    double* weights) VTK_OVERRIDE;
+  int IntersectWithLine(double a0[3], double a1[3], double tol, double& t, double x[3],
+    double pcoords[3], int& subId, vtkIdType& cellId, vtkGenericCell* cell) VTK_OVERRIDE;
+  void FindClosestPoint(double x[3], double closestPoint[3], vtkGenericCell* cell,
+    vtkIdType& cellId, int& subId, double& dist2) VTK_OVERRIDE;
+  vtkIdType FindClosestPointWithinRadius(double x[3], double radius, double closestPoint[3],
+    vtkGenericCell* cell, vtkIdType& cellId, int& subId, double& dist2, int& inside) VTK_OVERRIDE;
+  void FindCellsWithinBounds(double* bbox, vtkIdList* cells) VTK_OVERRIDE;
+  //@}
+
+protected:
+  vtkPVCachedCellLocator();
+  ~vtkPVCachedCellLocator() override;
+
+  /**
+   * Hands the locator back to the cache.
+   */
+  void ReleaseLocator();
+
+  vtkSmartPointer<vtkStaticCellLocator> Locator;
+
+private:
+  vtkPVCachedCellLocator(const vtkPVCachedCellLocator&) = delete;
+  void operator=(const vtkPVCachedCellLocator&) = delete;
+};
+
+#endif
@@ -15,14 +15,18 @@
 #include "vtkPVGlyphFilter.h"
 
 // VTK includes
-#include "vtkAppendPolyData.h"
 #include "vtkBoundingBox.h"
+#include "vtkCellArray.h"
 #include "vtkCellCenters.h"
 #include "vtkCellData.h"
 #include "vtkCompositeDataIterator.h"
 #include "vtkDataSet.h"
+#include "vtkFloatArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkMinimalStandardRandomSequence.h"
 #include "vtkMultiBlockDataSet.h"
 #include "vtkMultiProcessController.h"
@@ -30,19 +34,241 @@
 #include "vtkObjectFactory.h"
 #include "vtkOctreePointLocator.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
+#include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTransform.h"
 #include "vtkTuple.h"
 #include "vtkUniformGrid.h"
+#include "vtkUnsignedCharArray.h"
 
 // C/C++ includes
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <map>
 #include <set>
 #include <vector>
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Computes the position, scale and orientation of the glyph at each selected
+// point, the same way vtkGlyph3D transforms the glyph source.
+class vtkComputeGlyphInstances
+{
+public:
+  vtkComputeGlyphInstances(vtkGlyph3D* self, vtkDataSet* input, const vtkIdType* ids,
+    vtkDataArray* scalars, vtkDataArray* vectors, vtkPoints* points, vtkFloatArray* scales,
+    vtkFloatArray* orientations)
+    : Input(input)
+    , Ids(ids)
+    , Scalars(scalars)
+    , Vectors(vectors)
+    , Points(points)
+    , Scales(scales)
+    , Orientations(orientations)
+    , ScaleMode(self->GetScaleMode())
+    , ScaleFactor(self->GetScaleFactor())
+    , Clamping(self->GetClamping() != 0)
+    , Scaling(self->GetScaling() != 0)
+    , Orient(self->GetOrient() != 0)
+  {
+    self->GetRange(this->Range);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    double den = this->Range[1] - this->Range[0];
+    den = den != 0.0 ? den : 1.0;
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      const vtkIdType ptId = this->Ids[cc];
+      double x[3];
+      this->Input->GetPoint(ptId, x);
+      this->Points->SetPoint(cc, x);
+
+      double scale[3] = { 1.0, 1.0, 1.0 };
+      if (this->Scalars)
+      {
+        const double s = this->Scalars->GetComponent(ptId, 0);
+        if (this->ScaleMode == VTK_SCALE_BY_SCALAR || this->ScaleMode == VTK_DATA_SCALING_OFF)
+        {
+          scale[0] = scale[1] = scale[2] = s;
+        }
+      }
+
+      double v[3] = { 1.0, 0.0, 0.0 };
+      double vMag = 0.0;
+      if (this->Vectors)
+      {
+        this->Vectors->GetTuple(ptId, v);
+        vMag = vtkMath::Norm(v);
+        if (this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS)
+        {
+          scale[0] = v[0];
+          scale[1] = v[1];
+          scale[2] = v[2];
+        }
+        else if (this->ScaleMode == VTK_SCALE_BY_VECTOR)
+        {
+          scale[0] = scale[1] = scale[2] = vMag;
+        }
+      }
+
+      for (int comp = 0; comp < 3; comp++)
+      {
+        if (this->Clamping)
+        {
+          scale[comp] = std::min(std::max(scale[comp], this->Range[0]), this->Range[1]);
+          scale[comp] = (scale[comp] - this->Range[0]) / den;
+        }
+        if (!this->Scaling)
+        {
+          scale[comp] = 1.0;
+        }
+        else
+        {
+          scale[comp] = this->ScaleMode == VTK_DATA_SCALING_OFF
+            ? this->ScaleFactor
+            : scale[comp] * this->ScaleFactor;
+          scale[comp] = scale[comp] == 0.0 ? 1.0e-10 : scale[comp];
+        }
+      }
+      this->Scales->SetTuple(cc, scale);
+
+      if (!this->Orient || vMag <= 0.0)
+      {
+        v[0] = 1.0;
+        v[1] = v[2] = 0.0;
+      }
+      this->Orientations->SetTuple(cc, v);
+    }
+  }
+
+private:
+  vtkDataSet* Input;
+  const vtkIdType* Ids;
+  vtkDataArray* Scalars;
+  vtkDataArray* Vectors;
+  vtkPoints* Points;
+  vtkFloatArray* Scales;
+  vtkFloatArray* Orientations;
+  int ScaleMode;
+  double ScaleFactor;
+  bool Clamping;
+  bool Scaling;
+  bool Orient;
+  double Range[2];
+};
+
+//-----------------------------------------------------------------------------
+// Copies the tuples of an array for the given ids.
+vtkSmartPointer<vtkDataArray> vtkExtractTuples(vtkDataArray* array, vtkIdList* ids)
+{
+  vtkSmartPointer<vtkDataArray> result;
+  if (array)
+  {
+    result.TakeReference(array->NewInstance());
+    result->SetName(array->GetName());
+    result->SetNumberOfComponents(array->GetNumberOfComponents());
+    result->SetNumberOfTuples(ids->GetNumberOfIds());
+    array->GetTuples(ids, result);
+  }
+  return result;
+}
+
+// Number of points glyphed by each task when generating the geometry.
+const vtkIdType vtkGlyphChunkSize = 65536;
+
+//-----------------------------------------------------------------------------
+// Cells of a vtkPolyData, in the order cell ids are assigned.
+const int vtkNumberOfCellTypes = 4;
+vtkCellArray* vtkGetCells(vtkPolyData* pd, int type)
+{
+  switch (type)
+  {
+    case 0:
+      return pd->GetVerts();
+    case 1:
+      return pd->GetLines();
+    case 2:
+      return pd->GetPolys();
+    default:
+      return pd->GetStrips();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Returns true if \c pd has cells in more than one of its cell arrays.
+bool vtkHasMixedCells(vtkPolyData* pd)
+{
+  int numTypes = 0;
+  for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+  {
+    numTypes += vtkGetCells(pd, type)->GetNumberOfCells() > 0 ? 1 : 0;
+  }
+  return numTypes > 1;
+}
+
+//-----------------------------------------------------------------------------
+// Adds arrays with the layout and attributes of those of \c source to
+// \c target, with \c numTuples tuples.
+void vtkAllocateArrays(vtkDataSetAttributes* source, vtkDataSetAttributes* target,
+  vtkIdType numTuples)
+{
+  for (int idx = 0; idx < source->GetNumberOfArrays(); ++idx)
+  {
+    vtkAbstractArray* array = source->GetAbstractArray(idx);
+    vtkSmartPointer<vtkAbstractArray> copy;
+    copy.TakeReference(array->NewInstance());
+    copy->SetName(array->GetName());
+    copy->SetNumberOfComponents(array->GetNumberOfComponents());
+    copy->SetNumberOfTuples(numTuples);
+    const int index = target->AddArray(copy);
+    const int attribute = source->IsArrayAnAttribute(idx);
+    if (attribute >= 0)
+    {
+      target->SetActiveAttribute(index, attribute);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Copies \c numTuples tuples of the arrays of \c source, from \c srcStart,
+// to those of \c target allocated by vtkAllocateArrays(), from \c dstStart.
+// vtkDataArrays are copied when \c dataArrays is true, the other arrays,
+// which cannot be written from several threads, otherwise.
+void vtkCopyTuples(vtkDataSetAttributes* source, vtkIdType srcStart,
+  vtkDataSetAttributes* target, vtkIdType dstStart, vtkIdType numTuples, bool dataArrays)
+{
+  for (int idx = 0; idx < source->GetNumberOfArrays() && numTuples > 0; ++idx)
+  {
+    vtkAbstractArray* in = source->GetAbstractArray(idx);
+    vtkAbstractArray* out = target->GetAbstractArray(idx);
+    const int numComps = in->GetNumberOfComponents();
+    if (vtkDataArray::SafeDownCast(in) && vtkDataArray::SafeDownCast(out))
+    {
+      if (dataArrays)
+      {
+        memcpy(out->GetVoidPointer(dstStart * numComps), in->GetVoidPointer(srcStart * numComps),
+          numTuples * numComps * in->GetDataTypeSize());
+      }
+    }
+    else if (!dataArrays)
+    {
+      for (vtkIdType cc = 0; cc < numTuples; ++cc)
+      {
+        out->SetTuple(dstStart + cc, srcStart + cc, in);
+      }
+    }
+  }
+}
+}
+
 class vtkPVGlyphFilter::vtkInternals
 {
   vtkBoundingBox Bounds;
@@ -222,6 +448,446 @@ public:
     }
     return false;
   }
+
+  //---------------------------------------------------------------------------
+  // Collects the ids of the points to glyph, in increasing order. As in
+  // vtkGlyph3D::Execute(), duplicate ghost points are skipped before checking
+  // for visibility.
+  void SelectPoints(vtkDataSet* ds, vtkPVGlyphFilter* self, std::vector<vtkIdType>& ids)
+  {
+    const vtkIdType numPts = ds->GetNumberOfPoints();
+    vtkUnsignedCharArray* ghostArray = vtkUnsignedCharArray::SafeDownCast(
+      ds->GetPointData()->GetArray(vtkDataSetAttributes::GhostArrayName()));
+    const unsigned char* ghosts =
+      ghostArray && ghostArray->GetNumberOfComponents() == 1 && numPts > 0
+      ? ghostArray->GetPointer(0)
+      : NULL;
+
+    ids.clear();
+    for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+    {
+      if (ghosts && (ghosts[ptId] & vtkDataSetAttributes::DUPLICATEPOINT))
+      {
+        continue;
+      }
+      if (self->IsPointVisible(ds, ptId))
+      {
+        ids.push_back(ptId);
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Outputs a vertex per glyphed point, with the point data of the input and
+  // the scale and orientation of the glyph.
+  bool GenerateInstances(vtkDataSet* input, vtkPolyData* output, vtkDataArray* inSScalars,
+    vtkDataArray* inVectors, vtkPVGlyphFilter* self)
+  {
+    vtkDataArray* vectors = NULL;
+    if (self->VectorMode == VTK_USE_VECTOR)
+    {
+      vectors = inVectors;
+    }
+    else if (self->VectorMode == VTK_USE_NORMAL)
+    {
+      vectors = input->GetPointData()->GetNormals();
+    }
+    if (vectors && vectors->GetNumberOfComponents() > 3)
+    {
+      vtkErrorWithObjectMacro(self, "vtkDataArray " << vectors->GetName()
+                                                    << " has more than 3 components.");
+      return false;
+    }
+
+    std::vector<vtkIdType> ids;
+    this->SelectPoints(input, self, ids);
+    const vtkIdType numIds = static_cast<vtkIdType>(ids.size());
+
+    vtkNew<vtkPoints> points;
+    vtkPointSet* ps = vtkPointSet::SafeDownCast(input);
+    if (self->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+    {
+      points->SetDataTypeToDouble();
+    }
+    else if (self->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION && ps &&
+      ps->GetPoints())
+    {
+      points->SetDataType(ps->GetPoints()->GetDataType());
+    }
+    points->SetNumberOfPoints(numIds);
+
+    vtkNew<vtkFloatArray> scales;
+    scales->SetName("GlyphScale");
+    scales->SetNumberOfComponents(3);
+    scales->SetNumberOfTuples(numIds);
+    vtkNew<vtkFloatArray> orientations;
+    orientations->SetName("GlyphOrientation");
+    orientations->SetNumberOfComponents(3);
+    orientations->SetNumberOfTuples(numIds);
+
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfValues(2 * numIds);
+    for (vtkIdType cc = 0; cc < numIds; ++cc)
+    {
+      connectivity->SetValue(2 * cc, 1);
+      connectivity->SetValue(2 * cc + 1, cc);
+    }
+
+    if (numIds > 0)
+    {
+      double x[3];
+      input->GetPoint(ids[0], x); // make sure GetPoint() can be called from several threads.
+      vtkComputeGlyphInstances functor(self, input, &ids[0], inSScalars, vectors,
+        points.GetPointer(), scales.GetPointer(), orientations.GetPointer());
+      vtkSMPTools::For(0, numIds, functor);
+    }
+
+    vtkNew<vtkCellArray> verts;
+    verts->SetCells(numIds, connectivity.GetPointer());
+    output->SetPoints(points.GetPointer());
+    output->SetVerts(verts.GetPointer());
+
+    vtkPointData* inPD = input->GetPointData();
+    vtkPointData* outPD = output->GetPointData();
+    outPD->CopyAllocate(inPD, numIds);
+    for (vtkIdType cc = 0; cc < numIds; ++cc)
+    {
+      outPD->CopyData(inPD, ids[cc], cc);
+    }
+    outPD->AddArray(scales.GetPointer());
+    outPD->AddArray(orientations.GetPointer());
+    if (self->GeneratePointIds)
+    {
+      vtkNew<vtkIdTypeArray> pointIds;
+      pointIds->SetName(self->PointIdsName);
+      pointIds->SetNumberOfValues(numIds);
+      std::copy(ids.begin(), ids.end(), pointIds->GetPointer(0));
+      outPD->AddArray(pointIds.GetPointer());
+    }
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  // A range of the glyphed points, glyphed by its own filter so that the
+  // chunks can be processed concurrently.
+  struct GlyphChunk
+  {
+    vtkIdType Begin;
+    vtkIdType End;
+    vtkSmartPointer<vtkPVGlyphFilter> Worker;
+    vtkSmartPointer<vtkInformationVector> SourceVector;
+    vtkSmartPointer<vtkPolyData> Input;
+    vtkSmartPointer<vtkPolyData> Output;
+    bool Result;
+
+    // Where the chunk's output goes in the filter's output.
+    vtkIdType PointOffset;
+    vtkIdType CellOffset[vtkNumberOfCellTypes];
+    vtkIdType ConnectivityOffset[vtkNumberOfCellTypes];
+  };
+
+  class GlyphChunks
+  {
+  public:
+    GlyphChunks(vtkDataSet* input, const vtkIdType* ids, vtkDataArray* scalars,
+      vtkDataArray* vectors, std::vector<GlyphChunk>& chunks)
+      : Input(input)
+      , Ids(ids)
+      , Scalars(scalars)
+      , Vectors(vectors)
+      , Chunks(chunks)
+    {
+    }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      vtkPointData* inPD = this->Input->GetPointData();
+      for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+        GlyphChunk& chunk = this->Chunks[cc];
+        const vtkIdType numIds = chunk.End - chunk.Begin;
+
+        // Extract the chunk's points and their attributes.
+        vtkNew<vtkIdList> ids;
+        ids->SetNumberOfIds(numIds);
+        vtkPoints* points = chunk.Input->GetPoints();
+        points->SetNumberOfPoints(numIds);
+        vtkPointData* outPD = chunk.Input->GetPointData();
+        outPD->CopyAllocate(inPD, numIds);
+        for (vtkIdType id = 0; id < numIds; ++id)
+        {
+          const vtkIdType ptId = this->Ids[chunk.Begin + id];
+          double x[3];
+          this->Input->GetPoint(ptId, x);
+          points->SetPoint(id, x);
+          outPD->CopyData(inPD, ptId, id);
+          ids->SetId(id, ptId);
+        }
+        vtkSmartPointer<vtkDataArray> scalars = vtkExtractTuples(this->Scalars, ids.GetPointer());
+        vtkSmartPointer<vtkDataArray> vectors = vtkExtractTuples(this->Vectors, ids.GetPointer());
+
+        chunk.Result = chunk.Worker->Execute(
+          chunk.Input, chunk.SourceVector, chunk.Output, scalars, vectors);
+
+        // Point ids refer to the chunk's points, map them back to the input's.
+        vtkIdTypeArray* pointIds = chunk.Worker->GetGeneratePointIds()
+          ? vtkIdTypeArray::SafeDownCast(
+              chunk.Output->GetPointData()->GetArray(chunk.Worker->GetPointIdsName()))
+          : NULL;
+        const vtkIdType numPointIds = pointIds ? pointIds->GetNumberOfTuples() : 0;
+        for (vtkIdType id = 0; id < numPointIds; ++id)
+        {
+          pointIds->SetValue(id, ids->GetId(pointIds->GetValue(id)));
+        }
+      }
+    }
+
+  private:
+    vtkDataSet* Input;
+    const vtkIdType* Ids;
+    vtkDataArray* Scalars;
+    vtkDataArray* Vectors;
+    std::vector<GlyphChunk>& Chunks;
+  };
+
+  //---------------------------------------------------------------------------
+  // Copies the output of each chunk into the filter's output, allocated once
+  // for all chunks, at the offsets computed for the chunk.
+  class GatherChunks
+  {
+  public:
+    GatherChunks(std::vector<GlyphChunk>& chunks, vtkPolyData* output)
+      : Chunks(chunks)
+      , Output(output)
+    {
+      for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+      {
+        this->Connectivity[type] = vtkGetCells(output, type)->GetPointer();
+      }
+    }
+
+    void operator()(vtkIdType begin, vtkIdType end)
+    {
+      for (vtkIdType cc = begin; cc < end; ++cc)
+      {
+        GlyphChunk& chunk = this->Chunks[cc];
+        vtkPolyData* chunkOutput = chunk.Output;
+        const vtkIdType numPts = chunkOutput->GetNumberOfPoints();
+        if (numPts > 0)
+        {
+          vtkDataArray* points = chunkOutput->GetPoints()->GetData();
+          memcpy(this->Output->GetPoints()->GetData()->GetVoidPointer(3 * chunk.PointOffset),
+            points->GetVoidPointer(0), 3 * numPts * points->GetDataTypeSize());
+        }
+        vtkCopyTuples(chunkOutput->GetPointData(), 0, this->Output->GetPointData(),
+          chunk.PointOffset, numPts, true);
+
+        vtkIdType cellStart = 0;
+        for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+        {
+          vtkCellArray* cells = vtkGetCells(chunkOutput, type);
+          const vtkIdType size = cells->GetNumberOfConnectivityEntries();
+          const vtkIdType* src = size > 0 ? cells->GetPointer() : NULL;
+          vtkIdType* dst = this->Connectivity[type] + chunk.ConnectivityOffset[type];
+          for (vtkIdType idx = 0; idx < size;)
+          {
+            const vtkIdType npts = src[idx];
+            dst[idx++] = npts;
+            for (vtkIdType pt = 0; pt < npts; ++pt, ++idx)
+            {
+              dst[idx] = src[idx] + chunk.PointOffset;
+            }
+          }
+          const vtkIdType numCells = cells->GetNumberOfCells();
+          vtkCopyTuples(chunkOutput->GetCellData(), cellStart, this->Output->GetCellData(),
+            chunk.CellOffset[type], numCells, true);
+          cellStart += numCells;
+        }
+      }
+    }
+
+  private:
+    std::vector<GlyphChunk>& Chunks;
+    vtkPolyData* Output;
+    vtkIdType* Connectivity[vtkNumberOfCellTypes];
+  };
+
+  //---------------------------------------------------------------------------
+  // Allocates \c output once for the outputs of all the chunks and copies
+  // them in order, concurrently. The result matches appending the outputs.
+  void GatherGeometry(std::vector<GlyphChunk>& chunks, vtkPolyData* output)
+  {
+    vtkIdType numPts = 0;
+    vtkIdType numCells[vtkNumberOfCellTypes] = { 0, 0, 0, 0 };
+    vtkIdType connectivitySize[vtkNumberOfCellTypes] = { 0, 0, 0, 0 };
+    for (size_t cc = 0; cc < chunks.size(); ++cc)
+    {
+      GlyphChunk& chunk = chunks[cc];
+      chunk.PointOffset = numPts;
+      numPts += chunk.Output->GetNumberOfPoints();
+      for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+      {
+        vtkCellArray* cells = vtkGetCells(chunk.Output, type);
+        chunk.CellOffset[type] = numCells[type];
+        chunk.ConnectivityOffset[type] = connectivitySize[type];
+        numCells[type] += cells->GetNumberOfCells();
+        connectivitySize[type] += cells->GetNumberOfConnectivityEntries();
+      }
+    }
+    // Cell ids are assigned to verts first, then lines, polys and strips.
+    vtkIdType totalCells = 0;
+    for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+    {
+      for (size_t cc = 0; cc < chunks.size(); ++cc)
+      {
+        chunks[cc].CellOffset[type] += totalCells;
+      }
+      totalCells += numCells[type];
+    }
+
+    vtkPolyData* first = chunks[0].Output;
+    if (numPts == 0 || !first->GetPoints())
+    {
+      output->ShallowCopy(first);
+      return;
+    }
+    vtkNew<vtkPoints> points;
+    points->SetDataType(first->GetPoints()->GetDataType());
+    points->SetNumberOfPoints(numPts);
+    output->SetPoints(points.GetPointer());
+    for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+    {
+      vtkNew<vtkIdTypeArray> connectivity;
+      connectivity->SetNumberOfValues(connectivitySize[type]);
+      vtkNew<vtkCellArray> cells;
+      cells->SetCells(numCells[type], connectivity.GetPointer());
+      switch (type)
+      {
+        case 0:
+          output->SetVerts(cells.GetPointer());
+          break;
+        case 1:
+          output->SetLines(cells.GetPointer());
+          break;
+        case 2:
+          output->SetPolys(cells.GetPointer());
+          break;
+        default:
+          output->SetStrips(cells.GetPointer());
+      }
+    }
+    vtkAllocateArrays(first->GetPointData(), output->GetPointData(), numPts);
+    vtkAllocateArrays(first->GetCellData(), output->GetCellData(), totalCells);
+
+    GatherChunks functor(chunks, output);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(chunks.size()), 1, functor);
+
+    // Arrays that are not vtkDataArrays, if any, are copied serially.
+    for (size_t cc = 0; cc < chunks.size(); ++cc)
+    {
+      GlyphChunk& chunk = chunks[cc];
+      vtkCopyTuples(chunk.Output->GetPointData(), 0, output->GetPointData(), chunk.PointOffset,
+        chunk.Output->GetNumberOfPoints(), false);
+      vtkIdType cellStart = 0;
+      for (int type = 0; type < vtkNumberOfCellTypes; ++type)
+      {
+        const vtkIdType chunkCells = vtkGetCells(chunk.Output, type)->GetNumberOfCells();
+        vtkCopyTuples(chunk.Output->GetCellData(), cellStart, output->GetCellData(),
+          chunk.CellOffset[type], chunkCells, false);
+        cellStart += chunkCells;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // Generates the glyph geometry using vtkGlyph3D::Execute() on chunks of the
+  // glyphed points concurrently, and gathers the results in order. This
+  // produces the same output as glyphing all the points at once.
+  bool GenerateGeometry(vtkDataSet* input, vtkInformationVector* sourceVector,
+    vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors,
+    vtkPVGlyphFilter* self)
+  {
+    std::vector<vtkIdType> ids;
+    this->SelectPoints(input, self, ids);
+    if (ids.empty())
+    {
+      return true;
+    }
+
+    // Keep the points' precision, since vtkGlyph3D picks the output's from it.
+    vtkPointSet* ps = vtkPointSet::SafeDownCast(input);
+    const int pointsType = ps && ps->GetPoints() ? ps->GetPoints()->GetDataType() : VTK_DOUBLE;
+    const int precision = !ps && self->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION
+      ? vtkAlgorithm::SINGLE_PRECISION
+      : self->OutputPointsPrecision;
+
+    vtkPolyData* source = self->GetSource(0, sourceVector);
+    const vtkIdType numIds = static_cast<vtkIdType>(ids.size());
+    std::vector<GlyphChunk> chunks((numIds + vtkGlyphChunkSize - 1) / vtkGlyphChunkSize);
+    for (size_t cc = 0; cc < chunks.size(); ++cc)
+    {
+      GlyphChunk& chunk = chunks[cc];
+      chunk.Begin = static_cast<vtkIdType>(cc) * vtkGlyphChunkSize;
+      chunk.End = std::min(chunk.Begin + vtkGlyphChunkSize, numIds);
+      chunk.Result = false;
+
+      chunk.Worker = vtkSmartPointer<vtkPVGlyphFilter>::New();
+      chunk.Worker->SetScaleMode(self->ScaleMode);
+      chunk.Worker->SetScaleFactor(self->ScaleFactor);
+      chunk.Worker->SetColorMode(self->ColorMode);
+      chunk.Worker->SetRange(self->Range);
+      chunk.Worker->SetClamping(self->Clamping);
+      chunk.Worker->SetScaling(self->Scaling);
+      chunk.Worker->SetOrient(self->Orient);
+      chunk.Worker->SetVectorMode(self->VectorMode);
+      chunk.Worker->SetGeneratePointIds(self->GeneratePointIds);
+      chunk.Worker->SetPointIdsName(self->PointIdsName);
+      chunk.Worker->SetFillCellData(self->FillCellData);
+      chunk.Worker->SetOutputPointsPrecision(precision);
+      if (self->SourceTransform)
+      {
+        vtkNew<vtkTransform> transform;
+        transform->DeepCopy(self->SourceTransform);
+        chunk.Worker->SetSourceTransform(transform.GetPointer());
+      }
+
+      // vtkPolyData builds its cells lazily and keeps a cell instance for
+      // GetCell(), so each worker gets its own shallow copy of the source.
+      vtkNew<vtkPolyData> sourceCopy;
+      sourceCopy->ShallowCopy(source);
+      vtkNew<vtkInformation> sourceInfo;
+      sourceInfo->Set(vtkDataObject::DATA_OBJECT(), sourceCopy.GetPointer());
+      chunk.SourceVector = vtkSmartPointer<vtkInformationVector>::New();
+      chunk.SourceVector->Append(sourceInfo.GetPointer());
+
+      vtkNew<vtkPoints> points;
+      points->SetDataType(pointsType);
+      chunk.Input = vtkSmartPointer<vtkPolyData>::New();
+      chunk.Input->SetPoints(points.GetPointer());
+      chunk.Output = vtkSmartPointer<vtkPolyData>::New();
+    }
+
+    double x[3];
+    input->GetPoint(ids[0], x); // make sure GetPoint() can be called from several threads.
+    GlyphChunks functor(input, &ids[0], inSScalars, inVectors, chunks);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(chunks.size()), 1, functor);
+
+    for (size_t cc = 0; cc < chunks.size(); ++cc)
+    {
+      if (!chunks[cc].Result)
+      {
+        return false;
+      }
+    }
+    if (chunks.size() == 1)
+    {
+      output->ShallowCopy(chunks[0].Output);
+      return true;
+    }
+
+    this->GatherGeometry(chunks, output);
+    return true;
+  }
 };
 
 vtkStandardNewMacro(vtkPVGlyphFilter);
@@ -229,6 +895,7 @@ vtkCxxSetObjectMacro(vtkPVGlyphFilter, Controller, vtkMultiProcessController);
 //-----------------------------------------------------------------------------
 vtkPVGlyphFilter::vtkPVGlyphFilter()
   : GlyphMode(vtkPVGlyphFilter::ALL_POINTS)
+  , OutputMode(vtkPVGlyphFilter::GLYPH_GEOMETRY)
   , MaximumNumberOfSamplePoints(5000)
   , Seed(1)
   , Stride(1)
@@ -336,7 +1003,9 @@ int vtkPVGlyphFilter::RequestData(vtkInformation* vtkNotUsed(request),
     }
     else
     {
-      return this->Execute(ds, sourceVector, outputPD) ? 1 : 0;
+      vtkDataArray* inSScalars = this->GetInputArrayToProcess(0, ds);
+      vtkDataArray* inVectors = this->GetInputArrayToProcess(1, ds);
+      return this->ExecuteGlyphs(ds, sourceVector, outputPD, inSScalars, inVectors) ? 1 : 0;
     }
   }
   else if (cds)
@@ -376,7 +1045,10 @@ int vtkPVGlyphFilter::RequestData(vtkInformation* vtkNotUsed(request),
         }
         else
         {
-          res = this->Execute(currentDS, sourceVector, outputPD.GetPointer());
+          vtkDataArray* inSScalars = this->GetInputArrayToProcess(0, currentDS);
+          vtkDataArray* inVectors = this->GetInputArrayToProcess(1, currentDS);
+          res = this->ExecuteGlyphs(
+            currentDS, sourceVector, outputPD.GetPointer(), inSScalars, inVectors);
         }
         if (!res)
         {
@@ -489,7 +1161,29 @@ bool vtkPVGlyphFilter::ExecuteWithCellCenters(
     this->GetInputArrayInformation(0)->Get(vtkDataObject::FIELD_NAME()));
   vtkDataArray* inVectors = input->GetPointData()->GetArray(
     this->GetInputArrayInformation(1)->Get(vtkDataObject::FIELD_NAME()));
-  return this->Execute(input, sourceVector, output, inSScalars, inVectors);
+  return this->ExecuteGlyphs(input, sourceVector, output, inSScalars, inVectors);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPVGlyphFilter::ExecuteGlyphs(vtkDataSet* input, vtkInformationVector* sourceVector,
+  vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors)
+{
+  if (this->OutputMode == GLYPH_INSTANCES)
+  {
+    return this->Internals->GenerateInstances(input, output, inSScalars, inVectors, this);
+  }
+
+  // Glyphs indexed from several sources, the default glyph used when there
+  // is no source, and sources mixing verts, lines, polys or strips (whose
+  // glyph cells vtkGlyph3D numbers in insertion order) are left to vtkGlyph3D.
+  if (this->IndexMode != VTK_INDEXING_OFF || !sourceVector ||
+    sourceVector->GetNumberOfInformationObjects() != 1 || !this->GetSource(0, sourceVector) ||
+    vtkHasMixedCells(this->GetSource(0, sourceVector)))
+  {
+    return this->Execute(input, sourceVector, output, inSScalars, inVectors);
+  }
+  return this->Internals->GenerateGeometry(
+    input, sourceVector, output, inSScalars, inVectors, this);
 }
 
 //-----------------------------------------------------------------------------
@@ -514,6 +1208,8 @@ void vtkPVGlyphFilter::PrintSelf(ostream& os, vtkIndent indent)
     default:
       os << "(invalid:" << this->GlyphMode << ")" << endl;
   }
+  os << indent << "OutputMode: "
+     << (this->OutputMode == GLYPH_INSTANCES ? "GLYPH_INSTANCES" : "GLYPH_GEOMETRY") << endl;
   os << indent << "MaximumNumberOfSamplePoints: " << this->MaximumNumberOfSamplePoints << endl;
   os << indent << "Seed: " << this->Seed << endl;
   os << indent << "Stride: " << this->Stride << endl;
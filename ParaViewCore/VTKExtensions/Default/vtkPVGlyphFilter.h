@@ -35,6 +35,13 @@
  * doesn't not equal the number of points actually glyphed, since that depends on
  * several factors. In parallel, this filter ensures that spatial bounds are collected
  * across all ranks for generating identical sample points.
+ *
+ * \c OutputMode controls what is generated for the glyphed points. With
+ * GLYPH_GEOMETRY, the glyph source is copied at each point, as vtkGlyph3D does.
+ * The points are glyphed in parallel, in chunks, using vtkSMPTools. With
+ * GLYPH_INSTANCES, the output only has a vertex per glyphed point, with the
+ * input point data and the scale and orientation of each glyph, so that the
+ * glyphs can be rendered with instancing using vtkGlyph3DMapper.
 */
 
 #ifndef vtkPVGlyphFilter_h
@@ -55,6 +62,12 @@ public:
     SPATIALLY_UNIFORM_DISTRIBUTION
   };
 
+  enum OutputModeType
+  {
+    GLYPH_GEOMETRY,
+    GLYPH_INSTANCES
+  };
+
   vtkTypeMacro(vtkPVGlyphFilter, vtkGlyph3D);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
   static vtkPVGlyphFilter* New();
@@ -102,6 +115,21 @@ public:
   vtkGetMacro(MaximumNumberOfSamplePoints, int);
   //@}
 
+  //@{
+  /**
+   * Set/Get what is generated for the glyphed points. GLYPH_GEOMETRY, the
+   * default, outputs the glyphs' geometry. GLYPH_INSTANCES outputs a vertex per
+   * glyphed point with the input point data and two 3-component arrays:
+   * "GlyphScale", the scale factors along each axis, and "GlyphOrientation",
+   * the direction the glyph's x axis is rotated to. These match the
+   * vtkGlyph3DMapper options to scale by components and to orient by
+   * direction, with a scale factor of 1. The glyph source and SourceTransform
+   * are not used in that mode.
+   */
+  vtkSetClampMacro(OutputMode, int, GLYPH_GEOMETRY, GLYPH_INSTANCES);
+  vtkGetMacro(OutputMode, int);
+  //@}
+
   //@{
   /**
    * Overridden to create output data of appropriate type.
@@ -152,7 +180,17 @@ protected:
   virtual bool ExecuteWithCellCenters(
     vtkDataSet* input, vtkInformationVector* sourceVector, vtkPolyData* output);
 
+  /**
+   * Glyphs the points of \c input selected by \c GlyphMode, generating the
+   * geometry or the instances depending on \c OutputMode. The geometry is
+   * generated by vtkGlyph3D::Execute() over chunks of the selected points in
+   * parallel, unless glyphs are indexed from several sources.
+   */
+  virtual bool ExecuteGlyphs(vtkDataSet* input, vtkInformationVector* sourceVector,
+    vtkPolyData* output, vtkDataArray* inSScalars, vtkDataArray* inVectors);
+
   int GlyphMode;
+  int OutputMode;
   int MaximumNumberOfSamplePoints;
   int Seed;
   int Stride;
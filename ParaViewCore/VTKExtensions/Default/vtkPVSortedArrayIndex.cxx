@@ -0,0 +1,445 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVSortedArrayIndex.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPVSortedArrayIndex.h"
+
+#include "vtkArrayDispatch.h"
+#include "vtkCallbackCommand.h"
+#include "vtkDataArray.h"
+#include "vtkDataArrayAccessor.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+#include "vtkSimpleCriticalSection.h"
+#include "vtkWeakPointer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+// Extracts a component (or the magnitude, for component -1) of the tuples.
+// As numpy does, the magnitude of floating point values is computed in their
+// own type.
+template <typename ArrayT>
+class vtkExtractValues
+{
+  typedef typename vtkDataArrayAccessor<ArrayT>::APIType ValueType;
+  typedef typename std::conditional<std::is_floating_point<ValueType>::value, ValueType,
+    double>::type MagnitudeType;
+
+public:
+  vtkExtractValues(ArrayT* array, int component, double* values)
+    : Array(array)
+    , Component(component)
+    , Values(values)
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataArrayAccessor<ArrayT> accessor(this->Array);
+    const int numComps = this->Array->GetNumberOfComponents();
+    for (vtkIdType cc = begin; cc < end; ++cc)
+    {
+      if (this->Component >= 0)
+      {
+        this->Values[cc] = static_cast<double>(accessor.Get(cc, this->Component));
+      }
+      else
+      {
+        MagnitudeType sum = 0;
+        for (int comp = 0; comp < numComps; comp++)
+        {
+          const MagnitudeType value = static_cast<MagnitudeType>(accessor.Get(cc, comp));
+          sum += value * value;
+        }
+        this->Values[cc] = static_cast<double>(std::sqrt(sum));
+      }
+    }
+  }
+
+private:
+  ArrayT* Array;
+  int Component;
+  double* Values;
+};
+
+struct vtkExtractValuesWorker
+{
+  vtkExtractValuesWorker(int component, double* values)
+    : Component(component)
+    , Values(values)
+  {
+  }
+
+  template <typename ArrayT>
+  void operator()(ArrayT* array)
+  {
+    vtkExtractValues<ArrayT> functor(array, this->Component, this->Values);
+    vtkSMPTools::For(0, array->GetNumberOfTuples(), functor);
+  }
+
+  int Component;
+  double* Values;
+};
+
+//----------------------------------------------------------------------------
+// Orders ids by value, NaNs last, then by id.
+class vtkValueOrder
+{
+public:
+  vtkValueOrder(const std::vector<double>& values)
+    : Values(&values[0])
+  {
+  }
+
+  bool operator()(vtkIdType a, vtkIdType b) const
+  {
+    const double va = this->Values[a];
+    const double vb = this->Values[b];
+    const bool nana = vtkMath::IsNan(va);
+    const bool nanb = vtkMath::IsNan(vb);
+    if (nana || nanb)
+    {
+      return nana != nanb ? nanb : a < b;
+    }
+    return va != vb ? va < vb : a < b;
+  }
+
+private:
+  const double* Values;
+};
+
+//----------------------------------------------------------------------------
+// Ids of the non-NaN values sorted by value, and the matching values.
+struct vtkSortedIndex
+{
+  std::vector<double> Values;
+  std::vector<vtkIdType> Ids;
+
+  void Build(vtkDataArray* array, int component)
+  {
+    const vtkIdType numTuples = array->GetNumberOfTuples();
+    std::vector<double> values(numTuples);
+    std::vector<vtkIdType> order(numTuples);
+    if (numTuples > 0)
+    {
+      vtkExtractValuesWorker worker(component, &values[0]);
+      if (!vtkArrayDispatch::Dispatch::Execute(array, worker))
+      {
+        worker(array);
+      }
+    }
+    for (vtkIdType cc = 0; cc < numTuples; ++cc)
+    {
+      order[cc] = cc;
+    }
+    if (numTuples > 1)
+    {
+      vtkSMPTools::Sort(order.begin(), order.end(), vtkValueOrder(values));
+    }
+
+    vtkIdType numValid = numTuples;
+    while (numValid > 0 && vtkMath::IsNan(values[order[numValid - 1]]))
+    {
+      --numValid;
+    }
+    order.resize(numValid);
+    this->Values.resize(numValid);
+    for (vtkIdType cc = 0; cc < numValid; ++cc)
+    {
+      this->Values[cc] = values[order[cc]];
+    }
+    this->Ids.swap(order);
+  }
+
+  // Copies the ids of positions [begin, end) to the output, sorted by id.
+  vtkIdType CopyIds(size_t begin, size_t end, vtkIdTypeArray* ids) const
+  {
+    const vtkIdType count = static_cast<vtkIdType>(end > begin ? end - begin : 0);
+    ids->SetNumberOfComponents(1);
+    ids->SetNumberOfTuples(count);
+    if (count > 0)
+    {
+      vtkIdType* output = ids->GetPointer(0);
+      std::copy(this->Ids.begin() + begin, this->Ids.begin() + end, output);
+      vtkSMPTools::Sort(output, output + count);
+    }
+    return count;
+  }
+};
+
+//----------------------------------------------------------------------------
+// The cache does not keep arrays alive. Entries are released when their array
+// is deleted.
+class vtkIndexCache
+{
+public:
+  vtkIndexCache()
+    : Limit(1024 * 1024)
+    , Size(0)
+    , Counter(0)
+  {
+    this->DeleteObserver->SetCallback(&vtkIndexCache::OnArrayDeleted);
+    this->DeleteObserver->SetClientData(this);
+  }
+
+  ~vtkIndexCache() { this->Clear(); }
+
+  // Returns the index for the array component, building it if needed. The
+  // cache stays locked until Release() is called.
+  const vtkSortedIndex& Acquire(vtkDataArray* array, int component)
+  {
+    this->Lock.Lock();
+
+    Entry& entry = this->Entries[KeyType(array, component)];
+    if (!entry.Array)
+    {
+      entry.Array = array;
+      entry.ObserverTag = array->AddObserver(vtkCommand::DeleteEvent, this->DeleteObserver);
+    }
+    if (!entry.Built || entry.ArrayMTime != array->GetMTime())
+    {
+      this->Size -= std::min(this->Size, entry.Size);
+
+      entry.Index.Build(array, component);
+      entry.Built = true;
+      entry.ArrayMTime = array->GetMTime();
+      entry.Size = static_cast<unsigned long>(
+        (entry.Index.Ids.size() * (sizeof(double) + sizeof(vtkIdType))) / 1024 + 1);
+      this->Size += entry.Size;
+    }
+    entry.LastUse = ++this->Counter;
+    return entry.Index;
+  }
+
+  // Unlocks the cache once the index returned by Acquire() is no longer used.
+  // Indices are evicted at this point, including the one that was just used
+  // if it does not fit in the limit by itself.
+  void Release()
+  {
+    this->ReleaseLeastRecentlyUsed();
+    this->Lock.Unlock();
+  }
+
+  void Clear()
+  {
+    this->Lock.Lock();
+    for (EntriesType::iterator iter = this->Entries.begin(); iter != this->Entries.end(); ++iter)
+    {
+      this->RemoveObserver(iter->second);
+    }
+    this->Entries.clear();
+    this->Size = 0;
+    this->Lock.Unlock();
+  }
+
+  unsigned long Limit;
+  unsigned long Size;
+
+private:
+  typedef std::pair<vtkDataArray*, int> KeyType;
+  struct Entry
+  {
+    Entry()
+      : Built(false)
+      , ArrayMTime(0)
+      , Size(0)
+      , LastUse(0)
+      , ObserverTag(0)
+    {
+    }
+    vtkWeakPointer<vtkDataArray> Array;
+    vtkSortedIndex Index;
+    bool Built;
+    vtkMTimeType ArrayMTime;
+    unsigned long Size;
+    vtkTypeUInt64 LastUse;
+    unsigned long ObserverTag;
+  };
+  typedef std::map<KeyType, Entry> EntriesType;
+
+  // Releases the entries, one per indexed component, of an array being
+  // deleted.
+  static void OnArrayDeleted(vtkObject* caller, unsigned long, void* clientdata, void*)
+  {
+    vtkIndexCache* self = reinterpret_cast<vtkIndexCache*>(clientdata);
+    vtkDataArray* array = static_cast<vtkDataArray*>(caller);
+    self->Lock.Lock();
+    EntriesType::iterator iter = self->Entries.lower_bound(KeyType(array, -1));
+    while (iter != self->Entries.end() && iter->first.first == array)
+    {
+      self->Size -= std::min(self->Size, iter->second.Size);
+      self->Entries.erase(iter++);
+    }
+    self->Lock.Unlock();
+  }
+
+  void RemoveObserver(Entry& entry)
+  {
+    if (entry.Array)
+    {
+      entry.Array->RemoveObserver(entry.ObserverTag);
+    }
+  }
+
+  // Releases the least recently used indices until the cache fits in its
+  // limit.
+  void ReleaseLeastRecentlyUsed()
+  {
+    while (this->Size > this->Limit && !this->Entries.empty())
+    {
+      EntriesType::iterator oldest = this->Entries.begin();
+      for (EntriesType::iterator iter = this->Entries.begin(); iter != this->Entries.end(); ++iter)
+      {
+        if (iter->second.LastUse < oldest->second.LastUse)
+        {
+          oldest = iter;
+        }
+      }
+      this->Size -= std::min(this->Size, oldest->second.Size);
+      this->RemoveObserver(oldest->second);
+      this->Entries.erase(oldest);
+    }
+  }
+
+  EntriesType Entries;
+  vtkTypeUInt64 Counter;
+  vtkSimpleCriticalSection Lock;
+  vtkNew<vtkCallbackCommand> DeleteObserver;
+};
+
+vtkIndexCache& vtkGetIndexCache()
+{
+  static vtkIndexCache cache;
+  return cache;
+}
+
+bool vtkIsValidComponent(vtkDataArray* array, int component)
+{
+  return array && component >= -1 && component < array->GetNumberOfComponents();
+}
+
+// Rounds a bound to the value type of the array, as numpy does when comparing
+// a float array with a Python float, so that the values indexed as doubles
+// are compared as they would be in their own type.
+double vtkRoundToValueType(vtkDataArray* array, double value)
+{
+  if (array->GetDataType() != VTK_FLOAT || vtkMath::IsNan(value) || vtkMath::IsInf(value))
+  {
+    return value;
+  }
+  if (std::abs(value) > VTK_FLOAT_MAX)
+  {
+    return value > 0 ? vtkMath::Inf() : vtkMath::NegInf();
+  }
+  return static_cast<double>(static_cast<float>(value));
+}
+}
+
+vtkStandardNewMacro(vtkPVSortedArrayIndex);
+//----------------------------------------------------------------------------
+vtkPVSortedArrayIndex::vtkPVSortedArrayIndex()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkPVSortedArrayIndex::~vtkPVSortedArrayIndex()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkPVSortedArrayIndex::SelectRange(vtkDataArray* array, int component,
+  double minValue, double maxValue, bool includeMin, bool includeMax, vtkIdTypeArray* ids)
+{
+  if (!vtkIsValidComponent(array, component) || !ids)
+  {
+    return -1;
+  }
+
+  minValue = vtkRoundToValueType(array, minValue);
+  maxValue = vtkRoundToValueType(array, maxValue);
+
+  vtkIndexCache& cache = vtkGetIndexCache();
+  const vtkSortedIndex& index = cache.Acquire(array, component);
+  std::vector<double>::const_iterator first = includeMin
+    ? std::lower_bound(index.Values.begin(), index.Values.end(), minValue)
+    : std::upper_bound(index.Values.begin(), index.Values.end(), minValue);
+  std::vector<double>::const_iterator last = includeMax
+    ? std::upper_bound(first, index.Values.end(), maxValue)
+    : std::lower_bound(first, index.Values.end(), maxValue);
+  vtkIdType count = index.CopyIds(first - index.Values.begin(), last - index.Values.begin(), ids);
+  cache.Release();
+  return count;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPVSortedArrayIndex::GetRange(vtkDataArray* array, int component, double range[2])
+{
+  if (!vtkIsValidComponent(array, component))
+  {
+    return false;
+  }
+
+  vtkIndexCache& cache = vtkGetIndexCache();
+  const vtkSortedIndex& index = cache.Acquire(array, component);
+  const bool valid = !index.Values.empty();
+  if (valid)
+  {
+    range[0] = index.Values.front();
+    range[1] = index.Values.back();
+  }
+  cache.Release();
+  return valid;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVSortedArrayIndex::SetCacheLimit(unsigned long kbytes)
+{
+  vtkGetIndexCache().Limit = kbytes;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPVSortedArrayIndex::GetCacheLimit()
+{
+  return vtkGetIndexCache().Limit;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPVSortedArrayIndex::GetCacheSize()
+{
+  return vtkGetIndexCache().Size;
+}
+
+//----------------------------------------------------------------------------
+void vtkPVSortedArrayIndex::ClearCache()
+{
+  vtkGetIndexCache().Clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkPVSortedArrayIndex::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CacheLimit: " << vtkPVSortedArrayIndex::GetCacheLimit() << endl;
+  os << indent << "CacheSize: " << vtkPVSortedArrayIndex::GetCacheSize() << endl;
+}
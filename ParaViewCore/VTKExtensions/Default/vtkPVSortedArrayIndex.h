@@ -0,0 +1,99 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    vtkPVSortedArrayIndex.h
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkPVSortedArrayIndex
+ * @brief   process-wide cache of sorted indices over data arrays.
+ *
+ * vtkPVSortedArrayIndex answers range queries on a component (or the
+ * magnitude) of a vtkDataArray using binary search over an index of the
+ * tuple ids sorted by value. Indices are built lazily, with vtkSMPTools, the
+ * first time an array is queried, and are kept in a cache shared by the
+ * process. An index is rebuilt when the array is modified.
+ *
+ * This is used by the Python code evaluating query selections
+ * (paraview.extract_selection) so that editing a Find Data query does not scan
+ * the whole dataset each time.
+ *
+ * As for vtkPVCachedCellLocator, the memory used by the cached indices is
+ * capped using SetCacheLimit(). When the limit is exceeded, the least recently
+ * used indices are released. The cache does not keep arrays alive: the
+ * indices of an array are released when the array is deleted.
+ *
+ * NaN values never match any query.
+*/
+
+#ifndef vtkPVSortedArrayIndex_h
+#define vtkPVSortedArrayIndex_h
+
+#include "vtkObject.h"
+#include "vtkPVVTKExtensionsDefaultModule.h" //needed for exports
+
+class vtkDataArray;
+class vtkIdTypeArray;
+
+class VTKPVVTKEXTENSIONSDEFAULT_EXPORT vtkPVSortedArrayIndex : public vtkObject
+{
+public:
+  static vtkPVSortedArrayIndex* New();
+  vtkTypeMacro(vtkPVSortedArrayIndex, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Fills \c ids with the ids, in increasing order, of the tuples of \c array
+   * whose value is between \c minValue and \c maxValue. \c component -1
+   * stands for the magnitude. The bounds are included or not depending on
+   * \c includeMin and \c includeMax. As in numpy, the bounds are rounded to
+   * the value type of float arrays before comparing. Returns the number of
+   * ids, or -1 if the component is invalid.
+   */
+  static vtkIdType SelectRange(vtkDataArray* array, int component, double minValue,
+    double maxValue, bool includeMin, bool includeMax, vtkIdTypeArray* ids);
+
+  /**
+   * Gets the range of the non-NaN values of a component. Returns false if
+   * there are no such values or if the component is invalid.
+   */
+  static bool GetRange(vtkDataArray* array, int component, double range[2]);
+
+  //@{
+  /**
+   * Get/Set the maximum memory used by the cached indices in the process (in
+   * KBs). An index larger than the limit is built for the query and released
+   * right after it. Default is 1 GB.
+   */
+  static void SetCacheLimit(unsigned long kbytes);
+  static unsigned long GetCacheLimit();
+  //@}
+
+  /**
+   * Returns the memory currently used by the cached indices (in KBs).
+   */
+  static unsigned long GetCacheSize();
+
+  /**
+   * Releases all cached indices.
+   */
+  static void ClearCache();
+
+protected:
+  vtkPVSortedArrayIndex();
+  ~vtkPVSortedArrayIndex() override;
+
+private:
+  vtkPVSortedArrayIndex(const vtkPVSortedArrayIndex&) = delete;
+  void operator=(const vtkPVSortedArrayIndex&) = delete;
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestResampledAMRImageSourceSampling.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Resamples a two level vtkOverlappingAMR, in 3D and in 2D (i.e. with a
+// degenerate third axis), and checks that each output point takes the values
+// of the donor cell containing it in the finest block, as located by
+// vtkImageData::ComputeStructuredCoordinates().
+
+#include "vtkAMRBox.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkOverlappingAMR.h"
+#include "vtkPointData.h"
+#include "vtkResampledAMRImageSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredData.h"
+#include "vtkUniformGrid.h"
+
+namespace
+{
+const int NUMBER_OF_LEVEL0_CELLS = 16;
+const int NUMBER_OF_SAMPLES = 8;
+
+// Creates a block of cellDims cells (a single layer of points along z in 2D)
+// whose cell values encode the level and the cell center, and whose point
+// values are the x coordinate.
+vtkSmartPointer<vtkUniformGrid> CreateBlock(
+  const double origin[3], const int cellDims[3], double h, int level, bool is2D)
+{
+  vtkSmartPointer<vtkUniformGrid> grid = vtkSmartPointer<vtkUniformGrid>::New();
+  grid->SetOrigin(origin[0], origin[1], origin[2]);
+  grid->SetSpacing(h, h, h);
+  grid->SetDimensions(cellDims[0] + 1, cellDims[1] + 1, is2D ? 1 : cellDims[2] + 1);
+
+  vtkNew<vtkDoubleArray> cellValues;
+  cellValues->SetName("CellValue");
+  cellValues->SetNumberOfTuples(grid->GetNumberOfCells());
+  const int nz = is2D ? 1 : cellDims[2];
+  vtkIdType cellId = 0;
+  for (int k = 0; k < nz; ++k)
+  {
+    for (int j = 0; j < cellDims[1]; ++j)
+    {
+      for (int i = 0; i < cellDims[0]; ++i, ++cellId)
+      {
+        const double x = origin[0] + (i + 0.5) * h;
+        const double y = origin[1] + (j + 0.5) * h;
+        const double z = is2D ? origin[2] : origin[2] + (k + 0.5) * h;
+        cellValues->SetValue(cellId, level + 10 * x + 1000 * y + 100000 * z);
+      }
+    }
+  }
+  grid->GetCellData()->AddArray(cellValues.GetPointer());
+
+  vtkNew<vtkDoubleArray> pointValues;
+  pointValues->SetName("PointValue");
+  pointValues->SetNumberOfTuples(grid->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < grid->GetNumberOfPoints(); ++cc)
+  {
+    pointValues->SetValue(cc, grid->GetPoint(cc)[0]);
+  }
+  grid->GetPointData()->AddArray(pointValues.GetPointer());
+  return grid;
+}
+
+// Level 0 covers [0, 16]^3 with unit cells. Level 1 has two blocks with cells
+// of size 0.5 whose boundaries do not go through any sample, i.e. any odd
+// coordinate.
+vtkSmartPointer<vtkOverlappingAMR> CreateAMR(bool is2D)
+{
+  const int gridDescription = is2D ? VTK_XY_PLANE : VTK_XYZ_GRID;
+  const double globalOrigin[3] = { 0, 0, 0 };
+  const double spacing[2][3] = { { 1, 1, 1 }, { 0.5, 0.5, 0.5 } };
+  const double origins[3][3] = { { 0, 0, 0 }, { 4, 4, 4 }, { 10, 2, 6 } };
+  const int cellDims[3][3] = { { NUMBER_OF_LEVEL0_CELLS, NUMBER_OF_LEVEL0_CELLS,
+                                 NUMBER_OF_LEVEL0_CELLS },
+    { 12, 12, 12 }, { 8, 12, 8 } };
+  const int levels[3] = { 0, 1, 1 };
+  const int indices[3] = { 0, 0, 1 };
+
+  vtkSmartPointer<vtkOverlappingAMR> amr = vtkSmartPointer<vtkOverlappingAMR>::New();
+  int blocksPerLevel[2] = { 1, 2 };
+  amr->Initialize(2, blocksPerLevel);
+  amr->SetGridDescription(gridDescription);
+  amr->SetOrigin(globalOrigin);
+  amr->SetSpacing(0, spacing[0]);
+  amr->SetSpacing(1, spacing[1]);
+  amr->SetRefinementRatio(0, 2);
+  amr->SetRefinementRatio(1, 2);
+  for (int cc = 0; cc < 3; ++cc)
+  {
+    double origin[3] = { origins[cc][0], origins[cc][1], is2D ? 0.0 : origins[cc][2] };
+    vtkSmartPointer<vtkUniformGrid> grid =
+      CreateBlock(origin, cellDims[cc], spacing[levels[cc]][0], levels[cc], is2D);
+    vtkAMRBox box(
+      grid->GetOrigin(), grid->GetDimensions(), spacing[levels[cc]], globalOrigin, gridDescription);
+    amr->SetAMRBox(levels[cc], indices[cc], box);
+    amr->SetDataSet(levels[cc], indices[cc], grid);
+  }
+  return amr;
+}
+
+// Returns the finest block containing x, and the id of the cell containing
+// it.
+vtkUniformGrid* FindDonor(vtkOverlappingAMR* amr, double x[3], vtkIdType& cellId)
+{
+  for (int level = static_cast<int>(amr->GetNumberOfLevels()) - 1; level >= 0; --level)
+  {
+    for (unsigned int index = 0; index < amr->GetNumberOfDataSets(level); ++index)
+    {
+      vtkUniformGrid* grid = amr->GetDataSet(level, index);
+      int ijk[3];
+      double pcoords[3];
+      if (grid && grid->ComputeStructuredCoordinates(x, ijk, pcoords))
+      {
+        cellId = vtkStructuredData::ComputeCellId(grid->GetDimensions(), ijk);
+        return grid;
+      }
+    }
+  }
+  return NULL;
+}
+
+bool TestSampling(bool is2D)
+{
+  const char* what = is2D ? "2D" : "3D";
+  vtkSmartPointer<vtkOverlappingAMR> amr = CreateAMR(is2D);
+
+  vtkNew<vtkResampledAMRImageSource> resampler;
+  resampler->SetMaxDimensions(NUMBER_OF_SAMPLES, NUMBER_OF_SAMPLES, NUMBER_OF_SAMPLES);
+  resampler->UpdateResampledVolume(amr);
+  vtkImageData* output = vtkImageData::SafeDownCast(resampler->GetOutputDataObject(0));
+
+  const int expectedDims[3] = { NUMBER_OF_SAMPLES, NUMBER_OF_SAMPLES,
+    is2D ? 1 : NUMBER_OF_SAMPLES };
+  if (!output || output->GetDimensions()[0] != expectedDims[0] ||
+    output->GetDimensions()[1] != expectedDims[1] || output->GetDimensions()[2] != expectedDims[2])
+  {
+    cerr << "ERROR: " << what << " resampled volume does not have " << expectedDims[0] << "x"
+         << expectedDims[1] << "x" << expectedDims[2] << " points." << endl;
+    return false;
+  }
+  vtkDataArray* cellValues = output->GetPointData()->GetArray("CellValue");
+  vtkDataArray* pointValues = output->GetPointData()->GetArray("PointValue");
+  if (!cellValues || !pointValues)
+  {
+    cerr << "ERROR: " << what << " resampled arrays missing." << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType cc = 0; cc < output->GetNumberOfPoints(); ++cc)
+  {
+    // Samples are at the centers of the cells of the resampled volume.
+    double x[3];
+    output->GetPoint(cc, x);
+    const double expectedX = 1.0 + 2.0 * (cc % NUMBER_OF_SAMPLES);
+    vtkIdType cellId;
+    vtkUniformGrid* donor = FindDonor(amr, x, cellId);
+    if (x[0] != expectedX || !donor)
+    {
+      cerr << "ERROR: " << what << " sample " << cc << " at (" << x[0] << ", " << x[1] << ", "
+           << x[2] << ") instead of x = " << expectedX << endl;
+      return false;
+    }
+
+    donor->GetCellPoints(cellId, ptIds.GetPointer());
+    vtkDataArray* donorPointValues = donor->GetPointData()->GetArray("PointValue");
+    double expectedPointValue = 0.0;
+    for (vtkIdType pt = 0; pt < ptIds->GetNumberOfIds(); ++pt)
+    {
+      expectedPointValue += donorPointValues->GetComponent(ptIds->GetId(pt), 0);
+    }
+    expectedPointValue /= ptIds->GetNumberOfIds();
+
+    const double expectedCellValue =
+      donor->GetCellData()->GetArray("CellValue")->GetComponent(cellId, 0);
+    if (cellValues->GetComponent(cc, 0) != expectedCellValue ||
+      pointValues->GetComponent(cc, 0) != expectedPointValue)
+    {
+      cerr << "ERROR: " << what << " sample " << cc << " at (" << x[0] << ", " << x[1] << ", "
+           << x[2] << ") has values " << cellValues->GetComponent(cc, 0) << " and "
+           << pointValues->GetComponent(cc, 0) << " instead of " << expectedCellValue << " and "
+           << expectedPointValue << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestResampledAMRImageSourceSampling(int, char* [])
+{
+  bool success = TestSampling(false);
+  success &= TestSampling(true);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
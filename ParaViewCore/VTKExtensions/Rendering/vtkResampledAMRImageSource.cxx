@@ -16,9 +16,10 @@
 
 #include "vtkAMRBox.h"
 #include "vtkAMRInformation.h"
+#include "vtkArrayDispatch.h"
 #include "vtkBoundingBox.h"
 #include "vtkCellData.h"
-#include "vtkIdList.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkIntArray.h"
 #include "vtkMath.h"
 #include "vtkNew.h"
@@ -26,20 +27,442 @@
 #include "vtkOverlappingAMR.h"
 #include "vtkPVStreamingMacros.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkUniformGrid.h"
 #include "vtkUniformGridAMRDataIterator.h"
-#include "vtkVoxel.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace
 {
-static inline vtkIdType FindCell(vtkImageData* image, double point[3])
+// Fills the receiver cells covered by a donor block. Donor cells are located
+// using index arithmetic on the donor's origin and spacing, and the receiver
+// is filled in parallel, one z-slice at a time. Since each receiver cell is
+// written by exactly one slice, arrays are simply pre-sized in
+// vtkResampledAMRImageSource::Initialize() and written directly. Arrays
+// sharing the memory layout of their target are copied with memcpy, other
+// data arrays through vtkArrayDispatch, and the remaining ones serially.
+class vtkResampleBlockWorker
 {
-  double pcoords[3];
-  int subid = 0;
-  return image->vtkImageData::FindCell(point, NULL, -1, 0.1, subid, pcoords, NULL);
+public:
+  struct ArrayPair
+  {
+    vtkAbstractArray* Source;
+    vtkAbstractArray* Target;
+    const unsigned char* SourcePointer;
+    unsigned char* TargetPointer;
+    size_t TupleSize;
+  };
+
+  int ReceiverCellDims[3];
+  int ReceiverMin[3];
+  int ReceiverMax[3];
+  int DonorCellDims[3];
+  int DonorPointDims[3];
+  std::vector<int> DonorIndex[3];
+  int* DonorLevel;
+  int Level;
+  std::vector<ArrayPair> CellArrays;
+  std::vector<std::pair<vtkDataArray*, vtkDataArray*> > PointArrays;
+  std::vector<vtkIdType> CornerOffsets;
+  vtkSMPThreadLocal<unsigned char> Changed;
+
+  // Returns false if no receiver cell center falls in the donor.
+  bool Initialize(vtkImageData* receiver, vtkImageData* donor)
+  {
+    double rorigin[3], rspacing[3], dorigin[3], dspacing[3], dbounds[6];
+    int rdims[3];
+    receiver->GetOrigin(rorigin);
+    receiver->GetSpacing(rspacing);
+    receiver->GetDimensions(rdims);
+    donor->GetOrigin(dorigin);
+    donor->GetSpacing(dspacing);
+    donor->GetDimensions(this->DonorPointDims);
+    donor->GetBounds(dbounds);
+
+    for (int cc = 0; cc < 3; cc++)
+    {
+      this->ReceiverCellDims[cc] = std::max(rdims[cc] - 1, 1);
+      this->DonorCellDims[cc] = std::max(this->DonorPointDims[cc] - 1, 1);
+
+      if (this->DonorPointDims[cc] <= 1 || rdims[cc] <= 1 || rspacing[cc] <= 0.0)
+      {
+        // Degenerate axis, e.g. the third axis of 2D AMR. The donor has no
+        // extent along it (or the receiver has a single layer), so it covers
+        // the one receiver layer containing it instead of an empty range.
+        int idx = 0;
+        if (rdims[cc] > 1 && rspacing[cc] > 0.0)
+        {
+          idx = static_cast<int>(std::floor((dbounds[2 * cc] - rorigin[cc]) / rspacing[cc]));
+          if (idx < 0 || idx >= this->ReceiverCellDims[cc])
+          {
+            return false;
+          }
+        }
+        this->ReceiverMin[cc] = this->ReceiverMax[cc] = idx;
+      }
+      else
+      {
+        // receiver cells whose centers lie in [min, max) of the donor.
+        this->ReceiverMin[cc] = std::max(
+          static_cast<int>(std::ceil((dbounds[2 * cc] - rorigin[cc]) / rspacing[cc] - 0.5)), 0);
+        this->ReceiverMax[cc] =
+          std::min(static_cast<int>(
+                     std::ceil((dbounds[2 * cc + 1] - rorigin[cc]) / rspacing[cc] - 0.5)) -
+              1,
+            this->ReceiverCellDims[cc] - 1);
+        if (this->ReceiverMin[cc] > this->ReceiverMax[cc])
+        {
+          return false;
+        }
+      }
+
+      this->DonorIndex[cc].resize(this->ReceiverMax[cc] - this->ReceiverMin[cc] + 1);
+      for (int idx = this->ReceiverMin[cc]; idx <= this->ReceiverMax[cc]; idx++)
+      {
+        double center = rorigin[cc] + (idx + 0.5) * rspacing[cc];
+        int didx = dspacing[cc] > 0
+          ? static_cast<int>(std::floor((center - dorigin[cc]) / dspacing[cc]))
+          : 0;
+        this->DonorIndex[cc][idx - this->ReceiverMin[cc]] =
+          std::min(std::max(didx, 0), this->DonorCellDims[cc] - 1);
+      }
+    }
+
+    // Offsets of the points of a donor cell from its first point.
+    this->CornerOffsets.clear();
+    const vtkIdType strides[3] = { 1, this->DonorPointDims[0],
+      static_cast<vtkIdType>(this->DonorPointDims[0]) * this->DonorPointDims[1] };
+    for (int k = 0; k < (this->DonorPointDims[2] > 1 ? 2 : 1); k++)
+    {
+      for (int j = 0; j < (this->DonorPointDims[1] > 1 ? 2 : 1); j++)
+      {
+        for (int i = 0; i < (this->DonorPointDims[0] > 1 ? 2 : 1); i++)
+        {
+          this->CornerOffsets.push_back(i * strides[0] + j * strides[1] + k * strides[2]);
+        }
+      }
+    }
+    return true;
+  }
+
+  void AddCellArrays(vtkFieldData* source, vtkFieldData* target)
+  {
+    this->CellArrays.clear();
+    for (int cc = 0; cc < target->GetNumberOfArrays(); cc++)
+    {
+      vtkAbstractArray* tarray = target->GetAbstractArray(cc);
+      vtkAbstractArray* sarray =
+        tarray->GetName() ? source->GetAbstractArray(tarray->GetName()) : NULL;
+      if (!sarray || sarray->GetNumberOfComponents() != tarray->GetNumberOfComponents())
+      {
+        continue;
+      }
+      ArrayPair pair = { sarray, tarray, NULL, NULL, 0 };
+      if (sarray->GetDataType() == tarray->GetDataType() &&
+        vtkDataArray::SafeDownCast(sarray) && sarray->HasStandardMemoryLayout() &&
+        tarray->HasStandardMemoryLayout())
+      {
+        pair.SourcePointer = static_cast<const unsigned char*>(sarray->GetVoidPointer(0));
+        pair.TargetPointer = static_cast<unsigned char*>(tarray->GetVoidPointer(0));
+        pair.TupleSize = static_cast<size_t>(tarray->GetNumberOfComponents()) *
+          static_cast<size_t>(tarray->GetDataTypeSize());
+      }
+      this->CellArrays.push_back(pair);
+    }
+  }
+
+  void AddPointArrays(vtkFieldData* source, vtkFieldData* target)
+  {
+    this->PointArrays.clear();
+    for (int cc = 0; target && cc < target->GetNumberOfArrays(); cc++)
+    {
+      vtkDataArray* tarray = target->GetArray(cc);
+      vtkDataArray* sarray = (tarray && tarray->GetName()) ? source->GetArray(tarray->GetName())
+                                                           : NULL;
+      if (sarray && sarray->GetNumberOfComponents() == tarray->GetNumberOfComponents())
+      {
+        this->PointArrays.push_back(std::make_pair(sarray, tarray));
+      }
+    }
+  }
+
+  // Calls functor(rid, did, pid, run) for each run of receiver cells in the
+  // slices [begin, end) that the donor may write, i.e. whose current donor is
+  // not from a finer level. rid, did and pid are the first receiver cell,
+  // donor cell and donor point of the run; the run maps to consecutive donor
+  // cells.
+  template <typename FunctorT>
+  void ForEachRun(vtkIdType begin, vtkIdType end, FunctorT& functor) const
+  {
+    const vtkIdType rsliceSize =
+      static_cast<vtkIdType>(this->ReceiverCellDims[0]) * this->ReceiverCellDims[1];
+    const vtkIdType dsliceSize =
+      static_cast<vtkIdType>(this->DonorCellDims[0]) * this->DonorCellDims[1];
+    const vtkIdType dpsliceSize =
+      static_cast<vtkIdType>(this->DonorPointDims[0]) * this->DonorPointDims[1];
+    const int nx = static_cast<int>(this->DonorIndex[0].size());
+
+    for (vtkIdType kk = begin; kk < end; kk++)
+    {
+      const int dk = this->DonorIndex[2][kk];
+      for (int jj = 0; jj < static_cast<int>(this->DonorIndex[1].size()); jj++)
+      {
+        const int dj = this->DonorIndex[1][jj];
+        const vtkIdType rrow = (this->ReceiverMin[2] + kk) * rsliceSize +
+          (this->ReceiverMin[1] + jj) * this->ReceiverCellDims[0] + this->ReceiverMin[0];
+        const vtkIdType drow = dk * dsliceSize + dj * this->DonorCellDims[0];
+        const vtkIdType dprow = dk * dpsliceSize + dj * this->DonorPointDims[0];
+
+        for (int ii = 0; ii < nx;)
+        {
+          if (this->DonorLevel[rrow + ii] > this->Level)
+          {
+            ++ii;
+            continue;
+          }
+
+          // Find the run of receiver cells mapping to consecutive donor cells
+          // so that they can be copied at once.
+          int run = 1;
+          while (ii + run < nx && this->DonorIndex[0][ii + run] == this->DonorIndex[0][ii] + run &&
+            this->DonorLevel[rrow + ii + run] <= this->Level)
+          {
+            ++run;
+          }
+
+          functor(rrow + ii, drow + this->DonorIndex[0][ii], dprow + this->DonorIndex[0][ii], run);
+          ii += run;
+        }
+      }
+    }
+  }
+
+  // Copies the memcpy-able cell arrays and marks the cells as coming from
+  // this level. Run last since it updates DonorLevel.
+  struct FillRun
+  {
+    vtkResampleBlockWorker* Self;
+    unsigned char* Changed;
+    void operator()(vtkIdType rid, vtkIdType did, vtkIdType, int run)
+    {
+      for (size_t cc = 0; cc < this->Self->CellArrays.size(); cc++)
+      {
+        const ArrayPair& pair = this->Self->CellArrays[cc];
+        if (pair.TargetPointer)
+        {
+          memcpy(pair.TargetPointer + rid * pair.TupleSize,
+            pair.SourcePointer + did * pair.TupleSize, run * pair.TupleSize);
+        }
+      }
+      for (int r = 0; r < run; r++)
+      {
+        this->Self->DonorLevel[rid + r] = this->Self->Level;
+      }
+      *this->Changed = 1;
+    }
+  };
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    FillRun functor = { this, &this->Changed.Local() };
+    this->ForEachRun(begin, end, functor);
+  }
+
+  // Fills the cell and point arrays that could not be memcpy'ed. Must be
+  // called before the vtkSMPTools::For() on this worker.
+  void FillOtherArrays();
+};
+
+// Copies donor cell tuples, using the typed API of both arrays.
+template <typename SourceArrayT, typename TargetArrayT>
+struct vtkCopyCellRun
+{
+  SourceArrayT* Source;
+  TargetArrayT* Target;
+  void operator()(vtkIdType rid, vtkIdType did, vtkIdType, int run)
+  {
+    vtkDataArrayAccessor<SourceArrayT> source(this->Source);
+    vtkDataArrayAccessor<TargetArrayT> target(this->Target);
+    const int numComps = this->Target->GetNumberOfComponents();
+    for (int r = 0; r < run; r++)
+    {
+      for (int comp = 0; comp < numComps; comp++)
+      {
+        target.Set(rid + r, comp, source.Get(did + r, comp));
+      }
+    }
+  }
+};
+
+// Sets receiver values to the average of the donor cell's point values,
+// using the typed API of both arrays.
+template <typename SourceArrayT, typename TargetArrayT>
+struct vtkAveragePointRun
+{
+  SourceArrayT* Source;
+  TargetArrayT* Target;
+  const std::vector<vtkIdType>* CornerOffsets;
+  void operator()(vtkIdType rid, vtkIdType, vtkIdType pid, int run)
+  {
+    typedef typename vtkDataArrayAccessor<TargetArrayT>::APIType TargetType;
+    vtkDataArrayAccessor<SourceArrayT> source(this->Source);
+    vtkDataArrayAccessor<TargetArrayT> target(this->Target);
+    const int numComps = this->Target->GetNumberOfComponents();
+    const double weight = 1.0 / this->CornerOffsets->size();
+    for (int r = 0; r < run; r++)
+    {
+      for (int comp = 0; comp < numComps; comp++)
+      {
+        double sum = 0.0;
+        for (size_t pt = 0; pt < this->CornerOffsets->size(); pt++)
+        {
+          sum += static_cast<double>(source.Get(pid + r + (*this->CornerOffsets)[pt], comp));
+        }
+        target.Set(rid + r, comp, static_cast<TargetType>(sum * weight));
+      }
+    }
+  }
+};
+
+// vtkSMPTools functor running a run functor over slices.
+template <typename RunFunctorT>
+struct vtkRunSlices
+{
+  const vtkResampleBlockWorker* Worker;
+  RunFunctorT Functor;
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    RunFunctorT functor = this->Functor;
+    this->Worker->ForEachRun(begin, end, functor);
+  }
+};
+
+template <typename RunFunctorT>
+void vtkForEachRunInParallel(const vtkResampleBlockWorker* worker, const RunFunctorT& functor)
+{
+  vtkRunSlices<RunFunctorT> slices = { worker, functor };
+  vtkSMPTools::For(0, static_cast<vtkIdType>(worker->DonorIndex[2].size()), slices);
+}
+
+// Dispatch workers.
+struct vtkCopyCellArray
+{
+  const vtkResampleBlockWorker* Worker;
+  template <typename SourceArrayT, typename TargetArrayT>
+  void operator()(SourceArrayT* source, TargetArrayT* target)
+  {
+    vtkCopyCellRun<SourceArrayT, TargetArrayT> functor = { source, target };
+    vtkForEachRunInParallel(this->Worker, functor);
+  }
+};
+
+struct vtkAveragePointArray
+{
+  const vtkResampleBlockWorker* Worker;
+  template <typename SourceArrayT, typename TargetArrayT>
+  void operator()(SourceArrayT* source, TargetArrayT* target)
+  {
+    vtkAveragePointRun<SourceArrayT, TargetArrayT> functor = { source, target,
+      &this->Worker->CornerOffsets };
+    vtkForEachRunInParallel(this->Worker, functor);
+  }
+};
+
+// Fallbacks for arrays vtkArrayDispatch does not handle. These use the
+// generic vtkAbstractArray/vtkDataArray API, which is not safe to call from
+// several threads, and thus run serially.
+struct vtkCopyCellRunGeneric
+{
+  vtkAbstractArray* Source;
+  vtkAbstractArray* Target;
+  void operator()(vtkIdType rid, vtkIdType did, vtkIdType, int run)
+  {
+    for (int r = 0; r < run; r++)
+    {
+      this->Target->SetTuple(rid + r, did + r, this->Source);
+    }
+  }
+};
+
+struct vtkAveragePointRunGeneric
+{
+  vtkDataArray* Source;
+  vtkDataArray* Target;
+  const std::vector<vtkIdType>* CornerOffsets;
+  void operator()(vtkIdType rid, vtkIdType, vtkIdType pid, int run)
+  {
+    const double weight = 1.0 / this->CornerOffsets->size();
+    for (int r = 0; r < run; r++)
+    {
+      for (int comp = 0; comp < this->Target->GetNumberOfComponents(); comp++)
+      {
+        double sum = 0.0;
+        for (size_t pt = 0; pt < this->CornerOffsets->size(); pt++)
+        {
+          sum += this->Source->GetComponent(pid + r + (*this->CornerOffsets)[pt], comp);
+        }
+        this->Target->SetComponent(rid + r, comp, sum * weight);
+      }
+    }
+  }
+};
+
+void vtkResampleBlockWorker::FillOtherArrays()
+{
+  const vtkIdType numSlices = static_cast<vtkIdType>(this->DonorIndex[2].size());
+  for (size_t cc = 0; cc < this->CellArrays.size(); cc++)
+  {
+    const ArrayPair& pair = this->CellArrays[cc];
+    if (pair.TargetPointer)
+    {
+      continue;
+    }
+    vtkDataArray* source = vtkDataArray::SafeDownCast(pair.Source);
+    vtkDataArray* target = vtkDataArray::SafeDownCast(pair.Target);
+    vtkCopyCellArray worker = { this };
+    if (!source || !target ||
+      !vtkArrayDispatch::Dispatch2SameValueType::Execute(source, target, worker))
+    {
+      vtkCopyCellRunGeneric functor = { pair.Source, pair.Target };
+      this->ForEachRun(0, numSlices, functor);
+    }
+  }
+
+  for (size_t cc = 0; cc < this->PointArrays.size(); cc++)
+  {
+    vtkDataArray* source = this->PointArrays[cc].first;
+    vtkDataArray* target = this->PointArrays[cc].second;
+    vtkAveragePointArray worker = { this };
+    if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(source, target, worker))
+    {
+      vtkAveragePointRunGeneric functor = { source, target, &this->CornerOffsets };
+      this->ForEachRun(0, numSlices, functor);
+    }
+  }
+}
+
+// Size arrays to hold one tuple per cell of the resampled volume so that they
+// can be filled in parallel.
+void vtkPreallocate(vtkFieldData* fd, vtkIdType numTuples)
+{
+  for (int cc = 0; fd && cc < fd->GetNumberOfArrays(); cc++)
+  {
+    vtkAbstractArray* array = fd->GetAbstractArray(cc);
+    array->SetNumberOfTuples(numTuples);
+    if (vtkDataArray* darray = vtkDataArray::SafeDownCast(array))
+    {
+      for (int comp = 0; comp < darray->GetNumberOfComponents(); comp++)
+      {
+        darray->FillComponent(comp, 0.0);
+      }
+    }
+  }
 }
 }
 
@@ -163,25 +586,24 @@ bool vtkResampledAMRImageSource::Initialize(vtkOverlappingAMR* amr)
 
   // now for a box covering the bounds, with this data-spacing, we can get the
   // following resolution.
+  // Axes along which the data has no extent, e.g. the third axis of 2D AMR,
+  // get no cells, i.e. a single layer of points.
   int data_dimensions[3];
-  data_dimensions[0] = static_cast<int>((bounds[1] - bounds[0]) / data_spacing[0]);
-  data_dimensions[1] = static_cast<int>((bounds[3] - bounds[2]) / data_spacing[1]);
-  data_dimensions[2] = static_cast<int>((bounds[5] - bounds[4]) / data_spacing[2]);
-
   int dimensions[3];
-  dimensions[0] = std::min(data_dimensions[0], this->MaxDimensions[0]);
-  dimensions[1] = std::min(data_dimensions[1], this->MaxDimensions[1]);
-  dimensions[2] = std::min(data_dimensions[2], this->MaxDimensions[2]);
+  double spacing[3];
+  for (int cc = 0; cc < 3; cc++)
+  {
+    const double extent = bounds[2 * cc + 1] - bounds[2 * cc];
+    data_dimensions[cc] =
+      (extent > 0.0 && data_spacing[cc] > 0.0) ? static_cast<int>(extent / data_spacing[cc]) : 0;
+    dimensions[cc] = std::min(data_dimensions[cc], this->MaxDimensions[cc]);
+    assert(extent <= 0.0 || dimensions[cc] >= 1);
+    spacing[cc] = dimensions[cc] > 0 ? extent / dimensions[cc] : 1.0;
+  }
 
   vtkStreamingStatusMacro("resampled image resolution: " << dimensions[0] << ", " << dimensions[1]
                                                          << ", " << dimensions[2]);
 
-  //---------------------------------------------------------------------------
-  assert(dimensions[0] >= 2 && dimensions[1] >= 2 && dimensions[2] >= 2);
-
-  double spacing[3] = { (bounds[1] - bounds[0]) / dimensions[0],
-    (bounds[3] - bounds[2]) / dimensions[1], (bounds[5] - bounds[4]) / dimensions[2] };
-
   double origin[3];
   origin[0] = bounds[0];
   origin[1] = bounds[2];
@@ -225,6 +647,7 @@ bool vtkResampledAMRImageSource::Initialize(vtkOverlappingAMR* amr)
   // Add point arrays in the output that correspond to the cell arrays in the
   // input.
   output->GetCellData()->CopyAllocate(reference->GetCellData(), numCells);
+  vtkPreallocate(output->GetCellData(), numCells);
 
   if (reference->GetPointData()->GetNumberOfArrays() > 0)
   {
@@ -234,6 +657,7 @@ bool vtkResampledAMRImageSource::Initialize(vtkOverlappingAMR* amr)
     // the dualGrid directly.
     this->ResampledAMRPointData = vtkSmartPointer<vtkPointData>::New();
     this->ResampledAMRPointData->InterpolateAllocate(reference->GetPointData(), numCells);
+    vtkPreallocate(this->ResampledAMRPointData, numCells);
   }
   else
   {
@@ -256,11 +680,18 @@ bool vtkResampledAMRImageSource::Initialize(vtkOverlappingAMR* amr)
 
   // the output of this filter is the dual grid on the resample AMR since.
   vtkNew<vtkImageData> dualGrid;
-  dualGrid->SetDimensions(
-    output->GetDimensions()[0] - 1, output->GetDimensions()[1] - 1, output->GetDimensions()[2] - 1);
-  dualGrid->SetOrigin(output->GetOrigin()[0] + output->GetSpacing()[0] / 2.0,
-    output->GetOrigin()[1] + output->GetSpacing()[1] / 2.0,
-    output->GetOrigin()[2] + output->GetSpacing()[2] / 2.0);
+  // Its points are the cell centers, or the single layer of points along axes
+  // without cells.
+  int dualDimensions[3];
+  double dualOrigin[3];
+  for (int cc = 0; cc < 3; cc++)
+  {
+    const bool hasCells = output->GetDimensions()[cc] > 1;
+    dualDimensions[cc] = hasCells ? output->GetDimensions()[cc] - 1 : 1;
+    dualOrigin[cc] = output->GetOrigin()[cc] + (hasCells ? output->GetSpacing()[cc] / 2.0 : 0.0);
+  }
+  dualGrid->SetDimensions(dualDimensions);
+  dualGrid->SetOrigin(dualOrigin);
   dualGrid->SetSpacing(output->GetSpacing());
   dualGrid->GetPointData()->PassData(output->GetCellData());
 
@@ -307,59 +738,28 @@ bool vtkResampledAMRImageSource::UpdateResampledVolume(
     return false;
   }
 
-  bool something_changed = false;
-  double receiver_spacing[3];
-  this->ResampledAMR->GetSpacing(receiver_spacing);
+  vtkResampleBlockWorker worker;
+  if (!worker.Initialize(this->ResampledAMR, donor))
+  {
+    return false;
+  }
+  worker.DonorLevel = this->DonorLevel->GetPointer(0);
+  worker.Level = static_cast<int>(level);
+  worker.AddCellArrays(donor->GetCellData(), this->ResampledAMR->GetCellData());
+  if (this->ResampledAMRPointData)
+  {
+    worker.AddPointArrays(donor->GetPointData(), this->ResampledAMRPointData);
+  }
 
-  vtkNew<vtkIdList> cellPoints;
+  // The other arrays first since the last pass updates the donor levels.
+  worker.FillOtherArrays();
+  vtkSMPTools::For(0, static_cast<vtkIdType>(worker.DonorIndex[2].size()), worker);
 
-  for (double z = updateBounds.GetMinPoint()[2]; z <= updateBounds.GetMaxPoint()[2];
-       z += receiver_spacing[2])
+  bool something_changed = false;
+  for (vtkSMPThreadLocal<unsigned char>::iterator iter = worker.Changed.begin();
+       iter != worker.Changed.end(); ++iter)
   {
-    for (double y = updateBounds.GetMinPoint()[1]; y <= updateBounds.GetMaxPoint()[1];
-         y += receiver_spacing[1])
-    {
-      for (double x = updateBounds.GetMinPoint()[0]; x < updateBounds.GetMaxPoint()[0];
-           x += receiver_spacing[0])
-      {
-        double sample_point[3] = { x, y, z };
-        vtkIdType receiver_cellid = FindCell(this->ResampledAMR, sample_point);
-        if (receiver_cellid == -1 || receiver_cellid >= this->DonorLevel->GetNumberOfTuples() ||
-          this->DonorLevel->GetValue(receiver_cellid) > static_cast<int>(level))
-        {
-          continue;
-        }
-        vtkIdType donor_cellId = FindCell(donor, sample_point);
-        if (donor_cellId == -1)
-        {
-          // the sample_point is not in the donor grid. This cannot happen since
-          // we have intersected the two boxes, but just in case.
-          continue;
-        }
-        this->ResampledAMR->GetCellData()->CopyData(
-          donor->GetCellData(), donor_cellId, receiver_cellid);
-        if (this->ResampledAMRPointData)
-        {
-          donor->GetCellPoints(donor_cellId, cellPoints.GetPointer());
-          vtkIdType numPoints = cellPoints->GetNumberOfIds();
-          assert(numPoints <= 8);
-          if (numPoints > 0)
-          {
-            double weight, weights[8];
-            weight = 1.0 / numPoints;
-            for (vtkIdType cc = 0; cc < numPoints; cc++)
-            {
-              weights[cc] = weight;
-            }
-
-            this->ResampledAMRPointData->InterpolatePoint(
-              donor->GetPointData(), receiver_cellid, cellPoints.GetPointer(), weights);
-          }
-        }
-        something_changed = true;
-        this->DonorLevel->SetValue(receiver_cellid, static_cast<int>(level));
-      }
-    }
+    something_changed |= (*iter != 0);
   }
   return something_changed;
 }
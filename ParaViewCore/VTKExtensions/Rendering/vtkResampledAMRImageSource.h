@@ -25,6 +25,17 @@
  * input AMR have exactly the same point/cell arrays in same order. If they are
  * different we will end up with weird runtime issues that may be hard to debug.
  *
+ * Each cell of the resampled volume is sampled at its center, which is also
+ * the position of the corresponding output point, and takes its values from
+ * the donor cell containing that center in the finest block available.
+ * Previous versions instead sampled at positions stepped, by the output
+ * spacing, from the lower corner of each block's intersection with the
+ * volume, so cells near a block boundary may now get their values from a
+ * different block. Donor cells are located
+ * using index arithmetic on the AMR blocks and the output is filled using
+ * vtkSMPTools. Axes along which the AMR has no extent, as the third axis of
+ * 2D AMR, yield a single layer of output points.
+ *
  * @attention
  * We subclass vtkTrivialProducer since it deals with all the meta-data that
  * needs to be passed down the pipeline for image data, keeping the code here
@@ -0,0 +1,195 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestAMRDualGridHelperAsynchronous.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the ghost values vtkAMRDualGridHelper copies into the local blocks
+// when the degenerate regions are exchanged asynchronously (BeginSetupData(),
+// WaitForRegionRemoteCopy(), FinishSetupData()) with the blocking exchange,
+// and checks that a helper destroyed before FinishSetupData() cancels its
+// requests instead of waiting on them.
+
+#include "vtkAMRDualGridHelper.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkMPIController.h"
+#include "vtkNew.h"
+#include "vtkNonOverlappingAMR.h"
+#include "vtkObjectFactory.h"
+#include "vtkOutputWindow.h"
+#include "vtkSmartPointer.h"
+#include "vtkSpyPlotReader.h"
+#include "vtkTestUtilities.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mpi.h>
+
+namespace
+{
+const char* ARRAY_NAME = "Material volume fraction - 2";
+
+// Records the errors reported.
+class vtkAsyncHelperOutputWindow : public vtkOutputWindow
+{
+public:
+  static vtkAsyncHelperOutputWindow* New();
+  vtkTypeMacro(vtkAsyncHelperOutputWindow, vtkOutputWindow);
+
+  void DisplayErrorText(const char* text) VTK_OVERRIDE { this->Errors += text; }
+
+  std::string Errors;
+
+private:
+  vtkAsyncHelperOutputWindow() {}
+};
+vtkStandardNewMacro(vtkAsyncHelperOutputWindow);
+
+typedef std::map<std::pair<int, int>, std::vector<double> > BlockValues;
+
+vtkSmartPointer<vtkNonOverlappingAMR> Read(const char* fname, vtkMultiProcessController* controller)
+{
+  vtkNew<vtkSpyPlotReader> reader;
+  reader->SetFileName(fname);
+  reader->SetGlobalController(controller);
+  reader->MergeXYZComponentsOn();
+  reader->DownConvertVolumeFractionOn();
+  // Split the blocks of the file between the processes.
+  reader->DistributeFilesOff();
+  reader->SetCellArrayStatus(ARRAY_NAME, 1);
+  reader->Update();
+  return vtkNonOverlappingAMR::SafeDownCast(reader->GetOutputDataObject(0));
+}
+
+// Returns the values of the local blocks, ghost cells included.
+BlockValues GetLocalValues(vtkAMRDualGridHelper* helper, int rank)
+{
+  BlockValues values;
+  for (int level = 0; level < helper->GetNumberOfLevels(); ++level)
+  {
+    for (int cc = 0; cc < helper->GetNumberOfBlocksInLevel(level); ++cc)
+    {
+      vtkAMRDualGridHelperBlock* block = helper->GetBlock(level, cc);
+      if (block->ProcessId != rank || !block->Image)
+      {
+        continue;
+      }
+      vtkDataArray* array = block->Image->GetCellData()->GetArray(ARRAY_NAME);
+      std::vector<double>& blockValues = values[std::make_pair(level, block->BlockId)];
+      for (vtkIdType idx = 0; array && idx < array->GetNumberOfTuples(); ++idx)
+      {
+        blockValues.push_back(array->GetComponent(idx, 0));
+      }
+    }
+  }
+  return values;
+}
+
+bool AllBlocksReady(vtkAMRDualGridHelper* helper)
+{
+  for (int level = 0; level < helper->GetNumberOfLevels(); ++level)
+  {
+    for (int cc = 0; cc < helper->GetNumberOfBlocksInLevel(level); ++cc)
+    {
+      if (!helper->IsBlockReady(helper->GetBlock(level, cc)))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 1);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+  const int rank = controller->GetLocalProcessId();
+
+  char* fname =
+    vtkTestUtilities::ExpandDataFileName(argc, argv, "Data/Dave_Karelitz_Small/spcth.0");
+
+  int success = 1;
+  {
+    // Reference: blocking exchange.
+    vtkSmartPointer<vtkNonOverlappingAMR> syncInput = Read(fname, controller.GetPointer());
+    vtkNew<vtkAMRDualGridHelper> syncHelper;
+    syncHelper->SetController(controller.GetPointer());
+    syncHelper->SetEnableAsynchronousCommunication(0);
+    syncHelper->Initialize(syncInput);
+    syncHelper->SetupData(syncInput, ARRAY_NAME);
+    BlockValues expected = GetLocalValues(syncHelper.GetPointer(), rank);
+
+    vtkSmartPointer<vtkNonOverlappingAMR> asyncInput = Read(fname, controller.GetPointer());
+    vtkNew<vtkAMRDualGridHelper> asyncHelper;
+    asyncHelper->SetController(controller.GetPointer());
+    asyncHelper->SetEnableAsynchronousCommunication(1);
+    asyncHelper->Initialize(asyncInput);
+    asyncHelper->BeginSetupData(asyncInput, ARRAY_NAME);
+    while (asyncHelper->WaitForRegionRemoteCopy())
+    {
+    }
+    if (!AllBlocksReady(asyncHelper.GetPointer()))
+    {
+      cerr << "ERROR: blocks still pending once every message was received." << endl;
+      success = 0;
+    }
+    asyncHelper->FinishSetupData();
+    BlockValues actual = GetLocalValues(asyncHelper.GetPointer(), rank);
+
+    if (expected.empty() || actual != expected)
+    {
+      cerr << "ERROR: rank " << rank << ": " << actual.size()
+           << " local blocks with asynchronous exchange differ from " << expected.size()
+           << " local blocks with blocking exchange." << endl;
+      success = 0;
+    }
+  }
+
+  {
+    // Destroying a helper with outstanding communication must neither hang
+    // nor go unreported.
+    vtkNew<vtkAsyncHelperOutputWindow> window;
+    vtkOutputWindow::SetInstance(window.GetPointer());
+    vtkSmartPointer<vtkNonOverlappingAMR> input = Read(fname, controller.GetPointer());
+    vtkAMRDualGridHelper* helper = vtkAMRDualGridHelper::New();
+    helper->SetController(controller.GetPointer());
+    helper->SetEnableAsynchronousCommunication(1);
+    helper->Initialize(input);
+    helper->BeginSetupData(input, ARRAY_NAME);
+    const bool pending = !AllBlocksReady(helper);
+    helper->Delete();
+    vtkOutputWindow::SetInstance(NULL);
+    if (pending && window->Errors.find("FinishSetupData") == std::string::npos)
+    {
+      cerr << "ERROR: outstanding communication was not reported." << endl;
+      success = 0;
+    }
+    controller->Barrier();
+  }
+  delete[] fname;
+
+  int allSuccess = 0;
+  controller->AllReduce(&success, &allSuccess, 1, vtkCommunicator::MIN_OP);
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return allSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+}
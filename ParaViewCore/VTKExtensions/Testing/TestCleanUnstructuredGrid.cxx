@@ -0,0 +1,331 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestCleanUnstructuredGrid.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the points merged by vtkCleanUnstructuredGrid, and the order they
+// are numbered in, with inserting the points one by one in a vtkMergePoints,
+// for unstructured grids (including polyhedra) and other datasets, and with a
+// brute force search when a tolerance is used.
+
+#include "vtkCellArray.h"
+#include "vtkCleanUnstructuredGrid.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMergePoints.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <utility>
+#include <vector>
+
+namespace
+{
+// Adds a point id array to the point data, to check which input point is kept.
+void AddPointIds(vtkDataSet* data)
+{
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("ids");
+  ids->SetNumberOfTuples(data->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < data->GetNumberOfPoints(); ++cc)
+  {
+    ids->SetValue(cc, cc);
+  }
+  data->GetPointData()->AddArray(ids.GetPointer());
+}
+
+// Hexahedra that do not share their points, in a shuffled order.
+vtkSmartPointer<vtkUnstructuredGrid> CreateHexahedra()
+{
+  const int dim = 12;
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->Allocate(dim * dim * dim);
+  for (int k = 0; k < dim; ++k)
+  {
+    for (int j = 0; j < dim; ++j)
+    {
+      for (int i = 0; i < dim; ++i)
+      {
+        vtkIdType ids[8];
+        for (int corner = 0; corner < 8; ++corner)
+        {
+          const int di = ((corner + 1) / 2) % 2, dj = (corner / 2) % 2, dk = corner / 4;
+          ids[corner] = points->InsertNextPoint(i + di, j + dj, k + dk);
+        }
+        grid->InsertNextCell(VTK_HEXAHEDRON, 8, ids);
+      }
+    }
+  }
+  grid->SetPoints(points.GetPointer());
+
+  // Shuffle the point ids.
+  const vtkIdType numPts = points->GetNumberOfPoints();
+  std::vector<vtkIdType> permutation(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    permutation[cc] = cc;
+  }
+  for (vtkIdType cc = numPts - 1; cc > 0; --cc)
+  {
+    random->Next();
+    std::swap(permutation[cc], permutation[static_cast<vtkIdType>(random->GetValue() * cc)]);
+  }
+  vtkNew<vtkPoints> shuffled;
+  shuffled->SetDataTypeToDouble();
+  shuffled->SetNumberOfPoints(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    shuffled->SetPoint(permutation[cc], points->GetPoint(cc));
+  }
+  vtkIdTypeArray* connectivity = grid->GetCells()->GetData();
+  for (vtkIdType cc = 0; cc < connectivity->GetNumberOfValues(); cc += 9)
+  {
+    for (int corner = 1; corner <= 8; ++corner)
+    {
+      connectivity->SetValue(cc + corner, permutation[connectivity->GetValue(cc + corner)]);
+    }
+  }
+  grid->SetPoints(shuffled.GetPointer());
+  AddPointIds(grid);
+  return grid;
+}
+
+// Two cubes given as polyhedra, with the points of their common face
+// duplicated.
+vtkSmartPointer<vtkUnstructuredGrid> CreatePolyhedra()
+{
+  vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  vtkNew<vtkPoints> points;
+  grid->Allocate(2);
+  for (int cube = 0; cube < 2; ++cube)
+  {
+    vtkIdType ids[8];
+    for (int corner = 0; corner < 8; ++corner)
+    {
+      ids[corner] = points->InsertNextPoint(
+        cube + ((corner + 1) / 2) % 2, (corner / 2) % 2, corner / 4);
+    }
+    vtkIdType faces[] = { 4, ids[0], ids[3], ids[2], ids[1], 4, ids[4], ids[5], ids[6], ids[7], 4,
+      ids[0], ids[1], ids[5], ids[4], 4, ids[1], ids[2], ids[6], ids[5], 4, ids[2], ids[3], ids[7],
+      ids[6], 4, ids[3], ids[0], ids[4], ids[7] };
+    grid->InsertNextCell(VTK_POLYHEDRON, 8, ids, 6, faces);
+  }
+  grid->SetPoints(points.GetPointer());
+  AddPointIds(grid);
+  return grid;
+}
+
+// Triangles that do not share their points.
+vtkSmartPointer<vtkPolyData> CreateTriangles()
+{
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j < 20; ++j)
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      vtkIdType ids[3];
+      ids[0] = points->InsertNextPoint(i, j, 0);
+      ids[1] = points->InsertNextPoint(i + 1, j, 0);
+      ids[2] = points->InsertNextPoint(i + (j % 2), j + 1, 0);
+      polys->InsertNextCell(3, ids);
+    }
+  }
+  data->SetPoints(points.GetPointer());
+  data->SetPolys(polys.GetPointer());
+  AddPointIds(data);
+  return data;
+}
+
+// Points jittered around the nodes of a grid, and points far from any other.
+vtkSmartPointer<vtkUnstructuredGrid> CreateCloud(double tolerance)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(7);
+  vtkNew<vtkPoints> points;
+  vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->Allocate(3000);
+  for (vtkIdType cc = 0; cc < 3000; ++cc)
+  {
+    double x[3];
+    random->Next();
+    const bool isolated = random->GetValue() < 0.2;
+    for (int comp = 0; comp < 3; ++comp)
+    {
+      random->Next();
+      x[comp] = isolated ? random->GetRangeValue(0.0, 10.0)
+                         : static_cast<int>(random->GetValue() * 10) +
+          random->GetRangeValue(-0.4, 0.4) * tolerance;
+    }
+    vtkIdType id = points->InsertNextPoint(x);
+    grid->InsertNextCell(VTK_VERTEX, 1, &id);
+  }
+  grid->SetPoints(points.GetPointer());
+  AddPointIds(grid);
+  return grid;
+}
+
+// Inserts the points one by one in a vtkMergePoints.
+void MergeReference(vtkDataSet* input, std::vector<vtkIdType>& ptMap, vtkPoints* merged)
+{
+  vtkNew<vtkMergePoints> locator;
+  locator->InitPointInsertion(merged, input->GetBounds(), input->GetNumberOfPoints());
+  ptMap.resize(input->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < input->GetNumberOfPoints(); ++cc)
+  {
+    locator->InsertUniquePoint(input->GetPoint(cc), ptMap[cc]);
+  }
+}
+
+// Merges a point with the point of lowest id within the tolerance, comparing
+// the coordinates in single precision.
+void MergeWithinTolerance(
+  vtkDataSet* input, double tolerance, std::vector<vtkIdType>& ptMap, vtkPoints* merged)
+{
+  const vtkIdType numPts = input->GetNumberOfPoints();
+  std::vector<float> coords(3 * numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    double x[3];
+    input->GetPoint(cc, x);
+    for (int comp = 0; comp < 3; ++comp)
+    {
+      coords[3 * cc + comp] = static_cast<float>(x[comp]);
+    }
+  }
+  ptMap.resize(numPts);
+  for (vtkIdType cc = 0; cc < numPts; ++cc)
+  {
+    vtkIdType best = cc;
+    for (vtkIdType other = 0; other < cc; ++other)
+    {
+      const double dx = coords[3 * cc] - coords[3 * other];
+      const double dy = coords[3 * cc + 1] - coords[3 * other + 1];
+      const double dz = coords[3 * cc + 2] - coords[3 * other + 2];
+      if (dx * dx + dy * dy + dz * dz <= tolerance * tolerance)
+      {
+        best = other;
+        break;
+      }
+    }
+    ptMap[cc] = best == cc ? merged->InsertNextPoint(&coords[3 * cc]) : ptMap[best];
+  }
+}
+
+bool CheckOutput(const char* name, vtkDataSet* input, vtkUnstructuredGrid* output,
+  const std::vector<vtkIdType>& ptMap, vtkPoints* merged)
+{
+  if (output->GetNumberOfPoints() != merged->GetNumberOfPoints() ||
+    output->GetNumberOfCells() != input->GetNumberOfCells())
+  {
+    cerr << "ERROR: " << name << ": " << output->GetNumberOfPoints() << " points and "
+         << output->GetNumberOfCells() << " cells instead of " << merged->GetNumberOfPoints()
+         << " and " << input->GetNumberOfCells() << endl;
+    return false;
+  }
+  vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(output->GetPointData()->GetArray("ids"));
+  for (vtkIdType cc = 0; cc < output->GetNumberOfPoints(); ++cc)
+  {
+    double x[3], y[3];
+    merged->GetPoint(cc, x);
+    output->GetPoint(cc, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2] || !ids || ptMap[ids->GetValue(cc)] != cc)
+    {
+      cerr << "ERROR: " << name << ": point " << cc << " differs." << endl;
+      return false;
+    }
+  }
+
+  vtkNew<vtkIdList> expected;
+  vtkNew<vtkIdList> actual;
+  vtkUnstructuredGrid* ugInput = vtkUnstructuredGrid::SafeDownCast(input);
+  for (vtkIdType cellId = 0; cellId < input->GetNumberOfCells(); ++cellId)
+  {
+    const bool polyhedron = input->GetCellType(cellId) == VTK_POLYHEDRON;
+    if (polyhedron)
+    {
+      ugInput->GetFaceStream(cellId, expected.GetPointer());
+      vtkUnstructuredGrid::ConvertFaceStreamPointIds(
+        expected.GetPointer(), const_cast<vtkIdType*>(&ptMap[0]));
+      output->GetFaceStream(cellId, actual.GetPointer());
+    }
+    else
+    {
+      input->GetCellPoints(cellId, expected.GetPointer());
+      for (vtkIdType pt = 0; pt < expected->GetNumberOfIds(); ++pt)
+      {
+        expected->SetId(pt, ptMap[expected->GetId(pt)]);
+      }
+      output->GetCellPoints(cellId, actual.GetPointer());
+    }
+    bool same = output->GetCellType(cellId) == input->GetCellType(cellId) &&
+      actual->GetNumberOfIds() == expected->GetNumberOfIds();
+    for (vtkIdType pt = 0; same && pt < expected->GetNumberOfIds(); ++pt)
+    {
+      same = actual->GetId(pt) == expected->GetId(pt);
+    }
+    if (!same)
+    {
+      cerr << "ERROR: " << name << ": cell " << cellId << (polyhedron ? " faces" : " points")
+           << " differ." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestMerge(const char* name, vtkDataSet* input, double tolerance)
+{
+  vtkNew<vtkCleanUnstructuredGrid> clean;
+  clean->SetInputData(input);
+  clean->SetTolerance(tolerance);
+  clean->Update();
+
+  std::vector<vtkIdType> ptMap;
+  vtkNew<vtkPoints> merged;
+  if (tolerance > 0.0)
+  {
+    MergeWithinTolerance(input, tolerance, ptMap, merged.GetPointer());
+  }
+  else
+  {
+    MergeReference(input, ptMap, merged.GetPointer());
+  }
+  if (merged->GetNumberOfPoints() == input->GetNumberOfPoints())
+  {
+    cerr << "ERROR: " << name << ": nothing to merge." << endl;
+    return false;
+  }
+  return CheckOutput(name, input, clean->GetOutput(), ptMap, merged.GetPointer());
+}
+}
+
+int TestCleanUnstructuredGrid(int, char* [])
+{
+  bool success = true;
+  success &= TestMerge("hexahedra", CreateHexahedra(), 0.0);
+  success &= TestMerge("polyhedra", CreatePolyhedra(), 0.0);
+  success &= TestMerge("triangles", CreateTriangles(), 0.0);
+  success &= TestMerge("cloud", CreateCloud(0.05), 0.05);
+  success &= TestMerge("triangles within tolerance", CreateTriangles(), 0.5);
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
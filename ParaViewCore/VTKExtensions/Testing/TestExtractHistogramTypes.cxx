@@ -0,0 +1,230 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestExtractHistogramTypes.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkDoubleArray.h"
+#include "vtkExtractHistogram.h"
+#include "vtkFloatArray.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSignedCharArray.h"
+#include "vtkSmartPointer.h"
+#include "vtkTable.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+// More than a block of tuples, so that every thread gets several blocks.
+const vtkIdType NUMBER_OF_TUPLES = 100003;
+
+void AddArray(vtkPolyData* data, vtkDataArray* array, const char* name, int numComps)
+{
+  array->SetName(name);
+  array->SetNumberOfComponents(numComps);
+  array->SetNumberOfTuples(NUMBER_OF_TUPLES);
+  data->GetPointData()->AddArray(array);
+  array->Delete();
+}
+
+vtkSmartPointer<vtkPolyData> CreateInput()
+{
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(NUMBER_OF_TUPLES);
+  data->SetPoints(points);
+
+  AddArray(data, vtkUnsignedCharArray::New(), "bytes", 1);
+  AddArray(data, vtkSignedCharArray::New(), "chars", 1);
+  AddArray(data, vtkIntArray::New(), "ints", 1);
+  AddArray(data, vtkFloatArray::New(), "floats", 3);
+  AddArray(data, vtkDoubleArray::New(), "doubles", 1);
+  vtkPointData* pd = data->GetPointData();
+  for (vtkIdType cc = 0; cc < NUMBER_OF_TUPLES; ++cc)
+  {
+    points->SetPoint(cc, cc, 0, 0);
+    pd->GetArray("bytes")->SetComponent(cc, 0, (cc * 7) % 200 + 20);
+    pd->GetArray("chars")->SetComponent(cc, 0, (cc % 256) - 128);
+    pd->GetArray("ints")->SetComponent(cc, 0, (cc * 31) % 1000 - 300);
+    for (int comp = 0; comp < 3; ++comp)
+    {
+      pd->GetArray("floats")->SetComponent(cc, comp, std::sin(cc * 0.001 * (comp + 1)));
+    }
+    pd->GetArray("doubles")->SetComponent(
+      cc, 0, cc % 97 == 0 ? vtkMath::Nan() : std::cos(cc * 0.01) * 1e3);
+  }
+  return data;
+}
+
+// Serial reference, binning values as vtkExtractHistogram documents: values
+// below the first bin (and NaNs) in the first bin, values above the last bin
+// in the last one.
+struct Reference
+{
+  std::vector<int> Counts;
+  std::vector<std::vector<double> > Totals; // per point data array
+};
+
+Reference ComputeReference(vtkPolyData* data, const char* name, int component, int binCount,
+  bool center, double min, double max)
+{
+  vtkPointData* pd = data->GetPointData();
+  vtkDataArray* values = pd->GetArray(name);
+  const double delta = (max - min) / (center ? binCount - 1 : binCount);
+  Reference ref;
+  ref.Counts.assign(binCount, 0);
+  ref.Totals.resize(pd->GetNumberOfArrays());
+  for (int idx = 0; idx < pd->GetNumberOfArrays(); ++idx)
+  {
+    ref.Totals[idx].assign(binCount * pd->GetArray(idx)->GetNumberOfComponents(), 0.0);
+  }
+  for (vtkIdType cc = 0; cc < NUMBER_OF_TUPLES; ++cc)
+  {
+    const double value = values->GetComponent(cc, component);
+    const double findex = (value - min + (center ? delta / 2 : 0.)) / delta;
+    const int bin =
+      !(findex >= 0) ? 0 : (findex >= binCount - 1 ? binCount - 1 : static_cast<int>(findex));
+    ref.Counts[bin]++;
+    for (int idx = 0; idx < pd->GetNumberOfArrays(); ++idx)
+    {
+      vtkDataArray* array = pd->GetArray(idx);
+      const int numComps = array->GetNumberOfComponents();
+      for (int comp = 0; comp < numComps; ++comp)
+      {
+        ref.Totals[idx][bin * numComps + comp] += array->GetComponent(cc, comp);
+      }
+    }
+  }
+  return ref;
+}
+
+bool Equal(double a, double b)
+{
+  if (vtkMath::IsNan(a) || vtkMath::IsNan(b))
+  {
+    return vtkMath::IsNan(a) && vtkMath::IsNan(b);
+  }
+  return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(a));
+}
+
+bool TestHistogram(
+  vtkPolyData* data, const char* name, int component, int binCount, bool center, bool averages)
+{
+  vtkSmartPointer<vtkExtractHistogram> histogram = vtkSmartPointer<vtkExtractHistogram>::New();
+  histogram->SetInputData(data);
+  histogram->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, name);
+  histogram->SetComponent(component);
+  histogram->SetBinCount(binCount);
+  histogram->SetCenterBinsAroundMinAndMax(center);
+  histogram->SetCalculateAverages(averages ? 1 : 0);
+  histogram->Update();
+
+  double range[2];
+  data->GetPointData()->GetArray(name)->GetRange(range, component);
+  Reference ref = ComputeReference(data, name, component, binCount, center, range[0], range[1]);
+
+  const std::string test = std::string(name) + "[" + std::to_string(component) + "], " +
+    std::to_string(binCount) + " bins" + (center ? ", centered" : "") +
+    (averages ? ", averages" : "");
+  vtkTable* output = histogram->GetOutput();
+  vtkIntArray* counts = vtkIntArray::SafeDownCast(output->GetRowData()->GetArray("bin_values"));
+  if (!counts || counts->GetNumberOfTuples() != binCount)
+  {
+    cerr << "ERROR: " << test << ": missing bin values." << endl;
+    return false;
+  }
+  for (int bin = 0; bin < binCount; ++bin)
+  {
+    if (counts->GetValue(bin) != ref.Counts[bin])
+    {
+      cerr << "ERROR: " << test << ": bin " << bin << " counts " << counts->GetValue(bin)
+           << " values instead of " << ref.Counts[bin] << endl;
+      return false;
+    }
+  }
+
+  vtkPointData* pd = data->GetPointData();
+  for (int idx = 0; idx < pd->GetNumberOfArrays(); ++idx)
+  {
+    const std::string total = std::string(pd->GetArrayName(idx)) + "_total";
+    vtkDataArray* totals = output->GetRowData()->GetArray(total.c_str());
+    if (!averages || pd->GetArray(idx) == pd->GetArray(name))
+    {
+      if (totals)
+      {
+        cerr << "ERROR: " << test << ": unexpected " << total << " array." << endl;
+        return false;
+      }
+      continue;
+    }
+    const int numComps = pd->GetArray(idx)->GetNumberOfComponents();
+    if (!totals || totals->GetNumberOfTuples() != binCount ||
+      totals->GetNumberOfComponents() != numComps)
+    {
+      cerr << "ERROR: " << test << ": missing " << total << " array." << endl;
+      return false;
+    }
+    for (int bin = 0; bin < binCount; ++bin)
+    {
+      for (int comp = 0; comp < numComps; ++comp)
+      {
+        const double expected = ref.Totals[idx][bin * numComps + comp];
+        if (!Equal(totals->GetComponent(bin, comp), expected))
+        {
+          cerr << "ERROR: " << test << ": " << total << " is " << totals->GetComponent(bin, comp)
+               << " in bin " << bin << " instead of " << expected << endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+}
+
+/// Compares the output of vtkExtractHistogram with a serial reference for
+/// arrays of several types, including the 8-bit arrays counted per raw value.
+int TestExtractHistogramTypes(int, char* [])
+{
+  vtkSmartPointer<vtkPolyData> data = CreateInput();
+
+  struct
+  {
+    const char* Name;
+    int Component;
+  } inputs[] = { { "bytes", 0 }, { "chars", 0 }, { "ints", 0 }, { "floats", 1 },
+    { "doubles", 0 } };
+
+  bool success = true;
+  for (size_t cc = 0; cc < sizeof(inputs) / sizeof(inputs[0]); ++cc)
+  {
+    const int binCounts[] = { 17, 256 };
+    for (int bins = 0; bins < 2; ++bins)
+    {
+      for (int flags = 0; flags < 4; ++flags)
+      {
+        success &= TestHistogram(data, inputs[cc].Name, inputs[cc].Component, binCounts[bins],
+          (flags & 1) != 0, (flags & 2) != 0);
+      }
+    }
+  }
+  return success ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestIntegrateAttributesParallel.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Integrates pieces that are empty, 2D, or 2D and 3D on the different
+// processes, and compares the result gathered on the root with the serial
+// integration of all the pieces. The pieces are shifted across processes so
+// that the higher dimension is found on the sending as well as on the
+// receiving side of the reduction. Pieces have more cells than the chunks
+// vtkIntegrateAttributes integrates in parallel.
+
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkIntegrateAttributes.h"
+#include "vtkMPIController.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <mpi.h>
+
+namespace
+{
+enum PieceType
+{
+  EMPTY_PIECE = 0,
+  SURFACE_PIECE,
+  SURFACE_AND_VOLUME_PIECE,
+  NUMBER_OF_PIECE_TYPES
+};
+
+void AddArrays(vtkDataSet* ds)
+{
+  vtkNew<vtkDoubleArray> pointValues;
+  pointValues->SetName("PointValue");
+  pointValues->SetNumberOfTuples(ds->GetNumberOfPoints());
+  vtkNew<vtkDoubleArray> pointVectors;
+  pointVectors->SetName("PointVector");
+  pointVectors->SetNumberOfComponents(3);
+  pointVectors->SetNumberOfTuples(ds->GetNumberOfPoints());
+  for (vtkIdType cc = 0; cc < ds->GetNumberOfPoints(); ++cc)
+  {
+    double x[3];
+    ds->GetPoint(cc, x);
+    pointValues->SetValue(cc, x[0] + 2 * x[1] + 3 * x[2]);
+    pointVectors->SetTuple3(cc, x[0], x[1] * x[1], 1.0);
+  }
+  ds->GetPointData()->AddArray(pointValues.GetPointer());
+  ds->GetPointData()->AddArray(pointVectors.GetPointer());
+
+  vtkNew<vtkDoubleArray> cellValues;
+  cellValues->SetName("CellValue");
+  cellValues->SetNumberOfTuples(ds->GetNumberOfCells());
+  for (vtkIdType cc = 0; cc < ds->GetNumberOfCells(); ++cc)
+  {
+    cellValues->SetValue(cc, cc % 7);
+  }
+  ds->GetCellData()->AddArray(cellValues.GetPointer());
+}
+
+// 6400 quads.
+vtkSmartPointer<vtkPolyData> CreateSurface(double offset)
+{
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetOrigin(offset, 0, 0);
+  plane->SetPoint1(offset + 20, 0, 0);
+  plane->SetPoint2(offset, 20, 0);
+  plane->SetResolution(80, 80);
+  plane->Update();
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->CopyStructure(plane->GetOutput());
+  AddArrays(surface);
+  return surface;
+}
+
+// 8000 voxels.
+vtkSmartPointer<vtkImageData> CreateVolume(double offset)
+{
+  vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+  volume->SetOrigin(offset, 0, 0);
+  volume->SetSpacing(1, 1, 0.5);
+  volume->SetDimensions(21, 21, 21);
+  AddArrays(volume);
+  return volume;
+}
+
+vtkSmartPointer<vtkDataObject> CreatePiece(int type, int rank)
+{
+  const double offset = 25.0 * rank;
+  switch (type)
+  {
+    case SURFACE_PIECE:
+      return CreateSurface(offset);
+    case SURFACE_AND_VOLUME_PIECE:
+    {
+      vtkSmartPointer<vtkMultiBlockDataSet> mb = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+      mb->SetBlock(0, CreateSurface(offset));
+      mb->SetBlock(1, CreateVolume(offset));
+      return mb;
+    }
+    default:
+      return vtkSmartPointer<vtkPolyData>::New();
+  }
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> Integrate(
+  vtkDataObject* input, vtkMultiProcessController* controller)
+{
+  vtkNew<vtkIntegrateAttributes> integrate;
+  integrate->SetController(controller);
+  integrate->SetInputData(input);
+  integrate->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> output = vtkSmartPointer<vtkUnstructuredGrid>::New();
+  output->ShallowCopy(integrate->GetOutput());
+  return output;
+}
+
+bool Compare(double expected, double actual)
+{
+  return std::abs(expected - actual) <= 1e-9 * std::max(1.0, std::abs(expected));
+}
+
+bool CompareArrays(vtkFieldData* expected, vtkFieldData* actual, const char* what)
+{
+  if (expected->GetNumberOfArrays() != actual->GetNumberOfArrays())
+  {
+    cerr << "ERROR: " << actual->GetNumberOfArrays() << " " << what << " arrays instead of "
+         << expected->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int idx = 0; idx < expected->GetNumberOfArrays(); ++idx)
+  {
+    vtkDataArray* expectedArray = expected->GetArray(idx);
+    vtkDataArray* actualArray = actual->GetArray(expectedArray->GetName());
+    if (!actualArray ||
+      actualArray->GetNumberOfComponents() != expectedArray->GetNumberOfComponents())
+    {
+      cerr << "ERROR: " << what << " array " << expectedArray->GetName() << " missing." << endl;
+      return false;
+    }
+    for (int comp = 0; comp < expectedArray->GetNumberOfComponents(); ++comp)
+    {
+      if (!Compare(expectedArray->GetComponent(0, comp), actualArray->GetComponent(0, comp)))
+      {
+        cerr << "ERROR: " << what << " array " << expectedArray->GetName() << " is "
+             << actualArray->GetComponent(0, comp) << " instead of "
+             << expectedArray->GetComponent(0, comp) << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestReduction(vtkMultiProcessController* controller, int shift)
+{
+  const int rank = controller->GetLocalProcessId();
+  const int numProcs = controller->GetNumberOfProcesses();
+
+  vtkSmartPointer<vtkDataObject> piece =
+    CreatePiece((rank + shift) % NUMBER_OF_PIECE_TYPES, rank);
+  vtkSmartPointer<vtkUnstructuredGrid> actual = Integrate(piece, controller);
+  if (rank != 0)
+  {
+    if (actual->GetNumberOfPoints() != 0 || actual->GetNumberOfCells() != 0)
+    {
+      cerr << "ERROR: rank " << rank << " output is not empty." << endl;
+      return false;
+    }
+    return true;
+  }
+
+  // Reference: the serial integration of the pieces of all processes.
+  vtkNew<vtkMultiBlockDataSet> all;
+  for (int cc = 0; cc < numProcs; ++cc)
+  {
+    all->SetBlock(cc, CreatePiece((cc + shift) % NUMBER_OF_PIECE_TYPES, cc));
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> expected = Integrate(all.GetPointer(), NULL);
+
+  if (actual->GetNumberOfPoints() != 1 || actual->GetNumberOfCells() != 1)
+  {
+    cerr << "ERROR: root output is not a single vertex." << endl;
+    return false;
+  }
+  double x[3], y[3];
+  expected->GetPoint(0, x);
+  actual->GetPoint(0, y);
+  if (!Compare(x[0], y[0]) || !Compare(x[1], y[1]) || !Compare(x[2], y[2]))
+  {
+    cerr << "ERROR: output point (" << y[0] << ", " << y[1] << ", " << y[2] << ") instead of ("
+         << x[0] << ", " << x[1] << ", " << x[2] << ")" << endl;
+    return false;
+  }
+  if (!expected->GetCellData()->GetArray("Volume"))
+  {
+    cerr << "ERROR: the reference did not integrate the volume." << endl;
+    return false;
+  }
+  return CompareArrays(expected->GetPointData(), actual->GetPointData(), "point") &&
+    CompareArrays(expected->GetCellData(), actual->GetCellData(), "cell");
+}
+}
+
+int main(int argc, char* argv[])
+{
+  MPI_Init(&argc, &argv);
+
+  vtkNew<vtkMPIController> controller;
+  controller->Initialize(&argc, &argv, 1);
+  vtkMultiProcessController::SetGlobalController(controller.GetPointer());
+
+  int success = 1;
+  if (controller->GetNumberOfProcesses() < NUMBER_OF_PIECE_TYPES)
+  {
+    cerr << "ERROR: this test needs at least " << NUMBER_OF_PIECE_TYPES << " processes." << endl;
+    success = 0;
+  }
+  for (int shift = 0; success && shift < NUMBER_OF_PIECE_TYPES; ++shift)
+  {
+    int localSuccess = TestReduction(controller.GetPointer(), shift) ? 1 : 0;
+    controller->AllReduce(&localSuccess, &success, 1, vtkCommunicator::MIN_OP);
+  }
+
+  vtkMultiProcessController::SetGlobalController(NULL);
+  controller->Finalize();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+/*=========================================================================
+
+  Program:   ParaView
+  Module:    TestPVGlyphFilter.cxx
+
+  Copyright (c) Kitware, Inc.
+  All rights reserved.
+  See Copyright.txt or http://www.paraview.org/HTML/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compares the glyphs vtkPVGlyphFilter generates over several chunks of
+// points with those of a serial vtkGlyph3D, and checks the vertices and
+// arrays of the GLYPH_INSTANCES output.
+
+#include "vtkArrowSource.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGlyph3D.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPVGlyphFilter.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkStringArray.h"
+
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+// More than two chunks of vtkPVGlyphFilter, the last one partial.
+const vtkIdType NUMBER_OF_POINTS = 2 * 65536 + 1234;
+const double SCALE_FACTOR = 0.25;
+
+vtkSmartPointer<vtkPolyData> CreateInput()
+{
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(NUMBER_OF_POINTS);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(NUMBER_OF_POINTS);
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(NUMBER_OF_POINTS);
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("ints");
+  ints->SetNumberOfTuples(NUMBER_OF_POINTS);
+  vtkNew<vtkStringArray> labels;
+  labels->SetName("labels");
+  labels->SetNumberOfTuples(NUMBER_OF_POINTS);
+  for (vtkIdType cc = 0; cc < NUMBER_OF_POINTS; ++cc)
+  {
+    points->SetPoint(cc, cc % 97, (cc / 97) % 89, cc / (97 * 89));
+    scalars->SetValue(cc, static_cast<float>(std::sin(cc * 0.01)));
+    vectors->SetTuple3(cc, 1.0 + std::cos(cc * 0.003), std::sin(cc * 0.007), 0.5);
+    ints->SetValue(cc, static_cast<int>(cc % 1000));
+    std::ostringstream label;
+    label << "p" << cc % 13;
+    labels->SetValue(cc, label.str());
+  }
+  data->SetPoints(points.GetPointer());
+  data->GetPointData()->SetScalars(scalars.GetPointer());
+  data->GetPointData()->SetVectors(vectors.GetPointer());
+  data->GetPointData()->AddArray(ints.GetPointer());
+  data->GetPointData()->AddArray(labels.GetPointer());
+  return data;
+}
+
+void Configure(vtkGlyph3D* glyph, vtkPolyData* input, vtkAlgorithm* source)
+{
+  glyph->SetInputData(input);
+  glyph->SetSourceConnection(source->GetOutputPort());
+  glyph->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "scalars");
+  glyph->SetInputArrayToProcess(1, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "vectors");
+  glyph->SetScaleModeToScaleByVector();
+  glyph->SetScaleFactor(SCALE_FACTOR);
+  glyph->SetVectorModeToUseVector();
+  glyph->SetColorModeToColorByScalar();
+  glyph->OrientOn();
+  glyph->GeneratePointIdsOn();
+  glyph->FillCellDataOn();
+}
+
+bool CompareArrays(vtkFieldData* expected, vtkFieldData* actual, const char* what)
+{
+  if (expected->GetNumberOfArrays() != actual->GetNumberOfArrays())
+  {
+    cerr << "ERROR: " << actual->GetNumberOfArrays() << " " << what << " arrays instead of "
+         << expected->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int idx = 0; idx < expected->GetNumberOfArrays(); ++idx)
+  {
+    vtkAbstractArray* expectedArray = expected->GetAbstractArray(idx);
+    vtkAbstractArray* actualArray = actual->GetAbstractArray(expectedArray->GetName());
+    if (!actualArray || actualArray->GetDataType() != expectedArray->GetDataType() ||
+      actualArray->GetNumberOfComponents() != expectedArray->GetNumberOfComponents() ||
+      actualArray->GetNumberOfTuples() != expectedArray->GetNumberOfTuples())
+    {
+      cerr << "ERROR: " << what << " array " << expectedArray->GetName() << " differs." << endl;
+      return false;
+    }
+    const vtkIdType numValues =
+      expectedArray->GetNumberOfTuples() * expectedArray->GetNumberOfComponents();
+    for (vtkIdType cc = 0; cc < numValues; ++cc)
+    {
+      if (expectedArray->GetVariantValue(cc) != actualArray->GetVariantValue(cc))
+      {
+        cerr << "ERROR: " << what << " array " << expectedArray->GetName() << " differs at value "
+             << cc << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool CompareCells(vtkCellArray* expected, vtkCellArray* actual, const char* what)
+{
+  if (expected->GetNumberOfCells() != actual->GetNumberOfCells() ||
+    expected->GetNumberOfConnectivityEntries() != actual->GetNumberOfConnectivityEntries())
+  {
+    cerr << "ERROR: " << actual->GetNumberOfCells() << " " << what << " instead of "
+         << expected->GetNumberOfCells() << endl;
+    return false;
+  }
+  const vtkIdType size = expected->GetNumberOfConnectivityEntries();
+  for (vtkIdType cc = 0; cc < size; ++cc)
+  {
+    if (expected->GetPointer()[cc] != actual->GetPointer()[cc])
+    {
+      cerr << "ERROR: " << what << " connectivity differs at " << cc << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestGeometry(vtkPolyData* input, vtkAlgorithm* source)
+{
+  vtkNew<vtkGlyph3D> reference;
+  Configure(reference.GetPointer(), input, source);
+  reference->Update();
+  vtkPolyData* expected = reference->GetOutput();
+
+  vtkNew<vtkPVGlyphFilter> glyph;
+  Configure(glyph.GetPointer(), input, source);
+  glyph->SetGlyphMode(vtkPVGlyphFilter::ALL_POINTS);
+  glyph->Update();
+  vtkPolyData* actual = vtkPolyData::SafeDownCast(glyph->GetOutputDataObject(0));
+
+  if (!actual || actual->GetNumberOfPoints() != expected->GetNumberOfPoints() ||
+    actual->GetPoints()->GetDataType() != expected->GetPoints()->GetDataType())
+  {
+    cerr << "ERROR: glyph points differ from vtkGlyph3D's." << endl;
+    return false;
+  }
+  for (vtkIdType cc = 0; cc < expected->GetNumberOfPoints(); ++cc)
+  {
+    double x[3], y[3];
+    expected->GetPoint(cc, x);
+    actual->GetPoint(cc, y);
+    if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+    {
+      cerr << "ERROR: glyph point " << cc << " differs from vtkGlyph3D's." << endl;
+      return false;
+    }
+  }
+  return CompareCells(expected->GetVerts(), actual->GetVerts(), "verts") &&
+    CompareCells(expected->GetLines(), actual->GetLines(), "lines") &&
+    CompareCells(expected->GetPolys(), actual->GetPolys(), "polys") &&
+    CompareCells(expected->GetStrips(), actual->GetStrips(), "strips") &&
+    CompareArrays(expected->GetPointData(), actual->GetPointData(), "point") &&
+    CompareArrays(expected->GetCellData(), actual->GetCellData(), "cell");
+}
+
+bool TestInstances(vtkPolyData* input, vtkAlgorithm* source)
+{
+  vtkNew<vtkPVGlyphFilter> glyph;
+  Configure(glyph.GetPointer(), input, source);
+  glyph->SetGlyphMode(vtkPVGlyphFilter::EVERY_NTH_POINT);
+  glyph->SetStride(3);
+  glyph->SetOutputMode(vtkPVGlyphFilter::GLYPH_INSTANCES);
+  glyph->Update();
+  vtkPolyData* output = vtkPolyData::SafeDownCast(glyph->GetOutputDataObject(0));
+
+  const vtkIdType numInstances = (NUMBER_OF_POINTS + 2) / 3;
+  if (!output || output->GetNumberOfPoints() != numInstances ||
+    output->GetNumberOfVerts() != numInstances || output->GetNumberOfPolys() != 0)
+  {
+    cerr << "ERROR: expected " << numInstances << " instances." << endl;
+    return false;
+  }
+  vtkPointData* pd = output->GetPointData();
+  vtkDataArray* scales = pd->GetArray("GlyphScale");
+  vtkDataArray* orientations = pd->GetArray("GlyphOrientation");
+  vtkIdTypeArray* ids = vtkIdTypeArray::SafeDownCast(pd->GetArray("InputPointIds"));
+  vtkDataArray* ints = pd->GetArray("ints");
+  vtkStringArray* labels = vtkStringArray::SafeDownCast(pd->GetAbstractArray("labels"));
+  if (!scales || scales->GetNumberOfComponents() != 3 || !orientations ||
+    orientations->GetNumberOfComponents() != 3 || !ids || !ints || !labels)
+  {
+    cerr << "ERROR: missing instance arrays." << endl;
+    return false;
+  }
+
+  vtkDataArray* vectors = input->GetPointData()->GetArray("vectors");
+  vtkStringArray* inLabels = vtkStringArray::SafeDownCast(
+    input->GetPointData()->GetAbstractArray("labels"));
+  for (vtkIdType cc = 0; cc < numInstances; ++cc)
+  {
+    const vtkIdType ptId = 3 * cc;
+    double x[3], y[3], v[3], scale[3], orientation[3];
+    input->GetPoint(ptId, x);
+    output->GetPoint(cc, y);
+    vectors->GetTuple(ptId, v);
+    scales->GetTuple(cc, scale);
+    orientations->GetTuple(cc, orientation);
+    const double expectedScale = static_cast<float>(vtkMath::Norm(v) * SCALE_FACTOR);
+    if (ids->GetValue(cc) != ptId || x[0] != y[0] || x[1] != y[1] || x[2] != y[2] ||
+      ints->GetComponent(cc, 0) != ptId % 1000 || labels->GetValue(cc) != inLabels->GetValue(ptId))
+    {
+      cerr << "ERROR: instance " << cc << " does not match input point " << ptId << endl;
+      return false;
+    }
+    for (int comp = 0; comp < 3; ++comp)
+    {
+      if (scale[comp] != expectedScale ||
+        std::abs(orientation[comp] - v[comp]) > 1e-6 * std::abs(v[comp]) + 1e-7)
+      {
+        cerr << "ERROR: instance " << cc << " has scale " << scale[comp] << " and orientation "
+             << orientation[comp] << " instead of " << expectedScale << " and " << v[comp]
+             << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestPVGlyphFilter(int, char* [])
+{
+  vtkSmartPointer<vtkPolyData> input = CreateInput();
+  vtkNew<vtkArrowSource> arrow;
+  arrow->SetTipResolution(4);
+  arrow->SetShaftResolution(4);
+
+  bool success = TestGeometry(input, arrow.GetPointer());
+  success &= TestInstances(input, arrow.GetPointer());
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -42,6 +42,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // VTK includes
 #include "vtkCommand.h"
 #include "vtkEventQtSlotConnect.h"
+#include "vtkNew.h"
 #include <vtksys/SystemTools.hxx>
 
 // ParaView Server Manager includes
@@ -49,11 +50,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "vtkPVCompositeDataInformation.h"
 #include "vtkPVDataInformation.h"
 #include "vtkPVDataSetAttributesInformation.h"
+#include "vtkPVDataSizeInformation.h"
 #include "vtkSMDomain.h"
 #include "vtkSMDomainIterator.h"
 #include "vtkSMDoubleVectorProperty.h"
 #include "vtkSMOutputPort.h"
 #include "vtkSMPropertyIterator.h"
+#include "vtkSMProxy.h"
 #include "vtkSmartPointer.h"
 
 // ParaView widget includes
@@ -182,6 +185,20 @@ void pqProxyInformationWidget::updateInformation()
 
   this->fillDataInformation(dataInformation);
 
+  // The memory shown is that of the output port. Also report the memory held
+  // by all outputs of the source, where arrays shallow copied among them are
+  // counted once, and how much of it is shared with other objects and would
+  // not be freed by deleting the source.
+  if (dataInformation->GetNumberOfDataSets() > 0)
+  {
+    vtkNew<vtkPVDataSizeInformation> sizeInformation;
+    source->getProxy()->GatherInformation(sizeInformation.GetPointer());
+    this->Ui->memory->setToolTip(
+      tr("All outputs: %1 MB, of which %2 MB is shared with other objects")
+        .arg(sizeInformation->GetMemorySize() / 1000.0, 0, 'g', 2)
+        .arg(sizeInformation->GetSharedMemorySize() / 1000.0, 0, 'g', 2));
+  }
+
   // Find the first property that has a vtkSMFileListDomain. Assume that
   // it is the property used to set the filename.
   vtkSmartPointer<vtkSMPropertyIterator> piter;
@@ -261,6 +278,7 @@ void pqProxyInformationWidget::fillDataInformation(vtkPVDataInformation* dataInf
   this->Ui->numberOfRows->setText(tr("NA"));
   this->Ui->numberOfColumns->setText(tr("NA"));
   this->Ui->memory->setText(tr("NA"));
+  this->Ui->memory->setToolTip(QString());
 
   this->Ui->dataArrays->clear();
 
@@ -428,8 +428,9 @@ void outputFunction(FILE* fp, ClassInfo* data)
     {
       fprintf(fp, "#if !defined(VTK_LEGACY_REMOVE)\n");
     }
-    fprintf(fp, "  if (!strcmp(\"%s\",method) && msg.GetNumberOfArguments(0) == %i)\n",
-      currentFunction->Name, currentFunction->NumberOfArguments + 2);
+    /* the method name has already been matched in output_DispatchFunctions */
+    fprintf(fp, "  if (msg.GetNumberOfArguments(0) == %i) /* %s */\n",
+      currentFunction->NumberOfArguments + 2, currentFunction->Name);
     fprintf(fp, "    {\n");
 
     /* process the args */
@@ -790,6 +791,93 @@ int managableArguments(FunctionInfo* curFunction)
   return args_ok;
 }
 
+//--------------------------------------------------------------------------nix
+/*
+ * isDispatched returns true if outputFunction generates code for the
+ * function i.e. it is wrappable and is neither a constructor nor a destructor.
+ */
+static int isDispatched(ClassInfo* data, FunctionInfo* curFunction)
+{
+  return (!notWrappable(curFunction) && managableArguments(curFunction) &&
+    strcmp(data->Name, curFunction->Name) && strcmp(data->Name, curFunction->Name + 1));
+}
+
+static int nameCmp(const void* name1, const void* name2)
+{
+  return strcmp(*(const char* const*)name1, *(const char* const*)name2);
+}
+
+//--------------------------------------------------------------------------nix
+/*
+ * output_DispatchFunctions generates the code for all wrapped methods of the
+ * class. Rather than comparing the requested method against every wrapped
+ * method in turn, the unique method names are emitted as a sorted table which
+ * the generated code searches with a binary search. The index is then used in a
+ * switch statement that tries the overloads for the method, in the order they
+ * were declared.
+ */
+void output_DispatchFunctions(FILE* fp, ClassInfo* data)
+{
+  const char** names;
+  int numberOfNames = 0;
+  int i, j;
+
+  names = (const char**)malloc(sizeof(const char*) * (data->NumberOfFunctions + 1));
+  for (i = 0; i < data->NumberOfFunctions; i++)
+  {
+    if (isDispatched(data, data->Functions[i]))
+    {
+      names[numberOfNames++] = data->Functions[i]->Name;
+    }
+  }
+
+  if (numberOfNames == 0)
+  {
+    free(names);
+    return;
+  }
+
+  /* sort and remove duplicates (overloads) */
+  qsort(names, numberOfNames, sizeof(const char*), nameCmp);
+  for (i = 1, j = 1; i < numberOfNames; i++)
+  {
+    if (strcmp(names[i], names[j - 1]) != 0)
+    {
+      names[j++] = names[i];
+    }
+  }
+  numberOfNames = j;
+
+  fprintf(fp, "  static const char* const methodNames[] = {\n");
+  for (i = 0; i < numberOfNames; i++)
+  {
+    fprintf(fp, "    \"%s\",\n", names[i]);
+  }
+  fprintf(fp, "  };\n");
+  fprintf(fp,
+    "  switch (vtkClientServerInterpreter::FindMethodIndex(method, methodNames, %i))\n"
+    "  {\n",
+    numberOfNames);
+  for (i = 0; i < numberOfNames; i++)
+  {
+    fprintf(fp, "  case %i: /* %s */\n  {\n", i, names[i]);
+    for (j = 0; j < data->NumberOfFunctions; j++)
+    {
+      if (isDispatched(data, data->Functions[j]) && strcmp(data->Functions[j]->Name, names[i]) == 0)
+      {
+        currentFunction = data->Functions[j];
+        outputFunction(fp, data);
+      }
+    }
+    fprintf(fp, "  }\n  break;\n");
+  }
+  fprintf(fp, "  default:\n"
+              "    break;\n"
+              "  }\n");
+
+  free(names);
+}
+
 //--------------------------------------------------------------------------nix
 /*
  * funCmp is used to compare the function names of two FunInfo data.
@@ -1332,11 +1420,7 @@ int main(int argc, char* argv[])
   /*fprintf(fp,"  vtkClientServerStream resultStream;\n");*/
 
   /* insert function handling code here */
-  for (i = 0; i < data->NumberOfFunctions; i++)
-  {
-    currentFunction = data->Functions[i];
-    outputFunction(fp, data);
-  }
+  output_DispatchFunctions(fp, data);
 
   /* try superclasses */
   for (i = 0; i < data->NumberOfSuperClasses; i++)
@@ -9,6 +9,8 @@ except ImportError:
   raise RuntimeError ("'numpy' module is not found. numpy is needed for "\
     "this functionality to work. Please install numpy and try again.")
 
+import ast
+
 import paraview
 from paraview import vtk
 import vtk.numpy_interface.dataset_adapter as dsa
@@ -150,6 +152,125 @@ def compute(inputs, expression, ns=None):
     retVal = eval(expression, globals(), mylocals)
     return retVal
 
+# Functions that apply to each element (or tuple) of their arguments
+# independently. Expressions using only these, arithmetic and comparisons give
+# the same result on the concatenated arrays as block by block, and do not
+# communicate across ranks.
+_ELEMENTWISE_FUNCTIONS = frozenset([
+    "abs", "arccos", "arcsin", "arctan", "ceil", "cos", "cosh", "cross",
+    "dot", "exp", "floor", "log", "log10", "mag", "norm", "sin", "sinh",
+    "sqrt", "tan", "tanh"])
+
+_ELEMENTWISE_OPERATORS = (ast.Add, ast.Sub, ast.Mult, ast.Div, ast.FloorDiv,
+    ast.Mod, ast.Pow, ast.BitAnd, ast.BitOr, ast.BitXor, ast.UAdd, ast.USub,
+    ast.Invert, ast.Eq, ast.NotEq, ast.Lt, ast.LtE, ast.Gt, ast.GtE)
+
+_CONSTANT_NODES = tuple(getattr(ast, name) for name in ("Constant", "Num") \
+    if hasattr(ast, name))
+
+# Variables holding a number rather than an array.
+_SCALAR_NAMES = frozenset(["time_value", "t_value", "time_index", "t_index"])
+
+def _get_elementwise_names(expression):
+    """Returns the names of the variables used by the expression if it only
+    applies element-wise operations (see _ELEMENTWISE_FUNCTIONS) to variables
+    and numbers, or None otherwise. This only depends on the expression, so
+    that all ranks take the same decision."""
+    try:
+        tree = ast.parse(expression.strip(), mode="eval")
+    except SyntaxError:
+        return None
+    names = set()
+    def is_elementwise(node):
+        if isinstance(node, ast.BinOp):
+            return isinstance(node.op, _ELEMENTWISE_OPERATORS) and \
+                is_elementwise(node.left) and is_elementwise(node.right)
+        if isinstance(node, ast.UnaryOp):
+            return isinstance(node.op, _ELEMENTWISE_OPERATORS) and \
+                is_elementwise(node.operand)
+        if isinstance(node, ast.Compare):
+            # chained comparisons use 'and', which does not apply to arrays.
+            return len(node.ops) == 1 and \
+                isinstance(node.ops[0], _ELEMENTWISE_OPERATORS) and \
+                is_elementwise(node.left) and is_elementwise(node.comparators[0])
+        if isinstance(node, ast.Call):
+            return isinstance(node.func, ast.Name) and \
+                node.func.id in _ELEMENTWISE_FUNCTIONS and not node.keywords and \
+                not getattr(node, "starargs", None) and \
+                not getattr(node, "kwargs", None) and \
+                all(is_elementwise(arg) for arg in node.args)
+        if isinstance(node, ast.Name):
+            names.add(node.id)
+            return True
+        if isinstance(node, _CONSTANT_NODES):
+            value = getattr(node, "value", getattr(node, "n", None))
+            return isinstance(value, (int, float)) and not isinstance(value, bool)
+        return False
+    return names if is_elementwise(tree.body) else None
+
+def _to_vtk_array(array, name):
+    """Converts the result of an expression to a vtkDataArray the same way
+    dsa.DataSetAttributes.append does, without copying when possible."""
+    array = np.ascontiguousarray(array)
+    if array.dtype == np.bool_:
+        array = array.astype(np.int8)
+    if array.ndim == 3:
+        array = array.reshape(array.shape[0], array.shape[1] * array.shape[2])
+    return dsa.numpyTovtkDataArray(array, name)
+
+def compute_concatenated(self, inputs, expression, ns):
+    """Evaluates an element-wise expression once over the arrays of all the
+    blocks of the composite input concatenated together, and adds the result
+    to the blocks of the output. Returns False, without touching the output,
+    when the expression has to be evaluated block by block instead.
+
+    Element-wise expressions do not communicate across ranks, so a rank can
+    fall back to the per-block evaluation without affecting the others.
+    """
+    if len(inputs) != 1 or not self.GetConcatenateBlocks() or \
+        not inputs[0].VTKObject.IsA("vtkCompositeDataSet"):
+        return False
+
+    names = _get_elementwise_names(expression)
+    if names is None:
+        return False
+
+    association = self.GetArrayAssociation()
+    composite = inputs[0].VTKObject
+    mylocals = dict()
+    gathered = []
+    for key in inputs[0].GetAttributes(association).keys():
+        varname = paraview.make_name_valid(key)
+        if varname not in names or varname in mylocals:
+            continue
+        # arrays missing on some blocks behave differently per block.
+        vtkarray = self.GatherArray(composite, association, key)
+        if vtkarray is None:
+            return False
+        gathered.append(vtkarray)
+        mylocals[varname] = dsa.vtkDataArrayToVTKArray(vtkarray)
+        mylocals[varname].Association = association
+    if "points" in names:
+        if association != dsa.ArrayAssociation.POINT:
+            return False
+        vtkarray = self.GatherArray(composite, association, None)
+        if vtkarray is None:
+            return False
+        gathered.append(vtkarray)
+        mylocals["points"] = dsa.vtkDataArrayToVTKArray(vtkarray)
+        mylocals["points"].Association = association
+    for name in names & _SCALAR_NAMES:
+        mylocals[name] = ns.get(name)
+    if not gathered or set(mylocals) != names:
+        return False
+
+    retVal = eval(expression, globals(), mylocals)
+    if not isinstance(retVal, np.ndarray) or np.ndim(retVal) == 0 or \
+        retVal.shape[0] != gathered[0].GetNumberOfTuples():
+        return False
+    return self.ScatterArray(_to_vtk_array(retVal, self.GetArrayName()),
+        self.GetOutputDataObject(0), association, self.GetArrayName())
+
 def get_data_time(self, do, ininfo):
     dinfo = do.GetInformation()
     if dinfo and dinfo.Has(do.DATA_TIME_STEP()):
@@ -199,6 +320,8 @@ def execute(self, expression):
                        "t_value": inputs[0].t_value,
                        "time_index": inputs[0].time_index,
                        "t_index": inputs[0].t_index })
+    if compute_concatenated(self, inputs, expression, variables):
+        return
     retVal = compute(inputs, expression, ns=variables)
     if retVal is not None:
         if hasattr(retVal, "Association"):
@@ -3,6 +3,10 @@ selections. It relies on the python-calculator (vtkPythonCalculator),
 specifically, the Python code used by that class, to compute a mask array from
 the query expression. Once the mask array is obtained, this filter will either
 extract the selected ids, or mark those elements as requested.
+
+When use_sorted_index is set, simple queries on a single array, such as the
+ones generated by the Find Data panel, are instead answered by binary search in
+sorted indices that vtkPVSortedArrayIndex caches across executions.
 """
 from __future__ import print_function
 try:
@@ -15,8 +19,20 @@ import re
 import vtk
 import vtk.numpy_interface.dataset_adapter as dsa
 import vtk.numpy_interface.algorithms as algos
+import paraview
 from paraview import calculator
 
+# When True, simple queries on a single array (comparisons, ranges, lists of
+# values, min/max) are answered using sorted indices cached by
+# vtkPVSortedArrayIndex instead of evaluating the expression over every element.
+# Off by default since the indices take memory in addition to the arrays.
+use_sorted_index = False
+
+_NUMBER = r'[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?'
+_FIELD = r'mag\(\s*[A-Za-z_]\w*\s*\)|[A-Za-z_]\w*(?:\[\s*:\s*,\s*\d+\s*\])?'
+_COMPARISON = re.compile(r'^(%s)\s*(==|<=|>=|<|>)\s*(%s)$' % (_FIELD, _NUMBER))
+_EXTREMUM = re.compile(r'^(%s)\s*==\s*(min|max)\(\s*(%s)\s*\)$' % (_FIELD, _FIELD))
+
 def _create_id_array(dataobject, attributeType):
     """Returns a VTKArray or VTKCompositeDataArray for the ids"""
     if not dataobject:
@@ -37,6 +53,179 @@ def maskarray_is_valid(maskArray):
         isinstance(maskArray, dsa.VTKArray) or \
         isinstance(maskArray, dsa.VTKCompositeDataArray)
 
+def _strip_parentheses(text):
+    """Removes the parentheses enclosing the whole text, if any."""
+    text = text.strip()
+    if not text.startswith("(") or not text.endswith(")"):
+        return text
+    depth = 0
+    for index, char in enumerate(text):
+        depth += {"(" : 1, ")" : -1}.get(char, 0)
+        if depth == 0 and index < len(text) - 1:
+            return text
+    return text[1:-1].strip()
+
+def _parse_field(field):
+    """Returns the (name, component) referred to by a field of a query. The
+    component is -1 for the magnitude and None when not specified."""
+    field = re.sub(r'\s', '', field)
+    if field.startswith("mag("):
+        return (field[4:-1], -1)
+    if field.endswith("]"):
+        name, comp = field[:-1].split("[:,")
+        return (name, int(comp))
+    return (field, None)
+
+def _parse_comparison(text):
+    """Returns (field, interval) for a 'field op value' comparison, where the
+    interval is (min, max, include min, include max), or None."""
+    match = _COMPARISON.match(_strip_parentheses(text))
+    if not match:
+        return None
+    field, op, value = match.group(1), match.group(2), float(match.group(3))
+    inf = float("inf")
+    intervals = { "==" : (value, value, True, True),
+                  "<=" : (-inf, value, True, True),
+                  "<"  : (-inf, value, True, False),
+                  ">=" : (value, inf, True, True),
+                  ">"  : (value, inf, False, True) }
+    return (re.sub(r'\s', '', field), intervals[op])
+
+def _parse_indexed_query(query):
+    """Parses the queries that can be answered using sorted indices. These are
+    the ones generated by the Find Data panel, i.e. a single comparison,
+    comparisons combined with '&' (ranges) or with '|' (lists of values), and
+    'field == min(field)' or 'field == max(field)'. Returns (field, intervals,
+    extremum) or None."""
+    query = _strip_parentheses(query)
+    match = _EXTREMUM.match(query)
+    if match:
+        field = re.sub(r'\s', '', match.group(1))
+        if field != re.sub(r'\s', '', match.group(3)):
+            return None
+        return (field, None, match.group(2))
+
+    for operator in ("|", "&"):
+        parts = [_parse_comparison(part) for part in query.split(operator)]
+        if None in parts or len(set([field for field, interval in parts])) != 1:
+            continue
+        intervals = [interval for field, interval in parts]
+        if operator == "&":
+            # intersect the intervals.
+            lows = sorted([(i[0], not i[2]) for i in intervals])
+            highs = sorted([(i[1], i[3]) for i in intervals])
+            intervals = [(lows[-1][0], highs[0][0], not lows[-1][1], highs[0][1])]
+        return (parts[0][0], intervals, None)
+    return None
+
+def _get_array(dataset, attributeType, name):
+    """Returns the vtkDataArray named 'name', once made a valid Python name, or
+    None."""
+    attribs = dataset.GetAttributes(attributeType)
+    for key in attribs.keys():
+        if paraview.make_name_valid(key) == name:
+            return attribs.VTKObject.GetArray(key)
+    return None
+
+def _select_ids(dataset, attributeType, name, component, intervals):
+    """Returns the ids of the elements of a dataset whose value is in one of the
+    intervals, or None if the array cannot be indexed. As when the query is
+    evaluated with numpy, vtkPVSortedArrayIndex compares the values of float
+    arrays, and their magnitude, in single precision."""
+    from paraview.vtk.vtkPVVTKExtensionsDefault import vtkPVSortedArrayIndex
+    array = _get_array(dataset, attributeType, name)
+    if array is None and name == "id":
+        # "id" refers to the element ids, see execute().
+        allids = np.arange(dataset.GetNumberOfElements(attributeType))
+        mask = np.zeros(len(allids), dtype=bool)
+        for low, high, includeLow, includeHigh in intervals:
+            mask |= (allids >= low if includeLow else allids > low) & \
+                (allids <= high if includeHigh else allids < high)
+        return dsa.VTKArray(np.flatnonzero(mask))
+    if array is None:
+        return dsa.VTKArray(np.empty(0, dtype=np.int64))
+    if component is None:
+        if array.GetNumberOfComponents() != 1:
+            return None
+        component = 0
+
+    selected = []
+    for low, high, includeLow, includeHigh in intervals:
+        ids = vtk.vtkIdTypeArray()
+        if vtkPVSortedArrayIndex.SelectRange(
+            array, component, low, high, includeLow, includeHigh, ids) < 0:
+            return None
+        selected.append(dsa.vtkDataArrayToVTKArray(ids))
+    if len(selected) == 1:
+        return selected[0]
+    return dsa.VTKArray(np.unique(np.concatenate(selected)))
+
+def _get_local_extremum(dataset, attributeType, name, component, extremum):
+    """Returns the min or max of the array in the dataset, or NoneArray."""
+    from paraview.vtk.vtkPVVTKExtensionsDefault import vtkPVSortedArrayIndex
+    array = _get_array(dataset, attributeType, name)
+    if array is None:
+        return dsa.NoneArray
+    if component is None:
+        if array.GetNumberOfComponents() != 1:
+            return dsa.NoneArray
+        component = 0
+    valueRange = [0.0, 0.0]
+    if not vtkPVSortedArrayIndex.GetRange(array, component, valueRange):
+        return dsa.NoneArray
+    return dsa.VTKArray(np.array([valueRange[0] if extremum == "min" else valueRange[1]]))
+
+def _indexed_query(dataobject, attributeType, query, elocals):
+    """Evaluates the query using sorted indices. Returns the selected ids
+    (VTKArray or VTKCompositeDataArray) or None if the query cannot be
+    evaluated that way.
+
+    Whether a query is evaluated using indices only depends on the query and
+    on the arrays known to all ranks, since min and max are reduced across
+    ranks."""
+    parsed = _parse_indexed_query(query)
+    if not use_sorted_index or not parsed:
+        return None
+    field, intervals, extremum = parsed
+    name, component = _parse_field(field)
+    if name not in elocals or (name == "id" and extremum):
+        return None
+
+    datasets = list(dataobject) if dataobject.IsA("vtkCompositeDataSet") else [dataobject]
+    if extremum:
+        values = [_get_local_extremum(ds, attributeType, name, component, extremum) \
+            for ds in datasets]
+        reduce = algos.min if extremum == "min" else algos.max
+        value = reduce(dsa.VTKCompositeDataArray(values))
+        if value is dsa.NoneArray:
+            intervals = []
+        else:
+            value = float(value)
+            intervals = [(value, value, True, True)]
+
+    selected = []
+    for ds in datasets:
+        ids = _select_ids(ds, attributeType, name, component, intervals)
+        if ids is None:
+            if extremum:
+                # keep the result consistent across ranks.
+                ids = dsa.VTKArray(np.empty(0, dtype=np.int64))
+            else:
+                return None
+        selected.append(ids)
+    if dataobject.IsA("vtkCompositeDataSet"):
+        return dsa.VTKCompositeDataArray(selected)
+    return selected[0]
+
+def _ids_to_mask(dataobject, attributeType, selectedIds):
+    """Converts the ids returned by _indexed_query() to a mask array."""
+    if dataobject.IsA("vtkCompositeDataSet"):
+        return dsa.VTKCompositeDataArray([_ids_to_mask(ds, attributeType, ids) \
+            for ds, ids in zip(dataobject, selectedIds.Arrays)])
+    mask = np.zeros(dataobject.GetNumberOfElements(attributeType), dtype=bool)
+    mask[selectedIds] = True
+    return dsa.VTKArray(mask)
+
 def execute(self):
     inputDO = self.GetInputDataObject(0, 0)
     inputSEL = self.GetInputDataObject(1, 0)
@@ -71,15 +260,32 @@ def execute(self):
         # This is a temporary fix. We should look into
         # accelerating id-based selections in the future.
         elocals["id"] = _create_id_array(inputs[0], attributeType)
-    try:
-        maskArray = calculator.compute(inputs, query, ns=elocals)
-    except:
-        from sys import stderr
-        print ("Error: Failed to evaluate Expression '%s'. "\
-            "The following exception stack should provide additional developer "\
-            "specific information. This typically implies a malformed "\
-            "expression. Verify that the expression is valid.\n" % query, file=stderr)
-        raise
+
+    inverse = selectionNode.GetProperties().Has(selectionNode.INVERSE()) and \
+        selectionNode.GetProperties().Get(selectionNode.INVERSE()) == 1
+
+    output = dsa.WrapDataObject(outputDO)
+    selectedIds = _indexed_query(inputs[0], attributeType, query, elocals)
+    if selectedIds is not None and not inverse and not self.GetPreserveTopology():
+        # the selected ids are all we need to extract the elements.
+        output.FieldData.append(selectedIds, "vtkSelectedIds")
+        self.ExtractElements(attributeType, inputDO, outputDO)
+        del selectedIds
+        return
+
+    if selectedIds is not None:
+        maskArray = _ids_to_mask(inputs[0], attributeType, selectedIds)
+        del selectedIds
+    else:
+        try:
+            maskArray = calculator.compute(inputs, query, ns=elocals)
+        except:
+            from sys import stderr
+            print ("Error: Failed to evaluate Expression '%s'. "\
+                "The following exception stack should provide additional developer "\
+                "specific information. This typically implies a malformed "\
+                "expression. Verify that the expression is valid.\n" % query, file=stderr)
+            raise
 
     if not maskarray_is_valid(maskArray):
         raise RuntimeError(
@@ -89,11 +295,9 @@ def execute(self):
             (query, type(maskArray)))
 
     # if inverse selection is requested, just logical_not the mask array.
-    if selectionNode.GetProperties().Has(selectionNode.INVERSE()) and \
-        selectionNode.GetProperties().Get(selectionNode.INVERSE()) == 1:
+    if inverse:
           maskArray = algos.logical_not(maskArray)
 
-    output = dsa.WrapDataObject(outputDO)
     if self.GetPreserveTopology():
         # when preserving topology, just add the mask array as
         # vtkSignedCharArray to the output. vtkPythonExtractSelection should